@@ -257,11 +257,7 @@ main (int argc, char *argv[])
   }*/
 
   Ptr<const SpectrumModel> sm1 =  NrSpectrumValueHelper::GetSpectrumModel (rbNum, frequency, subcarrierSpacing);
-  std::vector<int> activeRbs;
-  for (size_t rbId = 0; rbId < sm1->GetNumBands(); rbId++)
-    {
-      activeRbs.push_back(rbId);
-    }
+  NrRbMask activeRbs (sm1->GetNumBands (), true);
   Ptr<const SpectrumValue> txPsd1 = NrSpectrumValueHelper::CreateTxPowerSpectralDensity (txPower, activeRbs, sm1, NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_BW);
   std::cout << "Average tx power 1: " << 10 * log10 (Sum (*txPsd1) / txPsd1->GetSpectrumModel ()->GetNumBands ()) << " dBm" << std::endl;
   Ptr<SpectrumValue> rxPsd1 = m_spectrumLossModel->DoCalcRxPowerSpectralDensity (txPsd1, txMob, rxMob, txAntenna, rxAntenna);
@@ -297,11 +293,7 @@ main (int argc, char *argv[])
 
 
   Ptr<const SpectrumModel> sm2 =  NrSpectrumValueHelper::GetSpectrumModel (rbNum, frequency, subcarrierSpacing);
-  std::vector<int> activeRbs2;
-  for (size_t rbId = 0; rbId < sm2->GetNumBands(); rbId++)
-    {
-      activeRbs2.push_back(rbId);
-    }
+  NrRbMask activeRbs2 (sm2->GetNumBands (), true);
   Ptr<const SpectrumValue> txPsd2 = NrSpectrumValueHelper::CreateTxPowerSpectralDensity (txPower, activeRbs2, sm2, NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_BW);
 
   std::cout << "Average tx power 1: " << 10 * log10 (Sum (*txPsd2) / txPsd2->GetSpectrumModel ()->GetNumBands ()) << " dBm" << std::endl;
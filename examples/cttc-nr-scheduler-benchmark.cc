@@ -0,0 +1,691 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/nr-mac-scheduler-ns3.h"
+#include "ns3/nr-mac-short-bsr-ce.h"
+#include "ns3/nr-spectrum-value-helper.h"
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+/**
+ * \file cttc-nr-scheduler-benchmark.cc
+ * \ingroup examples
+ *
+ * \brief Micro-benchmark of the MAC schedulers, without PHY and channel.
+ *
+ * The example creates the schedulers through their TypeId, and drives them
+ * directly through the NrMacCschedSapProvider and NrMacSchedSapProvider
+ * interfaces, playing the role of the gNB MAC. The UEs are synthetic:
+ *
+ * - each UE has one logical channel (in DL and UL) with a constant arrival
+ * rate, and the buffer status is reported as the RLC (DL) and the BSR (UL) would do;
+ * - each UE has a mean CQI, and periodically reports a wideband DL CQI around
+ * that value; the UL CQI (PUSCH) is reported for every UL allocation, with a
+ * per-UE mean SINR;
+ * - the HARQ feedback is generated one slot after the transmission, and it is
+ * negative with probability equal to the BLER parameter;
+ * - the UEs are distributed in a configurable number of beams.
+ *
+ * All the slots are of type F: in every slot, the scheduler is asked to
+ * schedule the UL and then the DL of the slot that is two slots ahead
+ * (as the gNB does with the L1L2 control latency).
+ *
+ * For each combination of scheduler, number of UEs, number of RBGs and
+ * number of beams, the example prints one line with the time spent
+ * in the trigger requests (ns/slot), the time spent in all the calls to the
+ * scheduler (ns/slot, including CQI, buffer status and HARQ processing),
+ * and the number of DL and UL data allocations per slot. The time
+ * is measured over the slots after the warm-up ones.
+ *
+ * The lists are comma-separated:
+ *
+ * \code{.unparsed}
+$ ./ns3 run "cttc-nr-scheduler-benchmark --schedulers=ns3::NrMacSchedulerOfdmaPF --ueList=10,50,100 --rbgList=51 --beamList=1,4"
+    \endcode
+ *
+ * The example should be compiled in optimized mode to give meaningful numbers.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("CttcNrSchedulerBenchmark");
+
+/**
+ * \brief Configuration of a single benchmark run
+ */
+struct BenchmarkConf
+{
+  std::string m_scheduler;       //!< TypeId name of the scheduler
+  uint32_t m_ues {0};            //!< Number of UEs
+  uint32_t m_rbgs {0};           //!< Bandwidth in RBG
+  uint32_t m_beams {0};          //!< Number of beams
+  uint32_t m_rbPerRbg {1};       //!< Number of RB per RBG
+  uint32_t m_slots {0};          //!< Number of measured slots
+  uint32_t m_warmUpSlots {0};    //!< Number of slots not measured
+  uint16_t m_numerology {0};     //!< Numerology
+  uint32_t m_dlBytesPerSlot {0}; //!< DL bytes arriving per slot per UE
+  uint32_t m_ulBytesPerSlot {0}; //!< UL bytes arriving per slot per UE
+  uint32_t m_cqiPeriod {1};      //!< Periodicity of the DL CQI reports, in slots
+  double m_bler {0.0};           //!< Probability of a NACK
+};
+
+/**
+ * \brief Result of a benchmark run
+ */
+struct BenchmarkResult
+{
+  double m_triggerNsPerSlot {0.0}; //!< Time spent in the trigger requests
+  double m_totalNsPerSlot {0.0};   //!< Time spent in all the scheduler calls
+  double m_dlAllocPerSlot {0.0};   //!< DL data allocations per slot
+  double m_ulAllocPerSlot {0.0};   //!< UL data allocations per slot
+  double m_dlBytesPerSlot {0.0};   //!< DL bytes of new data per slot
+  double m_ulBytesPerSlot {0.0};   //!< UL bytes of new data per slot
+};
+
+class SchedulerBenchmark;
+
+/**
+ * \brief CSCHED SAP user that ignores everything
+ */
+class BenchmarkCschedSapUser : public NrMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf ([[maybe_unused]] const struct CschedCellConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeConfigCnf ([[maybe_unused]] const struct CschedUeConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedLcConfigCnf ([[maybe_unused]] const struct CschedLcConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedLcReleaseCnf ([[maybe_unused]] const struct CschedLcReleaseCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeReleaseCnf ([[maybe_unused]] const struct CschedUeReleaseCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeConfigUpdateInd ([[maybe_unused]] const struct CschedUeConfigUpdateIndParameters& params) override
+  {
+  }
+  virtual void CschedCellConfigUpdateInd ([[maybe_unused]] const struct CschedCellConfigUpdateIndParameters& params) override
+  {
+  }
+};
+
+/**
+ * \brief SCHED SAP user that forwards the decisions to the benchmark
+ */
+class BenchmarkSchedSapUser : public NrMacSchedSapUser
+{
+public:
+  /**
+   * \brief BenchmarkSchedSapUser constructor
+   * \param bench the benchmark
+   * \param conf the configuration
+   * \param model the spectrum model
+   */
+  BenchmarkSchedSapUser (SchedulerBenchmark *bench, const BenchmarkConf &conf,
+                         const Ptr<const SpectrumModel> &model)
+    : m_bench (bench),
+      m_conf (conf),
+      m_model (model)
+  {
+  }
+
+  virtual void SchedConfigInd (const struct SchedConfigIndParameters& params) override;
+
+  virtual Ptr<const SpectrumModel> GetSpectrumModel () const override
+  {
+    return m_model;
+  }
+  virtual uint32_t GetNumRbPerRbg () const override
+  {
+    return m_conf.m_rbPerRbg;
+  }
+  virtual uint8_t GetNumHarqProcess () const override
+  {
+    return 20;
+  }
+  virtual uint16_t GetBwpId () const override
+  {
+    return 0;
+  }
+  virtual uint16_t GetCellId () const override
+  {
+    return 1;
+  }
+  virtual uint32_t GetSymbolsPerSlot () const override
+  {
+    return 14;
+  }
+  virtual Time GetSlotPeriod () const override
+  {
+    return MicroSeconds (1000 >> m_conf.m_numerology);
+  }
+
+private:
+  SchedulerBenchmark *m_bench {nullptr}; //!< The benchmark
+  BenchmarkConf m_conf;                  //!< The configuration
+  Ptr<const SpectrumModel> m_model;      //!< The spectrum model
+};
+
+/**
+ * \brief Play the role of the gNB MAC (and of the UEs) for a scheduler
+ */
+class SchedulerBenchmark
+{
+public:
+  /**
+   * \brief SchedulerBenchmark constructor
+   * \param conf the configuration
+   */
+  SchedulerBenchmark (const BenchmarkConf &conf);
+
+  /**
+   * \brief Run the benchmark
+   * \return the results
+   */
+  BenchmarkResult Run ();
+
+  /**
+   * \brief Receive a decision from the scheduler
+   * \param params the decision
+   */
+  void SchedConfigInd (const NrMacSchedSapUser::SchedConfigIndParameters& params);
+
+private:
+  /**
+   * \brief Synthetic UE
+   */
+  struct Ue
+  {
+    uint16_t m_rnti {0};       //!< RNTI
+    uint8_t m_meanCqi {0};     //!< Mean DL CQI
+    double m_ulSinr {0.0};     //!< UL SINR (linear)
+    uint64_t m_dlQueue {0};    //!< DL RLC queue
+    uint64_t m_ulQueue {0};    //!< UL queue
+  };
+
+  /**
+   * \brief Pending UL CQI of a slot, one per starting symbol
+   */
+  typedef std::map<uint8_t, std::vector<double> > UlCqiPerSym;
+
+  void Setup ();
+  void DoSlot (const SfnSf &current, bool measure);
+  Ue & GetUe (uint16_t rnti);
+
+  BenchmarkConf m_conf;                          //!< Configuration
+  Ptr<NrMacSchedulerNs3> m_sched;                //!< The scheduler
+  NrMacSchedSapProvider *m_schedSap {nullptr};   //!< SCHED SAP provider
+  NrMacCschedSapProvider *m_cschedSap {nullptr}; //!< CSCHED SAP provider
+  std::unique_ptr<BenchmarkCschedSapUser> m_cschedSapUser; //!< CSCHED SAP user
+  std::unique_ptr<BenchmarkSchedSapUser> m_schedSapUser;   //!< SCHED SAP user
+
+  std::vector<Ue> m_ues;                         //!< UEs, indexed by RNTI - 1
+  Ptr<UniformRandomVariable> m_random;           //!< Random variable
+
+  std::map<uint64_t, std::vector<DlHarqInfo> > m_dlHarq; //!< DL feedback, per slot in which it is available
+  std::map<uint64_t, std::vector<UlHarqInfo> > m_ulHarq; //!< UL feedback, per slot in which it is available
+  std::map<uint64_t, std::pair<SfnSf, UlCqiPerSym> > m_ulCqi; //!< UL CQI, per slot in which it is available
+
+  uint64_t m_dlAlloc {0};  //!< Counter of DL data allocations
+  uint64_t m_ulAlloc {0};  //!< Counter of UL data allocations
+  uint64_t m_dlBytes {0};  //!< Counter of DL new bytes
+  uint64_t m_ulBytes {0};  //!< Counter of UL new bytes
+  std::chrono::nanoseconds m_triggerTime {0}; //!< Time spent in the triggers
+  std::chrono::nanoseconds m_totalTime {0};   //!< Time spent in the scheduler
+};
+
+void
+BenchmarkSchedSapUser::SchedConfigInd (const struct SchedConfigIndParameters& params)
+{
+  m_bench->SchedConfigInd (params);
+}
+
+SchedulerBenchmark::SchedulerBenchmark (const BenchmarkConf &conf)
+  : m_conf (conf)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+SchedulerBenchmark::Ue &
+SchedulerBenchmark::GetUe (uint16_t rnti)
+{
+  NS_ASSERT (rnti > 0 && rnti <= m_ues.size ());
+  return m_ues.at (rnti - 1);
+}
+
+void
+SchedulerBenchmark::Setup ()
+{
+  double scs = 15e3 * static_cast<double> (1 << m_conf.m_numerology);
+  auto model = NrSpectrumValueHelper::GetSpectrumModel (m_conf.m_rbgs * m_conf.m_rbPerRbg,
+                                                        3.5e9, scs);
+
+  m_cschedSapUser = std::make_unique<BenchmarkCschedSapUser> ();
+  m_schedSapUser = std::make_unique<BenchmarkSchedSapUser> (this, m_conf, model);
+
+  ObjectFactory factory;
+  factory.SetTypeId (m_conf.m_scheduler);
+  m_sched = DynamicCast<NrMacSchedulerNs3> (factory.Create ());
+  NS_ABORT_MSG_IF (m_sched == nullptr, "Can't create a NrMacSchedulerNs3 from type " + m_conf.m_scheduler);
+
+  m_sched->InstallDlAmc (CreateObject<NrAmc> ());
+  m_sched->InstallUlAmc (CreateObject<NrAmc> ());
+  m_sched->SetMacSchedSapUser (m_schedSapUser.get ());
+  m_sched->SetMacCschedSapUser (m_cschedSapUser.get ());
+  m_schedSap = m_sched->GetMacSchedSapProvider ();
+  m_cschedSap = m_sched->GetMacCschedSapProvider ();
+
+  NrMacCschedSapProvider::CschedCellConfigReqParameters cellConf;
+  cellConf.m_dlBandwidth = static_cast<uint16_t> (m_conf.m_rbgs);
+  cellConf.m_ulBandwidth = static_cast<uint16_t> (m_conf.m_rbgs);
+  m_cschedSap->CschedCellConfigReq (cellConf);
+
+  for (uint32_t i = 0; i < m_conf.m_ues; ++i)
+    {
+      Ue ue;
+      ue.m_rnti = static_cast<uint16_t> (i + 1);
+      ue.m_meanCqi = static_cast<uint8_t> (m_random->GetInteger (3, 15));
+      ue.m_ulSinr = std::pow (10.0, m_random->GetValue (0.0, 25.0) / 10.0);
+      m_ues.push_back (ue);
+
+      NrMacCschedSapProvider::CschedUeConfigReqParameters ueConf;
+      ueConf.m_rnti = ue.m_rnti;
+      ueConf.m_transmissionMode = 0;
+      double sector = static_cast<double> (i % m_conf.m_beams);
+      ueConf.m_beamConfId = BeamConfId (BeamId (static_cast<uint16_t> (sector), 90.0),
+                                        BeamId::GetEmptyBeamId ());
+      m_cschedSap->CschedUeConfigReq (ueConf);
+
+      NrMacCschedSapProvider::CschedLcConfigReqParameters lcConf;
+      lcConf.m_rnti = ue.m_rnti;
+      lcConf.m_reconfigureFlag = false;
+      LogicalChannelConfigListElement_s lc;
+      lc.m_logicalChannelIdentity = 3;
+      lc.m_logicalChannelGroup = 1;
+      lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+      lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+      lc.m_qci = 9;
+      lcConf.m_logicalChannelConfigList.push_back (lc);
+      m_cschedSap->CschedLcConfigReq (lcConf);
+    }
+}
+
+void
+SchedulerBenchmark::SchedConfigInd (const NrMacSchedSapUser::SchedConfigIndParameters& params)
+{
+  SfnSf feedbackSlot = params.m_sfnSf;
+  feedbackSlot.Add (1);
+  uint64_t feedbackKey = feedbackSlot.Normalize ();
+
+  for (const auto & varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+      const auto & dci = varTti.m_dci;
+      if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+          continue;
+        }
+
+      Ue & ue = GetUe (dci->m_rnti);
+
+      if (dci->m_format == DciInfoElementTdma::DL)
+        {
+          ++m_dlAlloc;
+
+          DlHarqInfo harq;
+          harq.m_rnti = dci->m_rnti;
+          harq.m_harqProcessId = dci->m_harqProcess;
+          harq.m_bwpIndex = 0;
+          for (uint8_t stream = 0; stream < dci->m_tbSize.size (); ++stream)
+            {
+              if (dci->m_tbSize.at (stream) == 0)
+                {
+                  harq.m_harqStatus.push_back (DlHarqInfo::NONE);
+                }
+              else
+                {
+                  harq.m_harqStatus.push_back (m_random->GetValue () < m_conf.m_bler ?
+                                               DlHarqInfo::NACK : DlHarqInfo::ACK);
+                }
+              harq.m_numRetx.push_back (dci->m_rv.at (stream));
+
+              if (dci->m_ndi.at (stream) == 1)
+                {
+                  for (const auto & lc : varTti.m_rlcPduInfo)
+                    {
+                      if (stream < lc.size ())
+                        {
+                          uint32_t bytes = lc.at (stream).m_size;
+                          ue.m_dlQueue -= std::min (ue.m_dlQueue, static_cast<uint64_t> (bytes));
+                          m_dlBytes += bytes;
+                        }
+                    }
+                }
+            }
+          m_dlHarq[feedbackKey].push_back (harq);
+        }
+      else
+        {
+          ++m_ulAlloc;
+
+          UlHarqInfo harq;
+          harq.m_rnti = dci->m_rnti;
+          harq.m_harqProcessId = dci->m_harqProcess;
+          harq.m_bwpIndex = 0;
+          harq.m_numRetx = dci->m_rv.at (0);
+          harq.m_receptionStatus = m_random->GetValue () < m_conf.m_bler ?
+            UlHarqInfo::NotOk : UlHarqInfo::Ok;
+          m_ulHarq[feedbackKey].push_back (harq);
+
+          if (dci->m_ndi.at (0) == 1)
+            {
+              uint32_t bytes = dci->m_tbSize.at (0);
+              ue.m_ulQueue -= std::min (ue.m_ulQueue, static_cast<uint64_t> (bytes));
+              m_ulBytes += bytes;
+            }
+
+          // The gNB reports one CQI for each starting symbol, with the
+          // SINR of the UEs in the RBs they used
+          auto & cqiSlot = m_ulCqi[feedbackKey];
+          cqiSlot.first = params.m_sfnSf;
+          auto & sinr = cqiSlot.second[dci->m_symStart];
+          sinr.resize (m_conf.m_rbgs * m_conf.m_rbPerRbg, 0.0);
+          for (uint32_t rb : dci->m_rbgBitmask.ExpandRbgToRb (m_conf.m_rbPerRbg))
+            {
+              sinr.at (rb) = ue.m_ulSinr;
+            }
+        }
+    }
+}
+
+void
+SchedulerBenchmark::DoSlot (const SfnSf &current, bool measure)
+{
+  using Clock = std::chrono::steady_clock;
+  uint64_t currentKey = current.Normalize ();
+  std::chrono::nanoseconds total {0};
+
+  // UL CQI of the allocations that have been received
+  for (auto it = m_ulCqi.begin (); it != m_ulCqi.end () && it->first <= currentKey; )
+    {
+      for (const auto & sym : it->second.second)
+        {
+          NrMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+          ulCqi.m_sfnSf = it->second.first;
+          ulCqi.m_symStart = sym.first;
+          ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+          ulCqi.m_ulCqi.m_sinr = sym.second;
+
+          auto start = Clock::now ();
+          m_schedSap->SchedUlCqiInfoReq (ulCqi);
+          total += Clock::now () - start;
+        }
+      it = m_ulCqi.erase (it);
+    }
+
+  // DL CQI
+  if (currentKey % m_conf.m_cqiPeriod == 0)
+    {
+      NrMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+      dlCqi.m_sfnsf = current;
+      for (const auto & ue : m_ues)
+        {
+          DlCqiInfo info;
+          info.m_rnti = ue.m_rnti;
+          info.m_ri = 1;
+          info.m_cqiType = DlCqiInfo::WB;
+          int cqi = static_cast<int> (ue.m_meanCqi) + static_cast<int> (m_random->GetInteger (0, 2)) - 1;
+          info.m_wbCqi.push_back (static_cast<uint8_t> (std::max (1, std::min (15, cqi))));
+          dlCqi.m_cqiList.push_back (info);
+        }
+
+      auto start = Clock::now ();
+      m_schedSap->SchedDlCqiInfoReq (dlCqi);
+      total += Clock::now () - start;
+    }
+
+  // New data: RLC buffer status (DL) and BSR (UL)
+  NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsrs;
+  bsrs.m_sfnSf = current;
+  for (auto & ue : m_ues)
+    {
+      if (m_conf.m_dlBytesPerSlot > 0)
+        {
+          ue.m_dlQueue += m_conf.m_dlBytesPerSlot;
+
+          NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+          rlc.m_rnti = ue.m_rnti;
+          rlc.m_logicalChannelIdentity = 3;
+          rlc.m_rlcTransmissionQueueSize = static_cast<uint32_t> (std::min (ue.m_dlQueue,
+                                                                           static_cast<uint64_t> (UINT32_MAX)));
+          rlc.m_rlcTransmissionQueueHolDelay = 0;
+          rlc.m_rlcRetransmissionQueueSize = 0;
+          rlc.m_rlcRetransmissionHolDelay = 0;
+          rlc.m_rlcStatusPduSize = 0;
+
+          auto start = Clock::now ();
+          m_schedSap->SchedDlRlcBufferReq (rlc);
+          total += Clock::now () - start;
+        }
+      if (m_conf.m_ulBytesPerSlot > 0)
+        {
+          ue.m_ulQueue += m_conf.m_ulBytesPerSlot;
+
+          MacCeElement bsr;
+          bsr.m_rnti = ue.m_rnti;
+          bsr.m_macCeType = MacCeElement::BSR;
+          for (uint8_t lcg = 0; lcg < 4; ++lcg)
+            {
+              bsr.m_macCeValue.m_bufferStatus.push_back (lcg == 1 ? NrMacShortBsrCe::FromBytesToLevel (ue.m_ulQueue) : 0);
+            }
+          bsrs.m_macCeList.push_back (bsr);
+        }
+    }
+  if (! bsrs.m_macCeList.empty ())
+    {
+      auto start = Clock::now ();
+      m_schedSap->SchedUlMacCtrlInfoReq (bsrs);
+      total += Clock::now () - start;
+    }
+
+  // Triggers, for the slot in the future (L1L2 latency of 2 slots)
+  SfnSf target = current;
+  target.Add (2);
+
+  NrMacSchedSapProvider::SchedUlTriggerReqParameters ulParams;
+  ulParams.m_snfSf = target;
+  ulParams.m_slotType = LteNrTddSlotType::F;
+  NrMacSchedSapProvider::SchedDlTriggerReqParameters dlParams;
+  dlParams.m_snfSf = target;
+  dlParams.m_slotType = LteNrTddSlotType::F;
+
+  for (auto it = m_ulHarq.begin (); it != m_ulHarq.end () && it->first <= currentKey; )
+    {
+      ulParams.m_ulHarqInfoList.insert (ulParams.m_ulHarqInfoList.end (), it->second.begin (), it->second.end ());
+      it = m_ulHarq.erase (it);
+    }
+  for (auto it = m_dlHarq.begin (); it != m_dlHarq.end () && it->first <= currentKey; )
+    {
+      dlParams.m_dlHarqInfoList.insert (dlParams.m_dlHarqInfoList.end (), it->second.begin (), it->second.end ());
+      it = m_dlHarq.erase (it);
+    }
+
+  auto start = Clock::now ();
+  m_schedSap->SchedUlTriggerReq (ulParams);
+  m_schedSap->SchedDlTriggerReq (dlParams);
+  auto trigger = Clock::now () - start;
+  total += trigger;
+
+  if (measure)
+    {
+      m_triggerTime += trigger;
+      m_totalTime += total;
+    }
+}
+
+BenchmarkResult
+SchedulerBenchmark::Run ()
+{
+  Setup ();
+
+  SfnSf current (0, 0, 0, static_cast<uint8_t> (m_conf.m_numerology));
+
+  for (uint32_t i = 0; i < m_conf.m_warmUpSlots; ++i)
+    {
+      DoSlot (current, false);
+      current.Add (1);
+    }
+
+  m_dlAlloc = m_ulAlloc = m_dlBytes = m_ulBytes = 0;
+
+  for (uint32_t i = 0; i < m_conf.m_slots; ++i)
+    {
+      DoSlot (current, true);
+      current.Add (1);
+    }
+
+  double slots = std::max (1U, m_conf.m_slots);
+  BenchmarkResult res;
+  res.m_triggerNsPerSlot = m_triggerTime.count () / slots;
+  res.m_totalNsPerSlot = m_totalTime.count () / slots;
+  res.m_dlAllocPerSlot = m_dlAlloc / slots;
+  res.m_ulAllocPerSlot = m_ulAlloc / slots;
+  res.m_dlBytesPerSlot = m_dlBytes / slots;
+  res.m_ulBytesPerSlot = m_ulBytes / slots;
+  return res;
+}
+
+/**
+ * \brief Split a comma-separated list
+ * \param list the list
+ * \return the elements of the list
+ */
+static std::vector<std::string>
+SplitList (const std::string &list)
+{
+  std::vector<std::string> ret;
+  std::stringstream ss (list);
+  std::string item;
+  while (std::getline (ss, item, ','))
+    {
+      if (! item.empty ())
+        {
+          ret.push_back (item);
+        }
+    }
+  return ret;
+}
+
+/**
+ * \brief Split a comma-separated list of numbers
+ * \param list the list
+ * \return the numbers of the list
+ */
+static std::vector<uint32_t>
+SplitNumbers (const std::string &list)
+{
+  std::vector<uint32_t> ret;
+  for (const auto & item : SplitList (list))
+    {
+      ret.push_back (static_cast<uint32_t> (std::stoul (item)));
+    }
+  return ret;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string schedulers = "ns3::NrMacSchedulerTdmaRR,ns3::NrMacSchedulerTdmaPF,"
+                           "ns3::NrMacSchedulerTdmaMR,ns3::NrMacSchedulerOfdmaRR,"
+                           "ns3::NrMacSchedulerOfdmaPF,ns3::NrMacSchedulerOfdmaMR,"
+                           "ns3::NrMacSchedulerTdmaQos,ns3::NrMacSchedulerOfdmaQos";
+  std::string ueList = "10,20,50,100";
+  std::string rbgList = "51";
+  std::string beamList = "1";
+  BenchmarkConf conf;
+  conf.m_slots = 2000;
+  conf.m_warmUpSlots = 200;
+  conf.m_numerology = 1;
+  conf.m_dlBytesPerSlot = 500;
+  conf.m_ulBytesPerSlot = 100;
+  conf.m_cqiPeriod = 4;
+  conf.m_bler = 0.1;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("schedulers", "Comma-separated list of scheduler TypeIds", schedulers);
+  cmd.AddValue ("ueList", "Comma-separated list of number of UEs", ueList);
+  cmd.AddValue ("rbgList", "Comma-separated list of bandwidths, in RBG", rbgList);
+  cmd.AddValue ("beamList", "Comma-separated list of number of beams", beamList);
+  cmd.AddValue ("rbPerRbg", "Number of RB per RBG", conf.m_rbPerRbg);
+  cmd.AddValue ("slots", "Number of measured slots", conf.m_slots);
+  cmd.AddValue ("warmUpSlots", "Number of slots before the measure starts", conf.m_warmUpSlots);
+  cmd.AddValue ("numerology", "Numerology", conf.m_numerology);
+  cmd.AddValue ("dlBytesPerSlot", "DL bytes arriving at each UE in each slot", conf.m_dlBytesPerSlot);
+  cmd.AddValue ("ulBytesPerSlot", "UL bytes arriving at each UE in each slot", conf.m_ulBytesPerSlot);
+  cmd.AddValue ("cqiPeriod", "Periodicity (in slots) of the DL CQI reports", conf.m_cqiPeriod);
+  cmd.AddValue ("bler", "Probability of a negative HARQ feedback", conf.m_bler);
+  cmd.AddValue ("seed", "Seed of the random number generator", seed);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (conf.m_cqiPeriod == 0, "The CQI period must be greater than 0");
+  RngSeedManager::SetSeed (seed);
+
+  std::cout << "scheduler\tues\trbgs\tbeams\ttriggerNsPerSlot\ttotalNsPerSlot"
+            << "\tdlAllocPerSlot\tulAllocPerSlot\tdlBytesPerSlot\tulBytesPerSlot" << std::endl;
+
+  for (const auto & scheduler : SplitList (schedulers))
+    {
+      for (uint32_t ues : SplitNumbers (ueList))
+        {
+          for (uint32_t rbgs : SplitNumbers (rbgList))
+            {
+              for (uint32_t beams : SplitNumbers (beamList))
+                {
+                  NS_ABORT_MSG_IF (ues == 0 || rbgs == 0 || beams == 0,
+                                   "The number of UEs, RBGs, and beams must be greater than 0");
+                  conf.m_scheduler = scheduler;
+                  conf.m_ues = ues;
+                  conf.m_rbgs = rbgs;
+                  conf.m_beams = beams;
+
+                  SchedulerBenchmark bench (conf);
+                  BenchmarkResult res = bench.Run ();
+
+                  std::cout << scheduler << "\t" << ues << "\t" << rbgs << "\t" << beams
+                            << "\t" << res.m_triggerNsPerSlot << "\t" << res.m_totalNsPerSlot
+                            << "\t" << res.m_dlAllocPerSlot << "\t" << res.m_ulAllocPerSlot
+                            << "\t" << res.m_dlBytesPerSlot << "\t" << res.m_ulBytesPerSlot
+                            << std::endl;
+                }
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -58,10 +58,10 @@ LenaV2Utils::ReportSlotStatsNr (SlotOutputStats *stats, const SfnSf &sfnSf, uint
 
 void
 LenaV2Utils::ReportRbStatsNr (RbOutputStats *stats, const SfnSf &sfnSf, uint8_t sym,
-                              const std::vector<int> &rbUsed, uint16_t bwpId,
+                              const NrRbMask &rbUsed, uint16_t bwpId,
                               uint16_t cellId)
 {
-  stats->SaveRbStats (sfnSf, sym, rbUsed, bwpId, cellId);
+  stats->SaveRbStats (sfnSf, sym, rbUsed.ToIndexVector (), bwpId, cellId);
 }
 
 void
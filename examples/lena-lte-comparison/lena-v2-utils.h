@@ -83,7 +83,7 @@ public:
                      uint16_t cellId);
   static void
   ReportRbStatsNr (RbOutputStats *stats, const SfnSf &sfnSf, uint8_t sym,
-                   const std::vector<int> &rbUsed, uint16_t bwpId,
+                   const NrRbMask &rbUsed, uint16_t bwpId,
                    uint16_t cellId);
   static void
   ReportGnbRxDataNr (PowerOutputStats *gnbRxDataStats, const SfnSf &sfnSf,
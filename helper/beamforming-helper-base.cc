@@ -67,7 +67,17 @@ BeamformingHelperBase::RunTask (const Ptr<NrGnbNetDevice>& gNbDev,
   NS_LOG_INFO (" Run beamforming task for gNB:" << gNbDev->GetNode() -> GetId() <<
                  " and UE:"<< ueDev->GetNode()->GetId () );
   BeamformingVectorPair bfPair = GetBeamformingVectors (gnbSpectrumPhy, ueSpectrumPhy);
+  SaveBeamformingVectors (gNbDev, ueDev, gnbSpectrumPhy, ueSpectrumPhy, bfPair);
+}
 
+void
+BeamformingHelperBase::SaveBeamformingVectors (const Ptr<NrGnbNetDevice>& gNbDev,
+                                               const Ptr<NrUeNetDevice>& ueDev,
+                                               const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                               const Ptr<NrSpectrumPhy>& ueSpectrumPhy,
+                                               const BeamformingVectorPair &bfPair) const
+{
+  NS_LOG_FUNCTION (this);
   NS_ASSERT (bfPair.first.first.size () && bfPair.second.first.size ());
   gnbSpectrumPhy->GetBeamManager ()->SaveBeamformingVector (bfPair.first, ueDev);
   ueSpectrumPhy->GetBeamManager ()->SaveBeamformingVector (bfPair.second, gNbDev);
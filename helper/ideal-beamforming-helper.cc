@@ -28,6 +28,15 @@
 #include <ns3/beam-manager.h>
 #include <ns3/vector.h>
 #include <ns3/nr-spectrum-phy.h>
+#include <ns3/node.h>
+#include <ns3/uinteger.h>
+#include <ns3/boolean.h>
+#include <ns3/mobility-model.h>
+#include <ns3/three-gpp-spectrum-propagation-loss-model.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 namespace ns3{
 
@@ -72,6 +81,25 @@ IdealBeamformingHelper::GetTypeId (void)
                       MakeTimeAccessor (&IdealBeamformingHelper::SetPeriodicity,
                                         &IdealBeamformingHelper::GetPeriodicity),
                       MakeTimeChecker())
+      .AddAttribute ("NumThreads",
+                     "Number of threads used to compute the beams of the pairs of "
+                     "devices, if the beamforming method supports it (see "
+                     "IdealBeamformingAlgorithm::GetBeamSearchInput). The result "
+                     "does not depend on the number of threads. If set to 0, one "
+                     "thread per hardware thread is used. It has no effect with "
+                     "CellScanQuasiOmniBeamforming, and with CellScanBeamforming "
+                     "if its BeamSearchMethod is ChannelScan.",
+                      UintegerValue (1),
+                      MakeUintegerAccessor (&IdealBeamformingHelper::m_numThreads),
+                      MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("IncrementalUpdate",
+                     "If true, at each periodic run, recompute the beams only of the pairs "
+                     "of devices whose positions, or channel matrix (for the methods "
+                     "that depend on it), changed since the last time their beams "
+                     "were computed.",
+                      BooleanValue (false),
+                      MakeBooleanAccessor (&IdealBeamformingHelper::m_incrementalUpdate),
+                      MakeBooleanChecker ())
       ;
     return tid;
 }
@@ -101,6 +129,10 @@ IdealBeamformingHelper::AddBeamformingTask (const Ptr<NrGnbNetDevice>& gnbDev,
 
            m_spectrumPhyPairToDevicePair [std::make_pair (gnbSpectrumPhy, ueSpectrumPhy)] = std::make_pair (gnbDev, ueDev);
 
+           if (m_incrementalUpdate)
+             {
+               UpdatePairState (gnbSpectrumPhy, ueSpectrumPhy);
+             }
            RunTask (gnbDev, ueDev, gnbSpectrumPhy, ueSpectrumPhy);
          }
 
@@ -114,9 +146,175 @@ IdealBeamformingHelper::Run () const
   NS_LOG_INFO ("Running the beamforming method. There are :" <<
                m_spectrumPhyPairToDevicePair.size()<<" tasks.");
 
+  if (m_numThreads != 1 && m_spectrumPhyPairToDevicePair.size () > 1)
+    {
+      RunParallel ();
+      return;
+    }
+
   for (const auto& task : m_spectrumPhyPairToDevicePair)
     {
+      if (m_incrementalUpdate && ! UpdatePairState (task.first.first, task.first.second))
+        {
+          ++m_skippedTasks;
+          continue;
+        }
       RunTask (task.second.first, task.second.second, task.first.first, task.first.second);
+      ++m_recomputedTasks;
+    }
+}
+
+bool
+IdealBeamformingHelper::UpdatePairState (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                         const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+{
+  NS_LOG_FUNCTION (this);
+
+  PairState state;
+  state.m_gnbPosition = gnbSpectrumPhy->GetMobility ()->GetPosition ();
+  state.m_uePosition = ueSpectrumPhy->GetMobility ()->GetPosition ();
+
+  if (m_beamformingAlgorithm->DependsOnChannel ())
+    {
+      Ptr<const ThreeGppSpectrumPropagationLossModel> threeGppSplm =
+        DynamicCast<const ThreeGppSpectrumPropagationLossModel> (gnbSpectrumPhy->GetSpectrumChannel ()->GetPhasedArraySpectrumPropagationLossModel ());
+      if (threeGppSplm == nullptr)
+        {
+          // the channel cannot be checked: always recompute
+          return true;
+        }
+      // GetChannel updates the channel if needed, as the computation of the
+      // beams would do
+      Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix =
+        threeGppSplm->GetChannelModel ()->GetChannel (gnbSpectrumPhy->GetMobility (),
+                                                      ueSpectrumPhy->GetMobility (),
+                                                      gnbSpectrumPhy->GetAntenna ()->GetObject<PhasedArrayModel> (),
+                                                      ueSpectrumPhy->GetAntenna ()->GetObject<PhasedArrayModel> ());
+      state.m_channelGenerated = channelMatrix->m_generatedTime;
+      state.m_channelKnown = true;
+    }
+
+  auto it = m_pairStates.find (std::make_pair (gnbSpectrumPhy, ueSpectrumPhy));
+  if (it == m_pairStates.end ())
+    {
+      m_pairStates.emplace (std::make_pair (gnbSpectrumPhy, ueSpectrumPhy), state);
+      return true;
+    }
+
+  bool changed = it->second.m_gnbPosition != state.m_gnbPosition
+    || it->second.m_uePosition != state.m_uePosition
+    || it->second.m_channelKnown != state.m_channelKnown
+    || it->second.m_channelGenerated != state.m_channelGenerated;
+  it->second = state;
+  return changed;
+}
+
+uint64_t
+IdealBeamformingHelper::GetNumRecomputedTasks () const
+{
+  return m_recomputedTasks;
+}
+
+uint64_t
+IdealBeamformingHelper::GetNumSkippedTasks () const
+{
+  return m_skippedTasks;
+}
+
+void
+IdealBeamformingHelper::RunParallel () const
+{
+  NS_LOG_FUNCTION (this);
+
+  size_t numTasks = m_spectrumPhyPairToDevicePair.size ();
+  std::vector<Ptr<const BeamSearchInput>> inputs;
+  std::vector<BeamformingVectorPair> results (numTasks);
+  inputs.reserve (numTasks);
+
+  // Read the inputs from the main thread, in the order of the tasks (which is
+  // the order in which the serial run would access the channel). If the
+  // method does not support it for a pair, the beams of the pair are computed
+  // now, as in the serial run.
+  std::vector<bool> skipped (numTasks, false);
+  size_t numInputs = 0;
+  bool computedByMainThread = false;
+  for (const auto& task : m_spectrumPhyPairToDevicePair)
+    {
+      if (m_incrementalUpdate && ! UpdatePairState (task.first.first, task.first.second))
+        {
+          skipped.at (inputs.size ()) = true;
+          inputs.push_back (nullptr);
+          continue;
+        }
+      inputs.push_back (m_beamformingAlgorithm->GetBeamSearchInput (task.first.first, task.first.second));
+      if (inputs.back () == nullptr)
+        {
+          results.at (inputs.size () - 1) = GetBeamformingVectors (task.first.first, task.first.second);
+          computedByMainThread = true;
+        }
+      else
+        {
+          ++numInputs;
+        }
+    }
+
+  if (computedByMainThread && numInputs == 0)
+    {
+      NS_LOG_WARN ("The beamforming method does not support the parallel computation of "
+                   "the beams: the attribute NumThreads has no effect");
+    }
+
+  // Compute the beams of the other pairs: each thread picks the next one. The
+  // workers only use raw references, the reference counts are touched only
+  // by the main thread.
+  std::atomic<size_t> nextTask {0};
+  auto worker = [&] ()
+  {
+    for (size_t i = nextTask++; i < numTasks; i = nextTask++)
+      {
+        if (inputs[i] != nullptr)
+          {
+            results[i] = m_beamformingAlgorithm->ComputeBeamformingVectors (*PeekPointer (inputs[i]));
+          }
+      }
+  };
+
+  size_t numThreads = m_numThreads == 0 ? std::max (1U, std::thread::hardware_concurrency ())
+                                        : m_numThreads;
+  numThreads = std::min (numThreads, numInputs);
+  NS_LOG_INFO ("Computing the beams of " << numInputs << " pairs with " << numThreads << " threads");
+
+  // No thread is started if the main thread is enough, or if there is
+  // nothing left to compute
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < numThreads; ++t)
+    {
+      threads.emplace_back (worker);
+    }
+  if (numThreads > 0)
+    {
+      worker (); // the main thread works as well
+    }
+  for (auto & thread : threads)
+    {
+      thread.join ();
+    }
+
+  // Save the beams in the order of the tasks, as the serial run
+  size_t i = 0;
+  for (const auto& task : m_spectrumPhyPairToDevicePair)
+    {
+      if (skipped.at (i))
+        {
+          ++m_skippedTasks;
+          ++i;
+          continue;
+        }
+      ++m_recomputedTasks;
+      NS_LOG_INFO (" Save beamforming vectors for gNB:" << task.second.first->GetNode ()->GetId () <<
+                   " and UE:" << task.second.second->GetNode ()->GetId ());
+      SaveBeamformingVectors (task.second.first, task.second.second,
+                              task.first.first, task.first.second, results.at (i++));
     }
 }
 
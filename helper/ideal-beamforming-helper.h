@@ -72,6 +72,9 @@ public:
 
   /**
    * \brief Run beamforming task
+   *
+   * If the attribute NumThreads is not 1, the beams are computed by
+   * RunParallel.
    */
   virtual void Run () const;
 
@@ -84,6 +87,17 @@ public:
   virtual void AddBeamformingTask (const Ptr<NrGnbNetDevice>& gNbDev,
                                    const Ptr<NrUeNetDevice>& ueDev) override;
 
+  /**
+   * \return the number of beamforming tasks whose beams were computed by Run
+   */
+  uint64_t GetNumRecomputedTasks () const;
+
+  /**
+   * \return the number of beamforming tasks skipped by Run because their
+   * inputs did not change (see the attribute IncrementalUpdate)
+   */
+  uint64_t GetNumSkippedTasks () const;
+
 protected:
 
   // inherited from Object
@@ -95,6 +109,34 @@ protected:
    */
   virtual void ExpireBeamformingTimer ();
 
+  /**
+   * \brief Run the beamforming tasks with many threads
+   *
+   * The inputs of the pairs are read from the main thread, in the order of the
+   * tasks, then the beams are computed by a pool of NumThreads threads, and
+   * finally they are saved in the order of the tasks. The result is the same
+   * as the one of the serial run. The threads are started only for the pairs
+   * whose input is supported by the beamforming method: if there is none,
+   * all the beams are computed by the main thread.
+   */
+  void RunParallel () const;
+
+  /**
+   * \brief Tell if the inputs of the beams of a pair changed since the last
+   * time that its beams were computed, and remember the current ones
+   *
+   * The inputs are the positions of the devices and, if the beamforming
+   * method depends on it, the generation time of the channel matrix of the
+   * pair (which is generated or updated, if needed, as the computation of the
+   * beams would do).
+   *
+   * \param gnbSpectrumPhy the spectrum phy of the gNB
+   * \param ueSpectrumPhy the spectrum phy of the UE
+   * \return true if the beams of the pair have to be recomputed
+   */
+  bool UpdatePairState (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                        const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const;
+
 
   virtual BeamformingVectorPair GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
                                                        const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
@@ -102,12 +144,29 @@ protected:
   Time m_beamformingPeriodicity; //!< The beamforming periodicity or how frequently beamforming tasks will be executed
   EventId m_beamformingTimer; //!< Beamforming timer that is used to schedule periodical beamforming vector updates
   Ptr<IdealBeamformingAlgorithm> m_beamformingAlgorithm; //!< The beamforming algorithm that will be used
+  uint32_t m_numThreads {1}; //!< Number of threads used to compute the beams (attribute)
 
   typedef std::pair<Ptr<NrSpectrumPhy>, Ptr<NrSpectrumPhy> > SpectrumPhyPair;
   typedef std::pair<Ptr<NrGnbNetDevice>, Ptr<NrUeNetDevice> > DevicePair; //!< The list of beamforming tasks to be executed
 
   std::map <SpectrumPhyPair, DevicePair> m_spectrumPhyPairToDevicePair;
 
+  /**
+   * \brief The inputs of the beams of a pair, when they were last computed
+   */
+  struct PairState
+  {
+    Vector m_gnbPosition;            //!< Position of the gNB
+    Vector m_uePosition;             //!< Position of the UE
+    Time m_channelGenerated;         //!< Generation time of the channel matrix
+    bool m_channelKnown {false};     //!< True if m_channelGenerated is valid
+  };
+
+  bool m_incrementalUpdate {false};                           //!< Skip the pairs whose inputs did not change (attribute)
+  mutable std::map<SpectrumPhyPair, PairState> m_pairStates;  //!< Inputs of each pair, with m_incrementalUpdate
+  mutable uint64_t m_recomputedTasks {0};                     //!< Tasks computed by Run
+  mutable uint64_t m_skippedTasks {0};                        //!< Tasks skipped by Run
+
 };
 
 }; //ns3 namespace
@@ -119,6 +119,13 @@ NrHelper::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&NrHelper::m_harqEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseSlotClock",
+                   "Run the slot boundaries of all the PHYs installed by this "
+                   "helper in a single event per time stamp (see NrSlotClock). "
+                   "It must be set before installing the devices.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrHelper::m_useSlotClock),
+                   MakeBooleanChecker ())
     ;
   return tid;
 }
@@ -516,6 +523,15 @@ NrHelper::CreateUePhy (const Ptr<Node> &n, const std::unique_ptr<BandwidthPartIn
   NS_ASSERT_MSG (res, "Propagation model without Frequency attribute");
   phy->InstallCentralFrequency (frequency.Get ());
 
+  if (m_useSlotClock)
+    {
+      if (m_slotClock == nullptr)
+        {
+          m_slotClock = CreateObject<NrSlotClock> ();
+        }
+      phy->SetSlotClock (m_slotClock);
+    }
+
   phy->ScheduleStartEventLoop (n->GetId (), 0, 0, 0);
 
   // connect CAM and PHY
@@ -725,6 +741,15 @@ NrHelper::CreateGnbPhy (const Ptr<Node> &n, const std::unique_ptr<BandwidthPartI
   NS_ASSERT_MSG (res, "Propagation model without Frequency attribute");
   phy->InstallCentralFrequency (frequency.Get ());
 
+  if (m_useSlotClock)
+    {
+      if (m_slotClock == nullptr)
+        {
+          m_slotClock = CreateObject<NrSlotClock> ();
+        }
+      phy->SetSlotClock (m_slotClock);
+    }
+
   phy->ScheduleStartEventLoop (n->GetId (), 0, 0, 0);
 
   // PHY <--> CAM
@@ -46,6 +46,7 @@ class EpcTft;
 class NrBearerStatsCalculator;
 class NrMacRxTrace;
 class NrPhyRxTrace;
+class NrSlotClock;
 class ComponentCarrierEnb;
 class ComponentCarrier;
 class NrMacScheduler;
@@ -578,9 +579,11 @@ public:
    * \see NrMacSchedulerOfdmaPF
    * \see NrMacSchedulerOfdmaRR
    * \see NrMacSchedulerOfdmaMR
+   * \see NrMacSchedulerOfdmaQos
    * \see NrMacSchedulerTdmaPF
    * \see NrMacSchedulerTdmaRR
    * \see NrMacSchedulerTdmaMR
+   * \see NrMacSchedulerTdmaQos
    */
   void SetSchedulerTypeId (const TypeId &typeId);
 
@@ -926,6 +929,8 @@ private:
   Ptr<BeamformingHelperBase> m_beamformingHelper {nullptr}; //!< Ptr to the beamforming helper
 
   bool m_harqEnabled {false};
+  bool m_useSlotClock {false};  //!< Use a slot clock (attribute)
+  Ptr<NrSlotClock> m_slotClock; //!< Slot clock shared by all the PHYs installed
   bool m_snrTest {false};
 
   Ptr<NrPhyRxTrace> m_phyStats; //!< Pointer to the PhyRx stats
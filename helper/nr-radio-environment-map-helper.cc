@@ -675,11 +675,7 @@ NrRadioEnvironmentMapHelper::CalcRxPsdValue (RemDevice& device, RemDevice& other
 {
   PropagationModels tempPropModels = CreateTemporalPropagationModels ();
 
-  std::vector<int> activeRbs;
-  for (size_t rbId = 0; rbId < device.spectrumModel->GetNumBands(); rbId++)
-    {
-      activeRbs.push_back(rbId);
-    }
+  NrRbMask activeRbs (device.spectrumModel->GetNumBands (), true);
 
   Ptr<const SpectrumValue> txPsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity (device.txPower, activeRbs,
                                                                                         device.spectrumModel, NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_BW);
@@ -110,7 +110,7 @@ NrSpectrumValueHelper::GetSpectrumModel (uint32_t numRbs, double centerFrequency
 }
 
 Ptr<SpectrumValue>
-NrSpectrumValueHelper::CreateTxPsdOverActiveRbs (double powerTx, const std::vector <int>& activeRbs, const Ptr<const SpectrumModel>& spectrumModel)
+NrSpectrumValueHelper::CreateTxPsdOverActiveRbs (double powerTx, const NrRbMask &activeRbs, const Ptr<const SpectrumModel>& spectrumModel)
 {
   NS_LOG_FUNCTION (powerTx << activeRbs << spectrumModel);
   Ptr<SpectrumValue> txPsd = Create <SpectrumValue> (spectrumModel);
@@ -118,10 +118,10 @@ NrSpectrumValueHelper::CreateTxPsdOverActiveRbs (double powerTx, const std::vect
   double txPowerDensity = 0;
   double subbandWidth = (spectrumModel->Begin()->fh - spectrumModel->Begin()->fl);
   NS_ABORT_MSG_IF(subbandWidth < 180000, "Erroneous spectrum model. RB width should be equal or greater than 180KHz");
-  txPowerDensity = powerTxW / (subbandWidth * activeRbs.size());
-  for (std::vector <int>::const_iterator it = activeRbs.begin (); it != activeRbs.end (); it++)
+  txPowerDensity = powerTxW / (subbandWidth * activeRbs.Count ());
+  NS_ASSERT (activeRbs.GetSize () <= spectrumModel->GetNumBands ());
+  for (uint32_t rbId : activeRbs)
     {
-      int rbId = (*it);
       (*txPsd)[rbId] = txPowerDensity;
     }
   NS_LOG_LOGIC (*txPsd);
@@ -130,7 +130,7 @@ NrSpectrumValueHelper::CreateTxPsdOverActiveRbs (double powerTx, const std::vect
 
 
 Ptr<SpectrumValue>
-NrSpectrumValueHelper::CreateTxPsdOverAllRbs (double powerTx, const std::vector <int>& activeRbs, const Ptr<const SpectrumModel>& spectrumModel)
+NrSpectrumValueHelper::CreateTxPsdOverAllRbs (double powerTx, const NrRbMask &activeRbs, const Ptr<const SpectrumModel>& spectrumModel)
 {
   NS_LOG_FUNCTION (powerTx << activeRbs << spectrumModel);
   Ptr<SpectrumValue> txPsd = Create <SpectrumValue> (spectrumModel);
@@ -139,9 +139,9 @@ NrSpectrumValueHelper::CreateTxPsdOverAllRbs (double powerTx, const std::vector
   double subbandWidth = (spectrumModel->Begin()->fh - spectrumModel->Begin()->fl);
   NS_ABORT_MSG_IF(subbandWidth < 180000, "Erroneous spectrum model. RB width should be equal or greater than 180KHz");
   txPowerDensity = powerTxW / (subbandWidth * spectrumModel->GetNumBands());
-  for (std::vector <int>::const_iterator it = activeRbs.begin (); it != activeRbs.end (); it++)
+  NS_ASSERT (activeRbs.GetSize () <= spectrumModel->GetNumBands ());
+  for (uint32_t rbId : activeRbs)
     {
-      int rbId = (*it);
       (*txPsd)[rbId] = txPowerDensity;
     }
   NS_LOG_LOGIC (*txPsd);
@@ -149,18 +149,18 @@ NrSpectrumValueHelper::CreateTxPsdOverAllRbs (double powerTx, const std::vector
 }
 
 Ptr<SpectrumValue>
-NrSpectrumValueHelper::CreateTxPowerSpectralDensity (double powerTx, const std::vector<int> &rbIndexVector,
+NrSpectrumValueHelper::CreateTxPowerSpectralDensity (double powerTx, const NrRbMask &activeRbs,
                                                      const Ptr<const SpectrumModel>& txSm, enum PowerAllocationType allocationType)
 {
   switch (allocationType)
   {
     case UNIFORM_POWER_ALLOCATION_BW:
       {
-        return CreateTxPsdOverAllRbs (powerTx, rbIndexVector, txSm);
+        return CreateTxPsdOverAllRbs (powerTx, activeRbs, txSm);
       }
     case UNIFORM_POWER_ALLOCATION_USED:
       {
-        return CreateTxPsdOverActiveRbs (powerTx, rbIndexVector, txSm);
+        return CreateTxPsdOverActiveRbs (powerTx, activeRbs, txSm);
       }
     default:
       {
@@ -21,6 +21,7 @@
 #define NR_SPECTRUM_VALUE_HELPER_H
 
 #include <ns3/spectrum-value.h>
+#include <ns3/nr-rb-mask.h>
 #include <vector>
 
 namespace ns3 {
@@ -58,12 +59,12 @@ public:
     * \brief Create SpectrumValue that will represent transmit power spectral density,
     * and assuming that all RBs are active.
     * \param powerTx total power in dBm
-    * \param rbIndexVector the list of active/used RBs for the current transmission
+    * \param activeRbs the mask of active/used RBs for the current transmission
     * \param txSm spectrumModel to be used to create this SpectrumValue
     * \param allocationType power allocation type to be used
     * \return spectrum value representing power spectral density for given parameters
     */
-  static Ptr<SpectrumValue> CreateTxPowerSpectralDensity (double powerTx, const std::vector<int> &rbIndexVector,
+  static Ptr<SpectrumValue> CreateTxPowerSpectralDensity (double powerTx, const NrRbMask &activeRbs,
                                                                 const Ptr<const SpectrumModel>& txSm,
                                                                 enum PowerAllocationType allocationType);
 
@@ -89,11 +90,11 @@ protected:
    * \brief Create SpectrumValue that will represent transmit power spectral density, and
    * the total transmit power will be uniformly distributed only over active RBs
    * \param powerTx total power in dBm
-   * \param activeRbs vector of RBs that are active for this transmission
+   * \param activeRbs mask of RBs that are active for this transmission
    * \param spectrumModel spectrumModel to be used to create this SpectrumValue
    */
   static Ptr<SpectrumValue> CreateTxPsdOverActiveRbs (double powerTx,
-                                                      const std::vector <int>& activeRbs,
+                                                      const NrRbMask &activeRbs,
                                                       const Ptr<const SpectrumModel>& spectrumModel);
 
 
@@ -101,11 +102,11 @@ protected:
    * \brief Create SpectrumValue that will represent transmit power spectral density, and
    * the total transmit power will divided among all RBs, and then it will be assigned to active RBs
    * \param powerTx total power in dBm
-   * \param activeRbs vector of RBs that are active for this transmission
+   * \param activeRbs mask of RBs that are active for this transmission
    * \param spectrumModel spectrumModel to be used to create this SpectrumValue
    */
   static Ptr<SpectrumValue> CreateTxPsdOverAllRbs (double powerTx,
-                                                   const std::vector <int>& activeRbs,
+                                                   const NrRbMask &activeRbs,
                                                    const Ptr<const SpectrumModel>& spectrumModel);
 };
 
@@ -33,13 +33,17 @@ NS_LOG_COMPONENT_DEFINE ("BeamManager");
 NS_OBJECT_ENSURE_REGISTERED (BeamManager);
 
 BeamManager::BeamManager() {
-  // TODO Auto-generated constructor stub
+  // The first beam of the table is the quasi-omni beam, computed in
+  // ChangeToQuasiOmniBeamformingVector; it is never released
+  m_beams.emplace_back (complexVector_t (), OMNI_BEAM_ID);
+  m_beamRefs.push_back (1);
 }
 
 void
 BeamManager::Configure (const Ptr<UniformPlanarArray>& antennaArray)
 {
   m_antennaArray = antennaArray;
+  m_currentBeam = INVALID_BEAM_HANDLE;
   ChangeToQuasiOmniBeamformingVector ();
 }
 
@@ -75,6 +79,93 @@ BeamManager::GetTypeId (void)
   return tid;
 }
 
+size_t
+BeamManager::HashBeam (const BeamformingVector& bfv)
+{
+  size_t seed = BeamIdHash () (bfv.second);
+  std::hash<double> hasher;
+  for (const auto & w : bfv.first)
+    {
+      seed ^= hasher (w.real ()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      seed ^= hasher (w.imag ()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+  return seed;
+}
+
+BeamManager::BeamHandle
+BeamManager::InternBeam (const BeamformingVector& bfv)
+{
+  const size_t hash = HashBeam (bfv);
+  auto range = m_beamIndex.equal_range (hash);
+  for (auto it = range.first; it != range.second; ++it)
+    {
+      BeamHandle h = it->second;
+      if (m_beams.at (h).second == bfv.second && m_beams.at (h).first == bfv.first)
+        {
+          ++m_beamRefs.at (h);
+          return h;
+        }
+    }
+
+  BeamHandle h;
+  if (! m_freeBeams.empty ())
+    {
+      h = m_freeBeams.back ();
+      m_freeBeams.pop_back ();
+      m_beams.at (h) = bfv;
+    }
+  else
+    {
+      h = static_cast<BeamHandle> (m_beams.size ());
+      m_beams.push_back (bfv);
+      m_beamRefs.push_back (0);
+    }
+  m_beamRefs.at (h) = 1;
+  m_beamIndex.emplace (hash, h);
+  NS_LOG_INFO ("Beam " << bfv.second << " stored with handle " << h);
+  return h;
+}
+
+void
+BeamManager::ReleaseBeam (BeamHandle handle)
+{
+  if (handle == INVALID_BEAM_HANDLE || handle == OMNI_BEAM_HANDLE)
+    {
+      return;
+    }
+  NS_ASSERT (m_beamRefs.at (handle) > 0);
+  if (--m_beamRefs.at (handle) == 0)
+    {
+      auto range = m_beamIndex.equal_range (HashBeam (m_beams.at (handle)));
+      for (auto it = range.first; it != range.second; ++it)
+        {
+          if (it->second == handle)
+            {
+              m_beamIndex.erase (it);
+              break;
+            }
+        }
+      m_beams.at (handle).first.clear ();
+      m_freeBeams.push_back (handle);
+      if (m_currentBeam == handle)
+        {
+          // The position may be reused by a different beam, while the antenna
+          // still has the weights of this one
+          m_currentBeam = INVALID_BEAM_HANDLE;
+        }
+    }
+}
+
+void
+BeamManager::SetBeam (BeamHandle handle)
+{
+  NS_ASSERT (handle < m_beams.size () && m_beamRefs.at (handle) > 0);
+  if (handle != m_currentBeam)
+    {
+      m_antennaArray->SetBeamformingVector (m_beams.at (handle).first);
+      m_currentBeam = handle;
+    }
+}
 
 void
 BeamManager::SetPredefinedBeam (complexVector_t predefinedBeam)
@@ -82,14 +173,18 @@ BeamManager::SetPredefinedBeam (complexVector_t predefinedBeam)
   NS_LOG_FUNCTION (this);
   NS_ABORT_MSG_IF (predefinedBeam.size() == 0, "Cannot assign an empty predefined beam");
   NS_ABORT_MSG_IF (predefinedBeam.size() != m_antennaArray->GetNumberOfElements(), "Cannot assign a predefined beamforming vector whose dimension is not compatible with antenna array");
-  m_predefinedDirTxRxW = std::make_pair (predefinedBeam, PREDEFINED_BEAM_ID);
+  BeamHandle old = m_predefinedBeam;
+  m_predefinedBeam = InternBeam (std::make_pair (predefinedBeam, PREDEFINED_BEAM_ID));
+  ReleaseBeam (old);
 }
 
 void
 BeamManager::SetPredefinedBeam (uint16_t sector, double elevation)
 {
   NS_LOG_FUNCTION (this);
-  m_predefinedDirTxRxW = std::make_pair (CreateDirectionalBfv (m_antennaArray, sector, elevation), BeamId (sector, elevation));
+  BeamHandle old = m_predefinedBeam;
+  m_predefinedBeam = InternBeam (std::make_pair (CreateDirectionalBfv (m_antennaArray, sector, elevation), BeamId (sector, elevation)));
+  ReleaseBeam (old);
 }
 
 void
@@ -98,21 +193,24 @@ BeamManager::SaveBeamformingVector (const BeamformingVector& bfv,
 {
   NS_LOG_INFO ("Save beamforming vector toward device with node id:"<<device->GetNode()->GetId()<<" with BeamId:" << bfv.second);
 
-  if (m_predefinedDirTxRxW.first.size()!=0)
+  if (m_predefinedBeam != INVALID_BEAM_HANDLE)
     {
       NS_LOG_WARN ("Saving beamforming vector for device, while there is also a predefined beamforming vector defined to be used for all transmissions.");
     }
 
   if (device != nullptr)
     {
+      BeamHandle handle = InternBeam (bfv);
       BeamformingStorage::iterator iter = m_beamformingVectorMap.find (device);
       if (iter != m_beamformingVectorMap.end ())
         {
-          (*iter).second = bfv;
+          // Intern first: if the beam does not change, its handle is kept
+          ReleaseBeam ((*iter).second);
+          (*iter).second = handle;
         }
       else
         {
-          m_beamformingVectorMap.insert (std::make_pair (device, bfv));
+          m_beamformingVectorMap.insert (std::make_pair (device, handle));
         }
     }
 }
@@ -129,9 +227,9 @@ BeamManager::ChangeBeamformingVector (const Ptr<const NetDevice>& device)
 
       // if there is no beam defined for this specific device then use a 
       // predefined beam if specified and if not, then use quasi omni
-      if (m_predefinedDirTxRxW.first.size() != 0)
+      if (m_predefinedBeam != INVALID_BEAM_HANDLE)
         {
-          m_antennaArray->SetBeamformingVector (m_predefinedDirTxRxW.first);
+          SetBeam (m_predefinedBeam);
         }
       else
         {
@@ -141,7 +239,7 @@ BeamManager::ChangeBeamformingVector (const Ptr<const NetDevice>& device)
   else
     {
       NS_LOG_INFO ("Beamforming vector found");
-      m_antennaArray->SetBeamformingVector(it->second.first);
+      SetBeam (it->second);
     }
 }
 
@@ -151,11 +249,32 @@ BeamManager::GetCurrentBeamformingVector ()
   return m_antennaArray->GetBeamformingVector();
 }
 
+BeamManager::BeamHandle
+BeamManager::GetCurrentBeamHandle () const
+{
+  return m_currentBeam;
+}
+
+BeamManager::BeamHandle
+BeamManager::GetBeamHandle (const Ptr<const NetDevice>& device) const
+{
+  BeamformingStorage::const_iterator it = m_beamformingVectorMap.find (device);
+  return it != m_beamformingVectorMap.end () ? it->second : m_predefinedBeam;
+}
+
 void
 BeamManager::ChangeToQuasiOmniBeamformingVector ()
 {
   NS_LOG_FUNCTION (this);
 
+  // Fast path, the antenna is already quasi-omni: only check that the antenna
+  // size did not change since the vector was computed
+  if (m_currentBeam == OMNI_BEAM_HANDLE
+      && m_antennaArray->GetNumberOfElements () == m_numRows * m_numColumns)
+    {
+      return;
+    }
+
   UintegerValue numRows, numColumns;
   m_antennaArray->GetAttribute ("NumRows", numRows);
   m_antennaArray->GetAttribute ("NumColumns", numColumns);
@@ -171,10 +290,14 @@ BeamManager::ChangeToQuasiOmniBeamformingVector ()
     {
       m_numRows = numRows.Get();
       m_numColumns = numColumns.Get();
-      m_omniTxRxW = std::make_pair (CreateQuasiOmniBfv (m_numRows, m_numColumns), OMNI_BEAM_ID);
+      m_beams.at (OMNI_BEAM_HANDLE).first = CreateQuasiOmniBfv (m_numRows, m_numColumns);
+      if (m_currentBeam == OMNI_BEAM_HANDLE)
+        {
+          m_currentBeam = INVALID_BEAM_HANDLE;
+        }
     }
 
-  m_antennaArray->SetBeamformingVector(m_omniTxRxW.first);
+  SetBeam (OMNI_BEAM_HANDLE);
 }
 
 complexVector_t
@@ -185,15 +308,15 @@ BeamManager::GetBeamformingVector (const Ptr<NetDevice>& device) const
   BeamformingStorage::const_iterator it = m_beamformingVectorMap.find (device);
   if (it != m_beamformingVectorMap.end ())
     {
-      beamformingVector = it->second.first;
+      beamformingVector = m_beams.at (it->second).first;
     }
   else
     {
       // it there is no specific beam saved for this device, check
       // whether we have a predefined beam set, if yes return its vector
-      if (m_predefinedDirTxRxW.first.size() != 0)
+      if (m_predefinedBeam != INVALID_BEAM_HANDLE)
         {
-          beamformingVector = m_predefinedDirTxRxW.first;
+          beamformingVector = m_beams.at (m_predefinedBeam).first;
         }
       else
         {
@@ -210,15 +333,15 @@ BeamManager::GetBeamId (const Ptr<NetDevice>& device) const
   BeamformingStorage::const_iterator it = m_beamformingVectorMap.find (device);
   if (it != m_beamformingVectorMap.end ())
     {
-      beamId = it->second.second;
+      beamId = m_beams.at (it->second).second;
     }
   else
     {
       // it there is no specific beam saved for this device, check
       // whether we have a predefined beam set, if yes return its ID
-      if (m_predefinedDirTxRxW.first.size() != 0)
+      if (m_predefinedBeam != INVALID_BEAM_HANDLE)
         {
-          beamId = m_predefinedDirTxRxW.second;
+          beamId = m_beams.at (m_predefinedBeam).second;
         }
       else
         {
@@ -234,6 +357,7 @@ BeamManager::SetSector (uint16_t sector, double elevation) const
   NS_LOG_INFO ("Set sector to : " << (unsigned) sector <<
                ", and elevation to: " << elevation);
   m_antennaArray->SetBeamformingVector(CreateDirectionalBfv (m_antennaArray, sector, elevation));
+  m_currentBeam = INVALID_BEAM_HANDLE;
 }
 
 void
@@ -242,6 +366,15 @@ BeamManager::SetSectorAz (double azimuth, double zenith) const
   NS_LOG_INFO ("Set azimuth to : " << (unsigned) azimuth <<
                ", and zenith to:" << zenith);
   m_antennaArray->SetBeamformingVector(CreateDirectionalBfvAz (m_antennaArray, azimuth, zenith));
+  m_currentBeam = INVALID_BEAM_HANDLE;
+}
+
+void
+BeamManager::SetWeights (const complexVector_t &weights) const
+{
+  NS_LOG_FUNCTION (this);
+  m_antennaArray->SetBeamformingVector (weights);
+  m_currentBeam = INVALID_BEAM_HANDLE;
 }
 
 } /* namespace ns3 */
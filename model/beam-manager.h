@@ -24,6 +24,7 @@
 #include <ns3/nstime.h>
 #include <ns3/net-device.h>
 #include "beamforming-vector.h"
+#include <unordered_map>
 
 
 namespace ns3 {
@@ -40,6 +41,14 @@ class BeamformingHelperBase;
  * BeamManager is responsible of installation and configuration of antenna
  * array. Additionally, in the case of gNB it saves the map of beamforming
  * vectors per device.
+ *
+ * The beamforming vectors are stored once in a table of beams (the
+ * quasi-omni beam, the predefined beam, and the beams saved for the devices),
+ * and referenced by their position in the table, a BeamHandle. Two devices
+ * served with the same beam share the same handle. The antenna weights are
+ * written only when the beam to use is not the one already set in the
+ * antenna (GetCurrentBeamHandle()): changing many times per slot to the same
+ * beam (or to quasi-omni) does not copy the weights.
  */
 class BeamManager: public Object
 {
@@ -103,7 +112,11 @@ public:
   Ptr<const UniformPlanarArray> GetAntenna () const;
 
 
-  typedef std::map<const Ptr<const NetDevice>, BeamformingVector> BeamformingStorage; //!< BeamformingStorage type used to save the map of beamforming vectors per device
+  typedef uint32_t BeamHandle; //!< Position of a beam in the table of beams
+  static constexpr BeamHandle OMNI_BEAM_HANDLE = 0; //!< Handle of the quasi-omni beam
+  static constexpr BeamHandle INVALID_BEAM_HANDLE = UINT32_MAX; //!< No beam (or a beam not in the table)
+
+  typedef std::map<const Ptr<const NetDevice>, BeamHandle> BeamformingStorage; //!< BeamformingStorage type used to save the map of beam handles per device
 
   /**
    * \brief Function that saves the beamforming weights of the antenna
@@ -125,6 +138,24 @@ public:
    */
   virtual void ChangeToQuasiOmniBeamformingVector ();
 
+  /**
+   * \brief Get the handle of the beam currently set in the antenna
+   * \return the handle, or INVALID_BEAM_HANDLE if the antenna weights were
+   * set outside the table of beams (e.g., by SetSector())
+   *
+   * The handle of a beam does not change while a device uses it, so it can be
+   * used as a key to cache values that depend on the beam.
+   */
+  BeamHandle GetCurrentBeamHandle () const;
+
+  /**
+   * \brief Get the handle of the beam used to communicate with a device
+   * \param device the device
+   * \return the handle of the beam saved for the device, or of the
+   * predefined beam, or INVALID_BEAM_HANDLE if none of them is set
+   */
+  BeamHandle GetBeamHandle (const Ptr<const NetDevice>& device) const;
+
   /**
    * \brief Function that returns the beamforming vector that is currently being
    * used by the antenna.
@@ -161,14 +192,52 @@ public:
    */
   void SetSectorAz (double azimuth, double zenith) const;
 
+  /**
+   * \brief Set the weights of the antenna, as SetSector does, but from
+   * precomputed weights (e.g., of a NrBeamCodebook)
+   * \param weights the weights
+   */
+  void SetWeights (const complexVector_t &weights) const;
+
 private:
+  /**
+   * \brief Hash a beam, from its id and its weights
+   * \param bfv the beam
+   * \return the hash of the beam
+   */
+  static size_t HashBeam (const BeamformingVector& bfv);
+
+  /**
+   * \brief Store a beam in the table, or find it if already stored
+   * \param bfv the beam
+   * \return the handle of the beam, with one more reference
+   */
+  BeamHandle InternBeam (const BeamformingVector& bfv);
+
+  /**
+   * \brief Remove a reference to a beam of the table, freeing its
+   * position when it is not referenced anymore
+   * \param handle the handle of the beam
+   */
+  void ReleaseBeam (BeamHandle handle);
+
+  /**
+   * \brief Set the weights of a beam of the table in the antenna, if it is not
+   * the current one
+   * \param handle the handle of the beam
+   */
+  void SetBeam (BeamHandle handle);
 
   Ptr<UniformPlanarArray> m_antennaArray;  //!< the antenna array instance for which is responsible this BeamManager
   uint32_t m_numRows {0};//!< Number of rows of antenna array for which is calculated current quasi omni beamforming vector
   uint32_t m_numColumns {0}; //!< Number of columns of antenna array for which is calculated current quasi omni beamforming vector
-  BeamformingVector m_omniTxRxW; //!< Beamforming vector that emulates omnidirectional transmission and reception
-  BeamformingStorage m_beamformingVectorMap; //!< device to beamforming vector mapping
-  BeamformingVector m_predefinedDirTxRxW; //!< A predefined vector that is used for directional transmission and reception to any device
+  std::vector<BeamformingVector> m_beams; //!< Table of beams, the first one is the quasi-omni beam
+  std::vector<uint32_t> m_beamRefs; //!< Number of references to each beam of the table
+  std::vector<BeamHandle> m_freeBeams; //!< Positions of the table not used
+  std::unordered_multimap<size_t, BeamHandle> m_beamIndex; //!< Handles of the beams of the table (but the quasi-omni one) by HashBeam
+  mutable BeamHandle m_currentBeam {INVALID_BEAM_HANDLE}; //!< Beam set in the antenna (changed by the const SetSector)
+  BeamformingStorage m_beamformingVectorMap; //!< device to beam handle mapping
+  BeamHandle m_predefinedBeam {INVALID_BEAM_HANDLE}; //!< A predefined beam that is used for directional transmission and reception to any device
 
 };
 
@@ -125,11 +125,14 @@ complexVector_t CreateDirectPathBfv (const Ptr<MobilityModel>& a,
                                      const Ptr<MobilityModel>& b,
                                      const Ptr<const UniformPlanarArray>& antenna)
 {
-  complexVector_t antennaWeights;
-
   // retrieve the position of the two devices
-  Vector aPos = a->GetPosition ();
-  Vector bPos = b->GetPosition ();
+  return CreateDirectPathBfv (a->GetPosition (), b->GetPosition (), *antenna);
+}
+
+complexVector_t CreateDirectPathBfv (const Vector &aPos, const Vector &bPos,
+                                     const UniformPlanarArray &antenna)
+{
+  complexVector_t antennaWeights;
 
   // compute the azimuth and the elevation angles
   Angles completeAngle (bPos, aPos);
@@ -139,7 +142,7 @@ complexVector_t CreateDirectPathBfv (const Ptr<MobilityModel>& a,
   double vAngleRadian = completeAngle.GetInclination (); // the elevation angle
 
   // retrieve the number of antenna elements
-  int totNoArrayElements = antenna->GetNumberOfElements ();
+  int totNoArrayElements = antenna.GetNumberOfElements ();
 
   // the total power is divided equally among the antenna elements
   double power = 1 / sqrt (totNoArrayElements);
@@ -147,7 +150,7 @@ complexVector_t CreateDirectPathBfv (const Ptr<MobilityModel>& a,
   // compute the antenna weights
   for (int ind = 0; ind < totNoArrayElements; ind++)
     {
-      Vector loc = antenna->GetElementLocation (ind);
+      Vector loc = antenna.GetElementLocation (ind);
       double phase = -2 * M_PI * (sin (vAngleRadian) * cos (hAngleRadian) * loc.x
                                   + sin (vAngleRadian) * sin (hAngleRadian) * loc.y
                                   + cos (vAngleRadian) * loc.z);
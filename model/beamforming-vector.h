@@ -86,6 +86,21 @@ complexVector_t CreateDirectPathBfv(const Ptr<MobilityModel>& a,
                                     const Ptr<MobilityModel>& b,
                                     const Ptr<const UniformPlanarArray>& antenna);
 
+/**
+ * \brief Get the direct path beamforming vector of a device in position aPos,
+ * for the transmission toward a device in position bPos
+ * \ingroup utils
+ *
+ * It does not access the mobility models, so it can be used from any thread.
+ *
+ * \param [in] aPos position of the first device
+ * \param [in] bPos position of the second device
+ * \param [in] antenna antenna array of the first device
+ * \return the resulting beamforming vector for antenna array for the first device
+ */
+complexVector_t CreateDirectPathBfv (const Vector &aPos, const Vector &bPos,
+                                     const UniformPlanarArray &antenna);
+
 }
 
 #endif /* SRC_NR_MODEL_BEAMFORMING_VECTOR_H_ */
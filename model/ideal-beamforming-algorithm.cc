@@ -28,8 +28,12 @@
 #include "beam-manager.h"
 #include <ns3/nr-spectrum-value-helper.h>
 #include <ns3/uniform-planar-array.h>
+#include <ns3/enum.h>
+#include <ns3/three-gpp-spectrum-propagation-loss-model.h>
+#include <algorithm>
 #include "nr-ue-phy.h"
 #include "nr-gnb-phy.h"
+#include "nr-beam-codebook.h"
 #include "nr-gnb-net-device.h"
 #include "nr-ue-net-device.h"
 
@@ -52,6 +56,27 @@ IdealBeamformingAlgorithm::GetTypeId (void)
   return tid;
 }
 
+Ptr<const BeamSearchInput>
+IdealBeamformingAlgorithm::GetBeamSearchInput ([[maybe_unused]] const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                               [[maybe_unused]] const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+{
+  return nullptr;
+}
+
+BeamformingVectorPair
+IdealBeamformingAlgorithm::ComputeBeamformingVectors ([[maybe_unused]] const BeamSearchInput &input) const
+{
+  NS_FATAL_ERROR ("The algorithm " << GetInstanceTypeId () << " does not support "
+                  "the computation from a beam search input");
+  return BeamformingVectorPair ();
+}
+
+bool
+IdealBeamformingAlgorithm::DependsOnChannel () const
+{
+  return true;
+}
+
 TypeId
 CellScanBeamforming::GetTypeId (void)
 {
@@ -63,11 +88,36 @@ CellScanBeamforming::GetTypeId (void)
                                     DoubleValue (30),
                                     MakeDoubleAccessor (&CellScanBeamforming::SetBeamSearchAngleStep,
                                                         &CellScanBeamforming::GetBeamSearchAngleStep),
-                                    MakeDoubleChecker<double> ());
+                                    MakeDoubleChecker<double> ())
+                     .AddAttribute ("BeamSearchMethod",
+                                    "How the pairs of beams are evaluated: ChannelScan applies "
+                                    "each pair to the antennas and computes the average received "
+                                    "PSD with the spectrum propagation loss model; LongTermMatrix "
+                                    "computes the power of the long term component of the channel "
+                                    "matrix, summed over the clusters, for all the pairs at once "
+                                    "(faster, and it can run in parallel, see the "
+                                    "IdealBeamformingHelper attribute NumThreads)",
+                                    EnumValue (CellScanBeamforming::CHANNEL_SCAN),
+                                    MakeEnumAccessor (&CellScanBeamforming::SetBeamSearchMethod,
+                                                      &CellScanBeamforming::GetBeamSearchMethod),
+                                    MakeEnumChecker (CellScanBeamforming::CHANNEL_SCAN, "ChannelScan",
+                                                     CellScanBeamforming::LONG_TERM_MATRIX, "LongTermMatrix"));
 
   return tid;
 }
 
+void
+CellScanBeamforming::SetBeamSearchMethod (BeamSearchMethod method)
+{
+  m_beamSearchMethod = method;
+}
+
+CellScanBeamforming::BeamSearchMethod
+CellScanBeamforming::GetBeamSearchMethod () const
+{
+  return m_beamSearchMethod;
+}
+
 void
 CellScanBeamforming::SetBeamSearchAngleStep (double beamSearchAngleStep)
 {
@@ -83,6 +133,136 @@ CellScanBeamforming::GetBeamSearchAngleStep () const
 BeamformingVectorPair
 CellScanBeamforming::GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
                                             const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+{
+  if (m_beamSearchMethod == CHANNEL_SCAN)
+    {
+      return ScanBeamformingVectors (gnbSpectrumPhy, ueSpectrumPhy);
+    }
+
+  BeamformingVectorPair bfPair = ComputeBeamformingVectors (*GetBeamSearchInput (gnbSpectrumPhy, ueSpectrumPhy));
+
+  NS_LOG_DEBUG ("Beamforming vectors for gNB with node id: "<< gnbSpectrumPhy->GetMobility()->GetObject<Node>()->GetId () <<
+                " and UE with node id: " << ueSpectrumPhy->GetMobility()->GetObject<Node>()->GetId () <<
+                " are gNB beam " << bfPair.first.second << " UE beam " << bfPair.second.second);
+
+  return bfPair;
+}
+
+Ptr<const BeamSearchInput>
+CellScanBeamforming::GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                         const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_beamSearchMethod == CHANNEL_SCAN)
+    {
+      return nullptr;
+    }
+
+  NS_ABORT_MSG_IF (gnbSpectrumPhy == nullptr || ueSpectrumPhy == nullptr, "Something went wrong, gnb or UE PHY layer not set.");
+  double distance = gnbSpectrumPhy->GetMobility ()->GetDistanceFrom (ueSpectrumPhy->GetMobility());
+  NS_ABORT_MSG_IF (distance == 0, "Beamforming method cannot be performed between two devices that are placed in the same position.");
+
+  Ptr<const PhasedArraySpectrumPropagationLossModel> spectrumPropModel = gnbSpectrumPhy->GetSpectrumChannel ()->GetPhasedArraySpectrumPropagationLossModel ();
+  NS_ASSERT_MSG (spectrumPropModel == ueSpectrumPhy->GetSpectrumChannel ()->GetPhasedArraySpectrumPropagationLossModel (),
+                 "Devices should be connected on the same spectrum channel");
+  Ptr<const ThreeGppSpectrumPropagationLossModel> threeGppSplm = DynamicCast<const ThreeGppSpectrumPropagationLossModel> (spectrumPropModel);
+  NS_ABORT_MSG_IF (threeGppSplm == nullptr, "The LongTermMatrix beam search needs the 3GPP spectrum propagation loss model");
+
+  Ptr<const PhasedArrayModel> gnbArray = gnbSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel> ();
+  Ptr<const PhasedArrayModel> ueArray = ueSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel> ();
+  NS_ASSERT (gnbArray->GetNumberOfElements () && ueArray->GetNumberOfElements ());
+
+  Ptr<Input> input = Create<Input> ();
+  // the channel is generated (or updated) here, as CalcRxPowerSpectralDensity
+  // would do at the first pair of beams of the scan
+  input->m_channelMatrix = threeGppSplm->GetChannelModel ()->GetChannel (gnbSpectrumPhy->GetMobility (),
+                                                                         ueSpectrumPhy->GetMobility (),
+                                                                         gnbArray, ueArray);
+  input->m_ueIsU = ! input->m_channelMatrix->IsReverse (gnbArray->GetId (), ueArray->GetId ());
+  // the same beams as the scan, with the UE elevations truncated to integer degrees
+  input->m_gnbCodebook = NrBeamCodebook::GetSectorCodebook (gnbSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> (),
+                                                            NrBeamCodebook::GetCellScanElevations (m_beamSearchAngleStep));
+  input->m_ueCodebook = NrBeamCodebook::GetSectorCodebook (ueSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> (),
+                                                           NrBeamCodebook::GetCellScanUeElevations (m_beamSearchAngleStep));
+
+  return input;
+}
+
+BeamformingVectorPair
+CellScanBeamforming::ComputeBeamformingVectors (const BeamSearchInput &input) const
+{
+  const Input &in = dynamic_cast<const Input &> (input);
+  const auto &h = in.m_channelMatrix->m_channel; // [u][s][cluster]
+
+  const NrBeamCodebook &gnbCodebook = *in.m_gnbCodebook;
+  const NrBeamCodebook &ueCodebook = *in.m_ueCodebook;
+  NS_ASSERT (gnbCodebook.GetNumBeams () && ueCodebook.GetNumBeams ());
+  size_t numUeElems = in.m_ueIsU ? h.size () : h.at (0).size ();
+  size_t numGnbElems = in.m_ueIsU ? h.at (0).size () : h.size ();
+  size_t numClusters = h.at (0).at (0).size ();
+  NS_ASSERT (ueCodebook.GetNumElements () == numUeElems);
+  NS_ASSERT (gnbCodebook.GetNumElements () == numGnbElems);
+
+  size_t numUeBeams = ueCodebook.GetNumBeams ();
+  std::vector<double> power (gnbCodebook.GetNumBeams () * numUeBeams, 0.0);
+  // projection of the channel on a UE beam, per cluster and gNB element
+  std::vector<std::complex<double>> proj (numClusters * numGnbElems);
+
+  for (size_t r = 0; r < numUeBeams; ++r)
+    {
+      const std::complex<double> *ueW = ueCodebook.GetWeights (r);
+      std::fill (proj.begin (), proj.end (), std::complex<double> (0.0, 0.0));
+      for (size_t e = 0; e < numUeElems; ++e)
+        {
+          for (size_t g = 0; g < numGnbElems; ++g)
+            {
+              const auto &clusters = in.m_ueIsU ? h[e][g] : h[g][e];
+              std::complex<double> *p = &proj[g];
+              for (size_t c = 0; c < numClusters; ++c)
+                {
+                  p[c * numGnbElems] += ueW[e] * clusters[c];
+                }
+            }
+        }
+
+      for (size_t t = 0; t < gnbCodebook.GetNumBeams (); ++t)
+        {
+          const std::complex<double> *gnbW = gnbCodebook.GetWeights (t);
+          double sum = 0.0;
+          for (size_t c = 0; c < numClusters; ++c)
+            {
+              const std::complex<double> *p = &proj[c * numGnbElems];
+              std::complex<double> longTerm (0.0, 0.0);
+              for (size_t g = 0; g < numGnbElems; ++g)
+                {
+                  longTerm += gnbW[g] * p[g];
+                }
+              sum += std::norm (longTerm);
+            }
+          power[t * numUeBeams + r] = sum;
+        }
+    }
+
+  // same order, and same tie-breaking, as the scan
+  double max = 0;
+  size_t maxTx = 0, maxRx = 0;
+  for (size_t i = 0; i < power.size (); ++i)
+    {
+      if (max < power[i])
+        {
+          max = power[i];
+          maxTx = i / numUeBeams;
+          maxRx = i % numUeBeams;
+        }
+    }
+
+  return BeamformingVectorPair (std::make_pair (gnbCodebook.GetBeamformingVector (maxTx),
+                                                ueCodebook.GetBeamformingVector (maxRx)));
+}
+
+BeamformingVectorPair
+CellScanBeamforming::ScanBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                             const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
 {
   NS_ABORT_MSG_IF (gnbSpectrumPhy == nullptr || ueSpectrumPhy == nullptr, "Something went wrong, gnb or UE PHY layer not set.");
   double distance = gnbSpectrumPhy->GetMobility ()->GetDistanceFrom (ueSpectrumPhy->GetMobility());
@@ -95,95 +275,59 @@ CellScanBeamforming::GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectru
   Ptr<const PhasedArraySpectrumPropagationLossModel> ueThreeGppSpectrumPropModel = ueSpectrumChannel->GetPhasedArraySpectrumPropagationLossModel ();
   NS_ASSERT_MSG (gnbThreeGppSpectrumPropModel == ueThreeGppSpectrumPropModel, "Devices should be connected on the same spectrum channel");
 
-  std::vector<int> activeRbs;
-  for (size_t rbId = 0; rbId < gnbSpectrumPhy->GetRxSpectrumModel ()->GetNumBands(); rbId++)
-    {
-      activeRbs.push_back(rbId);
-    }
+  NrRbMask activeRbs (gnbSpectrumPhy->GetRxSpectrumModel ()->GetNumBands (), true);
 
   Ptr<const SpectrumValue> fakePsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity (0.0, activeRbs, gnbSpectrumPhy->GetRxSpectrumModel (),
                                                                                           NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_BW);
 
-  double max = 0, maxTxTheta = 0, maxRxTheta = 0;
-  uint16_t maxTxSector = 0, maxRxSector = 0;
-  complexVector_t  maxTxW, maxRxW;
-
-  UintegerValue uintValue;
-  gnbSpectrumPhy->GetAntenna ()->GetAttribute ("NumRows", uintValue);
-  uint32_t txNumRows = static_cast<uint32_t> (uintValue.Get ());
-  ueSpectrumPhy->GetAntenna ()->GetAttribute ("NumRows", uintValue);
-  uint32_t rxNumRows = static_cast<uint32_t> (uintValue.Get ());
-
-  NS_ASSERT (gnbSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel> ()->GetNumberOfElements() && ueSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel> ()->GetNumberOfElements());
+  Ptr<BeamManager> gnbBeamManager = gnbSpectrumPhy->GetBeamManager ();
+  Ptr<BeamManager> ueBeamManager = ueSpectrumPhy->GetBeamManager ();
 
-  for (double txTheta = 60; txTheta < 121; txTheta = txTheta + m_beamSearchAngleStep)
-    {
-      for (uint16_t txSector = 0; txSector <= txNumRows; txSector++)
-        {
-          NS_ASSERT(txSector < UINT16_MAX);
+  Ptr<const NrBeamCodebook> txCodebook = NrBeamCodebook::GetSectorCodebook (gnbSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> (),
+                                                                            NrBeamCodebook::GetCellScanElevations (m_beamSearchAngleStep));
+  Ptr<const NrBeamCodebook> rxCodebook = NrBeamCodebook::GetSectorCodebook (ueSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> (),
+                                                                            NrBeamCodebook::GetCellScanUeElevations (m_beamSearchAngleStep));
 
-          gnbSpectrumPhy->GetBeamManager ()->SetSector (txSector, txTheta);
-          complexVector_t txW = gnbSpectrumPhy->GetBeamManager ()->GetCurrentBeamformingVector ();
+  NS_ASSERT (txCodebook->GetNumElements () && rxCodebook->GetNumElements ());
 
-          if (maxTxW.size () == 0)
-            {
-              maxTxW = txW; // initialize maxTxW
-            }
+  double max = 0;
+  size_t maxTx = 0, maxRx = 0;
 
-          for (double rxTheta = 60; rxTheta < 121; rxTheta = static_cast<uint16_t> (rxTheta + m_beamSearchAngleStep))
-            {
-              for (uint16_t rxSector = 0; rxSector <= rxNumRows; rxSector++)
-                {
-                  NS_ASSERT(rxSector < UINT16_MAX);
-
-                  ueSpectrumPhy->GetBeamManager ()->SetSector (rxSector, rxTheta);
-                  complexVector_t rxW = ueSpectrumPhy->GetBeamManager ()->GetCurrentBeamformingVector ();
+  for (size_t tx = 0; tx < txCodebook->GetNumBeams (); tx++)
+    {
+      gnbBeamManager->SetWeights (txCodebook->GetBeamformingVector (tx).first);
 
-                  if (maxRxW.size () == 0)
-                    {
-                      maxRxW = rxW; // initialize maxRxW
-                    }
+      for (size_t rx = 0; rx < rxCodebook->GetNumBeams (); rx++)
+        {
+          ueBeamManager->SetWeights (rxCodebook->GetBeamformingVector (rx).first);
 
-                  NS_ABORT_MSG_IF (txW.size()==0 || rxW.size()==0, "Beamforming vectors must be initialized in order to calculate the long term matrix.");
+          Ptr<SpectrumValue> rxPsd = gnbThreeGppSpectrumPropModel->CalcRxPowerSpectralDensity (fakePsd,
+                                                                                               gnbSpectrumPhy->GetMobility (),
+                                                                                               ueSpectrumPhy->GetMobility (),
+                                                                                               gnbSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel>(),
+                                                                                               ueSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel>());
 
-                  Ptr<SpectrumValue> rxPsd = gnbThreeGppSpectrumPropModel->CalcRxPowerSpectralDensity (fakePsd,
-                                                                                                       gnbSpectrumPhy->GetMobility (),
-                                                                                                       ueSpectrumPhy->GetMobility (),
-                                                                                                       gnbSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel>(),
-                                                                                                       ueSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel>());
+          size_t nbands = rxPsd->GetSpectrumModel ()->GetNumBands ();
+          double power = Sum (*rxPsd) / nbands;
 
-                  size_t nbands = rxPsd->GetSpectrumModel ()->GetNumBands ();
-                  double power = Sum (*rxPsd) / nbands;
-                  
-                  NS_LOG_LOGIC (" Rx power: "<< power << "txTheta " << txTheta << " rxTheta " << rxTheta << " tx sector " <<
-                                (M_PI *  static_cast<double> (txSector) / static_cast<double> (txNumRows) - 0.5 * M_PI) / (M_PI) * 180 << " rx sector " <<
-                                (M_PI * static_cast<double> (rxSector) / static_cast<double> (rxNumRows) - 0.5 * M_PI) / (M_PI) * 180);
+          NS_LOG_LOGIC (" Rx power: "<< power << " tx beam " << txCodebook->GetBeamId (tx) <<
+                        " rx beam " << rxCodebook->GetBeamId (rx));
 
-                  if (max < power)
-                    {
-                      max = power;
-                      maxTxSector = txSector;
-                      maxRxSector = rxSector;
-                      maxTxTheta = txTheta;
-                      maxRxTheta = rxTheta;
-                      maxTxW = txW;
-                      maxRxW = rxW;
-                    }
-                }
+          if (max < power)
+            {
+              max = power;
+              maxTx = tx;
+              maxRx = rx;
             }
         }
     }
 
-  BeamformingVector gnbBfv = BeamformingVector (std::make_pair(maxTxW, BeamId (maxTxSector, maxTxTheta)));
-  BeamformingVector ueBfv = BeamformingVector (std::make_pair (maxRxW, BeamId (maxRxSector, maxRxTheta)));
+  BeamformingVector gnbBfv = txCodebook->GetBeamformingVector (maxTx);
+  BeamformingVector ueBfv = rxCodebook->GetBeamformingVector (maxRx);
 
   NS_LOG_DEBUG ("Beamforming vectors for gNB with node id: "<< gnbSpectrumPhy->GetMobility()->GetObject<Node>()->GetId () <<
                 " and UE with node id: " << ueSpectrumPhy->GetMobility()->GetObject<Node>()->GetId () <<
-                " are txTheta " << maxTxTheta << " rxTheta " << maxRxTheta <<
-                " tx sector " << (M_PI * static_cast<double> (maxTxSector) / static_cast<double> (txNumRows) - 0.5 * M_PI) / (M_PI) * 180 <<
-                " rx sector " << (M_PI * static_cast<double> (maxRxSector) / static_cast<double> (rxNumRows) - 0.5 * M_PI) / (M_PI) * 180);
-
-  NS_ASSERT (maxTxW.size () && maxRxW.size ());
+                " are gNB beam " << gnbBfv.second << " UE beam " << ueBfv.second);
 
   return BeamformingVectorPair (std::make_pair (gnbBfv, ueBfv));
 }
@@ -216,11 +360,7 @@ CellScanBeamformingAzimuthZenith::GetBeamformingVectors (const Ptr<NrSpectrumPhy
   NS_ASSERT_MSG (gnbThreeGppSpectrumPropModel == ueThreeGppSpectrumPropModel,
                  "Devices should be connected on the same spectrum channel");
 
-  std::vector<int> activeRbs;
-  for (size_t rbId = 0; rbId < gnbSpectrumPhy->GetRxSpectrumModel ()->GetNumBands (); rbId++)
-    {
-      activeRbs.push_back (rbId);
-    }
+  NrRbMask activeRbs (gnbSpectrumPhy->GetRxSpectrumModel ()->GetNumBands (), true);
 
   Ptr<const SpectrumValue> fakePsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity (0.0, activeRbs, gnbSpectrumPhy->GetRxSpectrumModel (),
                                                                                           NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_BW);
@@ -350,68 +490,51 @@ CellScanQuasiOmniBeamforming::GetBeamformingVectors (const Ptr<NrSpectrumPhy>& g
   Ptr<const PhasedArraySpectrumPropagationLossModel> rxThreeGppSpectrumPropModel = ueSpectrumPhy->GetSpectrumChannel ()->GetPhasedArraySpectrumPropagationLossModel ();
   NS_ASSERT_MSG (txThreeGppSpectrumPropModel == rxThreeGppSpectrumPropModel, "Devices should be connected to the same spectrum channel");
 
-  std::vector<int> activeRbs;
-  for (size_t rbId = 0; rbId < gnbSpectrumPhy->GetRxSpectrumModel ()->GetNumBands(); rbId++)
-    {
-      activeRbs.push_back(rbId);
-    }
+  NrRbMask activeRbs (gnbSpectrumPhy->GetRxSpectrumModel ()->GetNumBands (), true);
 
   Ptr<const SpectrumValue> fakePsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity (0.0, activeRbs, gnbSpectrumPhy->GetRxSpectrumModel (),
                                                                                           NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_BW);
 
-  double max = 0, maxTxTheta = 0;
-  uint16_t maxTxSector = 0;
-  complexVector_t maxTxW;
-
-  UintegerValue uintValue;
-  gnbSpectrumPhy->GetAntenna ()->GetAttribute("NumRows", uintValue);
-  uint32_t txNumRows = static_cast<uint32_t> (uintValue.Get ());
-
   ueSpectrumPhy->GetBeamManager ()->ChangeToQuasiOmniBeamformingVector (); // we have to set it inmediatelly to q-omni so that we can perform calculations when calling spectrum model above
 
   complexVector_t rxW = ueSpectrumPhy->GetBeamManager ()->GetCurrentBeamformingVector ();
   BeamformingVector ueBfv = std::make_pair (rxW, OMNI_BEAM_ID);
+  NS_ABORT_MSG_IF (rxW.size () == 0, "Beamforming vectors must be initialized in order to calculate the long term matrix.");
 
-  for (double txTheta = 60; txTheta < 121; txTheta = txTheta + m_beamSearchAngleStep)
-    {
-      for (uint16_t txSector = 0; txSector <= txNumRows; txSector++)
-        {
-          NS_ASSERT(txSector < UINT16_MAX);
+  Ptr<const NrBeamCodebook> txCodebook = NrBeamCodebook::GetSectorCodebook (gnbSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> (),
+                                                                            NrBeamCodebook::GetCellScanElevations (m_beamSearchAngleStep));
+  Ptr<BeamManager> gnbBeamManager = gnbSpectrumPhy->GetBeamManager ();
 
-          gnbSpectrumPhy->GetBeamManager ()->SetSector (txSector, txTheta);
-          complexVector_t txW = gnbSpectrumPhy->GetBeamManager ()->GetCurrentBeamformingVector ();
+  double max = 0;
+  size_t maxTx = 0;
 
-          NS_ABORT_MSG_IF (txW.size ()== 0 || rxW.size ()== 0,
-                           "Beamforming vectors must be initialized in order to calculate the long term matrix.");
-          Ptr<SpectrumValue> rxPsd = txThreeGppSpectrumPropModel->CalcRxPowerSpectralDensity (fakePsd,
-                                                                                              gnbSpectrumPhy ->GetMobility (),
-                                                                                              ueSpectrumPhy ->GetMobility(),
-                                                                                              gnbSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel>(),
-                                                                                              ueSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel>());
+  for (size_t tx = 0; tx < txCodebook->GetNumBeams (); tx++)
+    {
+      gnbBeamManager->SetWeights (txCodebook->GetBeamformingVector (tx).first);
 
-          size_t nbands = rxPsd->GetSpectrumModel ()->GetNumBands ();
-          double power = Sum (*rxPsd) / nbands;
+      Ptr<SpectrumValue> rxPsd = txThreeGppSpectrumPropModel->CalcRxPowerSpectralDensity (fakePsd,
+                                                                                          gnbSpectrumPhy ->GetMobility (),
+                                                                                          ueSpectrumPhy ->GetMobility(),
+                                                                                          gnbSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel>(),
+                                                                                          ueSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel>());
 
-          NS_LOG_LOGIC (" Rx power: "<< power << "txTheta " << txTheta  << " tx sector " <<
-                        (M_PI *  static_cast<double> (txSector) / static_cast<double>(txNumRows) - 0.5 * M_PI) / (M_PI) * 180);
+      size_t nbands = rxPsd->GetSpectrumModel ()->GetNumBands ();
+      double power = Sum (*rxPsd) / nbands;
 
-          if (max < power)
-             {
-                max = power;
-                maxTxSector = txSector;
-                maxTxTheta = txTheta;
-                maxTxW = txW;
-             }
+      NS_LOG_LOGIC (" Rx power: "<< power << " tx beam " << txCodebook->GetBeamId (tx));
 
-        }
+      if (max < power)
+         {
+            max = power;
+            maxTx = tx;
+         }
     }
 
-  BeamformingVector gnbBfv = BeamformingVector (std::make_pair(maxTxW, BeamId (maxTxSector, maxTxTheta)));
+  BeamformingVector gnbBfv = txCodebook->GetBeamformingVector (maxTx);
 
   NS_LOG_DEBUG ("Beamforming vectors for gNB with node id: "<< gnbSpectrumPhy->GetMobility()->GetObject<Node>()->GetId () <<
                 " and UE with node id: " << ueSpectrumPhy->GetMobility()->GetObject<Node>()->GetId () <<
-                " are txTheta " << maxTxTheta << " tx sector " <<
-                (M_PI * static_cast<double> (maxTxSector) / static_cast<double> (txNumRows) - 0.5 * M_PI) / (M_PI) * 180);
+                " are gNB beam " << gnbBfv.second);
 
   return BeamformingVectorPair (std::make_pair (gnbBfv, ueBfv));
 }
@@ -432,20 +555,42 @@ DirectPathBeamforming::GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpect
                                               const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
 {
   NS_LOG_FUNCTION (this);
+  return ComputeBeamformingVectors (*GetBeamSearchInput (gnbSpectrumPhy, ueSpectrumPhy));
+}
+
+Ptr<const BeamSearchInput>
+DirectPathBeamforming::GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                           const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+{
+  NS_LOG_FUNCTION (this);
+  return CreateInput (gnbSpectrumPhy, ueSpectrumPhy);
+}
 
-  Ptr<const UniformPlanarArray> gnbAntenna = gnbSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> ();
-  Ptr<const UniformPlanarArray> ueAntenna = ueSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> ();
+Ptr<DirectPathBeamforming::Input>
+DirectPathBeamforming::CreateInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                    const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+{
+  Ptr<Input> input = Create<Input> ();
+  input->m_gnbPosition = gnbSpectrumPhy->GetMobility ()->GetPosition ();
+  input->m_uePosition = ueSpectrumPhy->GetMobility ()->GetPosition ();
+  input->m_gnbAntenna = gnbSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> ();
+  input->m_ueAntenna = ueSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> ();
+  return input;
+}
+
+BeamformingVectorPair
+DirectPathBeamforming::ComputeBeamformingVectors (const BeamSearchInput &input) const
+{
+  const Input &in = dynamic_cast<const Input &> (input);
 
-  complexVector_t gNbAntennaWeights = CreateDirectPathBfv (gnbSpectrumPhy->GetMobility (),
-                                                           ueSpectrumPhy->GetMobility (),
-                                                           gnbAntenna);
+  complexVector_t gNbAntennaWeights = CreateDirectPathBfv (in.m_gnbPosition, in.m_uePosition,
+                                                           *in.m_gnbAntenna);
   // store the antenna weights
   BeamformingVector gnbBfv = BeamformingVector (std::make_pair (gNbAntennaWeights, BeamId::GetEmptyBeamId ()));
 
 
-  complexVector_t ueAntennaWeights = CreateDirectPathBfv (ueSpectrumPhy->GetMobility (),
-                                                          gnbSpectrumPhy->GetMobility (),
-                                                          ueAntenna);
+  complexVector_t ueAntennaWeights = CreateDirectPathBfv (in.m_uePosition, in.m_gnbPosition,
+                                                          *in.m_ueAntenna);
   // store the antenna weights
   BeamformingVector ueBfv = BeamformingVector (std::make_pair(ueAntennaWeights, BeamId::GetEmptyBeamId ()));
 
@@ -453,6 +598,12 @@ DirectPathBeamforming::GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpect
 
 }
 
+bool
+DirectPathBeamforming::DependsOnChannel () const
+{
+  return false;
+}
+
 TypeId
 QuasiOmniDirectPathBeamforming::GetTypeId (void)
 {
@@ -463,24 +614,27 @@ QuasiOmniDirectPathBeamforming::GetTypeId (void)
 }
 
 
-BeamformingVectorPair
-QuasiOmniDirectPathBeamforming::GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
-                                                       const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+Ptr<const BeamSearchInput>
+QuasiOmniDirectPathBeamforming::GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                    const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
 {
   NS_LOG_FUNCTION (this);
-  Ptr<const UniformPlanarArray> gnbAntenna = gnbSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> ();
-  Ptr<const UniformPlanarArray> ueAntenna = ueSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> ();
+  Ptr<Input> input = CreateInput (gnbSpectrumPhy, ueSpectrumPhy);
+  input->m_gnbQuasiOmni = NrBeamCodebook::GetQuasiOmniCodebook (input->m_gnbAntenna);
+  return input;
+}
+
+BeamformingVectorPair
+QuasiOmniDirectPathBeamforming::ComputeBeamformingVectors (const BeamSearchInput &input) const
+{
+  const Input &in = dynamic_cast<const Input &> (input);
 
   // configure gNb beamforming vector to be quasi omni
-  UintegerValue numRows, numColumns;
-  gnbAntenna->GetAttribute ("NumRows", numRows);
-  gnbAntenna->GetAttribute ("NumColumns", numColumns);
-  BeamformingVector gnbBfv = std::make_pair (CreateQuasiOmniBfv (numRows.Get (), numColumns.Get ()), OMNI_BEAM_ID);
+  BeamformingVector gnbBfv = in.m_gnbQuasiOmni->GetBeamformingVector (0);
 
   //configure UE beamforming vector to be directed towards gNB
-  complexVector_t ueAntennaWeights = CreateDirectPathBfv (ueSpectrumPhy->GetMobility (),
-                                                          gnbSpectrumPhy->GetMobility (),
-                                                          ueAntenna);
+  complexVector_t ueAntennaWeights = CreateDirectPathBfv (in.m_uePosition, in.m_gnbPosition,
+                                                          *in.m_ueAntenna);
   // store the antenna weights
   BeamformingVector ueBfv = BeamformingVector (std::make_pair (ueAntennaWeights, BeamId::GetEmptyBeamId ()));
 
@@ -497,24 +651,27 @@ DirectPathQuasiOmniBeamforming::GetTypeId (void)
 }
 
 
-BeamformingVectorPair
-DirectPathQuasiOmniBeamforming::GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
-                                                       const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+Ptr<const BeamSearchInput>
+DirectPathQuasiOmniBeamforming::GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                    const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
 {
   NS_LOG_FUNCTION (this);
-  Ptr<const UniformPlanarArray> gnbAntenna = gnbSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> ();
-  Ptr<const UniformPlanarArray> ueAntenna = ueSpectrumPhy->GetAntenna ()->GetObject <UniformPlanarArray> ();
+  Ptr<Input> input = CreateInput (gnbSpectrumPhy, ueSpectrumPhy);
+  input->m_ueQuasiOmni = NrBeamCodebook::GetQuasiOmniCodebook (input->m_ueAntenna);
+  return input;
+}
+
+BeamformingVectorPair
+DirectPathQuasiOmniBeamforming::ComputeBeamformingVectors (const BeamSearchInput &input) const
+{
+  const Input &in = dynamic_cast<const Input &> (input);
 
   // configure ue beamforming vector to be quasi omni
-  UintegerValue numRows, numColumns;
-  ueAntenna->GetAttribute ("NumRows", numRows);
-  ueAntenna->GetAttribute ("NumColumns", numColumns);
-  BeamformingVector ueBfv = std::make_pair (CreateQuasiOmniBfv (numRows.Get (), numColumns.Get ()), OMNI_BEAM_ID);
+  BeamformingVector ueBfv = in.m_ueQuasiOmni->GetBeamformingVector (0);
 
   //configure gNB beamforming vector to be directed towards UE
-  complexVector_t gnbAntennaWeights = CreateDirectPathBfv (gnbSpectrumPhy->GetMobility (),
-                                                           ueSpectrumPhy->GetMobility (),
-                                                           gnbAntenna);
+  complexVector_t gnbAntennaWeights = CreateDirectPathBfv (in.m_gnbPosition, in.m_uePosition,
+                                                           *in.m_gnbAntenna);
   // store the antenna weights
   BeamformingVector gnbBfv = BeamformingVector (std::make_pair (gnbAntennaWeights, BeamId::GetEmptyBeamId ()));
 
@@ -21,8 +21,12 @@
 #define SRC_NR_MODEL_IDEAL_BEAMFORMING_ALGORITHM_H_
 
 #include <ns3/object.h>
+#include <ns3/simple-ref-count.h>
+#include <ns3/vector.h>
+#include <ns3/matrix-based-channel-model.h>
 #include "beam-id.h"
 #include "beamforming-vector.h"
+#include "nr-beam-codebook.h"
 
 namespace ns3 {
 
@@ -32,6 +36,23 @@ class NrGnbNetDevice;
 class NrUeNetDevice;
 class NrSpectrumPhy;
 
+/**
+ * \ingroup gnb-phy
+ * \brief What an ideal beamforming algorithm needs to compute the beams of
+ * a pair of devices, read from the simulation
+ *
+ * Each algorithm that supports the parallel computation of the beams defines
+ * its own input, see IdealBeamformingAlgorithm::GetBeamSearchInput.
+ */
+class BeamSearchInput : public SimpleRefCount<BeamSearchInput>
+{
+public:
+  /**
+   * \brief ~BeamSearchInput
+   */
+  virtual ~BeamSearchInput () = default;
+};
+
 /**
  * \ingroup gnb-phy
  * \brief Generate "Ideal" beamforming vectors
@@ -59,6 +80,48 @@ public:
    */
   virtual BeamformingVectorPair GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
                                                        const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const = 0;
+
+  /**
+   * \brief Read from the simulation what is needed to compute the beams of a
+   * pair of devices
+   *
+   * The beams can then be computed with ComputeBeamformingVectors, which does
+   * not access the simulation objects, and can therefore run in parallel for
+   * many pairs (see the IdealBeamformingHelper attribute NumThreads).
+   * It is called from the main thread. The default implementation returns
+   * nullptr, i.e., the algorithm does not support it, and the beams have to be
+   * computed with GetBeamformingVectors.
+   *
+   * \param [in] gnbSpectrumPhy gNb spectrum phy instance
+   * \param [in] ueSpectrumPhy UE spectrum phy instance
+   * \return the input of ComputeBeamformingVectors, or nullptr
+   */
+  virtual Ptr<const BeamSearchInput> GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                         const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const;
+
+  /**
+   * \brief Compute the beamforming vectors of a pair of devices from the
+   * input returned by GetBeamSearchInput
+   *
+   * It can be called at the same time from different threads, for different
+   * inputs. The default implementation aborts.
+   *
+   * \param [in] input the input of the pair
+   * \return the beamforming vector pair of the gNB and the UE
+   */
+  virtual BeamformingVectorPair ComputeBeamformingVectors (const BeamSearchInput &input) const;
+
+  /**
+   * \brief Tell if the beams depend on the channel matrix of the pair
+   *
+   * If not, the beams depend only on the positions and on the antenna arrays
+   * of the devices, and the IdealBeamformingHelper does not check the channel
+   * to decide if the beams of a pair have to be recomputed (see its attribute
+   * IncrementalUpdate). The default implementation returns true.
+   *
+   * \return true if the beams depend on the channel matrix
+   */
+  virtual bool DependsOnChannel () const;
 };
 
 /**
@@ -69,6 +132,15 @@ class CellScanBeamforming: public IdealBeamformingAlgorithm
 {
 
 public:
+  /**
+   * \brief How the beams are evaluated
+   */
+  enum BeamSearchMethod
+  {
+    CHANNEL_SCAN,     //!< Apply each pair of beams to the antennas, and compute the average received PSD with the spectrum propagation loss model (reference)
+    LONG_TERM_MATRIX  //!< Project the channel matrix on the beams, and compute the power of the long term component, summed over the clusters
+  };
+
   /**
    * \brief Get the type id
    * \return the type id of the class
@@ -85,6 +157,17 @@ public:
    */
   void SetBeamSearchAngleStep (double beamSearchAngleStep);
 
+  /**
+   * \return Gets value of BeamSearchMethod attribute
+   */
+  BeamSearchMethod GetBeamSearchMethod () const;
+
+  /**
+   * \brief Sets the value of BeamSearchMethod attribute
+   * \param method the method
+   */
+  void SetBeamSearchMethod (BeamSearchMethod method);
+
   /**
    * \brief constructor
    */
@@ -105,9 +188,54 @@ public:
   virtual BeamformingVectorPair GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
                                                        const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
 
+  /**
+   * \brief Read the channel matrix of the pair, and build the beams to be
+   * evaluated
+   * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
+   * \param [in] ueSpectrumPhy the spectrum phy of the UE device
+   * \return a CellScanBeamforming::Input with the LONG_TERM_MATRIX method,
+   * nullptr with the CHANNEL_SCAN method
+   */
+  virtual Ptr<const BeamSearchInput> GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                         const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
+
+  /**
+   * \brief Find the pair of beams with the highest long term power
+   *
+   * The channel is projected on each UE beam once, and the projection is
+   * then combined with all the gNB beams, so that the cost is about
+   * (UE beams x antennas x antennas x clusters) instead of (gNB beams x UE
+   * beams x RBs x clusters x antennas) of the CHANNEL_SCAN method.
+   *
+   * \param [in] input a CellScanBeamforming::Input
+   * \return the beamforming vector pair of the gNB and the UE
+   */
+  virtual BeamformingVectorPair ComputeBeamformingVectors (const BeamSearchInput &input) const override;
+
+protected:
+  /**
+   * \brief The channel matrix of a pair of devices, and their beams
+   */
+  struct Input : public BeamSearchInput
+  {
+    Ptr<const MatrixBasedChannelModel::ChannelMatrix> m_channelMatrix; //!< Channel matrix of the pair
+    bool m_ueIsU {true};                     //!< True if the UE is the u-node of the channel matrix
+    Ptr<const NrBeamCodebook> m_gnbCodebook; //!< Beams of the gNB, in the order of the search
+    Ptr<const NrBeamCodebook> m_ueCodebook;  //!< Beams of the UE, in the order of the search
+  };
+
 private:
+  /**
+   * \brief Search the beams with the CHANNEL_SCAN method
+   * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
+   * \param [in] ueSpectrumPhy the spectrum phy of the UE device
+   * \return the beamforming vector pair of the gNB and the UE
+   */
+  BeamformingVectorPair ScanBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const;
 
   double m_beamSearchAngleStep {30};//!< the beam search angle step attribute
+  BeamSearchMethod m_beamSearchMethod {CHANNEL_SCAN}; //!< the beam search method attribute
 
 };
 
@@ -224,6 +352,50 @@ public:
    */
   virtual BeamformingVectorPair GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
                                                        const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
+
+  /**
+   * \brief Read the positions and the antenna arrays of the devices
+   * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
+   * \param [in] ueSpectrumPhy the spectrum phy of the UE
+   * \return a DirectPathBeamforming::Input
+   */
+  virtual Ptr<const BeamSearchInput> GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                         const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
+
+  /**
+   * \brief Point the beams of the gNB and of the UE to each other
+   * \param [in] input a DirectPathBeamforming::Input
+   * \return the beamforming vector pair of the gNB and the UE
+   */
+  virtual BeamformingVectorPair ComputeBeamformingVectors (const BeamSearchInput &input) const override;
+
+  /**
+   * \return false, the beams depend only on the positions of the devices
+   */
+  virtual bool DependsOnChannel () const override;
+
+protected:
+  /**
+   * \brief The positions and the antenna arrays of a pair of devices
+   */
+  struct Input : public BeamSearchInput
+  {
+    Vector m_gnbPosition;                       //!< Position of the gNB
+    Vector m_uePosition;                        //!< Position of the UE
+    Ptr<const UniformPlanarArray> m_gnbAntenna; //!< Antenna array of the gNB
+    Ptr<const UniformPlanarArray> m_ueAntenna;  //!< Antenna array of the UE
+    Ptr<const NrBeamCodebook> m_gnbQuasiOmni;   //!< Quasi-omni beam of the gNB (only if used by the method)
+    Ptr<const NrBeamCodebook> m_ueQuasiOmni;    //!< Quasi-omni beam of the UE (only if used by the method)
+  };
+
+  /**
+   * \brief Read the positions and the antenna arrays of the devices
+   * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
+   * \param [in] ueSpectrumPhy the spectrum phy of the UE
+   * \return the input, without the quasi-omni beams
+   */
+  Ptr<Input> CreateInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                          const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const;
 };
 
 /**
@@ -240,16 +412,24 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Read the positions and the antenna arrays of the devices, and the
+   * quasi-omni beam of the gNB
+   * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
+   * \param [in] ueSpectrumPhy the spectrum phy of the UE
+   * \return a DirectPathBeamforming::Input
+   */
+  virtual Ptr<const BeamSearchInput> GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                         const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
+
   /**
    * \brief Function that generates the beamforming vectors for a pair of
    * communicating devices by using the quasi omni beamforming vector for gNB
    * and direct path beamforming vector for UEs
-   * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
-   * \param [in] ueSpectrumPhy the spectrum phy of the UE
+   * \param [in] input a DirectPathBeamforming::Input
    * \return the beamforming vector pair of the gNB and the UE
    */
-  virtual BeamformingVectorPair GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
-                                                       const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
+  virtual BeamformingVectorPair ComputeBeamformingVectors (const BeamSearchInput &input) const override;
 
 };
 
@@ -268,17 +448,24 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Read the positions and the antenna arrays of the devices, and the
+   * quasi-omni beam of the UE
+   * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
+   * \param [in] ueSpectrumPhy the spectrum phy of the UE
+   * \return a DirectPathBeamforming::Input
+   */
+  virtual Ptr<const BeamSearchInput> GetBeamSearchInput (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                         const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
+
   /**
    * \brief Function that generates the beamforming vectors for a pair of
    * communicating devices by using the direct-path beamforming vector for gNB
    * and quasi-omni beamforming vector for UEs
-   * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
-   * \param [in] ueSpectrumPhy the spectrum phy of the UE
+   * \param [in] input a DirectPathBeamforming::Input
    * \return the beamforming vector pair of the gNB and the UE
-   *
    */
-  virtual BeamformingVectorPair GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
-                                                       const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
+  virtual BeamformingVectorPair ComputeBeamformingVectors (const BeamSearchInput &input) const override;
 
 };
 
@@ -224,26 +224,27 @@ NrAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t &mcs) const
     }
   else if (m_amcModel == ErrorModel)
     {
-      std::vector <int> rbMap;
-      int rbId = 0;
+      NrRbMask rbMap (sinr.GetValuesN ());
+      uint32_t rbId = 0;
       double sinrAvg = 0;
       for (it = sinr.ConstValuesBegin (); it != sinr.ConstValuesEnd (); it++)
         {
           if (*it != 0.0)
             {
-              rbMap.push_back (rbId);
+              rbMap.Set (rbId);
               sinrAvg += *it;
             }
           rbId += 1;
         }
-      sinrAvg /= rbMap.size ();
+      uint32_t rbMapNum = rbMap.Count ();
+      sinrAvg /= rbMapNum;
 
       mcs = 0;
       Ptr<NrErrorModelOutput> output;
       while (mcs <= m_errorModel->GetMaxMcs ())
         {
           output = m_errorModel->GetTbDecodificationStats (sinr, rbMap,
-                                                           CalculateTbSize (mcs, rbMap.size ()),
+                                                           CalculateTbSize (mcs, rbMapNum),
                                                            mcs,
                                                            NrErrorModel::NrErrorModelHistory ());
           if (output->m_tbler > 0.1)
@@ -280,6 +281,69 @@ NrAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t &mcs) const
   return cqi;
 }
 
+NrSubbandCqi
+NrAmc::CreateCqiFeedbackSbTdma (const SpectrumValue& sinr, uint32_t rbPerSubband,
+                                const NrSubbandCqi &previous) const
+{
+  NS_LOG_FUNCTION (this);
+
+  const uint32_t numRb = sinr.GetValuesN ();
+  const uint32_t minRbPerSubband = NrSubbandCqi::GetMinRbPerSubband (numRb);
+  if (rbPerSubband < minRbPerSubband)
+    {
+      NS_LOG_LOGIC ("Subband size " << rbPerSubband << " too small for " << numRb <<
+                    " RB, using " << minRbPerSubband);
+      rbPerSubband = minRbPerSubband;
+    }
+  NrSubbandCqi ret (numRb, rbPerSubband);
+  const bool keepPrevious = previous.GetNumSubbands () == ret.GetNumSubbands ()
+    && previous.GetRbPerSubband () == rbPerSubband;
+
+  // Shannon based model, as in CreateCqiFeedbackWbTdma
+  const double gap = (-std::log (5.0 * GetBer ())) / 1.5;
+  std::vector<double> seSum (ret.GetNumSubbands (), 0.0);
+  std::vector<uint32_t> rbNum (ret.GetNumSubbands (), 0);
+  double seWb = 0.0;
+  uint32_t rbNumWb = 0;
+
+  uint32_t rb = 0;
+  for (auto it = sinr.ConstValuesBegin (); it != sinr.ConstValuesEnd (); ++it, ++rb)
+    {
+      if (*it == 0.0)
+        {
+          continue;
+        }
+      double s = log2 (1 + (*it / gap));
+      uint32_t sb = ret.GetSubbandOfRb (rb);
+      seSum.at (sb) += s;
+      rbNum.at (sb)++;
+      seWb += s;
+      rbNumWb++;
+    }
+
+  if (rbNumWb == 0)
+    {
+      return keepPrevious ? previous : ret;
+    }
+
+  int32_t cqiWb = GetCqiFromSpectralEfficiency (seWb / rbNumWb);
+  for (uint32_t sb = 0; sb < ret.GetNumSubbands (); ++sb)
+    {
+      if (rbNum.at (sb) > 0)
+        {
+          int32_t cqiSb = GetCqiFromSpectralEfficiency (seSum.at (sb) / rbNum.at (sb));
+          ret.SetOffset (sb, cqiSb - cqiWb);
+        }
+      else if (keepPrevious)
+        {
+          ret.SetOffset (sb, previous.GetOffset (sb));
+        }
+      NS_LOG_LOGIC ("Subband " << sb << " offset " << +ret.GetOffset (sb));
+    }
+
+  return ret;
+}
+
 uint8_t
 NrAmc::GetCqiFromSpectralEfficiency (double s) const
 {
@@ -135,6 +135,32 @@ public:
    */
   uint8_t CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t &mcsWb) const;
 
+  /**
+   * \brief Create a subband CQI feedback from SINR values
+   *
+   * Running the error model on each subband would multiply the cost of the
+   * CQI creation by the number of subbands. The offset of each subband is
+   * instead the difference between the CQI of the average spectral efficiency
+   * of the subband and of the entire band, both estimated with the Shannon
+   * model, and it is meant to be applied to the wideband CQI given by
+   * CreateCqiFeedbackWbTdma.
+   *
+   * The subbands without signal (all the SINR values are 0) keep the offset
+   * of the previous report, or 0 if the previous report has a different
+   * layout.
+   *
+   * If the subbands are too small to fit the bandwidth in
+   * NrSubbandCqi::MAX_SUBBANDS, they are enlarged to
+   * NrSubbandCqi::GetMinRbPerSubband.
+   *
+   * \param sinr the sinr values
+   * \param rbPerSubband number of RB in each subband
+   * \param previous the previous report of the same stream
+   * \return The subband CQI
+   */
+  NrSubbandCqi CreateCqiFeedbackSbTdma (const SpectrumValue& sinr, uint32_t rbPerSubband,
+                                        const NrSubbandCqi &previous) const;
+
   /**
    * \brief Get CQI from a SpectralEfficiency value
    * \param s spectral efficiency
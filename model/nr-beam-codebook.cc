@@ -0,0 +1,195 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-beam-codebook.h"
+
+#include <ns3/abort.h>
+#include <ns3/double.h>
+#include <ns3/log.h>
+#include <ns3/uinteger.h>
+
+#include <map>
+#include <tuple>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrBeamCodebook");
+
+namespace {
+
+/**
+ * \brief Configuration of an array and of the beams of a codebook:
+ * rows, columns, horizontal spacing, vertical spacing, bearing, downtilt,
+ * quasi-omni, elevations
+ */
+typedef std::tuple<uint32_t, uint32_t, double, double, double, double, bool, std::vector<double>> CodebookKey;
+
+/**
+ * \return the codebooks created so far
+ */
+std::map<CodebookKey, Ptr<const NrBeamCodebook>> &
+GetCodebooks ()
+{
+  static std::map<CodebookKey, Ptr<const NrBeamCodebook>> codebooks;
+  return codebooks;
+}
+
+/**
+ * \brief Get the key of a codebook
+ * \param antenna the antenna array
+ * \param quasiOmni true for the quasi-omni codebook
+ * \param elevations the elevations of the sectors
+ * \return the key
+ */
+CodebookKey
+GetKey (const Ptr<const UniformPlanarArray> &antenna, bool quasiOmni,
+        const std::vector<double> &elevations)
+{
+  UintegerValue numRows, numColumns;
+  DoubleValue hSpacing, vSpacing, bearing, downtilt;
+  antenna->GetAttribute ("NumRows", numRows);
+  antenna->GetAttribute ("NumColumns", numColumns);
+  antenna->GetAttribute ("AntennaHorizontalSpacing", hSpacing);
+  antenna->GetAttribute ("AntennaVerticalSpacing", vSpacing);
+  antenna->GetAttribute ("BearingAngle", bearing);
+  antenna->GetAttribute ("DowntiltAngle", downtilt);
+  return CodebookKey (static_cast<uint32_t> (numRows.Get ()), static_cast<uint32_t> (numColumns.Get ()),
+                      hSpacing.Get (), vSpacing.Get (), bearing.Get (), downtilt.Get (),
+                      quasiOmni, elevations);
+}
+
+} // unnamed namespace
+
+Ptr<const NrBeamCodebook>
+NrBeamCodebook::GetSectorCodebook (const Ptr<const UniformPlanarArray> &antenna,
+                                   const std::vector<double> &elevations)
+{
+  CodebookKey key = GetKey (antenna, false, elevations);
+  auto it = GetCodebooks ().find (key);
+  if (it != GetCodebooks ().end ())
+    {
+      return it->second;
+    }
+
+  uint32_t numRows = std::get<0> (key);
+  NS_LOG_INFO ("Creating the sector codebook of a " << numRows << "x" << std::get<1> (key) <<
+               " array, with " << elevations.size () << " elevations");
+
+  Ptr<NrBeamCodebook> codebook = Create<NrBeamCodebook> ();
+  for (double elevation : elevations)
+    {
+      for (uint16_t sector = 0; sector <= numRows; sector++)
+        {
+          NS_ASSERT (sector < UINT16_MAX);
+          codebook->AddBeam (CreateDirectionalBfv (antenna, sector, elevation), BeamId (sector, elevation));
+        }
+    }
+
+  GetCodebooks ().emplace (key, codebook);
+  return codebook;
+}
+
+Ptr<const NrBeamCodebook>
+NrBeamCodebook::GetQuasiOmniCodebook (const Ptr<const UniformPlanarArray> &antenna)
+{
+  CodebookKey key = GetKey (antenna, true, {});
+  auto it = GetCodebooks ().find (key);
+  if (it != GetCodebooks ().end ())
+    {
+      return it->second;
+    }
+
+  Ptr<NrBeamCodebook> codebook = Create<NrBeamCodebook> ();
+  codebook->AddBeam (CreateQuasiOmniBfv (std::get<0> (key), std::get<1> (key)), OMNI_BEAM_ID);
+
+  GetCodebooks ().emplace (key, codebook);
+  return codebook;
+}
+
+std::vector<double>
+NrBeamCodebook::GetCellScanElevations (double angleStep)
+{
+  NS_ABORT_MSG_IF (angleStep <= 0, "The angle step must be positive");
+  std::vector<double> elevations;
+  for (double theta = 60; theta < 121; theta = theta + angleStep)
+    {
+      elevations.push_back (theta);
+    }
+  return elevations;
+}
+
+std::vector<double>
+NrBeamCodebook::GetCellScanUeElevations (double angleStep)
+{
+  NS_ABORT_MSG_IF (angleStep <= 0, "The angle step must be positive");
+  std::vector<double> elevations;
+  for (double theta = 60; theta < 121; theta = static_cast<uint16_t> (theta + angleStep))
+    {
+      elevations.push_back (theta);
+    }
+  return elevations;
+}
+
+size_t
+NrBeamCodebook::GetNumCodebooks ()
+{
+  return GetCodebooks ().size ();
+}
+
+size_t
+NrBeamCodebook::GetNumBeams () const
+{
+  return m_ids.size ();
+}
+
+size_t
+NrBeamCodebook::GetNumElements () const
+{
+  return m_numElements;
+}
+
+const std::complex<double> *
+NrBeamCodebook::GetWeights (size_t beam) const
+{
+  NS_ASSERT (beam < m_ids.size ());
+  return &m_weights[beam * m_numElements];
+}
+
+BeamId
+NrBeamCodebook::GetBeamId (size_t beam) const
+{
+  return m_ids.at (beam);
+}
+
+BeamformingVector
+NrBeamCodebook::GetBeamformingVector (size_t beam) const
+{
+  const std::complex<double> *weights = GetWeights (beam);
+  return BeamformingVector (complexVector_t (weights, weights + m_numElements), m_ids.at (beam));
+}
+
+void
+NrBeamCodebook::AddBeam (const complexVector_t &weights, const BeamId &id)
+{
+  NS_ASSERT (m_ids.empty () || weights.size () == m_numElements);
+  m_numElements = weights.size ();
+  m_weights.insert (m_weights.end (), weights.begin (), weights.end ());
+  m_ids.push_back (id);
+}
+
+} // namespace ns3
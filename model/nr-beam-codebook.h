@@ -0,0 +1,141 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_BEAM_CODEBOOK_H
+#define NR_BEAM_CODEBOOK_H
+
+#include "beamforming-vector.h"
+
+#include <ns3/simple-ref-count.h>
+
+#include <complex>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief A set of beams of a uniform planar array, with their weights stored
+ * contiguously
+ *
+ * The beams of the cell scan depend only on the geometry of the array (rows,
+ * columns, spacing, bearing and downtilt) and on the elevations searched.
+ * A codebook is computed (with trigonometric functions for each element)
+ * once per configuration, and it is shared by all the arrays with the same
+ * configuration, instead of being recomputed for each pair of devices at
+ * each run of the beamforming.
+ *
+ * The weights of beam i are at GetWeights (i), for GetNumElements () elements;
+ * the beams follow each other in memory, so that a codebook can be used as a
+ * (beams x elements) matrix.
+ *
+ * The codebooks are immutable: once created, they can be read from any
+ * thread. GetSectorCodebook and GetQuasiOmniCodebook must be called from the
+ * main thread.
+ */
+class NrBeamCodebook : public SimpleRefCount<NrBeamCodebook>
+{
+public:
+  /**
+   * \brief Get the codebook of the sectors of an array
+   *
+   * For each elevation (in order), the beams of the sectors from 0 to the
+   * number of rows of the array (see CreateDirectionalBfv).
+   *
+   * \param antenna the antenna array
+   * \param elevations the elevations, in degrees
+   * \return the (shared) codebook
+   */
+  static Ptr<const NrBeamCodebook> GetSectorCodebook (const Ptr<const UniformPlanarArray> &antenna,
+                                                      const std::vector<double> &elevations);
+
+  /**
+   * \brief Get the codebook with the quasi-omni beam of an array (see
+   * CreateQuasiOmniBfv)
+   * \param antenna the antenna array
+   * \return the (shared) codebook, with one beam (OMNI_BEAM_ID)
+   */
+  static Ptr<const NrBeamCodebook> GetQuasiOmniCodebook (const Ptr<const UniformPlanarArray> &antenna);
+
+  /**
+   * \brief Get the elevations searched by the cell scan
+   * \param angleStep the step, in degrees
+   * \return the elevations from 60 to 120 degrees
+   */
+  static std::vector<double> GetCellScanElevations (double angleStep);
+
+  /**
+   * \brief Get the elevations of the UE beams searched by the cell scan
+   * \param angleStep the step, in degrees
+   * \return the elevations from 60 to 120 degrees, truncated to integer
+   * degrees at each step, as the scan of the UE beams always did
+   */
+  static std::vector<double> GetCellScanUeElevations (double angleStep);
+
+  /**
+   * \return the number of codebooks stored
+   */
+  static size_t GetNumCodebooks ();
+
+  /**
+   * \return the number of beams
+   */
+  size_t GetNumBeams () const;
+
+  /**
+   * \return the number of antenna elements
+   */
+  size_t GetNumElements () const;
+
+  /**
+   * \brief Get the weights of a beam
+   * \param beam the index of the beam
+   * \return a pointer to the GetNumElements () weights of the beam
+   */
+  const std::complex<double> * GetWeights (size_t beam) const;
+
+  /**
+   * \brief Get the id of a beam
+   * \param beam the index of the beam
+   * \return the beam id
+   */
+  BeamId GetBeamId (size_t beam) const;
+
+  /**
+   * \brief Get a beam as a beamforming vector
+   * \param beam the index of the beam
+   * \return a copy of the weights, and the id of the beam
+   */
+  BeamformingVector GetBeamformingVector (size_t beam) const;
+
+private:
+  /**
+   * \brief Add a beam
+   * \param weights the weights of the beam
+   * \param id the id of the beam
+   */
+  void AddBeam (const complexVector_t &weights, const BeamId &id);
+
+  std::vector<std::complex<double>> m_weights; //!< Weights of all the beams, beam after beam
+  std::vector<BeamId> m_ids;                   //!< Ids of the beams
+  size_t m_numElements {0};                    //!< Number of antenna elements
+};
+
+} // namespace ns3
+
+#endif // NR_BEAM_CODEBOOK_H
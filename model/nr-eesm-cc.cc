@@ -45,7 +45,7 @@ NrEesmCc::GetTypeId (void)
 
 
 double
-NrEesmCc::ComputeSINR (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs,
+NrEesmCc::ComputeSINR (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs,
                        [[maybe_unused]] uint32_t sizeBit,
                          const NrErrorModel::NrErrorModelHistory &sinrHistory) const
 {
@@ -73,16 +73,15 @@ NrEesmCc::ComputeSINR (const SpectrumValue& sinr, const std::vector<int>& map, u
   for (uint32_t i = 0; i < historySize; ++i)
     {
       Ptr<NrEesmErrorModelOutput> output = DynamicCast<NrEesmErrorModelOutput> (total.at(i));
-      maxRBUsed = std::max (maxRBUsed, static_cast<uint32_t> (output->m_map.size ()));
+      maxRBUsed = std::max (maxRBUsed, output->m_map.Count ());
     }
 
-  std::vector<int> map_sum;
-  map_sum.reserve (maxRBUsed);
+  NrRbMask map_sum (sinr.GetValuesN ());
+  map_sum.SetRange (0, maxRBUsed);
 
   for (uint32_t i = 0 ; i < maxRBUsed; ++i)
     {
       sinr_sum[i] = 0;
-      map_sum.push_back (static_cast<int> (i));
     }
 
   /* combine at the bit level. Example:
@@ -102,10 +101,15 @@ NrEesmCc::ComputeSINR (const SpectrumValue& sinr, const std::vector<int>& map, u
   for (uint32_t i = 0; i < historySize; ++i)
     {
       Ptr<NrEesmErrorModelOutput> output = DynamicCast<NrEesmErrorModelOutput> (total.at(i));
-      uint32_t size = output->m_map.size ();
+      // visit the RBs of the tx cyclically, as if the map was repeated
+      auto rb = output->m_map.begin ();
       for (uint32_t j = 0 ; j < maxRBUsed; ++j)
         {
-          sinr_sum[j] += output->m_sinr [ output->m_map [ j % size ] ];
+          sinr_sum[j] += output->m_sinr [*rb];
+          if (++rb == output->m_map.end ())
+            {
+              rb = output->m_map.begin ();
+            }
         }
     }
 
@@ -121,7 +125,7 @@ NrEesmCc::ComputeSINR (const SpectrumValue& sinr, const std::vector<int>& map, u
   NS_LOG_INFO ("SINR_SUM: " << sinr_sum);
 
   // compute effective SINR with the sinr_sum vector and map_sum RB map
-  return SinrEff (sinr_sum, map_sum, mcs, 0.0, map_sum.size());
+  return SinrEff (sinr_sum, map_sum, mcs, 0.0, map_sum.Count ());
 }
 
 double
@@ -69,11 +69,11 @@ NrEesmErrorModel::GetInstanceTypeId() const
 }
 
 double
-NrEesmErrorModel::SinrEff (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs, double a, double b) const
+NrEesmErrorModel::SinrEff (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs, double a, double b) const
 {
   // it follows: SINReff = - beta * ln [1/b * (sum (exp (-sinr/beta)) + a)]
-  // for HARQ-IR: b = sum (map.size()), a = sum_j(sum_n (exp (-sinr/beta))) (for previous retx, till j=q-1)
-  // for HARQ-CC: b = map.size(), a = 0.0 (SINRs are already combined in sinr input)
+  // for HARQ-IR: b = sum (map.Count ()), a = sum_j(sum_n (exp (-sinr/beta))) (for previous retx, till j=q-1)
+  // for HARQ-CC: b = map.Count (), a = 0.0 (SINRs are already combined in sinr input)
 
   double sinrExpSum = SinrExp (sinr, map, mcs);
   double beta = GetBetaTable ()->at (mcs);
@@ -85,20 +85,20 @@ NrEesmErrorModel::SinrEff (const SpectrumValue& sinr, const std::vector<int>& ma
 }
 
 double
-NrEesmErrorModel::SinrExp (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs) const
+NrEesmErrorModel::SinrExp (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs) const
 {
   // it returns sum_n (exp (-SINR/beta))
   NS_LOG_FUNCTION (sinr << &map << (uint8_t) mcs);
-  NS_ABORT_MSG_IF (map.size () == 0,
+  NS_ABORT_MSG_IF (map.None (),
                    " Error: number of allocated RBs cannot be 0 - EESM method - SinrEff function");
 
   double SINRexp = 0.0;
   double SINRsum = 0.0;
   double beta = GetBetaTable ()->at (mcs);
   SpectrumValue sinrCopy = sinr;
-  for (uint32_t i = 0; i < map.size (); i++)
+  for (uint32_t rb : map)
     {
-      double sinrLin = sinrCopy [map.at (i)];
+      double sinrLin = sinrCopy [rb];
       SINRexp = exp (-sinrLin / beta);
       SINRsum += SINRexp;
     }
@@ -262,7 +262,7 @@ NrEesmErrorModel::CodeBlockSegmentation (uint32_t B, GraphType bg_type) const
 }
 
 Ptr<NrErrorModelOutput>
-NrEesmErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map,
+NrEesmErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const NrRbMask &map,
                                             uint32_t size, uint8_t mcs,
                                             const NrErrorModelHistory &sinrHistory)
 {
@@ -270,7 +270,7 @@ NrEesmErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std
 }
 
 std::string
-NrEesmErrorModel::PrintMap (const std::vector<int> &map) const
+NrEesmErrorModel::PrintMap (const NrRbMask &map) const
 {
   std::stringstream ss;
 
@@ -284,14 +284,14 @@ NrEesmErrorModel::PrintMap (const std::vector<int> &map) const
 
 Ptr<NrErrorModelOutput>
 NrEesmErrorModel::GetTbBitDecodificationStats (const SpectrumValue& sinr,
-                                               const std::vector<int>& map,
+                                               const NrRbMask &map,
                                                uint32_t sizeBit, uint8_t mcs,
                                                const NrErrorModelHistory &sinrHistory)
 {
   NS_LOG_FUNCTION (this);
   NS_ABORT_IF (mcs > GetMaxMcs ());
 
-  double tbSinr = SinrEff (sinr, map, mcs, 0, map.size());  // effective SINR for this tx
+  double tbSinr = SinrEff (sinr, map, mcs, 0, map.Count ());  // effective SINR for this tx
   double SINR = tbSinr;
   double sinrExpSum = SinrExp (sinr, map, mcs);  // exponential sum of SINRs for this tx
 
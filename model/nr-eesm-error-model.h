@@ -50,7 +50,7 @@ struct NrEesmErrorModelOutput : public NrErrorModelOutput
   double m_sinrExp {0.0};   //!< Sum of exponential SINR (needed for HARQ-IR)
   double m_sinrEff {0.0};   //!< The effective SINR (needed just for the test)
   SpectrumValue m_sinr;     //!< perceived SINRs in the whole bandwidth
-  std::vector<int> m_map;   //!< map of the active RBs
+  NrRbMask m_map;           //!< map of the active RBs
   uint32_t m_infoBits {0};  //!< number of info bits
   uint32_t m_codeBits {0};  //!< number of code bits
 };
@@ -123,7 +123,7 @@ public:
    * SINR, RB map, code bits, and info bits.
    */
   virtual Ptr<NrErrorModelOutput> GetTbDecodificationStats (const SpectrumValue& sinr,
-                                                            const std::vector<int>& map,
+                                                            const NrRbMask &map,
                                                             uint32_t size, uint8_t mcs,
                                                             const NrErrorModelHistory &sinrHistory) override;
 
@@ -170,7 +170,7 @@ protected:
    * \param map the RB map
    * \return a string that contains the RB map in a readable way
    */
-  std::string PrintMap (const std::vector<int> &map) const;
+  std::string PrintMap (const NrRbMask &map) const;
 
   /**
    * \brief compute the effective SINR for the specified MCS and SINR, according
@@ -191,7 +191,7 @@ protected:
    * \param b the denominator for the exponentials sum
    * \return the effective SINR
    */
-  double SinrEff (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs, double a, double b) const;
+  double SinrEff (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs, double a, double b) const;
 
   /**
    * \brief compute the sum of exponential SINRs for the specified MCS and SINR, according
@@ -202,7 +202,7 @@ protected:
    * \param mcs the MCS of the TB
    * \return the sum of exponential SINR
    */
-  double SinrExp (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs) const;
+  double SinrExp (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs) const;
 
   /**
    * \brief Compute the effective SINR after retransmission combining
@@ -220,7 +220,7 @@ protected:
    * \see NrEesmIr
    * \see NrEesmCc
    */
-  virtual double ComputeSINR (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs,
+  virtual double ComputeSINR (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs,
                               uint32_t sizeBit, const NrErrorModel::NrErrorModelHistory &sinrHistory) const = 0;
 
   /**
@@ -287,7 +287,7 @@ private:
    * SINR, RB map, code bits, and info bits.
    */
   Ptr<NrErrorModelOutput> GetTbBitDecodificationStats (const SpectrumValue& sinr,
-                                                       const std::vector<int>& map,
+                                                       const NrRbMask &map,
                                                        uint32_t size, uint8_t mcs,
                                                        const NrErrorModelHistory &sinrHistory);
 
@@ -45,7 +45,7 @@ NrEesmIr::GetTypeId (void)
 }
 
 double
-NrEesmIr::ComputeSINR (const SpectrumValue &sinr, const std::vector<int> &map,
+NrEesmIr::ComputeSINR (const SpectrumValue &sinr, const NrRbMask &map,
                          uint8_t mcs, uint32_t sizeBit,
                          const NrErrorModel::NrErrorModelHistory &sinrHistory) const
 {
@@ -68,9 +68,9 @@ NrEesmIr::ComputeSINR (const SpectrumValue &sinr, const std::vector<int> &map,
                     " infoBits: " << sinrHistorytemp->m_infoBits);
 
       codeBitsSum += sinrHistorytemp->m_codeBits;
-      mapSumSize += sinrHistorytemp->m_map.size();
+      mapSumSize += sinrHistorytemp->m_map.Count ();
     }
-  mapSumSize += map.size();
+  mapSumSize += map.Count ();
   codeBitsSum += sizeBit / GetMcsEcrTable()->at (mcs);;
   const_cast<NrEesmIr*> (this)->m_Reff = infoBits / static_cast<double> (codeBitsSum);
 
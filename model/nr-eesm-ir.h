@@ -73,7 +73,7 @@ protected:
    * \param sinrHistory the History of the previous transmissions of the same block
    * \return The effective SINR
    */
-  double ComputeSINR (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs,
+  double ComputeSINR (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs,
                       uint32_t sizeBit, const NrErrorModel::NrErrorModelHistory &sinrHistory) const override;
 
   /**
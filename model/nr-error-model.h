@@ -21,6 +21,7 @@
 #include <ns3/object.h>
 #include <vector>
 #include <ns3/spectrum-value.h>
+#include "nr-rb-mask.h"
 
 namespace ns3 {
 
@@ -142,7 +143,7 @@ public:
    * \return A pointer to an output, with the tbler and other customized values
    */
   virtual Ptr<NrErrorModelOutput> GetTbDecodificationStats (const SpectrumValue& sinr,
-                                                            const std::vector<int>& map,
+                                                            const NrRbMask &map,
                                                             uint32_t size, uint8_t mcs,
                                                             const NrErrorModelHistory &history) = 0;
 
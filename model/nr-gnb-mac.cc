@@ -1280,7 +1280,7 @@ NrGnbMac::GetDlCtrlDci () const
 
   auto bwInRbg = m_phySapProvider->GetRbNum () / GetNumRbPerRbg ();
   NS_ASSERT (bwInRbg > 0);
-  std::vector<uint8_t> rbgBitmask (bwInRbg , 1);
+  NrRbMask rbgBitmask (bwInRbg, true);
 
   return std::make_shared<DciInfoElementTdma> (0, m_macSchedSapProvider->GetDlCtrlSyms (),
                                                DciInfoElementTdma::DL, DciInfoElementTdma::CTRL,
@@ -1293,7 +1293,7 @@ NrGnbMac::GetUlCtrlDci () const
   NS_LOG_FUNCTION (this);
 
   NS_ASSERT (m_bandwidthInRbg > 0);
-  std::vector<uint8_t> rbgBitmask (m_bandwidthInRbg , 1);
+  NrRbMask rbgBitmask (m_bandwidthInRbg, true);
 
   return std::make_shared<DciInfoElementTdma> (0, m_macSchedSapProvider->GetUlCtrlSyms (),
                                                DciInfoElementTdma::UL, DciInfoElementTdma::CTRL,
@@ -39,6 +39,7 @@
 #include "nr-gnb-net-device.h"
 #include "nr-radio-bearer-tag.h"
 #include "nr-ch-access-manager.h"
+#include "nr-mac-scheduler-slot-dispatcher.h"
 
 #include <ns3/node-list.h>
 #include <ns3/node.h>
@@ -72,6 +73,9 @@ NrGnbPhy::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
   delete m_enbCphySapProvider;
+  m_deviceMap.clear ();
+  m_uePhyMap.clear ();
+  m_rntiToUe.clear ();
   NrPhy::DoDispose ();
 }
 
@@ -559,23 +563,19 @@ NrGnbPhy::GetBeamConfId (uint16_t rnti) const
 
   NS_ABORT_MSG_UNLESS (m_spectrumPhys.size () == 1 || m_spectrumPhys.size () == 2, " Currently the BeamConfId implementation supports up to 2 antenna arrays per PHY instance.");
 
-  for (uint8_t i = 0; i < m_deviceMap.size (); i++)
+  size_t i = GetUeIndex (rnti);
+
+  if (i < m_deviceMap.size ())
     {
-      Ptr<NrUeNetDevice> ueDev = DynamicCast < NrUeNetDevice > (m_deviceMap.at (i));
-      uint64_t ueRnti = (DynamicCast<NrUePhy>(ueDev->GetPhy (GetBwpId ())))->GetRnti ();
+      NS_ASSERT (m_spectrumPhys [0]->GetBeamManager ());
+      BeamId beamId1 = m_spectrumPhys [0]->GetBeamManager ()->GetBeamId (m_deviceMap.at (i));
+      BeamId beamId2 = BeamId::GetEmptyBeamId ();
 
-      if (ueRnti == rnti)
+      if (m_spectrumPhys.size () > 1)
         {
-          NS_ASSERT (m_spectrumPhys [0]->GetBeamManager ());
-          BeamId beamId1 = m_spectrumPhys [0]->GetBeamManager ()->GetBeamId (m_deviceMap.at (i));
-          BeamId beamId2 = BeamId::GetEmptyBeamId ();
-
-          if (m_spectrumPhys.size () > 1)
-            {
-              m_spectrumPhys [1]->GetBeamManager ()->GetBeamId (m_deviceMap.at (i));
-            }
-          return BeamConfId (beamId1, beamId2);
+          beamId2 = m_spectrumPhys [1]->GetBeamManager ()->GetBeamId (m_deviceMap.at (i));
         }
+      return BeamConfId (beamId1, beamId2);
     }
   return BeamConfId (BeamId (0,0), BeamId::GetEmptyBeamId ());
 }
@@ -610,9 +610,9 @@ NrGnbPhy::GetTxPower () const
 }
 
 void
-NrGnbPhy::SetSubChannels (const std::vector<int> &rbIndexVector, uint8_t activeStreams)
+NrGnbPhy::SetSubChannels (const NrRbMask &rbMask, uint8_t activeStreams)
 {
-  Ptr<SpectrumValue> txPsd = GetTxPowerSpectralDensity (rbIndexVector, activeStreams);
+  Ptr<SpectrumValue> txPsd = GetTxPowerSpectralDensity (rbMask, activeStreams);
   NS_ASSERT (txPsd);
   for (uint8_t streamIndex = 0; streamIndex < m_spectrumPhys.size(); streamIndex++)
     {
@@ -693,7 +693,15 @@ NrGnbPhy::StartSlot (const SfnSf &startSlot)
   m_currentSlot = startSlot;
   m_lastSlotStart = Simulator::Now ();
 
-  Simulator::Schedule (GetSlotPeriod (), &NrGnbPhy::EndSlot, this);
+  if (m_slotClock != nullptr)
+    {
+      m_slotClock->Schedule (GetSlotPeriod (), NrSlotClock::END_SLOT,
+                             std::bind (&NrGnbPhy::EndSlot, this));
+    }
+  else
+    {
+      Simulator::Schedule (GetSlotPeriod (), &NrGnbPhy::EndSlot, this);
+    }
 
   // update the current slot allocation; if empty (e.g., at the beginning of simu)
   // then insert a dummy allocation, without anything.
@@ -734,8 +742,7 @@ NrGnbPhy::StartSlot (const SfnSf &startSlot)
   if (m_channelStatus == GRANTED)
     {
       NS_LOG_INFO ("Channel granted");
-      CallMacForSlotIndication (m_currentSlot);
-      DoStartSlot ();
+      CallMacAndStartSlot ();
     }
   else
     {
@@ -767,8 +774,7 @@ NrGnbPhy::StartSlot (const SfnSf &startSlot)
                   // Repetition but we can have a CAM that gives the channel
                   // instantaneously
                   NS_LOG_INFO ("Channel granted; asking MAC for SlotIndication for the future and then start the slot");
-                  CallMacForSlotIndication (m_currentSlot);
-                  DoStartSlot ();
+                  CallMacAndStartSlot ();
                   return; // Exit without calling anything else
                 }
             }
@@ -821,6 +827,24 @@ NrGnbPhy::StartSlot (const SfnSf &startSlot)
 }
 
 
+void
+NrGnbPhy::CallMacAndStartSlot ()
+{
+  NS_LOG_FUNCTION (this);
+
+  CallMacForSlotIndication (m_currentSlot);
+
+  if (NrMacSchedulerSlotDispatcher::Get ()->HasPending ())
+    {
+      NS_LOG_INFO ("Scheduling decisions pending, start the slot after them");
+      Simulator::ScheduleNow (&NrGnbPhy::DoStartSlot, this);
+    }
+  else
+    {
+      DoStartSlot ();
+    }
+}
+
 void
 NrGnbPhy::DoCheckOrReleaseChannel ()
 {
@@ -895,8 +919,7 @@ NrGnbPhy::GenerateAllocationStatistics (const SlotAllocInfo &allocInfo) const
 
   for (const auto & allocation : allocInfo.m_varTtiAllocInfo)
     {
-      uint32_t rbg = std::count (allocation.m_dci->m_rbgBitmask.begin (),
-                                 allocation.m_dci->m_rbgBitmask.end (), 1);
+      uint32_t rbg = allocation.m_dci->m_rbgBitmask.Count ();
 
       // First: Store the RNTI of the UE in the active list
       if (allocation.m_dci->m_rnti != 0)
@@ -966,6 +989,16 @@ NrGnbPhy::DoStartSlot ()
 
   RetrievePrepareEncodeCtrlMsgs ();
 
+  if (std::all_of (m_currSlotAllocInfo.m_varTtiAllocInfo.begin (),
+                   m_currSlotAllocInfo.m_varTtiAllocInfo.end (),
+                   [] (const VarTtiAllocInfo &alloc) { return alloc.m_dci->m_type == DciInfoElementTdma::CTRL; }))
+    {
+      // No data and no SRS: nothing to put power on, nothing to beamform
+      m_rbgAllocationPerSym.Clear (m_rbgAllocationPerSym.GetNumRbg ());
+      FillTheCtrlOnlyEvent ();
+      return;
+    }
+
   PrepareRbgAllocationMap (m_currSlotAllocInfo.m_varTtiAllocInfo);
 
   FillTheEvent ();
@@ -976,10 +1009,20 @@ NrGnbPhy::PrepareRbgAllocationMap (const std::deque<VarTtiAllocInfo> &allocation
 {
   NS_LOG_FUNCTION (this);
 
-  // Start with a clean RBG allocation bitmask
-  m_rbgAllocationPerSym.clear ();
+  // Start with a clean RBG allocation grid, with the size of the DCI masks
+  uint32_t numRbg = m_rbgAllocationPerSym.GetNumRbg ();
+  for (const auto & allocation : allocations)
+    {
+      if (allocation.m_dci->m_type != DciInfoElementTdma::CTRL)
+        {
+          numRbg = allocation.m_dci->m_rbgBitmask.GetSize ();
+          break;
+        }
+    }
+  m_rbgAllocationPerSym.Clear (numRbg);
+  m_rbgAllocationPerSymDataStat.Clear (numRbg);
 
-  // Create RBG map to know where to put power in DL
+  // Create RBG grid to know where to put power in DL
   for (const auto & allocation : allocations)
     {
       if (allocation.m_dci->m_type != DciInfoElementTdma::CTRL)
@@ -988,22 +1031,22 @@ NrGnbPhy::PrepareRbgAllocationMap (const std::deque<VarTtiAllocInfo> &allocation
             {
               // In m_rbgAllocationPerSym, store only the DL RBG set to 1:
               // these will used to put power
-              StoreRBGAllocation (&m_rbgAllocationPerSym, allocation.m_dci);
+              m_rbgAllocationPerSym.Store (allocation.m_dci->m_symStart, allocation.m_dci->m_rbgBitmask);
             }
 
           // For statistics, store UL/DL allocations
-          StoreRBGAllocation (&m_rbgAllocationPerSymDataStat, allocation.m_dci);
+          m_rbgAllocationPerSymDataStat.Store (allocation.m_dci->m_symStart, allocation.m_dci->m_rbgBitmask);
         }
     }
 
-  for (const auto & s : m_rbgAllocationPerSymDataStat)
+  for (uint32_t sym = m_rbgAllocationPerSymDataStat.FindNextUsedSymbol (0);
+       sym < NrSlotRbgGrid::MAX_SYMBOLS;
+       sym = m_rbgAllocationPerSymDataStat.FindNextUsedSymbol (sym + 1))
     {
-      auto & rbgAllocation = s.second;
-      m_rbStatistics (m_currentSlot, s.first, FromRBGBitmaskToRBAssignment (rbgAllocation),
+      m_rbStatistics (m_currentSlot, sym,
+                      FromRBGBitmaskToRBAssignment (m_rbgAllocationPerSymDataStat.GetRow (sym)),
                       GetBwpId (), GetCellId ());
     }
-
-  m_rbgAllocationPerSymDataStat.clear ();
 }
 
 void
@@ -1028,6 +1071,13 @@ NrGnbPhy::FillTheEvent ()
         }
 
       auto varTtiStart = GetSymbolPeriod () * allocation.m_dci->m_symStart;
+      if (allocation.m_dci->m_type == DciInfoElementTdma::DATA
+          && allocation.m_dci->m_format == DciInfoElementTdma::DL)
+        {
+          // The DL data starts 1 ns after the var TTI, to not overlap with
+          // the previous transmission (see DlData): start the var TTI there
+          varTtiStart += NanoSeconds (1.0);
+        }
       Simulator::Schedule (varTtiStart, &NrGnbPhy::StartVarTti, this, allocation.m_dci);
       lastSymStart = allocation.m_dci->m_symStart;
 
@@ -1045,24 +1095,51 @@ NrGnbPhy::FillTheEvent ()
 }
 
 void
-NrGnbPhy::StoreRBGAllocation (std::unordered_map<uint8_t, std::vector<uint8_t> > *map,
-                              const std::shared_ptr<DciInfoElementTdma> &dci) const
+NrGnbPhy::FillTheCtrlOnlyEvent ()
+{
+  NS_LOG_FUNCTION (this);
+
+  std::shared_ptr<DciInfoElementTdma> dlCtrl;
+  bool hasUlCtrl = false;
+  for (const auto & allocation : m_currSlotAllocInfo.m_varTtiAllocInfo)
+    {
+      if (allocation.m_dci->m_format == DciInfoElementTdma::DL)
+        {
+          dlCtrl = allocation.m_dci;
+        }
+      else
+        {
+          hasUlCtrl = true;
+        }
+    }
+
+  // The DL CTRL is at the beginning of the slot; the CTRL messages that
+  // other BWPs route to us in this instant are checked when the event fires,
+  // as StartVarTti would do
+  Simulator::ScheduleNow (&NrGnbPhy::CtrlOnlySlot, this, dlCtrl, hasUlCtrl);
+
+  m_currSlotAllocInfo.m_varTtiAllocInfo.clear ();
+}
+
+void
+NrGnbPhy::CtrlOnlySlot (const std::shared_ptr<DciInfoElementTdma> &dlCtrl, bool hasUlCtrl)
 {
   NS_LOG_FUNCTION (this);
 
-  auto itAlloc = map->find (dci->m_symStart);
-  if (itAlloc == map->end ())
+  if (dlCtrl != nullptr && m_ctrlMsgs.size () > 0)
     {
-      itAlloc = map->insert (std::make_pair (dci->m_symStart, dci->m_rbgBitmask)).first;
+      StartVarTti (dlCtrl);
     }
   else
     {
-      auto & existingRBGBitmask = itAlloc->second;
-      NS_ASSERT (existingRBGBitmask.size () == dci->m_rbgBitmask.size ());
-      for (uint32_t i = 0; i < existingRBGBitmask.size (); ++i)
-        {
-          existingRBGBitmask.at (i) = existingRBGBitmask.at (i) | dci->m_rbgBitmask.at (i);
-        }
+      NS_LOG_INFO ("Slot " << m_currentSlot << " without allocations and CTRL messages to send");
+    }
+
+  // Listen to the UL CTRL with the quasi-omni vector; no one changes it
+  // until the end of the slot
+  if (hasUlCtrl && ! m_isQuasiOmni)
+    {
+      ChangeToQuasiOmniBeamformingVector ();
     }
 }
 
@@ -1243,6 +1320,7 @@ NrGnbPhy::DlData (const std::shared_ptr<DciInfoElementTdma> &dci)
                 " to " << +m_currSymStart + dci->m_numSym);
 
   Time varTtiPeriod = GetSymbolPeriod () * dci->m_numSym;
+  bool sent = false;
 
   for (uint8_t streamIndex = 0; streamIndex < m_spectrumPhys.size(); streamIndex++)
     {
@@ -1258,11 +1336,18 @@ NrGnbPhy::DlData (const std::shared_ptr<DciInfoElementTdma> &dci)
       NS_LOG_INFO ("ENB TXing DL DATA frame " << m_currentSlot <<
                     " symbols "  << static_cast<uint32_t> (dci->m_symStart) <<
                     "-" << static_cast<uint32_t> (dci->m_symStart + dci->m_numSym - 1) <<
-                    " start " << Simulator::Now () + NanoSeconds (1) <<
+                    " start " << Simulator::Now () <<
                     " end " << Simulator::Now () + varTtiPeriod - NanoSeconds (2.0));
 
-      Simulator::Schedule (NanoSeconds (1.0), &NrGnbPhy::SendDataChannels, this,
-                           pktBurst, varTtiPeriod - NanoSeconds (2.0), dci, streamIndex);
+      // We are already 1 ns after the start of the var TTI (see FillTheEvent)
+      SendDataChannels (pktBurst, varTtiPeriod - NanoSeconds (2.0), dci, streamIndex);
+      sent = true;
+    }
+
+  if (! sent)
+    {
+      // StartVarTti did not switch to quasi-omni for DL data
+      ChangeToQuasiOmniBeamformingVector ();
     }
 
   return varTtiPeriod;
@@ -1292,22 +1377,12 @@ NrGnbPhy::UlData(const std::shared_ptr<DciInfoElementTdma> &dci)
                                                         dci->m_symStart, dci->m_numSym, m_currentSlot);
      }
 
-  bool found = false;
-  for (uint8_t i = 0; i < m_deviceMap.size (); i++)
-    {
-      Ptr<NrUeNetDevice> ueDev = DynamicCast < NrUeNetDevice > (m_deviceMap.at (i));
-      uint64_t ueRnti = (DynamicCast<NrUePhy>(ueDev->GetPhy (GetBwpId ())))->GetRnti ();
-      if (dci->m_rnti == ueRnti)
-        {
-          // Even if we change the beamforming vector, we hope that the scheduler
-          // has scheduled UEs within the same beam (and, therefore, have the same
-          // beamforming vector)
-          ChangeBeamformingVector (m_deviceMap.at (i)); //assume the control signal is omni
-          found = true;
-          break;
-        }
-    }
-  NS_ASSERT (found);
+  size_t i = GetUeIndex (dci->m_rnti);
+  NS_ASSERT (i < m_deviceMap.size ());
+  // Even if we change the beamforming vector, we hope that the scheduler
+  // has scheduled UEs within the same beam (and, therefore, have the same
+  // beamforming vector)
+  ChangeBeamformingVector (m_deviceMap.at (i)); //assume the control signal is omni
 
   NS_LOG_INFO ("GNB RXing UL DATA frame " << m_currentSlot <<
                 " symbols "  << static_cast<uint32_t> (dci->m_symStart) <<
@@ -1325,6 +1400,7 @@ NrGnbPhy::ChangeBeamformingVector (Ptr<NetDevice> dev)
     {
       m_spectrumPhys.at (streamIndex)->GetBeamManager ()->ChangeBeamformingVector (dev);
     }
+  m_isQuasiOmni = false;
 }
 
 
@@ -1335,6 +1411,7 @@ NrGnbPhy::ChangeToQuasiOmniBeamformingVector ()
     {
       m_spectrumPhys.at (streamIndex)->GetBeamManager ()->ChangeToQuasiOmniBeamformingVector ();
     }
+  m_isQuasiOmni = true;
 }
 
 Time
@@ -1352,27 +1429,22 @@ NrGnbPhy::UlSrs (const std::shared_ptr<DciInfoElementTdma> &dci)
       m_spectrumPhys.at(streamIndex)->AddExpectedSrsRnti (dci->m_rnti);
     }
 
-  bool found = false;
+  size_t i = GetUeIndex (dci->m_rnti);
+  bool found = i < m_deviceMap.size ();
   uint16_t notValidRntiCounter = 0; // count if there are in the list of devices without initialized RNTI (rnti = 0)
                                     // if yes, and the rnti for the current SRS is not found in the list,
                                     // the code will not abort
-  for (uint8_t i = 0; i < m_deviceMap.size (); i++)
+  if (found)
     {
-      Ptr<NrUeNetDevice> ueDev = DynamicCast < NrUeNetDevice > (m_deviceMap.at (i));
-      uint64_t ueRnti = (DynamicCast<NrUePhy>(ueDev->GetPhy (0)))->GetRnti ();
-      if (ueRnti == 0)
-        {
-          notValidRntiCounter++;
-        }
-      if (dci->m_rnti == ueRnti)
-        {
-          // Even if we change the beamforming vector, we hope that the scheduler
-          // has scheduled UEs within the same beam (and, therefore, have the same
-          // beamforming vector)
-          ChangeBeamformingVector (m_deviceMap.at (i)); //assume the control signal is omni
-          found = true;
-          break;
-        }
+      // Even if we change the beamforming vector, we hope that the scheduler
+      // has scheduled UEs within the same beam (and, therefore, have the same
+      // beamforming vector)
+      ChangeBeamformingVector (m_deviceMap.at (i)); //assume the control signal is omni
+    }
+  else
+    {
+      notValidRntiCounter = std::count_if (m_uePhyMap.begin (), m_uePhyMap.end (),
+                                           [] (const Ptr<NrUePhy> &phy) { return phy->GetRnti () == 0; });
     }
 
   NS_ABORT_MSG_IF (!found && (notValidRntiCounter == 0), "All RNTIs are already set (all UEs received RAR message), "
@@ -1395,7 +1467,10 @@ void
 NrGnbPhy::StartVarTti (const std::shared_ptr<DciInfoElementTdma> &dci)
 {
   NS_LOG_FUNCTION (this);
-  ChangeToQuasiOmniBeamformingVector (); //assume the control signal is omni
+  if (dci->m_type != DciInfoElementTdma::DATA || dci->m_format != DciInfoElementTdma::DL)
+    {
+      ChangeToQuasiOmniBeamformingVector (); //assume the control signal is omni
+    }
   m_currSymStart = dci->m_symStart;
 
   Time varTtiPeriod;
@@ -1428,17 +1503,9 @@ NrGnbPhy::StartVarTti (const std::shared_ptr<DciInfoElementTdma> &dci)
       varTtiPeriod = UlSrs (dci);
     }
 
-  Simulator::Schedule (varTtiPeriod, &NrGnbPhy::EndVarTti, this, dci);
-}
-
-void
-NrGnbPhy::EndVarTti (const std::shared_ptr<DciInfoElementTdma> &lastDci)
-{
-  NS_LOG_FUNCTION (this << Simulator::Now ().GetSeconds ());
-
-  NS_LOG_DEBUG ("DCI started at symbol " << static_cast<uint32_t> (lastDci->m_symStart) <<
-                " which lasted for " << static_cast<uint32_t> (lastDci->m_numSym) <<
-                " symbols finished");
+  NS_LOG_DEBUG ("DCI started at symbol " << static_cast<uint32_t> (dci->m_symStart) <<
+                " lasts for " << static_cast<uint32_t> (dci->m_numSym) <<
+                " symbols, until " << Simulator::Now () + varTtiPeriod);
 }
 
 void
@@ -1457,7 +1524,15 @@ NrGnbPhy::EndSlot (void)
 
   NS_LOG_DEBUG ("Slot started at " << m_lastSlotStart << " ended");
   m_currentSlot.Add (1);
-  Simulator::Schedule (slotStart, &NrGnbPhy::StartSlot, this, m_currentSlot);
+  if (m_slotClock != nullptr)
+    {
+      m_slotClock->Schedule (slotStart, NrSlotClock::START_SLOT,
+                             std::bind (&NrGnbPhy::StartSlot, this, m_currentSlot));
+    }
+  else
+    {
+      Simulator::Schedule (slotStart, &NrGnbPhy::StartSlot, this, m_currentSlot);
+    }
 }
 
 void
@@ -1467,27 +1542,16 @@ NrGnbPhy::SendDataChannels (const Ptr<PacketBurst> &pb, const Time &varTtiPeriod
 {
   NS_LOG_FUNCTION (this);
   // update beamforming vectors (currently supports 1 user only)
-  bool found = false;
-  for (uint8_t i = 0; i < m_deviceMap.size (); i++)
-    {
-      Ptr<NrUeNetDevice> ueDev = DynamicCast<NrUeNetDevice> (m_deviceMap.at (i));
-      uint64_t ueRnti = (DynamicCast<NrUePhy>(ueDev->GetPhy (GetBwpId ())))->GetRnti ();
-      //NS_LOG_INFO ("Scheduled rnti:"<<rnti <<" ue rnti:"<< ueRnti);
-      if (dci->m_rnti == ueRnti)
-        {
-          ChangeBeamformingVector(m_deviceMap.at (i));
-          found = true;
-          break;
-        }
-    }
-  NS_ABORT_IF (!found);
+  size_t i = GetUeIndex (dci->m_rnti);
+  NS_ABORT_IF (i >= m_deviceMap.size ());
+  ChangeBeamformingVector (m_deviceMap.at (i));
 
 
   // in the map we stored the RBG allocated by the MAC for this symbol.
   // If the transmission last n symbol (n > 1 && n < 12) the SetSubChannels
   // doesn't need to be called again. In fact, SendDataChannels will be
   // invoked only when the symStart changes.
-  NS_ASSERT (m_rbgAllocationPerSym.find(dci->m_symStart) != m_rbgAllocationPerSym.end ());
+  NS_ASSERT (m_rbgAllocationPerSym.IsUsed (dci->m_symStart));
 
   uint8_t activeStreams = 0;
   for (const auto& tbSize : dci->m_tbSize)
@@ -1497,7 +1561,7 @@ NrGnbPhy::SendDataChannels (const Ptr<PacketBurst> &pb, const Time &varTtiPeriod
           activeStreams++;
         }
     }
-  SetSubChannels (FromRBGBitmaskToRBAssignment (m_rbgAllocationPerSym.at (dci->m_symStart)), activeStreams);
+  SetSubChannels (m_rbgAllocationPerSym.GetRbMask (dci->m_symStart, GetNumRbPerRbg ()), activeStreams);
 
   std::list<Ptr<NrControlMessage> > ctrlMsgs;
   m_spectrumPhys.at (streamId)->StartTxDataFrames (pb, ctrlMsgs, varTtiPeriod);
@@ -1508,12 +1572,7 @@ NrGnbPhy::SendCtrlChannels (const Time &varTtiPeriod)
 {
   NS_LOG_FUNCTION (this << "Send Ctrl");
 
-  std::vector <int> fullBwRb (GetRbNum ());
-  // The first time set the right values for the phy
-  for (uint32_t i = 0; i < fullBwRb.size (); ++i)
-    {
-      fullBwRb[i] = static_cast<int> (i);
-    }
+  NrRbMask fullBwRb (GetRbNum (), true);
 
   // Currently all DL CTRL is sent only through one stream
   SetSubChannels (fullBwRb, 1);
@@ -1522,6 +1581,41 @@ NrGnbPhy::SendCtrlChannels (const Time &varTtiPeriod)
   m_ctrlMsgs.clear ();
 }
 
+size_t
+NrGnbPhy::GetUeIndex (uint16_t rnti) const
+{
+  auto it = m_rntiToUe.find (rnti);
+  if (it != m_rntiToUe.end () && m_uePhyMap.at (it->second)->GetRnti () == rnti)
+    {
+      return it->second;
+    }
+
+  // The RNTI of the UEs change only in events of the UEs: if the index has
+  // already been rebuilt at this time, the RNTI is still unknown (e.g., the
+  // UE did not receive the RAR yet, and the MAC asks its beam in each slot)
+  if (m_rntiToUeUpdate == Simulator::Now ())
+    {
+      return m_deviceMap.size ();
+    }
+
+  // The UE got its RNTI (or a new one) after the last update: rebuild the
+  // index from the RNTI of all the UEs
+  NS_LOG_INFO ("RNTI " << rnti << " not in the index, updating it");
+  m_rntiToUeUpdate = Simulator::Now ();
+  m_rntiToUe.clear ();
+  for (size_t i = 0; i < m_uePhyMap.size (); ++i)
+    {
+      uint16_t ueRnti = m_uePhyMap.at (i)->GetRnti ();
+      if (ueRnti != 0)
+        {
+          m_rntiToUe[ueRnti] = i;
+        }
+    }
+
+  it = m_rntiToUe.find (rnti);
+  return it != m_rntiToUe.end () ? it->second : m_deviceMap.size ();
+}
+
 bool
 NrGnbPhy::RegisterUe (uint64_t imsi, const Ptr<NrUeNetDevice> &ueDevice)
 {
@@ -1533,6 +1627,9 @@ NrGnbPhy::RegisterUe (uint64_t imsi, const Ptr<NrUeNetDevice> &ueDevice)
     {
       m_ueAttached.insert (imsi);
       m_deviceMap.push_back (ueDevice);
+      m_uePhyMap.push_back (DynamicCast<NrUePhy> (ueDevice->GetPhy (GetBwpId ())));
+      NS_ASSERT (m_uePhyMap.back () != nullptr);
+      m_rntiToUeUpdate = Time::Min ();
       return (true);
     }
   else
@@ -1666,6 +1763,7 @@ NrGnbPhy::DoRemoveUe (uint16_t rnti)
   if (it != m_ueAttachedRnti.end ())
     {
       m_ueAttachedRnti.erase (it);
+      m_rntiToUe.erase (rnti);
     }
   else
     {
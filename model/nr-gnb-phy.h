@@ -24,8 +24,10 @@
 #include <ns3/lte-enb-cphy-sap.h>
 #include <ns3/nr-harq-phy.h>
 #include <functional>
+#include <unordered_map>
 #include "ns3/ideal-beamforming-algorithm.h"
 #include "beam-conf-id.h"
+#include "nr-slot-rbg-grid.h"
 
 namespace ns3 {
 
@@ -219,12 +221,12 @@ public:
   virtual double GetTxPower () const override;
 
   /**
-   * \brief Set the Tx power spectral density based on the RB index vector
-   * \param rbIndexVector vector of the index of the RB (in SpectrumValue array)
+   * \brief Set the Tx power spectral density based on the RB mask
+   * \param rbMask mask of the RB (in SpectrumValue array)
    * in which there is a transmission
    * \param activeStreams the number of active streams
    */
-  void SetSubChannels (const std::vector<int> &rbIndexVector, uint8_t activeStreams);
+  void SetSubChannels (const NrRbMask &rbMask, uint8_t activeStreams);
 
   /**
    * \brief Add the UE to the list of this gnb UEs.
@@ -379,12 +381,12 @@ public:
    *
    * \param [in] sfnSf Slot number
    * \param [in] sym Symbol
-   * \param [in] rbMap RB Map, in the spectrum format (vector of indexes of the active RB)
+   * \param [in] rbMap RB Map, in the spectrum format (mask of the active RB)
    * \param [in] bwpId BWP ID
    * \param [in] cellId Cell ID
    */
   typedef void (* RBStatsTracedCallback)(const SfnSf &sfnSf, uint8_t sym,
-                                         const std::vector<int> &rbMap,
+                                         const NrRbMask &rbMap,
                                          uint16_t bwpId, uint16_t cellId);
 
   /**
@@ -450,8 +452,11 @@ private:
    * This time can be a DL CTRL, a DL data, a UL data, or UL CTRL, with
    * any number of symbols (limited to the number of symbols per slot).
    *
-   * At the end of processing, schedule the method EndVarTtti that will finish
-   * the processing of the variable tti allocation.
+   * The method is called at the time the variable TTI starts, except for DL
+   * data, for which it is called when the data transmission starts (1 ns
+   * later, see DlData). Nothing is scheduled at the end of the variable
+   * TTI: the transmissions end by themselves, and the slot end is
+   * scheduled by StartSlot.
    *
    * \see DlCtrl
    * \see UlCtrl
@@ -460,20 +465,6 @@ private:
    */
   void StartVarTti (const std::shared_ptr<DciInfoElementTdma> &dci);
 
-  /**
-   * \brief End the processing of a variable tti
-   * \param lastDci the DCI of the variable TTI that has just passed
-   *
-   * The end of the variable tti indicates that the allocation has been
-   * transmitted/received. Depending on the variable tti left, the method
-   * will schedule another var tti (StartVarTti()) or will wait until the
-   * end of the slot (EndSlot()).
-   *
-   * \see StartVarTti
-   * \see EndSlot
-   */
-  void EndVarTti (const std::shared_ptr<DciInfoElementTdma> &lastDci);
-
   /**
    * \brief Transmit to the spectrum phy the data stored in pb
    *
@@ -540,7 +531,10 @@ private:
    * \param varTtiInfo the current varTti
    * \return the time at which the transmission of DL data will end
    *
-   * The method will get the data to transmit, and call SendDataChannels.
+   * The method will get the data to transmit, and call SendDataChannels for
+   * each stream that has data. It is called 1 ns after the start of the
+   * variable TTI, so that the transmission starts after the end of the
+   * previous one, and the transmission lasts the variable TTI minus 2 ns.
    *
    * \see SendDataChannels
    */
@@ -588,6 +582,16 @@ private:
    */
   void DoStartSlot ();
 
+  /**
+   * \brief Ask the MAC for the slot indications, and then start the slot
+   *
+   * If the schedulers compute the triggers in NrMacSchedulerSlotDispatcher,
+   * the decisions are indicated to the MAC in an event scheduled for now:
+   * the slot is then started after it, as the MAC enqueues with the
+   * decisions the CTRL messages (e.g., the RAR) to send in this slot.
+   */
+  void CallMacAndStartSlot ();
+
   void GenerateAllocationStatistics (const SlotAllocInfo &allocInfo) const;
 
   // LteEnbCphySapProvider forwarded methods
@@ -602,15 +606,6 @@ private:
   void DoSetSystemInformationBlockType1 (LteRrcSap::SystemInformationBlockType1 sib1);
   void DoSetEarfcn (uint16_t Earfcn );
 
-  /**
-   * \brief Store the RBG allocation in the symStart, rbg map.
-   * \param map the MAP
-   * \param dci DCI
-   *
-   */
-  void StoreRBGAllocation (std::unordered_map<uint8_t, std::vector<uint8_t> > *map,
-                           const std::shared_ptr<DciInfoElementTdma> &dci) const;
-
   /**
    * \brief Generate the generate/send DCI structures from a pattern
    * \param pattern The pattern to analyze
@@ -703,9 +698,46 @@ private:
 
   /**
    * \brief Prepare and schedule all the events needed for the current slot.
+   *
+   * The timeline of the slot is computed here: a single event (StartVarTti)
+   * is scheduled for each variable TTI, at the time its transmission or
+   * reception starts.
    */
   void FillTheEvent ();
 
+  /**
+   * \brief Schedule the events of a slot that contains only CTRL allocations
+   *
+   * The slot is handled with a single event (see CtrlOnlySlot) instead of a
+   * StartVarTti event for each CTRL allocation.
+   */
+  void FillTheCtrlOnlyEvent ();
+
+  /**
+   * \brief Handle a slot that contains only CTRL allocations
+   * \param dlCtrl the DL CTRL DCI of the slot, or nullptr
+   * \param hasUlCtrl true if the slot has an UL CTRL allocation
+   *
+   * If there are CTRL messages to send, the DL CTRL is transmitted as in
+   * the normal path (StartVarTti); otherwise, nothing is transmitted. The
+   * beamforming vector is moved to quasi-omni only if it is not already
+   * there and the slot has something to receive or transmit.
+   */
+  void CtrlOnlySlot (const std::shared_ptr<DciInfoElementTdma> &dlCtrl, bool hasUlCtrl);
+
+  /**
+   * \brief Find a registered UE by its RNTI
+   * \param rnti the RNTI of the UE
+   * \return the index of the UE in m_deviceMap (and m_uePhyMap), or
+   * m_deviceMap.size () if no registered UE has that RNTI
+   *
+   * The RNTI is assigned to the UE after its registration (and changes
+   * with a handover), so the index m_rntiToUe is checked against the RNTI of
+   * the UE PHY, and rebuilt when a RNTI is not found or not valid anymore,
+   * at most once for each simulation time.
+   */
+  size_t GetUeIndex (uint16_t rnti) const;
+
 private:
   NrGnbPhySapUser* m_phySapUser {nullptr};           //!< MAC SAP user pointer, MAC is user of services of PHY, implements e.g. ReceiveRachPreamble
   LteEnbCphySapProvider* m_enbCphySapProvider {nullptr}; //!< PHY SAP provider pointer, PHY provides control services to RRC, RRC can call e.g SetBandwidth
@@ -714,12 +746,16 @@ private:
   std::set <uint64_t> m_ueAttached; //!< Set of attached UE (by IMSI)
   std::set <uint16_t> m_ueAttachedRnti; //!< Set of attached UE (by RNTI)
   std::vector< Ptr<NrUeNetDevice> > m_deviceMap; //!< Vector of UE devices
+  std::vector< Ptr<NrUePhy> > m_uePhyMap; //!< PHY of the UE devices in this BWP, same position of m_deviceMap
+  mutable std::unordered_map<uint16_t, size_t> m_rntiToUe; //!< Position in m_deviceMap of the UE with a RNTI
+  mutable Time m_rntiToUeUpdate {Time::Min ()}; //!< Time of the last rebuild of m_rntiToUe
 
   LteRrcSap::SystemInformationBlockType1 m_sib1; //!< SIB1 message
   Time m_lastSlotStart; //!< Time at which the last slot started
   uint8_t m_currSymStart {0}; //!< Symbol at which the current allocation started
-  std::unordered_map<uint8_t, std::vector<uint8_t> > m_rbgAllocationPerSym;  //!< RBG allocation in each sym
-  std::unordered_map<uint8_t, std::vector<uint8_t> > m_rbgAllocationPerSymDataStat;  //!< RBG allocation in each sym, for statistics (UL and DL included, only data)
+  bool m_isQuasiOmni {false}; //!< True if the last beamforming vector set is the quasi-omni one
+  NrSlotRbgGrid m_rbgAllocationPerSym;  //!< DL RBG allocation of the slot, in the row of the start symbol of each allocation
+  NrSlotRbgGrid m_rbgAllocationPerSymDataStat;  //!< RBG allocation of the slot, in the row of the start symbol of each allocation, for statistics (UL and DL included, only data)
 
   TracedCallback< uint64_t, SpectrumValue&, SpectrumValue& > m_ulSinrTrace; //!< SINR trace
 
@@ -746,7 +782,7 @@ private:
    */
   TracedCallback<const SfnSf &, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint16_t, uint16_t> m_phySlotDataStats;
 
-  TracedCallback<const SfnSf &, uint8_t, const std::vector<int>&, uint16_t, uint16_t> m_rbStatistics;
+  TracedCallback<const SfnSf &, uint8_t, const NrRbMask&, uint16_t, uint16_t> m_rbStatistics;
 
   std::map<uint32_t, std::vector<uint32_t>> m_toSendDl; //!< Map that indicates, for each slot, what DL DCI we have to send
   std::map<uint32_t, std::vector<uint32_t>> m_toSendUl; //!< Map that indicates, for each slot, what UL DCI we have to send
@@ -333,7 +333,7 @@ NrLteMiErrorModel::GetInstanceTypeId() const
 }
 
 double
-NrLteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
+NrLteMiErrorModel::Mib (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
 
@@ -341,9 +341,9 @@ NrLteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map,
   double MIsum = 0.0;
   SpectrumValue sinrCopy = sinr;
 
-  for (uint32_t i = 0; i < map.size (); i++)
+  for (uint32_t rb : map)
     {
-      double sinrLin = sinrCopy[map.at (i)];
+      double sinrLin = sinrCopy[rb];
       if (mcs <= MI_QPSK_MAX_ID) // QPSK
         {
 
@@ -408,16 +408,17 @@ NrLteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map,
                 }
             }
         }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
+      NS_LOG_LOGIC (" RB " << rb << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
       MIsum += MI;
     }
-  if (map.size () == 0)
+  uint32_t rbNum = map.Count ();
+  if (rbNum == 0)
     {
       MI = 0;
     }
   else
     {
-      MI = MIsum / map.size ();
+      MI = MIsum / rbNum;
     }
 
   NS_LOG_LOGIC (" MI = " << MI);
@@ -471,7 +472,7 @@ NrLteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint32_t cbSize)
 
 Ptr<NrErrorModelOutput>
 NrLteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr,
-                                             const std::vector<int>& map,
+                                             const NrRbMask &map,
                                              uint32_t size, uint8_t mcs,
                                              const NrErrorModel::NrErrorModelHistory &history)
 {
@@ -480,7 +481,7 @@ NrLteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr,
 
 Ptr<NrErrorModelOutput>
 NrLteMiErrorModel::GetTbBitDecodificationStats (const SpectrumValue& sinr,
-                                                const std::vector<int>& map,
+                                                const NrRbMask &map,
                                                 uint32_t size, uint8_t mcs,
                                                 const NrErrorModel::NrErrorModelHistory &history)
 {
@@ -105,7 +105,7 @@ public:
    * MI, code bits, and info bits.
    */
   virtual Ptr<NrErrorModelOutput> GetTbDecodificationStats (const SpectrumValue& sinr,
-                                                            const std::vector<int>& map,
+                                                            const NrRbMask &map,
                                                             uint32_t size, uint8_t mcs,
                                                             const NrErrorModelHistory &history) override;
 
@@ -142,7 +142,7 @@ private:
    * MI, code bits, and info bits.
    */
   virtual Ptr<NrErrorModelOutput> GetTbBitDecodificationStats (const SpectrumValue& sinr,
-                                                               const std::vector<int>& map,
+                                                               const NrRbMask &map,
                                                                uint32_t size, uint8_t mcs,
                                                                const NrErrorModelHistory &history);
 
@@ -155,7 +155,7 @@ private:
    * \param mcs the MCS of the TB
    * \return the mmib
    */
-  static double Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs);
+  static double Mib (const SpectrumValue& sinr, const NrRbMask &map, uint8_t mcs);
 
   /**
    * \brief map the mmib (mean mutual information per bit) into CBLER for
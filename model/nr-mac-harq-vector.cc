@@ -23,18 +23,15 @@ namespace ns3 {
 bool
 NrMacHarqVector::Erase (uint8_t id)
 {
-  at (id).Erase ();
+  NS_ASSERT (Exist (id));
+  uint64_t bit = uint64_t {1} << id;
+  NS_ABORT_IF ((m_freeMask & bit) != 0);
+
+  m_processes[id].second.Erase ();
+  m_freeMask |= bit;
   --m_usedSize;
 
-  uint32_t count = 0;
-  for (const auto & v : *this)
-    {
-      if (v.second.m_active)
-        {
-          ++count;
-        }
-    }
-  NS_ASSERT (count == m_usedSize);
+  NS_ASSERT (m_maxSize - static_cast<uint32_t> (__builtin_popcountll (m_freeMask)) == m_usedSize);
   return true;
 }
 
@@ -54,10 +51,11 @@ NrMacHarqVector::Insert (uint8_t *id, const HarqProcess& element)
       return false;
     }
 
-  NS_ABORT_IF (at (*id).m_active == true);
-  at (*id) = element;
+  HarqProcess &process = m_processes[*id].second;
+  NS_ABORT_IF (process.m_active == true);
+  process = element;
 
-  NS_ABORT_IF (at (*id).m_active == false);
+  m_freeMask &= ~(uint64_t {1} << *id);
   NS_ABORT_IF (this->FirstAvailableId () == *id);
 
   ++m_usedSize;
@@ -67,7 +65,7 @@ NrMacHarqVector::Insert (uint8_t *id, const HarqProcess& element)
 std::ostream &
 operator<< (std::ostream & os, NrMacHarqVector const & item)
 {
-  for (const auto & p : item)
+  for (const auto & p : item.m_processes)
     {
       os << "Process ID " << static_cast<uint32_t> (p.first)
          << ": " << p.second << std::endl;
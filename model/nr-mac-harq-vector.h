@@ -18,7 +18,8 @@
  */
 #pragma once
 
-#include <unordered_map>
+#include <vector>
+#include <ns3/abort.h>
 #include "nr-mac-harq-process.h"
 
 namespace ns3 {
@@ -27,29 +28,36 @@ namespace ns3 {
  * \ingroup scheduler
  * \brief Data structure to save all the HARQ process of an UE
  *
- * The data is stored as an unordered_map between the process ID and the
- * real data, saved in the structure HarqProcess. The vector (yes, it is an
- * improper name) is always full (i.e., it always contains almost 20 HARQ processes)
- * but they can be inactive (i.e., no data is stored there). The duty of finding
- * an empty spot is split between Insert and FirstAvailableId.
+ * The processes are stored in a vector indexed by the process ID, as pairs
+ * between the ID and the real data, saved in the structure HarqProcess. The
+ * vector is always full (i.e., it always contains almost 20 HARQ processes)
+ * but they can be inactive (i.e., no data is stored there). A bit mask
+ * keeps track of the inactive processes, so that Insert and
+ * FirstAvailableId find an empty spot in constant time: it is always the
+ * inactive process with the lowest ID.
  *
  * The class does not support going "out of space", or in other words, if all
  * the spots are filled with active processes, the next insert will fail.
+ * The number of processes is limited to 64.
+ *
+ * The vector also remembers the processes for which a feedback has been
+ * seen (MarkFeedback), to discard duplicated feedbacks without building
+ * other containers.
  *
  * \see HarqProcess
  */
-class NrMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
+class NrMacHarqVector
 {
 public:
   friend std::ostream &  operator<< (std::ostream & os, NrMacHarqVector const & item);
   /**
-   * \brief iterator of the map
+   * \brief iterator of the vector
    */
-  typedef typename std::unordered_map<uint8_t, HarqProcess>::iterator iterator;
+  typedef typename std::vector<std::pair<const uint8_t, HarqProcess> >::iterator iterator;
   /**
-   * \brief const_iterator of the map
+   * \brief const_iterator of the vector
    */
-  typedef typename std::unordered_map<uint8_t, HarqProcess>::const_iterator const_iterator;
+  typedef typename std::vector<std::pair<const uint8_t, HarqProcess> >::const_iterator const_iterator;
 
   /**
     * \brief Default constructor
@@ -64,12 +72,17 @@ public:
    */
   void SetMaxSize (uint8_t size)
   {
+    NS_ABORT_MSG_IF (size > 64, "The maximum number of HARQ processes is 64");
     m_maxSize = size;
-    reserve (size);
+    m_usedSize = 0;
+    m_processes.clear ();
+    m_processes.reserve (size);
     for (auto i = 0; i < size; ++i)
       {
-        emplace (i, HarqProcess ());
+        m_processes.emplace_back (i, HarqProcess ());
       }
+    m_freeMask = size == 64 ? ~uint64_t {0} : (uint64_t {1} << size) - 1;
+    m_feedbackMask = 0;
   }
 
   /**
@@ -95,7 +108,7 @@ public:
   const iterator
   Find (uint8_t key)
   {
-    return this->find (key);
+    return Exist (key) ? m_processes.begin () + key : m_processes.end ();
   }
   /**
    * \brief Begin of the vector
@@ -104,7 +117,7 @@ public:
   const iterator
   Begin ()
   {
-    return this->begin ();
+    return m_processes.begin ();
   }
   /**
    * \brief End of the vector
@@ -113,7 +126,7 @@ public:
   const iterator
   End ()
   {
-    return this->end ();
+    return m_processes.end ();
   }
   /**
    * \brief Const begin of the vector
@@ -122,7 +135,7 @@ public:
   const_iterator
   CBegin ()
   {
-    return this->cbegin ();
+    return m_processes.cbegin ();
   }
   /**
    * \brief Const end of the vector
@@ -131,7 +144,7 @@ public:
   const_iterator
   CEnd ()
   {
-    return this->cend ();
+    return m_processes.cend ();
   }
   /**
    * \brief Check if the ID exists in the map
@@ -141,8 +154,7 @@ public:
    */
   bool Exist (uint8_t id) const
   {
-    // could be id > max_size?
-    return find (id) != end ();
+    return id < m_processes.size ();
   }
   /**
    * \brief Get a reference to a process
@@ -152,7 +164,7 @@ public:
   HarqProcess & Get (uint8_t id)
   {
     NS_ASSERT (Exist (id));
-    return find (id)->second;
+    return m_processes[id].second;
   }
   /**
    * \brief Get a const reference to a process
@@ -162,7 +174,7 @@ public:
   const HarqProcess & Get (uint8_t id) const
   {
     NS_ASSERT (Exist (id));
-    return find (id)->second;
+    return m_processes[id].second;
   }
   /**
    * \brief Find the first (INACTIVE) ID
@@ -170,14 +182,11 @@ public:
    */
   uint8_t FirstAvailableId () const
   {
-    for (const auto & it : *this)
+    if (m_freeMask == 0)
       {
-        if (!it.second.m_active)
-          {
-            return it.first;
-          }
+        return 255;
       }
-    return 255;
+    return static_cast<uint8_t> (__builtin_ctzll (m_freeMask));
   }
   /**
    * \brief Can an ID be inserted?
@@ -195,8 +204,33 @@ public:
   {
     return m_usedSize;
   }
+  /**
+   * \brief Remember that a feedback for a process has been seen
+   * \param id ID of the process
+   * \return false if a feedback for the same process was already seen
+   *
+   * The marks are kept until ClearFeedbackMarks() is called.
+   */
+  bool MarkFeedback (uint8_t id)
+  {
+    NS_ASSERT (Exist (id));
+    uint64_t bit = uint64_t {1} << id;
+    bool firstTime = (m_feedbackMask & bit) == 0;
+    m_feedbackMask |= bit;
+    return firstTime;
+  }
+  /**
+   * \brief Forget all the feedbacks marked with MarkFeedback()
+   */
+  void ClearFeedbackMarks ()
+  {
+    m_feedbackMask = 0;
+  }
 
 private:
+  std::vector<std::pair<const uint8_t, HarqProcess> > m_processes; //!< Processes, indexed by their ID
+  uint64_t m_freeMask     {0}; //!< Bit i set if the process i is INACTIVE
+  uint64_t m_feedbackMask {0}; //!< Bit i set if a feedback for the process i has been seen
   uint8_t m_maxSize  {0}; //!< Maximum size (or the number of processes stored)
   uint8_t m_usedSize {0}; //!< Number of ACTIVE processes
 };
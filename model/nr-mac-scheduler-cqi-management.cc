@@ -35,23 +35,51 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerCQIManagement");
 
 void
-NrMacSchedulerCQIManagement::DlSBCQIReported ([[maybe_unused]]const DlCqiInfo &info,
-                                              [[maybe_unused]] const std::shared_ptr<NrMacSchedulerUeInfo>&ueInfo) const
+NrMacSchedulerCQIManagement::DlSBCQIReported (const DlCqiInfo &info,
+                                              const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
+                                              uint32_t expirationTime, int8_t maxDlMcs) const
 {
   NS_LOG_INFO (this);
-  // TODO
+  NS_ASSERT (info.m_sbCqi.size () == info.m_wbCqi.size ());
+
+  DlWBCQIReported (info, ueInfo, expirationTime, maxDlMcs);
+
+  ueInfo->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::SB;
+  ueInfo->m_dlCqi.m_sbCqi = info.m_sbCqi;
+  ueInfo->m_dlCqi.m_sbMcs.resize (info.m_wbCqi.size ());
+
+  for (uint8_t stream = 0; stream < info.m_wbCqi.size (); stream++)
+    {
+      for (uint8_t code = 0; code < NrSubbandCqi::NUM_CODES; code++)
+        {
+          if (info.m_wbCqi.at (stream) == 0)
+            {
+              // As for the WB CQI, MCS 0 for CQI 0
+              ueInfo->m_dlCqi.m_sbMcs.at (stream).at (code) = 0;
+              continue;
+            }
+          int cqi = info.m_wbCqi.at (stream) + NrSubbandCqi::DecodeOffset (code);
+          cqi = std::max (1, std::min (15, cqi));
+          ueInfo->m_dlCqi.m_sbMcs.at (stream).at (code) =
+            std::min (static_cast<uint8_t> (GetAmcDl ()->GetMcsFromCqi (cqi)),
+                      static_cast<uint8_t> (maxDlMcs));
+        }
+      NS_LOG_INFO ("Updated SB CQI of UE " << ueInfo->m_rnti
+                   << " stream index " << static_cast<uint16_t> (stream)
+                   << " with " << info.m_sbCqi.at (stream).GetNumSubbands () << " subbands");
+    }
 }
 
 void
 NrMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime, [[maybe_unused]] uint32_t tbs,
                                               const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params,
                                               const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
-                                              const std::vector<uint8_t> &rbgMask,
+                                              const NrRbMask &rbgMask,
                                               uint32_t numRbPerRbg,
                                               const Ptr<const SpectrumModel> &model) const
 {
   NS_LOG_INFO (this);
-  NS_ASSERT (rbgMask.size () > 0);
+  NS_ASSERT (rbgMask.GetSize () > 0);
 
   NS_LOG_INFO ("Computing SB CQI for UE " << ueInfo->m_rnti);
 
@@ -59,18 +87,8 @@ NrMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime, [[maybe_u
   ueInfo->m_ulCqi.m_cqiType = NrMacSchedulerUeInfo::CqiInfo::SB;
   ueInfo->m_ulCqi.m_timer = expirationTime;
 
-  std::vector<int> rbAssignment (params.m_ulCqi.m_sinr.size (), 0);
-
-  for (uint32_t i = 0; i < rbgMask.size (); ++i)
-    {
-      if (rbgMask.at (i) == 1)
-        {
-          for (uint32_t k = 0; k < numRbPerRbg; ++k)
-            {
-              rbAssignment[i * numRbPerRbg + k] = 1;
-            }
-        }
-    }
+  const NrRbMask rbAssignment = rbgMask.ExpandRbgToRb (numRbPerRbg);
+  NS_ASSERT (rbAssignment.GetSize () <= params.m_ulCqi.m_sinr.size ());
 
   SpectrumValue specVals (model);
   Values::iterator specIt = specVals.ValuesBegin ();
@@ -80,7 +98,7 @@ NrMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime, [[maybe_u
   for (uint32_t ichunk = 0; ichunk < model->GetNumBands (); ichunk++)
     {
       NS_ASSERT (specIt != specVals.ValuesEnd ());
-      if (rbAssignment[ichunk] == 1)
+      if (ichunk < rbAssignment.GetSize () && rbAssignment.IsSet (ichunk))
         {
           *specIt = ueInfo->m_ulCqi.m_sinr.at (ichunk);
           out << ueInfo->m_ulCqi.m_sinr.at (ichunk) << " ";
@@ -213,6 +231,7 @@ NrMacSchedulerCQIManagement::RefreshDlCqiMaps (const std::unordered_map<uint16_t
       if (ue->m_dlCqi.m_timer == 0)
         {
           ue->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::WB;
+          ue->m_dlCqi.m_sbCqi.clear ();
           for (uint8_t stream = 0; stream < ue->m_dlCqi.m_wbCqi.size (); stream++)
             {
               ue->m_dlCqi.m_wbCqi.at (stream) = 1; // lowest value for trying a transmission
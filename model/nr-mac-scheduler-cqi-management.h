@@ -91,13 +91,20 @@ public:
   void DlWBCQIReported (const DlCqiInfo &info, const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
                         uint32_t expirationTime, int8_t maxDlMcs) const;
   /**
-   * \brief SB CQI reported
-   * \param info SB CQI
+   * \brief A subband CQI has been reported for the specified UE
+   * \param info SB CQI (with the wideband CQI of each stream)
    * \param ueInfo UE
+   * \param expirationTime expiration time of the CQI in number of slot
+   * \param maxDlMcs maximum DL MCS index
    *
-   * NOT IMPLEMENTED
+   * The wideband part is processed by DlWBCQIReported. Then, the subband
+   * offsets are stored in the UE, together with the MCS that corresponds
+   * to each of the offsets: since there are only NrSubbandCqi::NUM_CODES
+   * codes, the MCS of a set of RBG is obtained without any AMC call (see
+   * NrMacSchedulerUeInfo::GetDlMcsOnRbg).
    */
-  void DlSBCQIReported (const DlCqiInfo &info, const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo) const;
+  void DlSBCQIReported (const DlCqiInfo &info, const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
+                        uint32_t expirationTime, int8_t maxDlMcs) const;
 
   /**
    * \brief An UL SB CQI has been reported for the specified UE
@@ -122,7 +129,7 @@ public:
   void UlSBCQIReported (uint32_t expirationTime, uint32_t tbs,
                         const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params,
                         const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
-                        const std::vector<uint8_t> &rbgMask, uint32_t numRbPerRbg,
+                        const NrRbMask &rbgMask, uint32_t numRbPerRbg,
                         const Ptr<const SpectrumModel> &model) const;
 
   /**
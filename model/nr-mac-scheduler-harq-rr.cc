@@ -105,8 +105,7 @@ uint8_t NrMacSchedulerHarqRr::ScheduleDlHarq (NrMacSchedulerNs3::PointInFTPlane
 
           auto & dciInfoReTx = harqProcess.m_dciElement;
 
-          long rbgAssigned = std::count (dciInfoReTx->m_rbgBitmask.begin (),
-                                         dciInfoReTx->m_rbgBitmask.end (), 1) * dciInfoReTx->m_numSym;
+          long rbgAssigned = static_cast<long> (dciInfoReTx->m_rbgBitmask.Count ()) * dciInfoReTx->m_numSym;
           uint32_t rbgAvail = (GetBandwidthInRbg () - startingPoint->m_rbg) * symPerBeam;
 
           NS_LOG_INFO ("Evaluating space to retransmit HARQ PID=" <<
@@ -138,14 +137,10 @@ uint8_t NrMacSchedulerHarqRr::ScheduleDlHarq (NrMacSchedulerNs3::PointInFTPlane
 
           NS_ASSERT (dciInfoReTx->m_format == DciInfoElementTdma::DL);
 
-          std::vector<uint32_t> tbSize;
-          tbSize.resize (dciInfoReTx->m_tbSize.size ());
-          std::vector<uint8_t> ndi;
-          ndi.resize (dciInfoReTx->m_ndi.size ());
-          std::vector<uint8_t> rv;
-          rv.resize (dciInfoReTx->m_rv.size ());
-          std::vector<uint8_t> mcs;
-          mcs.resize (dciInfoReTx->m_mcs.size ());
+          NrStreamArray<uint32_t> tbSize (dciInfoReTx->m_tbSize.size ());
+          NrStreamArray<uint8_t> ndi (dciInfoReTx->m_ndi.size ());
+          NrStreamArray<uint8_t> rv (dciInfoReTx->m_rv.size ());
+          NrStreamArray<uint8_t> mcs (dciInfoReTx->m_mcs.size ());
 
           for (uint8_t stream = 0; stream < dciInfoReTx->m_tbSize.size (); stream++)
             {
@@ -193,18 +188,14 @@ uint8_t NrMacSchedulerHarqRr::ScheduleDlHarq (NrMacSchedulerNs3::PointInFTPlane
               ++rbgAssigned;
             }
 
-          NS_ABORT_IF (static_cast<unsigned long> (rbgAssigned) > dciInfoReTx->m_rbgBitmask.size ());
+          NS_ABORT_IF (static_cast<unsigned long> (rbgAssigned) > dciInfoReTx->m_rbgBitmask.GetSize ());
 
-          for (unsigned int i = 0; i < dciInfoReTx->m_rbgBitmask.size (); ++i)
+          dciInfoReTx->m_rbgBitmask.SetAll (false);
+          if (startingPoint->m_rbg < dciInfoReTx->m_rbgBitmask.GetSize ())
             {
-              if (startingPoint->m_rbg <= i && i < startingPoint->m_rbg + rbgAssigned)
-                {
-                  dciInfoReTx->m_rbgBitmask.at (i) = 1;
-                }
-              else
-                {
-                  dciInfoReTx->m_rbgBitmask.at (i) = 0;
-                }
+              dciInfoReTx->m_rbgBitmask.SetRange (startingPoint->m_rbg,
+                                                  std::min (static_cast<uint32_t> (rbgAssigned),
+                                                            dciInfoReTx->m_rbgBitmask.GetSize () - startingPoint->m_rbg));
             }
 
           startingPoint->m_rbg += rbgAssigned;
@@ -315,8 +306,8 @@ NrMacSchedulerHarqRr::ScheduleUlHarq (NrMacSchedulerNs3::PointInFTPlane *startin
           NS_ASSERT_MSG (harqProcess.nackStreamIndexes.size () == 1, "MIMO is not supported for UL yet");
 
           uint8_t rvIndex = dciInfoReTx->m_rv.at (0) + 1;
-          std::vector<uint8_t> rv {rvIndex};
-          std::vector<uint8_t> ndi {0};
+          NrStreamArray<uint8_t> rv {rvIndex};
+          NrStreamArray<uint8_t> ndi {0};
 
           auto dci = std::make_shared<DciInfoElementTdma> (dciInfoReTx->m_rnti, dciInfoReTx->m_format,
                                                            startingPoint->m_sym - dciInfoReTx->m_numSym,
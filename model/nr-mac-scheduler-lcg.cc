@@ -40,35 +40,38 @@ void
 NrMacSchedulerLCG::AssignedData (uint8_t lcId, uint32_t size, std::string type)
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (m_lcMap.size () > 0);
+  NS_ASSERT (m_lcMap.GetSize () > 0);
+
+  NrMacSchedulerLC &lc = m_lcMap.At (lcId);
+  const uint32_t lcSizeBefore = lc.GetTotalSize ();
 
   // Update queues: RLC tx order Status, ReTx, Tx. To understand this, you have
   // to see RlcAm::NotifyTxOpportunity
   NS_LOG_INFO ("Status of LCID " << static_cast<uint32_t> (lcId) << ": RLCSTATUS=" <<
-               m_lcMap.at (lcId)->m_rlcStatusPduSize << ", RLC Retr=" <<
-               m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize << ", RLC TX=" <<
-               m_lcMap.at (lcId)->m_rlcTransmissionQueueSize);
+               lc.m_rlcStatusPduSize << ", RLC Retr=" <<
+               lc.m_rlcRetransmissionQueueSize << ", RLC TX=" <<
+               lc.m_rlcTransmissionQueueSize);
 
-  if ((m_lcMap.at (lcId)->m_rlcStatusPduSize > 0) && (size >= m_lcMap.at (lcId)->m_rlcStatusPduSize))
+  if ((lc.m_rlcStatusPduSize > 0) && (size >= lc.m_rlcStatusPduSize))
     {
       // Update status queue
-      m_totalSize -= m_lcMap.at (lcId)->m_rlcStatusPduSize;
-      m_lcMap.at (lcId)->m_rlcStatusPduSize = 0;
+      m_totalSize -= lc.m_rlcStatusPduSize;
+      lc.m_rlcStatusPduSize = 0;
     }
-  else if ((m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize > 0) && (size >= m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize))
+  else if ((lc.m_rlcRetransmissionQueueSize > 0) && (size >= lc.m_rlcRetransmissionQueueSize))
     {
-      if (m_totalSize < m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize)
+      if (m_totalSize < lc.m_rlcRetransmissionQueueSize)
         {
           NS_LOG_WARN ("Total ReTx queue size lower than it should be at this point. Reseting it.");
           m_totalSize = 0;
         }
       else
         {
-          m_totalSize -= m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize;
+          m_totalSize -= lc.m_rlcRetransmissionQueueSize;
         }
-        m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize = 0;
+        lc.m_rlcRetransmissionQueueSize = 0;
     }
-  else if (m_lcMap.at (lcId)->m_rlcTransmissionQueueSize > 0) // if not enough size for retransmission use if for transmission if there is any data to be transmitted
+  else if (lc.m_rlcTransmissionQueueSize > 0) // if not enough size for retransmission use if for transmission if there is any data to be transmitted
     {
       uint32_t rlcOverhead = 0;
       // The following logic of selecting the overhead is
@@ -87,31 +90,31 @@ NrMacSchedulerLCG::AssignedData (uint8_t lcId, uint32_t size, std::string type)
           rlcOverhead = 2;
         }
 
-      if (m_totalSize < m_lcMap.at (lcId)->m_rlcTransmissionQueueSize)
+      if (m_totalSize < lc.m_rlcTransmissionQueueSize)
         {
           NS_LOG_WARN ("Total Tx queue size lower than it should be at this point. Reseting it.");
           m_totalSize = 0;
         }
       else
         {
-          if (m_lcMap.at (lcId)->m_rlcTransmissionQueueSize <= size)
+          if (lc.m_rlcTransmissionQueueSize <= size)
             {
-              m_totalSize -= m_lcMap.at (lcId)->m_rlcTransmissionQueueSize;
+              m_totalSize -= lc.m_rlcTransmissionQueueSize;
             }
           else
             {
-              m_totalSize -= std::min (m_lcMap.at (lcId)->m_rlcTransmissionQueueSize, size - rlcOverhead);
+              m_totalSize -= std::min (lc.m_rlcTransmissionQueueSize, size - rlcOverhead);
             }
         }
-      if (size - rlcOverhead >= m_lcMap.at (lcId)->m_rlcTransmissionQueueSize)
+      if (size - rlcOverhead >= lc.m_rlcTransmissionQueueSize)
         {
           // we can transmit everything from the queue, reset it
-          m_lcMap.at (lcId)->m_rlcTransmissionQueueSize = 0;
+          lc.m_rlcTransmissionQueueSize = 0;
         }
       else
         {
           // not enough to empty all queue, but send what you can, this is normal situation to happen
-          m_lcMap.at (lcId)->m_rlcTransmissionQueueSize -= size - rlcOverhead;
+          lc.m_rlcTransmissionQueueSize -= size - rlcOverhead;
         }
     }
   else
@@ -119,6 +122,9 @@ NrMacSchedulerLCG::AssignedData (uint8_t lcId, uint32_t size, std::string type)
       NS_LOG_WARN (" Not reducing m_totalSize since this opportunity cannot be used, not enough bytes to perform retransmission or not active flows.");
     }
 
+  // The bytes sent are the oldest: the head of line advances
+  lc.RemoveHeadOfLine (lcSizeBefore - lc.GetTotalSize ());
+
   SanityCheck ();
 }
 
@@ -18,13 +18,276 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <deque>
 #include <memory>
+#include <ns3/abort.h>
 #include <ns3/ff-mac-common.h>
 #include <ns3/nstime.h>
 #include "nr-mac-sched-sap.h"
 
 namespace ns3 {
 
+/**
+ * \ingroup scheduler
+ * \brief Range over the ids set in a 64-bit mask, in increasing order
+ *
+ * \see NrMacSchedulerIdMap::GetIds
+ */
+class NrMacSchedulerIdRange
+{
+public:
+  /**
+   * \brief Iterator over the ids
+   */
+  class Iterator
+  {
+  public:
+    /**
+     * \brief Iterator constructor
+     * \param mask the ids still to visit
+     */
+    explicit Iterator (uint64_t mask) : m_mask (mask)
+    {
+    }
+    /**
+     * \brief Get the current id
+     * \return the lowest id still to visit
+     */
+    uint8_t operator* () const
+    {
+      return static_cast<uint8_t> (__builtin_ctzll (m_mask));
+    }
+    /**
+     * \brief Move to the next id
+     * \return the iterator
+     */
+    Iterator & operator++ ()
+    {
+      m_mask &= m_mask - 1;
+      return *this;
+    }
+    /**
+     * \brief Compare two iterators
+     * \param o the other iterator
+     * \return true if the iterators are different
+     */
+    bool operator!= (const Iterator &o) const
+    {
+      return m_mask != o.m_mask;
+    }
+  private:
+    uint64_t m_mask {0}; //!< Ids still to visit
+  };
+
+  /**
+   * \brief Range constructor
+   * \param mask a mask with the bit i set if the id i is part of the range
+   */
+  explicit NrMacSchedulerIdRange (uint64_t mask) : m_mask (mask)
+  {
+  }
+  /**
+   * \brief Iterator to the first id
+   * \return the iterator
+   */
+  Iterator begin () const
+  {
+    return Iterator (m_mask);
+  }
+  /**
+   * \brief Iterator past the last id
+   * \return the iterator
+   */
+  Iterator end () const
+  {
+    return Iterator (0);
+  }
+  /**
+   * \brief Get the number of ids in the range
+   * \return the number of ids
+   */
+  uint32_t GetSize () const
+  {
+    return static_cast<uint32_t> (__builtin_popcountll (m_mask));
+  }
+
+private:
+  uint64_t m_mask {0}; //!< The ids
+};
+
+/**
+ * \ingroup scheduler
+ * \brief Map between a small id (of a LC, or of a LCG) and its object
+ *
+ * The objects are stored in a fixed array indexed by their id, and a bit
+ * mask records which ids are present. A lookup is an array access, and
+ * iterating (over the objects, or over their ids with GetIds ()) visits the
+ * ids in increasing order without allocating memory.
+ *
+ * \tparam T type of the object (NrMacSchedulerLC or NrMacSchedulerLCG)
+ * \tparam N number of valid ids: [0, N)
+ */
+template <typename T, uint8_t N>
+class NrMacSchedulerIdMap
+{
+  static_assert (N <= 64, "The ids must fit in a 64-bit mask");
+
+public:
+  /**
+   * \brief Iterator over the objects
+   */
+  template <typename V>
+  class Iterator
+  {
+  public:
+    /**
+     * \brief Iterator constructor
+     * \param values the storage of the map
+     * \param mask the ids still to visit
+     */
+    Iterator (const std::array<std::unique_ptr<T>, N> *values, uint64_t mask)
+      : m_values (values), m_it (mask)
+    {
+    }
+    /**
+     * \brief Get the current object
+     * \return the object with the lowest id still to visit
+     */
+    V & operator* () const
+    {
+      return *(*m_values)[*m_it];
+    }
+    /**
+     * \brief Move to the next object
+     * \return the iterator
+     */
+    Iterator & operator++ ()
+    {
+      ++m_it;
+      return *this;
+    }
+    /**
+     * \brief Compare two iterators
+     * \param o the other iterator
+     * \return true if the iterators are different
+     */
+    bool operator!= (const Iterator &o) const
+    {
+      return m_it != o.m_it;
+    }
+  private:
+    const std::array<std::unique_ptr<T>, N> *m_values {nullptr}; //!< The storage
+    NrMacSchedulerIdRange::Iterator m_it;                         //!< Current id
+  };
+
+  /**
+   * \brief Check if an object with the specified id is present
+   * \param id the id
+   * \return true if the object is present
+   */
+  bool Contains (uint8_t id) const
+  {
+    return id < N && ((m_mask >> id) & 1U);
+  }
+
+  /**
+   * \brief Get the number of objects
+   * \return the number of objects in the map
+   */
+  uint32_t GetSize () const
+  {
+    return GetIds ().GetSize ();
+  }
+
+  /**
+   * \brief Insert an object
+   * \param id the id of the object
+   * \param value the object
+   * \return false if an object with the same id was already present
+   */
+  bool Insert (uint8_t id, std::unique_ptr<T> &&value)
+  {
+    NS_ABORT_MSG_IF (id >= N, "Id " << +id << " is not supported, the maximum is " << N - 1);
+    if (Contains (id))
+      {
+        return false;
+      }
+    m_values[id] = std::move (value);
+    m_mask |= uint64_t {1} << id;
+    return true;
+  }
+
+  /**
+   * \brief Get an object, that must be present
+   * \param id the id of the object
+   * \return the object
+   */
+  T & At (uint8_t id)
+  {
+    NS_ABORT_MSG_IF (!Contains (id), "Id " << +id << " not found");
+    return *m_values[id];
+  }
+
+  /**
+   * \brief Get an object, that must be present
+   * \param id the id of the object
+   * \return the object
+   */
+  const T & At (uint8_t id) const
+  {
+    NS_ABORT_MSG_IF (!Contains (id), "Id " << +id << " not found");
+    return *m_values[id];
+  }
+
+  /**
+   * \brief Get the ids of the objects
+   * \return a range of the ids, in increasing order
+   */
+  NrMacSchedulerIdRange GetIds () const
+  {
+    return NrMacSchedulerIdRange (m_mask);
+  }
+
+  /**
+   * \brief Iterator to the first object
+   * \return the iterator
+   */
+  Iterator<T> begin ()
+  {
+    return Iterator<T> (&m_values, m_mask);
+  }
+  /**
+   * \brief Iterator past the last object
+   * \return the iterator
+   */
+  Iterator<T> end ()
+  {
+    return Iterator<T> (&m_values, 0);
+  }
+  /**
+   * \brief Iterator to the first object
+   * \return the iterator
+   */
+  Iterator<const T> begin () const
+  {
+    return Iterator<const T> (&m_values, m_mask);
+  }
+  /**
+   * \brief Iterator past the last object
+   * \return the iterator
+   */
+  Iterator<const T> end () const
+  {
+    return Iterator<const T> (&m_values, 0);
+  }
+
+private:
+  std::array<std::unique_ptr<T>, N> m_values; //!< The objects, indexed by id
+  uint64_t m_mask {0};                        //!< Bit i set if the id i is present
+};
+
 /**
  * \ingroup scheduler
  * \brief Represent a DL Logical Channel of an UE
@@ -58,11 +321,16 @@ public:
   /**
    * \brief Overwrite all the parameters with the one contained in the message
    * \param params the message received from the RLC layer, containing the information about the queues
+   * \param now the time at which the message is received
+   *
+   * The head-of-line delays of the message are converted into the arrival
+   * time of the oldest byte (m_headOfLineSince); the bytes that are not
+   * in the queue anymore are removed from the head (see UpdateArrivals).
    *
    * \return Number of bytes added or removed from the LC
    */
   int
-  Update (const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
+  Update (const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& params, const Time &now)
   {
     NS_ASSERT (params.m_logicalChannelIdentity == m_id);
 
@@ -87,16 +355,58 @@ public:
     m_rlcRetransmissionHolDelay = params.m_rlcRetransmissionHolDelay;
     m_rlcStatusPduSize = params.m_rlcStatusPduSize;
 
+    UpdateArrivals (now);
+    if (! m_arrivals.empty ())
+      {
+        // The RLC knows the age of its oldest byte: it replaces the estimate
+        uint16_t holDelay = std::max (m_rlcTransmissionQueueHolDelay, m_rlcRetransmissionHolDelay);
+        m_headOfLineSince = now - MilliSeconds (holDelay);
+        for (auto & arrival : m_arrivals)
+          {
+            arrival.first = std::max (arrival.first, m_headOfLineSince);
+          }
+        m_arrivals.front ().first = m_headOfLineSince;
+      }
+
     return ret;
   }
 
   /**
    * \brief Forcefully update m_rlcTransmissionQueueSize
    * \param size Num. of bytes
+   * \param now the time of the update
+   *
+   * The BSR does not carry any delay: the bytes that the report adds to the
+   * queue are considered arrived at the time of the report, and the bytes
+   * that it removes are the oldest ones (see UpdateArrivals).
    */
-  void OverwriteTxQueueSize (uint32_t size)
+  void OverwriteTxQueueSize (uint32_t size, const Time &now)
   {
     m_rlcTransmissionQueueSize = size;
+    UpdateArrivals (now);
+  }
+
+  /**
+   * \brief Remove the oldest bytes after a transmission opportunity
+   * \param bytes number of bytes that left the queues
+   *
+   * The head of line moves to the arrival time of the oldest byte still
+   * queued.
+   */
+  void
+  RemoveHeadOfLine (uint32_t bytes)
+  {
+    while (bytes > 0 && ! m_arrivals.empty ())
+      {
+        uint32_t removed = std::min (bytes, m_arrivals.front ().second);
+        m_arrivals.front ().second -= removed;
+        bytes -= removed;
+        if (m_arrivals.front ().second == 0)
+          {
+            m_arrivals.pop_front ();
+          }
+      }
+    m_headOfLineSince = m_arrivals.empty () ? Time::Max () : m_arrivals.front ().first;
   }
 
   /**
@@ -109,6 +419,21 @@ public:
     return m_rlcTransmissionQueueSize + m_rlcRetransmissionQueueSize + m_rlcStatusPduSize;
   }
 
+  /**
+   * \brief Get the time at which the oldest byte violates the delay budget
+   * \return the deadline, or Time::Max () if the LC is empty or has no delay budget
+   */
+  Time
+  GetDeadline () const
+  {
+    if (GetTotalSize () == 0 || m_headOfLineSince == Time::Max ()
+        || ! m_delayBudget.IsStrictlyPositive ())
+      {
+        return Time::Max ();
+      }
+    return m_headOfLineSince + m_delayBudget;
+  }
+
   uint32_t m_id                           {0}; //!< ID of the LC
   uint32_t m_rlcTransmissionQueueSize     {0}; //!< The current size of the new transmission queue in byte.
   uint16_t m_rlcTransmissionQueueHolDelay {0}; //!< Head of line delay of new transmissions in ms.
@@ -119,6 +444,33 @@ public:
   Time m_delayBudget    {Time::Min ()}; //!< Delay budget of the flow
   double m_PER          {0.0};         //!< PER of the flow
   bool m_isGbr          {false};       //!< Is GBR?
+  Time m_headOfLineSince {Time::Max ()}; //!< Arrival time of the oldest byte (Time::Max () if empty)
+
+private:
+  /**
+   * \brief Align the arrivals with the size of the queues
+   * \param now the time of the report
+   *
+   * If the queues grew, the new bytes are considered arrived now; if they
+   * shrank, the missing bytes are the oldest ones.
+   */
+  void
+  UpdateArrivals (const Time &now)
+  {
+    uint32_t tracked = 0;
+    for (const auto & arrival : m_arrivals)
+      {
+        tracked += arrival.second;
+      }
+
+    if (GetTotalSize () > tracked)
+      {
+        m_arrivals.emplace_back (now, GetTotalSize () - tracked);
+      }
+    RemoveHeadOfLine (tracked > GetTotalSize () ? tracked - GetTotalSize () : 0);
+  }
+
+  std::deque<std::pair<Time, uint32_t> > m_arrivals; //!< Arrival time and size of the queued bytes, oldest first
 };
 
 /**
@@ -132,7 +484,7 @@ typedef std::unique_ptr<NrMacSchedulerLC> LCPtr;
  * \brief Represent an UE LCG (can be DL or UL)
  *
  * A Logical Channel Group has an id (represented by m_id) and can contain
- * logical channels. The LC are stored inside an unordered map, indexed
+ * logical channels. The LC are stored inside a NrMacSchedulerIdMap, indexed
  * by their ID.
  *
  * The LCs are inserted through the method Insert, and they can be updated with
@@ -161,7 +513,6 @@ public:
    */
   NrMacSchedulerLCG (uint8_t id) : m_id (id)
   {
-    (void) m_id;
   }
   /**
    * \brief NrMacSchedulerLCG copy constructor (deleted)
@@ -169,6 +520,16 @@ public:
    */
   NrMacSchedulerLCG (const NrMacSchedulerLCG &other) = delete;
 
+  /**
+   * \brief Get the id of the LCG
+   * \return the LCG id
+   */
+  uint8_t
+  GetId () const
+  {
+    return m_id;
+  }
+
   /**
    * \brief Check if the LCG contains the LC id specified
    * \param lcId LC ID to check for
@@ -177,7 +538,7 @@ public:
   bool
   Contains (uint8_t lcId) const
   {
-    return m_lcMap.find (lcId) != m_lcMap.end ();
+    return m_lcMap.Contains (lcId);
   }
 
   /**
@@ -187,7 +548,7 @@ public:
   uint32_t
   NumOfLC () const
   {
-    return static_cast<uint32_t> (m_lcMap.size ());
+    return m_lcMap.GetSize ();
   }
 
   /**
@@ -199,7 +560,8 @@ public:
   Insert (LCPtr && lc)
   {
     NS_ASSERT (!Contains (lc->m_id));
-    return m_lcMap.emplace (std::make_pair (lc->m_id, std::move (lc))).second;
+    uint8_t lcId = static_cast<uint8_t> (lc->m_id);
+    return m_lcMap.Insert (lcId, std::move (lc));
   }
 
   /**
@@ -210,12 +572,14 @@ public:
    * Retx queue, Tx queue, and the various delays.
    *
    * A call to NrMacSchedulerLC::Update is performed.
+   *
+   * \param now the time at which the message is received
    */
   void
-  UpdateInfo (const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
+  UpdateInfo (const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& params, const Time &now)
   {
     NS_ASSERT (Contains (params.m_logicalChannelIdentity));
-    int ret = m_lcMap.at (params.m_logicalChannelIdentity)->Update (params);
+    int ret = m_lcMap.At (params.m_logicalChannelIdentity).Update (params, now);
     if (ret < 0)
       {
         NS_ASSERT_MSG (m_totalSize >= static_cast<uint32_t> (std::abs (ret)),
@@ -237,7 +601,7 @@ public:
     uint32_t size = 0;
     for (const auto & lc : m_lcMap)
       {
-        size += lc. second->m_rlcStatusPduSize + lc.second -> m_rlcRetransmissionQueueSize + lc.second ->m_rlcTransmissionQueueSize;
+        size += lc.m_rlcStatusPduSize + lc.m_rlcRetransmissionQueueSize + lc.m_rlcTransmissionQueueSize;
       }
 
     if (size == 0)
@@ -250,6 +614,7 @@ public:
   /**
    * \brief Update the LCG with just the LCG occupancy. Used in UL case when a BSR is received.
    * \param lcgQueueSize Sum of the size of all components in B
+   * \param now the time at which the BSR is received
    *
    * Used in the UL case, in which only the sum of the components are
    * available. For the LC, only the value m_rlcTransmissionQueueSize is updated.
@@ -259,13 +624,13 @@ public:
    * \see NrMacSchedulerLC::OverwriteTxQueueSize()
    */
   void
-  UpdateInfo (uint32_t lcgQueueSize)
+  UpdateInfo (uint32_t lcgQueueSize, const Time &now)
   {
-    NS_ABORT_IF (m_lcMap.size () > 1);
-    uint32_t lcIdPart = lcgQueueSize / m_lcMap.size ();
+    NS_ABORT_IF (m_lcMap.GetSize () > 1);
+    uint32_t lcIdPart = lcgQueueSize / m_lcMap.GetSize ();
     for (auto & lc : m_lcMap)
       {
-        lc.second->OverwriteTxQueueSize (lcIdPart);
+        lc.OverwriteTxQueueSize (lcIdPart, now);
       }
     m_totalSize = lcgQueueSize;
   }
@@ -288,23 +653,34 @@ public:
   uint32_t
   GetTotalSizeOfLC (uint8_t lcId) const
   {
-    NS_ABORT_IF (m_lcMap.size () == 0);
-    return m_lcMap.at (lcId)->GetTotalSize ();
+    NS_ABORT_IF (m_lcMap.GetSize () == 0);
+    return m_lcMap.At (lcId).GetTotalSize ();
   }
 
   /**
-   * \brief Get a vector of LC ID
-   * \return a vector with all the LC id present in this LCG
+   * \brief Get the earliest deadline of the LCs with data
+   * \return the minimum of NrMacSchedulerLC::GetDeadline, or Time::Max ()
+   * if all the LCs are empty
    */
-  std::vector<uint8_t>
-  GetLCId () const
+  Time
+  GetEarliestDeadline () const
   {
-    std::vector<uint8_t> ret;
+    Time deadline = Time::Max ();
     for (const auto & lc : m_lcMap)
       {
-        ret.emplace_back (lc.first);
+        deadline = std::min (deadline, lc.GetDeadline ());
       }
-    return ret;
+    return deadline;
+  }
+
+  /**
+   * \brief Get the LC IDs
+   * \return a range with all the LC id present in this LCG, in increasing order
+   */
+  NrMacSchedulerIdRange
+  GetLCId () const
+  {
+    return m_lcMap.GetIds ();
   }
 
   /**
@@ -318,7 +694,7 @@ public:
 private:
   uint32_t m_totalSize {0};                  //!< Total size
   uint8_t m_id {0};                          //!< ID of the LCG
-  std::unordered_map<uint8_t, LCPtr> m_lcMap; //!< Map between LC id and their pointer
+  NrMacSchedulerIdMap<NrMacSchedulerLC, 64> m_lcMap; //!< Map between LC id (6 bits) and the LC
 };
 
 /**
@@ -327,4 +703,10 @@ private:
  */
 typedef std::unique_ptr<NrMacSchedulerLCG> LCGPtr;
 
+/**
+ * \brief Map between the LCG id and the LCG of an UE
+ * \ingroup scheduler
+ */
+typedef NrMacSchedulerIdMap<NrMacSchedulerLCG, 8> NrMacSchedulerLCGMap;
+
 } // namespace ns3
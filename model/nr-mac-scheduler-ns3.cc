@@ -29,12 +29,15 @@
 #include "nr-mac-scheduler-harq-rr.h"
 #include "nr-mac-short-bsr-ce.h"
 #include "nr-mac-scheduler-srs-default.h"
+#include "nr-mac-scheduler-slot-dispatcher.h"
 
 #include <ns3/boolean.h>
+#include <ns3/enum.h>
 #include <ns3/uinteger.h>
 #include <ns3/log.h>
 #include <ns3/eps-bearer.h>
 #include <ns3/pointer.h>
+#include <ns3/simulator.h>
 #include <algorithm>
 #include <ns3/integer.h>
 #include <unordered_set>
@@ -70,6 +73,90 @@ NrMacSchedulerNs3::~NrMacSchedulerNs3 ()
   m_ueMap.clear ();
 }
 
+void
+NrMacSchedulerNs3::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_slotStats != nullptr)
+    {
+      NS_LOG_INFO ("Scheduler statistics: " << m_dlSlotStatsTotal);
+      NS_LOG_INFO ("Scheduler statistics: " << m_ulSlotStatsTotal);
+    }
+  NrMacScheduler::DoDispose ();
+}
+
+void
+NrMacSchedulerNs3::SetSlotStatsEnabled (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  if (enable && m_slotStats == nullptr)
+    {
+      m_slotStats = std::unique_ptr<NrMacSchedulerSlotStats> (new NrMacSchedulerSlotStats ());
+      m_dlSlotStatsTotal = NrMacSchedulerSlotStats ();
+      m_dlSlotStatsTotal.m_isDl = true;
+      m_ulSlotStatsTotal = NrMacSchedulerSlotStats ();
+      m_ulSlotStatsTotal.m_isDl = false;
+    }
+  else if (! enable)
+    {
+      m_slotStats.reset ();
+    }
+}
+
+bool
+NrMacSchedulerNs3::IsSlotStatsEnabled () const
+{
+  return m_slotStats != nullptr;
+}
+
+const NrMacSchedulerSlotStats &
+NrMacSchedulerNs3::GetSlotStatsTotal (bool isDl) const
+{
+  return isDl ? m_dlSlotStatsTotal : m_ulSlotStatsTotal;
+}
+
+void
+NrMacSchedulerNs3::StartSlotStats (const SfnSf &sfnSf, bool isDl)
+{
+  if (m_slotStats != nullptr)
+    {
+      m_slotStats->Reset (sfnSf, isDl);
+      m_slotStats->m_cellId = GetCellId ();
+      m_slotStats->m_bwpId = GetBwpId ();
+    }
+}
+
+void
+NrMacSchedulerNs3::ReportSlotStats (const SlotAllocInfo &allocInfo)
+{
+  if (m_slotStats == nullptr)
+    {
+      return;
+    }
+
+  for (const auto & alloc : allocInfo.m_varTtiAllocInfo)
+    {
+      if (alloc.m_dci->m_type == DciInfoElementTdma::DATA)
+        {
+          CountSlotStat (NrMacSchedulerSlotStats::DCI_EMITTED);
+        }
+    }
+
+  NrMacSchedulerSlotStats & total = m_slotStats->m_isDl ? m_dlSlotStatsTotal : m_ulSlotStatsTotal;
+  total.m_cellId = m_slotStats->m_cellId;
+  total.m_bwpId = m_slotStats->m_bwpId;
+  total += *m_slotStats;
+
+  if (m_runningDeferred)
+    {
+      m_deferredSlotStats.push_back (*m_slotStats);
+    }
+  else
+    {
+      m_slotStatsTrace (*m_slotStats);
+    }
+}
+
 void
 NrMacSchedulerNs3::InstallDlAmc (const Ptr<NrAmc> &dlAmc)
 {
@@ -196,6 +283,69 @@ NrMacSchedulerNs3::GetTypeId (void)
                    MakeBooleanAccessor (&NrMacSchedulerNs3::EnableHarqReTx,
                                         &NrMacSchedulerNs3::IsHarqReTxEnable),
                                         MakeBooleanChecker ())
+    .AddAttribute ("ParallelScheduling",
+                   "If true, the DL and UL trigger requests received at the same "
+                   "simulation time by all the schedulers with this flag enabled "
+                   "are computed concurrently, and the decisions are indicated to "
+                   "the MAC afterwards, in the order of arrival of the requests",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrMacSchedulerNs3::m_parallelScheduling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ParallelSchedulingThreads",
+                   "Maximum number of threads used when ParallelScheduling is "
+                   "enabled (0 means one per hardware thread)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrMacSchedulerNs3::m_parallelThreads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("DlSpsPeriodicity",
+                   "Periodicity, in slots, of the DL SPS given to each UE when it "
+                   "is added to the scheduler (0 to disable). The offset of the "
+                   "occasions is the RNTI, modulo the periodicity",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrMacSchedulerNs3::m_defaultDlSpsPeriodicity),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("UlConfiguredGrantPeriodicity",
+                   "Periodicity, in slots, of the UL configured grant given to each "
+                   "UE when it is added to the scheduler (0 to disable). The offset "
+                   "of the occasions is the RNTI, modulo the periodicity",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrMacSchedulerNs3::m_defaultUlCgPeriodicity),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("UlConfiguredGrantType",
+                   "Type of the UL configured grant given to each UE",
+                   EnumValue (SemiPersistentConfig::UL_TYPE1),
+                   MakeEnumAccessor (&NrMacSchedulerNs3::m_defaultUlCgType),
+                   MakeEnumChecker (SemiPersistentConfig::UL_TYPE1, "Type1",
+                                    SemiPersistentConfig::UL_TYPE2, "Type2"))
+    .AddAttribute ("UlConfiguredGrantReleaseAfter",
+                   "Number of consecutive occasions without data after which a "
+                   "UL configured grant of Type 2 is released (0 means never)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrMacSchedulerNs3::m_defaultUlCgReleaseAfter),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("SemiPersistentSymbols",
+                   "Number of symbols of each occasion of the DL SPS and of the "
+                   "UL configured grants",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&NrMacSchedulerNs3::m_defaultSemiPersistentSym),
+                   MakeUintegerChecker<uint8_t> (1, 14))
+    .AddAttribute ("SemiPersistentMcs",
+                   "MCS of the occasions of the DL SPS and of the UL configured grants",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrMacSchedulerNs3::m_defaultSemiPersistentMcs),
+                   MakeUintegerChecker<uint8_t> (0, 28))
+    .AddAttribute ("EnableSlotStats",
+                   "If true, measure the time and the work spent in each phase "
+                   "of the scheduling, and report them for each slot through the "
+                   "SlotStats trace source",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrMacSchedulerNs3::SetSlotStatsEnabled,
+                                        &NrMacSchedulerNs3::IsSlotStatsEnabled),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("SlotStats",
+                     "Time and work spent by the scheduler to decide a DL or UL slot",
+                     MakeTraceSourceAccessor (&NrMacSchedulerNs3::m_slotStatsTrace),
+                     "ns3::NrMacSchedulerNs3::SlotStatsTracedCallback")
   ;
 
   return tid;
@@ -212,6 +362,11 @@ void
 NrMacSchedulerNs3::DoSchedSetMcs (uint32_t mcs)
 {
   NS_LOG_FUNCTION (this);
+  if (DeferSapCall ([this, mcs] { DoSchedSetMcs (mcs); }, false))
+    {
+      return;
+    }
+
   m_fixedMcsDl = true;
   m_fixedMcsUl = true;
   m_startMcsDl = static_cast<uint8_t> (mcs);
@@ -223,6 +378,11 @@ NrMacSchedulerNs3::DoSchedDlRachInfoReq (const NrMacSchedSapProvider::SchedDlRac
 {
   NS_LOG_FUNCTION (this);
 
+  if (DeferSapCall ([this, params] { DoSchedDlRachInfoReq (params); }, false))
+    {
+      return;
+    }
+
   m_rachList = params.m_rachList;
 }
 
@@ -331,41 +491,49 @@ void
 NrMacSchedulerNs3::SetDlNotchedRbgMask (const std::vector<uint8_t> &dlNotchedRbgsMask)
 {
   NS_LOG_FUNCTION (this);
-  m_dlNotchedRbgsMask = dlNotchedRbgsMask;
-  std::stringstream ss;
-
-  //print the DL mask set (prefix + is added just for printing purposes)
-  for (const auto & x : m_dlNotchedRbgsMask)
-    {
-      ss << +x << " ";
-    }
-  NS_LOG_INFO ("Set DL notched mask: " << ss.str ());
+  m_dlNotchedRbgsMask = NrRbMask::FromVector (dlNotchedRbgsMask);
+  NS_LOG_INFO ("Set DL notched mask: " << m_dlNotchedRbgsMask);
 }
 
 std::vector<uint8_t>
 NrMacSchedulerNs3::GetDlNotchedRbgMask (void) const
 {
-  return m_dlNotchedRbgsMask;
+  return m_dlNotchedRbgsMask.ToVector ();
 }
 
 void
 NrMacSchedulerNs3::SetUlNotchedRbgMask (const std::vector<uint8_t> &ulNotchedRbgsMask)
 {
   NS_LOG_FUNCTION (this);
-  m_ulNotchedRbgsMask = ulNotchedRbgsMask;
-  std::stringstream ss;
+  m_ulNotchedRbgsMask = NrRbMask::FromVector (ulNotchedRbgsMask);
+  NS_LOG_INFO ("Set UL notched mask: " << m_ulNotchedRbgsMask);
+}
 
-  //print the UL mask set (prefix + is added just for printing purposes)
-  for (const auto & x : m_ulNotchedRbgsMask)
+std::vector<uint8_t>
+NrMacSchedulerNs3::GetUlNotchedRbgMask (void) const
+{
+  return m_ulNotchedRbgsMask.ToVector ();
+}
+
+NrRbMask
+NrMacSchedulerNs3::GetDlAssignableRbgMask () const
+{
+  if (m_dlNotchedRbgsMask.IsEmpty ())
     {
-      ss << +x << " ";
+      return NrRbMask (GetBandwidthInRbg (), true);
     }
-  NS_LOG_INFO ("Set UL notched mask: " << ss.str ());
+  NS_ASSERT (m_dlNotchedRbgsMask.GetSize () == GetBandwidthInRbg ());
+  return m_dlNotchedRbgsMask;
 }
 
-std::vector<uint8_t>
-NrMacSchedulerNs3::GetUlNotchedRbgMask (void) const
+NrRbMask
+NrMacSchedulerNs3::GetUlAssignableRbgMask () const
 {
+  if (m_ulNotchedRbgsMask.IsEmpty ())
+    {
+      return NrRbMask (GetBandwidthInRbg (), true);
+    }
+  NS_ASSERT (m_ulNotchedRbgsMask.GetSize () == GetBandwidthInRbg ());
   return m_ulNotchedRbgsMask;
 }
 
@@ -418,6 +586,56 @@ NrMacSchedulerNs3::IsHarqReTxEnable () const
   return m_enableHarqReTx;
 }
 
+void
+NrMacSchedulerNs3::SetSemiPersistentConfig (uint16_t rnti, const SemiPersistentConfig &config)
+{
+  NS_LOG_FUNCTION (this << rnti);
+  if (DeferSapCall ([this, rnti, config] { SetSemiPersistentConfig (rnti, config); }, false))
+    {
+      return;
+    }
+
+  NS_ABORT_MSG_IF (config.m_periodicity == 0, "The periodicity must be at least one slot");
+  NS_ABORT_MSG_IF (config.m_numSym == 0, "Each occasion must have at least one symbol");
+
+  SemiPersistentConfig stored = config;
+  // Type 2 grants are activated by the UE buffer; SPS and Type 1 are active from now on
+  stored.m_active = config.m_type != SemiPersistentConfig::UL_TYPE2;
+  stored.m_emptyOccasions = 0;
+
+  if (config.m_type == SemiPersistentConfig::DL_SPS)
+    {
+      m_dlSps[rnti] = stored;
+    }
+  else
+    {
+      m_ulCg[rnti] = stored;
+    }
+
+  NS_LOG_INFO ("RNTI " << rnti << " configured with type " << +config.m_type <<
+               " periodicity " << config.m_periodicity << " offset " << config.m_offset <<
+               " symbols " << +config.m_numSym << " MCS " << +config.m_mcs);
+}
+
+void
+NrMacSchedulerNs3::ReleaseSemiPersistentConfig (uint16_t rnti, DciInfoElementTdma::DciFormat format)
+{
+  NS_LOG_FUNCTION (this << rnti);
+  if (DeferSapCall ([this, rnti, format] { ReleaseSemiPersistentConfig (rnti, format); }, false))
+    {
+      return;
+    }
+
+  if (format == DciInfoElementTdma::DL)
+    {
+      m_dlSps.erase (rnti);
+    }
+  else
+    {
+      m_ulCg.erase (rnti);
+    }
+}
+
 
 uint8_t
 NrMacSchedulerNs3::ScheduleDlHarq (PointInFTPlane *startingPoint,
@@ -500,6 +718,11 @@ NrMacSchedulerNs3::DoCschedUeConfigReq (const NrMacCschedSapProvider::CschedUeCo
                    " RNTI " << params.m_rnti <<
                    " txMode " << static_cast<uint32_t> (params.m_transmissionMode));
 
+  if (DeferSapCall ([this, params] { DoCschedUeConfigReq (params); }, false))
+    {
+      return;
+    }
+
   auto itUe = m_ueMap.find (params.m_rnti);
   GetSecond UeInfoOf;
   if (itUe == m_ueMap.end ())
@@ -529,6 +752,26 @@ NrMacSchedulerNs3::DoCschedUeConfigReq (const NrMacCschedSapProvider::CschedUeCo
       NS_LOG_INFO ("Creating user, beam " << params.m_beamConfId << " and ue " << params.m_rnti <<
                    " assigned SRS periodicity " << srs.m_periodicity << " and offset " <<
                    srs.m_offset);
+
+      // Periodic resources configured through the attributes
+      SemiPersistentConfig config;
+      config.m_numSym = m_defaultSemiPersistentSym;
+      config.m_mcs = m_defaultSemiPersistentMcs;
+      if (m_defaultDlSpsPeriodicity > 0)
+        {
+          config.m_type = SemiPersistentConfig::DL_SPS;
+          config.m_periodicity = m_defaultDlSpsPeriodicity;
+          config.m_offset = params.m_rnti % m_defaultDlSpsPeriodicity;
+          SetSemiPersistentConfig (params.m_rnti, config);
+        }
+      if (m_defaultUlCgPeriodicity > 0)
+        {
+          config.m_type = m_defaultUlCgType;
+          config.m_periodicity = m_defaultUlCgPeriodicity;
+          config.m_offset = params.m_rnti % m_defaultUlCgPeriodicity;
+          config.m_releaseAfter = m_defaultUlCgReleaseAfter;
+          SetSemiPersistentConfig (params.m_rnti, config);
+        }
     }
   else
     {
@@ -549,11 +792,18 @@ NrMacSchedulerNs3::DoCschedUeReleaseReq (const NrMacCschedSapProvider::CschedUeR
 {
   NS_LOG_FUNCTION (this << " Release RNTI " << params.m_rnti);
 
+  if (DeferSapCall ([this, params] { DoCschedUeReleaseReq (params); }, false))
+    {
+      return;
+    }
+
   auto itUe = m_ueMap.find (params.m_rnti);
   NS_ABORT_IF (itUe == m_ueMap.end ());
 
   m_schedulerSrs->RemoveUe (itUe->second->m_srsOffset);
   m_ueMap.erase (itUe);
+  m_dlSps.erase (params.m_rnti);
+  m_ulCg.erase (params.m_rnti);
 
   // When it will be the case of reducing the periodicity? Question for the
   // future...
@@ -618,6 +868,11 @@ void
 NrMacSchedulerNs3::DoCschedLcConfigReq (const NrMacCschedSapProvider::CschedLcConfigReqParameters& params)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (params.m_rnti));
+  if (DeferSapCall ([this, params] { DoCschedLcConfigReq (params); }, false))
+    {
+      return;
+    }
+
   auto itUe = m_ueMap.find (params.m_rnti);
   GetSecond UeInfoOf;
   NS_ABORT_IF (itUe == m_ueMap.end ());
@@ -627,17 +882,15 @@ NrMacSchedulerNs3::DoCschedLcConfigReq (const NrMacCschedSapProvider::CschedLcCo
       if (lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_DL
           || lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_BOTH)
         {
-          auto itDl = UeInfoOf (*itUe)->m_dlLCG.find (lcConfig.m_logicalChannelGroup);
-          auto itDlEnd = UeInfoOf (*itUe)->m_dlLCG.end ();
-          if (itDl == itDlEnd)
+          NrMacSchedulerLCGMap &dlLcg = UeInfoOf (*itUe)->m_dlLCG;
+          if (! dlLcg.Contains (lcConfig.m_logicalChannelGroup))
             {
               NS_LOG_DEBUG ("Created DL LCG for UE " << UeInfoOf (*itUe)->m_rnti <<
                             " ID=" << static_cast<uint32_t> (lcConfig.m_logicalChannelGroup));
-              std::unique_ptr<NrMacSchedulerLCG> lcg = CreateLCG (lcConfig);
-              itDl = UeInfoOf (*itUe)->m_dlLCG.emplace (std::make_pair (lcConfig.m_logicalChannelGroup, std::move (lcg))).first;
+              dlLcg.Insert (lcConfig.m_logicalChannelGroup, CreateLCG (lcConfig));
             }
 
-          itDl->second->Insert (CreateLC (lcConfig));
+          dlLcg.At (lcConfig.m_logicalChannelGroup).Insert (CreateLC (lcConfig));
           NS_LOG_DEBUG ("Created DL LC for UE " << UeInfoOf (*itUe)->m_rnti <<
                         " ID=" << static_cast<uint32_t> (lcConfig.m_logicalChannelIdentity) <<
                         " in LCG " << static_cast<uint32_t> (lcConfig.m_logicalChannelGroup));
@@ -645,22 +898,20 @@ NrMacSchedulerNs3::DoCschedLcConfigReq (const NrMacCschedSapProvider::CschedLcCo
       if (lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_UL
           || lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_BOTH)
         {
-          auto itUl = UeInfoOf (*itUe)->m_ulLCG.find (lcConfig.m_logicalChannelGroup);
-          auto itUlEnd = UeInfoOf (*itUe)->m_ulLCG.end ();
-          if (itUl == itUlEnd)
+          NrMacSchedulerLCGMap &ulLcg = UeInfoOf (*itUe)->m_ulLCG;
+          if (! ulLcg.Contains (lcConfig.m_logicalChannelGroup))
             {
               NS_LOG_DEBUG ("Created UL LCG for UE " << UeInfoOf (*itUe)->m_rnti <<
                             " ID=" << static_cast<uint32_t> (lcConfig.m_logicalChannelGroup));
-              std::unique_ptr<NrMacSchedulerLCG> lcg = CreateLCG (lcConfig);
-              itUl = UeInfoOf (*itUe)->m_ulLCG.emplace (std::make_pair (lcConfig.m_logicalChannelGroup,
-                                                                        std::move (lcg))).first;
+              ulLcg.Insert (lcConfig.m_logicalChannelGroup, CreateLCG (lcConfig));
             }
 
           // Create a LC ID only if it is the first. For detail, see documentation
           // of NrMacSchedulerLCG.
-          if (itUl->second->NumOfLC () == 0)
+          NrMacSchedulerLCG &lcg = ulLcg.At (lcConfig.m_logicalChannelGroup);
+          if (lcg.NumOfLC () == 0)
             {
-              itUl->second->Insert (CreateLC (lcConfig));
+              lcg.Insert (CreateLC (lcConfig));
               NS_LOG_DEBUG ("Created UL LC for UE " << UeInfoOf (*itUe)->m_rnti <<
                             " ID=" << static_cast<uint32_t> (lcConfig.m_logicalChannelIdentity) <<
                             " in LCG " << static_cast<uint32_t> (lcConfig.m_logicalChannelGroup));
@@ -680,6 +931,11 @@ NrMacSchedulerNs3::DoCschedLcReleaseReq (const NrMacCschedSapProvider::CschedLcR
 {
   NS_LOG_FUNCTION (this);
 
+  if (DeferSapCall ([this, params] { DoCschedLcReleaseReq (params); }, false))
+    {
+      return;
+    }
+
   for ([[maybe_unused]] const auto & lcId : params.m_logicalChannelIdentity)
     {
       auto itUe = m_ueMap.find (params.m_rnti);
@@ -704,17 +960,22 @@ NrMacSchedulerNs3::DoSchedDlRlcBufferReq (const NrMacSchedSapProvider::SchedDlRl
   NS_LOG_FUNCTION (this << params.m_rnti <<
                    static_cast<uint32_t> (params.m_logicalChannelIdentity));
 
+  if (DeferSapCall ([this, params] { DoSchedDlRlcBufferReq (params); }, false))
+    {
+      return;
+    }
+
   GetSecond UeInfoOf;
   auto itUe = m_ueMap.find (params.m_rnti);
   NS_ABORT_IF (itUe == m_ueMap.end ());
 
-  for (const auto &lcg : UeInfoOf (*itUe)->m_dlLCG)
+  for (auto &lcg : UeInfoOf (*itUe)->m_dlLCG)
     {
-      if (lcg.second->Contains (params.m_logicalChannelIdentity))
+      if (lcg.Contains (params.m_logicalChannelIdentity))
         {
           NS_LOG_INFO ("Updating DL LC Info: " << params <<
-                       " in LCG: " << static_cast<uint32_t> (lcg.first));
-          lcg.second->UpdateInfo (params);
+                       " in LCG: " << static_cast<uint32_t> (lcg.GetId ()));
+          lcg.UpdateInfo (params, Simulator::Now ());
           return;
         }
     }
@@ -747,21 +1008,21 @@ NrMacSchedulerNs3::BSRReceivedFromUe (const MacCeElement &bsr)
       uint8_t bsrId = bsr.m_macCeValue.m_bufferStatus.at (lcg);
       uint32_t bufSize = NrMacShortBsrCe::FromLevelToBytes (bsrId);
 
-      auto itLcg = UeInfoOf (*itUe)->m_ulLCG.find (lcg);
-      if (itLcg == UeInfoOf (*itUe)->m_ulLCG.end ())
+      NrMacSchedulerLCGMap &ulLcg = UeInfoOf (*itUe)->m_ulLCG;
+      if (! ulLcg.Contains (lcg))
         {
           NS_ABORT_MSG_IF (bufSize > 0, "LCG " << static_cast<uint32_t> (lcg) <<
                            " not found for UE " << itUe->second->m_rnti);
           continue;
         }
 
-      if (itLcg->second->GetTotalSize () > 0 || bufSize > 0)
+      if (ulLcg.At (lcg).GetTotalSize () > 0 || bufSize > 0)
         {
           NS_LOG_INFO ("Updating UL LCG " << static_cast<uint32_t> (lcg) <<
                        " for UE " << bsr.m_rnti << " size " << bufSize);
         }
 
-      itLcg->second->UpdateInfo (bufSize);
+      ulLcg.At (lcg).UpdateInfo (bufSize, Simulator::Now ());
     }
 }
 
@@ -777,6 +1038,11 @@ NrMacSchedulerNs3::DoSchedUlMacCtrlInfoReq (const NrMacSchedSapProvider::SchedUl
 {
   NS_LOG_FUNCTION (this);
 
+  if (DeferSapCall ([this, params] { DoSchedUlMacCtrlInfoReq (params); }, false))
+    {
+      return;
+    }
+
   for (const auto & element : params.m_macCeList)
     {
       if ( element.m_macCeType == MacCeElement::BSR )
@@ -805,6 +1071,11 @@ NrMacSchedulerNs3::DoSchedDlCqiInfoReq (const NrMacSchedSapProvider::SchedDlCqiI
 {
   NS_LOG_FUNCTION (this);
 
+  if (DeferSapCall ([this, params] { DoSchedDlCqiInfoReq (params); }, false))
+    {
+      return;
+    }
+
   if (m_fixedMcsDl)
     {
       return;
@@ -826,7 +1097,7 @@ NrMacSchedulerNs3::DoSchedDlCqiInfoReq (const NrMacSchedSapProvider::SchedDlCqiI
         }
       else
         {
-          m_cqiManagement.DlSBCQIReported (cqi, ue);
+          m_cqiManagement.DlSBCQIReported (cqi, ue, expirationTime, m_maxDlMcs);
         }
     }
 }
@@ -849,6 +1120,14 @@ NrMacSchedulerNs3::DoSchedUlCqiInfoReq (const NrMacSchedSapProvider::SchedUlCqiI
 {
   NS_LOG_FUNCTION (this);
 
+  if (m_parallelScheduling && ! m_runningDeferred && ! m_deferredSapCalls.empty ())
+    {
+      // The UL CQI processing takes a reference to the spectrum model, which
+      // is shared between cells: do not move it to a worker thread, but
+      // execute here what is pending before it.
+      RunDeferredSapCalls ();
+    }
+
   if (m_fixedMcsUl)
     {
       return;
@@ -939,14 +1218,13 @@ std::vector<T> NrMacSchedulerNs3::MergeHARQ (std::vector<T> *existingFeedbacks,
                " HARQ Feedback");
   uint64_t existingSize = existingFeedbacks->size ();
   uint64_t inSize = inFeedbacks.size ();
-  existingFeedbacks->insert (existingFeedbacks->end (),
-                             inFeedbacks.begin (),
-                             inFeedbacks.end ());
-  NS_ASSERT (existingFeedbacks->size () == existingSize + inSize);
 
-  auto ret = std::vector<T> (std::make_move_iterator (existingFeedbacks->begin ()),
-                             std::make_move_iterator (existingFeedbacks->end ()));
-  existingFeedbacks->clear ();
+  // Take the old feedbacks without copying them
+  std::vector<T> ret;
+  ret.swap (*existingFeedbacks);
+  ret.insert (ret.end (), inFeedbacks.begin (), inFeedbacks.end ());
+  NS_ASSERT (ret.size () == existingSize + inSize);
+  NS_ASSERT (existingFeedbacks->empty ());
 
   return ret;
 }
@@ -993,7 +1271,7 @@ NrMacSchedulerNs3::ProcessHARQFeedbacks (std::vector<T> *harqInfo,
         }
       NS_ABORT_IF (ueProcess.m_dciElement == nullptr);
 
-      std::vector<uint8_t>::const_iterator rvIt;
+      const uint8_t *rvIt;
       rvIt = std::max_element (ueProcess.m_dciElement->m_rv.begin(), ueProcess.m_dciElement->m_rv.end());
       //RV number should not be greater than 3. An unscheduled stream should
       //be assigned RV = 0 in MIMO.
@@ -1077,10 +1355,10 @@ NrMacSchedulerNs3::PrependCtrlSym (uint8_t symStart, uint8_t numSymToAllocate,
                                        DciInfoElementTdma::DciFormat mode,
                                        std::deque<VarTtiAllocInfo> *allocations) const
 {
-  std::vector<uint8_t> rbgBitmask (GetBandwidthInRbg (), 1);
+  NrRbMask rbgBitmask (GetBandwidthInRbg (), true);
 
-  NS_ASSERT_MSG (rbgBitmask.size () == GetBandwidthInRbg (),
-                 "bitmask size " << rbgBitmask.size () << " conf " <<
+  NS_ASSERT_MSG (rbgBitmask.GetSize () == GetBandwidthInRbg (),
+                 "bitmask size " << rbgBitmask.GetSize () << " conf " <<
                  GetBandwidthInRbg ());
   if (mode == DciInfoElementTdma::DL)
     {
@@ -1112,9 +1390,9 @@ NrMacSchedulerNs3::AppendCtrlSym (uint8_t symStart, uint8_t numSymToAllocate,
                                       DciInfoElementTdma::DciFormat mode,
                                       std::deque<VarTtiAllocInfo> *allocations) const
 {
-  std::vector<uint8_t> rbgBitmask (GetBandwidthInRbg (), 1);
+  NrRbMask rbgBitmask (GetBandwidthInRbg (), true);
 
-  NS_ASSERT (rbgBitmask.size () == GetBandwidthInRbg ());
+  NS_ASSERT (rbgBitmask.GetSize () == GetBandwidthInRbg ());
   if (mode == DciInfoElementTdma::DL)
     {
       NS_ASSERT (allocations->size () == 0); // no previous allocations
@@ -1219,8 +1497,13 @@ NrMacSchedulerNs3::ComputeActiveHarq (ActiveHarqMap *activeUlHarq,
  * \brief Compute the number of active DL and UL UE
  * \param activeDlUe map of active DL UE to be filled
  * \param GetLCGFn Function to retrieve the LCG of a UE
+ * \param GetHarqVector Function to retrieve the HARQ vector of a UE
+ * \param semiPersistent Periodic resources of the UEs, in the same direction
  * \param mode UL or DL (to be printed in debug messages)
  *
+ * The UEs with active periodic resources are skipped, as their data is
+ * sent in the occasions (see SemiPersistentConfig).
+ *
  * The function loops all available UEs and checks their LC. If one (or more)
  * LC contains bytes, they are marked active and inserted in one of the
  * list passed as input parameters. Every UE is marked as active if it has
@@ -1231,6 +1514,7 @@ void
 NrMacSchedulerNs3::ComputeActiveUe (ActiveUeMap *activeUe,
                                         const NrMacSchedulerUeInfo::GetLCGFn &GetLCGFn,
                                         const NrMacSchedulerUeInfo::GetHarqVectorFn &GetHarqVector,
+                                        const SemiPersistentMap &semiPersistent,
                                         const std::string &mode) const
 {
   NS_LOG_FUNCTION (this);
@@ -1239,23 +1523,30 @@ NrMacSchedulerNs3::ComputeActiveUe (ActiveUeMap *activeUe,
       uint32_t totBuffer = 0;
       const auto & ue = ueInfo.second;
 
+      // the data of a UE with periodic resources waits for the next occasion
+      auto spIt = semiPersistent.find (ue->m_rnti);
+      if (spIt != semiPersistent.end () && spIt->second.m_active)
+        {
+          continue;
+        }
+
       // compute total DL and UL bytes buffered
-      for (const auto & lcgInfo : GetLCGFn (ue))
+      for (const auto & lcg : GetLCGFn (ue))
         {
-          const auto & lcg = lcgInfo.second;
-          if (lcg->GetTotalSize () > 0)
+          if (lcg.GetTotalSize () > 0)
             {
               NS_LOG_INFO ("UE " << ue->m_rnti << " " << mode << " LCG " <<
-                           static_cast<uint32_t> (lcgInfo.first) <<
-                           " bytes " << lcg->GetTotalSize ());
+                           static_cast<uint32_t> (lcg.GetId ()) <<
+                           " bytes " << lcg.GetTotalSize ());
             }
-          totBuffer += lcg->GetTotalSize ();
+          totBuffer += lcg.GetTotalSize ();
         }
 
       auto harqV = GetHarqVector (ue);
 
       if (totBuffer > 0 && harqV.CanInsert ())
         {
+          CountSlotStat (NrMacSchedulerSlotStats::UE_CONSIDERED);
           auto it = activeUe->find (ue->m_beamConfId);
           if (it == activeUe->end ())
             {
@@ -1275,7 +1566,8 @@ NrMacSchedulerNs3::ComputeActiveUe (ActiveUeMap *activeUe,
  * \brief Method to decide how to distribute the assigned bytes to the different LCs
  * \param ueLCG LCG of an UE
  * \param tbs TBS to divide between the LCG/LC
- * \return A vector of Assignation
+ * \param assignations the array where the assignations are written
+ * \return The number of assignations written in the array
  *
  * The method distribute bytes evenly between LCG. This is a default;
  * more advanced methods can be inserted. Please note that the correct way
@@ -1287,25 +1579,21 @@ NrMacSchedulerNs3::ComputeActiveUe (ActiveUeMap *activeUe,
  * and to change in the subclasses.
  */
 // Assume LC are unique
-std::vector<NrMacSchedulerNs3::Assignation>
-NrMacSchedulerNs3::AssignBytesToLC (const std::unordered_map<uint8_t, LCGPtr> &ueLCG,
-                                        uint32_t tbs) const
+uint8_t
+NrMacSchedulerNs3::AssignBytesToLC (const NrMacSchedulerLCGMap &ueLCG,
+                                        uint32_t tbs, AssignationArray *assignations) const
 {
   NS_LOG_FUNCTION (this);
-  GetFirst GetLCGID;
-  GetSecond GetLCG;
-
-  std::vector<Assignation> ret;
+  NrMacSchedulerPhaseTimer timer (GetSlotStats (), NrMacSchedulerSlotStats::LC_ASSIGNMENT);
 
-  NS_LOG_INFO ("To distribute: " << tbs << " bytes over " << ueLCG.size () << " LCG");
+  NS_LOG_INFO ("To distribute: " << tbs << " bytes over " << ueLCG.GetSize () << " LCG");
 
   uint32_t activeLc = 0;
   for (const auto & lcg : ueLCG)
     {
-      std::vector<uint8_t> lcs = GetLCG (lcg)->GetLCId ();
-      for (const auto & lcId : lcs)
+      for (uint8_t lcId : lcg.GetLCId ())
         {
-          if (GetLCG (lcg)->GetTotalSizeOfLC (lcId) > 0)
+          if (lcg.GetTotalSizeOfLC (lcId) > 0)
             {
               ++activeLc;
             }
@@ -1314,28 +1602,29 @@ NrMacSchedulerNs3::AssignBytesToLC (const std::unordered_map<uint8_t, LCGPtr> &u
 
   if (activeLc == 0)
     {
-      return ret;
+      return 0;
     }
 
   uint32_t amountPerLC = tbs / activeLc;
   NS_LOG_INFO ("Total LC: " << activeLc << " each one will receive " << amountPerLC << " bytes");
 
+  uint8_t numAssignations = 0;
   for (const auto & lcg : ueLCG)
     {
-      std::vector<uint8_t> lcs = GetLCG (lcg)->GetLCId ();
-      for (const auto & lcId : lcs)
+      for (uint8_t lcId : lcg.GetLCId ())
         {
-          if (GetLCG (lcg)->GetTotalSizeOfLC (lcId) > 0)
+          if (lcg.GetTotalSizeOfLC (lcId) > 0)
             {
               NS_LOG_INFO ("Assigned to LCID " << static_cast<uint32_t> (lcId) <<
-                           " inside LCG " << static_cast<uint32_t> (GetLCGID (lcg)) <<
+                           " inside LCG " << static_cast<uint32_t> (lcg.GetId ()) <<
                            " an amount of " << amountPerLC << " B");
-              ret.emplace_back (Assignation (GetLCGID (lcg), lcId, amountPerLC));
+              NS_ASSERT (numAssignations < assignations->size ());
+              (*assignations)[numAssignations++] = Assignation (lcg.GetId (), lcId, amountPerLC);
             }
         }
     }
 
-  return ret;
+  return numAssignations;
 }
 
 
@@ -1377,7 +1666,9 @@ NrMacSchedulerNs3::DoScheduleDlData (PointInFTPlane *spoint, uint32_t symAvail,
 {
   NS_LOG_FUNCTION (this << symAvail);
   NS_ASSERT (spoint->m_rbg == 0);
+  NrMacSchedulerPhaseTimer repartitionTimer (GetSlotStats (), NrMacSchedulerSlotStats::BEAM_REPARTITION);
   BeamSymbolMap symPerBeam = AssignDLRBG (symAvail, activeDl);
+  repartitionTimer.Stop ();
   GetFirst GetBeam;
   uint8_t usedSym = 0;
 
@@ -1410,8 +1701,10 @@ NrMacSchedulerNs3::DoScheduleDlData (PointInFTPlane *spoint, uint32_t symAvail,
               continue;
             }
 
+          NrMacSchedulerPhaseTimer dciTimer (GetSlotStats (), NrMacSchedulerSlotStats::DCI_CREATION);
           std::shared_ptr<DciInfoElementTdma> dci = CreateDlDci (spoint, ue.first,
                                                                  symPerBeam.at (GetBeam (beam)));
+          dciTimer.Stop ();
           if (dci == nullptr)
             {
               //By continuing to the next UE means that we are
@@ -1458,23 +1751,14 @@ NrMacSchedulerNs3::DoScheduleDlData (PointInFTPlane *spoint, uint32_t symAvail,
           ue.first->m_dlHarq.Get (id).m_dciElement->m_harqProcess = id;
 
 
-          std::vector <std::vector<Assignation> > bytesPerLcPerStream;
-
-          for (const auto &it:dci->m_tbSize)
+          //distribute tbsize of each stream among the LCs of the UE; the
+          //number of LCs is the same for all the streams
+          std::array<AssignationArray, NrStreamArray<uint32_t>::MAX_STREAMS> bytesPerStreamPerLc;
+          uint8_t numLcs = 0;
+          for (uint8_t stream = 0; stream < dci->m_tbSize.size (); stream++)
             {
-              //distribute tbsize of each stream among the LCs of the UE
-              //distributedBytes size is equal to the number of LCs
-              auto distributedBytes = AssignBytesToLC (ue.first->m_dlLCG, it);
-              if (bytesPerLcPerStream.size () == 0)
-                {
-                  bytesPerLcPerStream.resize (distributedBytes.size ());
-                }
-              for (uint16_t numLc = 0; numLc < distributedBytes.size (); numLc++)
-                {
-                  bytesPerLcPerStream.at (numLc).emplace_back (Assignation (distributedBytes.at (numLc).m_lcg,
-                                                                            distributedBytes.at (numLc).m_lcId,
-                                                                            distributedBytes.at (numLc).m_bytes));
-                }
+              numLcs = AssignBytesToLC (ue.first->m_dlLCG, dci->m_tbSize.at (stream),
+                                        &bytesPerStreamPerLc.at (stream));
             }
 
 
@@ -1498,12 +1782,12 @@ NrMacSchedulerNs3::DoScheduleDlData (PointInFTPlane *spoint, uint32_t symAvail,
 
 
 
-          for (const auto & bytesPerLc : bytesPerLcPerStream)
+          for (uint8_t numLc = 0; numLc < numLcs; numLc++)
             {
-              //bytesPerLc is a vector
               std::vector<RlcPduInfo> rlcPdusInfoPerStream;
-              for (const auto & bytesPerStream : bytesPerLc)
+              for (uint8_t stream = 0; stream < dci->m_tbSize.size (); stream++)
                 {
+                  const Assignation &bytesPerStream = bytesPerStreamPerLc.at (stream).at (numLc);
                   if (bytesPerStream.m_bytes != 0)
                     {
                       NS_ASSERT (bytesPerStream.m_bytes >= 3);
@@ -1512,7 +1796,7 @@ NrMacSchedulerNs3::DoScheduleDlData (PointInFTPlane *spoint, uint32_t symAvail,
                       uint32_t bytes = bytesPerStream.m_bytes - 3; // Consider the subPdu overhead
                       RlcPduInfo newRlcPdu (lcId, bytes);
                       rlcPdusInfoPerStream.push_back (newRlcPdu);
-                      ue.first->m_dlLCG.at (lcgId)->AssignedData (lcId, bytes, "DL");
+                      ue.first->m_dlLCG.At (lcgId).AssignedData (lcId, bytes, "DL");
 
                       NS_LOG_DEBUG ("DL LCG " << static_cast<uint32_t> (lcgId) <<
                                     " LCID " << static_cast<uint32_t> (lcId) <<
@@ -1621,7 +1905,9 @@ NrMacSchedulerNs3::DoScheduleUlData (PointInFTPlane *spoint, uint32_t symAvail,
   NS_ASSERT (symAvail > 0 && activeUl.size () > 0);
   NS_ASSERT (spoint->m_rbg == 0);
 
+  NrMacSchedulerPhaseTimer repartitionTimer (GetSlotStats (), NrMacSchedulerSlotStats::BEAM_REPARTITION);
   BeamSymbolMap symPerBeam = AssignULRBG (symAvail, activeUl);
+  repartitionTimer.Stop ();
   uint8_t usedSym = 0;
   GetFirst GetBeam;
 
@@ -1656,7 +1942,9 @@ NrMacSchedulerNs3::DoScheduleUlData (PointInFTPlane *spoint, uint32_t symAvail,
               continue;
             }
 
+          NrMacSchedulerPhaseTimer dciTimer (GetSlotStats (), NrMacSchedulerSlotStats::DCI_CREATION);
           std::shared_ptr<DciInfoElementTdma> dci = CreateUlDci (spoint, ue.first, symPerBeam.at (GetBeam (beam)));
+          dciTimer.Stop ();
 
           if (dci == nullptr)
             {
@@ -1713,12 +2001,14 @@ NrMacSchedulerNs3::DoScheduleUlData (PointInFTPlane *spoint, uint32_t symAvail,
             }
 
 
-          auto distributedBytes = AssignBytesToLC (ue.first->m_ulLCG, dci->m_tbSize.at (0));
+          AssignationArray distributedBytes;
+          uint8_t numLcs = AssignBytesToLC (ue.first->m_ulLCG, dci->m_tbSize.at (0), &distributedBytes);
           bool assignedToLC = false;
-          for (const auto & byteDistribution : distributedBytes)
+          for (uint8_t numLc = 0; numLc < numLcs; numLc++)
             {
+              const Assignation &byteDistribution = distributedBytes.at (numLc);
               assignedToLC = true;
-              ue.first->m_ulLCG.at (byteDistribution.m_lcg)->AssignedData (byteDistribution.m_lcId, byteDistribution.m_bytes, "UL");
+              ue.first->m_ulLCG.At (byteDistribution.m_lcg).AssignedData (byteDistribution.m_lcId, byteDistribution.m_bytes, "UL");
               NS_LOG_DEBUG ("UL LCG " << static_cast<uint32_t> (byteDistribution.m_lcg) <<
                             " assigned bytes " << byteDistribution.m_bytes << " to LCID " <<
                             static_cast<uint32_t> (byteDistribution.m_lcId));
@@ -1769,9 +2059,290 @@ NrMacSchedulerNs3::DoScheduleUlSr (PointInFTPlane *spoint, const std::list<uint1
       for (auto & ulLcg : NrMacSchedulerUeInfo::GetUlLCG (m_ueMap.at (v)))
         {
           NS_LOG_DEBUG ("Assigning 12 bytes to UE " << v << " because of a SR");
-          ulLcg.second->UpdateInfo (12);
+          ulLcg.UpdateInfo (12, Simulator::Now ());
+        }
+    }
+}
+
+/**
+ * \brief Check if a slot is an occasion of a semi-persistent configuration
+ * \param config the configuration
+ * \param sfn the slot
+ * \return true if the slot is an occasion
+ */
+static bool
+IsSemiPersistentOccasion (const NrMacSchedulerNs3::SemiPersistentConfig &config, const SfnSf &sfn)
+{
+  return sfn.Normalize () % config.m_periodicity == config.m_offset % config.m_periodicity;
+}
+
+/**
+ * \brief Check if a UE already has a data allocation in the slot
+ * \param rnti the RNTI of the UE
+ * \param allocInfo the allocations of the slot
+ * \return true if there is a data DCI for the UE (e.g., a HARQ retransmission)
+ */
+static bool
+HasDataAllocation (uint16_t rnti, const SlotAllocInfo *allocInfo)
+{
+  return std::any_of (allocInfo->m_varTtiAllocInfo.begin (), allocInfo->m_varTtiAllocInfo.end (),
+                      [rnti] (const VarTtiAllocInfo &alloc)
+                      {
+                        return alloc.m_dci->m_rnti == rnti &&
+                        alloc.m_dci->m_type == DciInfoElementTdma::DATA;
+                      });
+}
+
+/**
+ * \brief Schedule the DL SPS occasions of the slot
+ * \param spoint Starting point for allocation
+ * \param symAvail Number of available symbols
+ * \param dlSfn The DL slot
+ * \param allocInfo The allocation info to which append the allocations
+ * \return The number of symbols used
+ *
+ * Each UE with an occasion in this slot and with DL data gets the configured
+ * symbols, over all the assignable RBGs, at the configured MCS. There is
+ * no evaluation of the metric of the UE, nor any RBG assignment: the
+ * TBS is fixed by the configuration. The bytes are distributed between the
+ * LCs as in DoScheduleDlData(). The occasion is skipped if the UE has
+ * nothing to transmit, if a HARQ retransmission has been already scheduled
+ * for it, or if there is no space left.
+ */
+uint8_t
+NrMacSchedulerNs3::DoScheduleDlSps (PointInFTPlane *spoint, uint8_t symAvail,
+                                    const SfnSf &dlSfn, SlotAllocInfo *allocInfo)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (spoint->m_rbg == 0);
+
+  const NrRbMask rbgMask = GetDlAssignableRbgMask ();
+  uint8_t usedSym = 0;
+
+  for (const auto & sps : m_dlSps)
+    {
+      const uint16_t rnti = sps.first;
+      const SemiPersistentConfig & config = sps.second;
+
+      auto ueIt = m_ueMap.find (rnti);
+      if (!IsSemiPersistentOccasion (config, dlSfn) || ueIt == m_ueMap.end ())
+        {
+          continue;
+        }
+
+      const auto & ue = ueIt->second;
+      uint32_t totBuffer = 0;
+      for (const auto & lcg : ue->m_dlLCG)
+        {
+          totBuffer += lcg.GetTotalSize ();
+        }
+
+      if (totBuffer == 0 || HasDataAllocation (rnti, allocInfo) || !ue->m_dlHarq.CanInsert ())
+        {
+          NS_LOG_INFO ("SPS occasion of UE " << rnti << " in slot " << dlSfn << " not used");
+          continue;
+        }
+
+      if (config.m_numSym > symAvail - usedSym)
+        {
+          NS_LOG_INFO ("No space for the SPS occasion of UE " << rnti << " in slot " << dlSfn);
+          continue;
+        }
+
+      uint32_t tbs = m_dlAmc->CalculateTbSize (config.m_mcs, rbgMask.Count () *
+                                               GetNumRbPerRbg () * config.m_numSym);
+      CountSlotStat (NrMacSchedulerSlotStats::TBS_COMPUTATIONS);
+      if (tbs < 7)
+        {
+          NS_LOG_DEBUG ("The SPS occasion of UE " << rnti << " has a TBS < 7");
+          continue;
+        }
+
+      auto dci = std::make_shared<DciInfoElementTdma> (rnti, DciInfoElementTdma::DL, spoint->m_sym,
+                                                       config.m_numSym,
+                                                       NrStreamArray<uint8_t> {config.m_mcs},
+                                                       NrStreamArray<uint32_t> {tbs},
+                                                       NrStreamArray<uint8_t> {1},
+                                                       NrStreamArray<uint8_t> {0},
+                                                       DciInfoElementTdma::DATA, GetBwpId (),
+                                                       GetTpc ());
+      dci->m_rbgBitmask = rbgMask;
+
+      uint8_t id;
+      ue->m_dlHarq.Insert (&id, HarqProcess (true, HarqProcess::WAITING_FEEDBACK, 0, dci));
+      dci->m_harqProcess = id;
+      HarqProcess & process = ue->m_dlHarq.Get (id);
+
+      VarTtiAllocInfo slotInfo (dci);
+      AssignationArray assignations;
+      uint8_t numLcs = AssignBytesToLC (ue->m_dlLCG, tbs, &assignations);
+      for (uint8_t numLc = 0; numLc < numLcs; numLc++)
+        {
+          const Assignation &assignation = assignations.at (numLc);
+          uint32_t bytes = 0;
+          if (assignation.m_bytes != 0)
+            {
+              NS_ASSERT (assignation.m_bytes >= 3);
+              bytes = assignation.m_bytes - 3; // Consider the subPdu overhead
+              ue->m_dlLCG.At (assignation.m_lcg).AssignedData (assignation.m_lcId, bytes, "DL");
+            }
+          // one stream
+          std::vector<RlcPduInfo> rlcPdu {RlcPduInfo (assignation.m_lcId, bytes)};
+          slotInfo.m_rlcPduInfo.push_back (rlcPdu);
+          process.m_rlcPduInfo.push_back (rlcPdu);
+        }
+
+      NS_ABORT_IF (slotInfo.m_rlcPduInfo.size () == 0);
+
+      NS_LOG_DEBUG ("UE " << rnti << " gets the SPS occasion at DL symbols " <<
+                    +dci->m_symStart << "-" << +(dci->m_symStart + dci->m_numSym) <<
+                    " tbs " << tbs << " mcs " << +config.m_mcs << " harqId " << +id);
+
+      allocInfo->m_varTtiAllocInfo.emplace_back (slotInfo);
+      allocInfo->m_numSymAlloc += config.m_numSym;
+      spoint->m_sym += config.m_numSym;
+      usedSym += config.m_numSym;
+    }
+
+  return usedSym;
+}
+
+/**
+ * \brief Schedule the UL configured grant occasions of the slot
+ * \param spoint Starting point for allocation (going backward)
+ * \param symAvail Number of available symbols
+ * \param ulSfn The UL slot
+ * \param allocInfo The allocation info to which append the allocations
+ * \return The number of symbols used
+ *
+ * Each UE with an active grant and an occasion in this slot gets the
+ * configured symbols, over all the assignable RBGs, at the configured MCS,
+ * even if the scheduler does not know of any byte to transmit: in that
+ * case the UE will use the grant to send a BSR (or an empty PDU). A UE with
+ * a pending SR is served by the grant, and its SR is removed.
+ *
+ * A Type 2 grant is activated at the first occasion in which the UE has
+ * data or a pending SR, and released after SemiPersistentConfig::m_releaseAfter
+ * consecutive occasions without data.
+ */
+uint8_t
+NrMacSchedulerNs3::DoScheduleUlConfiguredGrant (PointInFTPlane *spoint, uint8_t symAvail,
+                                                const SfnSf &ulSfn, SlotAllocInfo *allocInfo)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (spoint->m_rbg == 0);
+
+  const NrRbMask rbgMask = GetUlAssignableRbgMask ();
+  uint8_t usedSym = 0;
+
+  for (auto & cg : m_ulCg)
+    {
+      const uint16_t rnti = cg.first;
+      SemiPersistentConfig & config = cg.second;
+
+      auto ueIt = m_ueMap.find (rnti);
+      if (!IsSemiPersistentOccasion (config, ulSfn) || ueIt == m_ueMap.end ())
+        {
+          continue;
+        }
+
+      const auto & ue = ueIt->second;
+      uint32_t totBuffer = 0;
+      for (const auto & lcg : ue->m_ulLCG)
+        {
+          totBuffer += lcg.GetTotalSize ();
+        }
+      bool srPending = std::find (m_srList.begin (), m_srList.end (), rnti) != m_srList.end ();
+      bool hasData = totBuffer > 0 || srPending;
+
+      if (config.m_type == SemiPersistentConfig::UL_TYPE2)
+        {
+          if (! config.m_active && ! hasData)
+            {
+              continue;
+            }
+          else if (! config.m_active)
+            {
+              NS_LOG_INFO ("Activating the configured grant of UE " << rnti);
+              config.m_active = true;
+              config.m_emptyOccasions = 0;
+            }
+          else if (hasData)
+            {
+              config.m_emptyOccasions = 0;
+            }
+          else if (config.m_releaseAfter > 0 && ++config.m_emptyOccasions >= config.m_releaseAfter)
+            {
+              NS_LOG_INFO ("Releasing the configured grant of UE " << rnti << " after " <<
+                           +config.m_emptyOccasions << " empty occasions");
+              config.m_active = false;
+              continue;
+            }
+        }
+
+      if (HasDataAllocation (rnti, allocInfo) || !ue->m_ulHarq.CanInsert ())
+        {
+          NS_LOG_INFO ("Configured grant occasion of UE " << rnti << " in slot " << ulSfn << " not used");
+          continue;
+        }
+
+      if (config.m_numSym > symAvail - usedSym)
+        {
+          NS_LOG_INFO ("No space for the configured grant of UE " << rnti << " in slot " << ulSfn);
+          continue;
+        }
+
+      uint32_t tbs = m_ulAmc->CalculateTbSize (config.m_mcs, rbgMask.Count () *
+                                               GetNumRbPerRbg () * config.m_numSym);
+      CountSlotStat (NrMacSchedulerSlotStats::TBS_COMPUTATIONS);
+      if (tbs < 7)
+        {
+          NS_LOG_DEBUG ("The configured grant of UE " << rnti << " has a TBS < 7");
+          continue;
+        }
+
+      NS_ASSERT (spoint->m_sym >= config.m_numSym);
+      spoint->m_sym -= config.m_numSym;
+
+      auto dci = std::make_shared<DciInfoElementTdma> (rnti, DciInfoElementTdma::UL, spoint->m_sym,
+                                                       config.m_numSym,
+                                                       NrStreamArray<uint8_t> {config.m_mcs},
+                                                       NrStreamArray<uint32_t> {tbs},
+                                                       NrStreamArray<uint8_t> {1},
+                                                       NrStreamArray<uint8_t> {0},
+                                                       DciInfoElementTdma::DATA, GetBwpId (),
+                                                       GetTpc ());
+      dci->m_rbgBitmask = rbgMask;
+      // Tell the UE that the grant is configured: it will not send a SR
+      // while the occasions keep coming
+      dci->m_cgPeriodicity = config.m_periodicity;
+
+      uint8_t id;
+      ue->m_ulHarq.Insert (&id, HarqProcess (true, HarqProcess::WAITING_FEEDBACK, 0, dci));
+      dci->m_harqProcess = id;
+
+      if (totBuffer > 0)
+        {
+          AssignationArray assignations;
+          uint8_t numLcs = AssignBytesToLC (ue->m_ulLCG, tbs, &assignations);
+          for (uint8_t numLc = 0; numLc < numLcs; numLc++)
+            {
+              const Assignation &assignation = assignations.at (numLc);
+              ue->m_ulLCG.At (assignation.m_lcg).AssignedData (assignation.m_lcId, assignation.m_bytes, "UL");
+            }
         }
+      m_srList.remove (rnti);
+
+      NS_LOG_DEBUG ("UE " << rnti << " gets the configured grant at UL symbols " <<
+                    +dci->m_symStart << "-" << +(dci->m_symStart + dci->m_numSym) <<
+                    " tbs " << tbs << " mcs " << +config.m_mcs << " harqId " << +id);
+
+      allocInfo->m_varTtiAllocInfo.emplace_front (VarTtiAllocInfo (dci));
+      allocInfo->m_numSymAlloc += config.m_numSym;
+      usedSym += config.m_numSym;
     }
+
+  return usedSym;
 }
 
 /**
@@ -1857,12 +2428,14 @@ NrMacSchedulerNs3::ScheduleDl (const NrMacSchedSapProvider::SchedDlTriggerReqPar
   m_rachList.clear ();
 
   // compute active ue in the current subframe, group them by BeamConfId
+  NrMacSchedulerPhaseTimer activeTimer (GetSlotStats (), NrMacSchedulerSlotStats::ACTIVE_UE);
   ActiveHarqMap activeDlHarq;
   ComputeActiveHarq (&activeDlHarq, dlHarqFeedback);
 
   ActiveUeMap activeDlUe;
   ComputeActiveUe (&activeDlUe, &NrMacSchedulerUeInfo::GetDlLCG,
-                   &NrMacSchedulerUeInfo::GetDlHarqVector, "DL");
+                   &NrMacSchedulerUeInfo::GetDlHarqVector, m_dlSps, "DL");
+  activeTimer.Stop ();
 
   DoScheduleDl (dlHarqFeedback, activeDlHarq, &activeDlUe, params.m_snfSf,
                 ulAllocations, &dlSlot.m_slotAllocInfo);
@@ -1879,7 +2452,8 @@ NrMacSchedulerNs3::ScheduleDl (const NrMacSchedSapProvider::SchedDlTriggerReqPar
 
   NS_LOG_INFO ("Total DCI for DL : " << dlSlot.m_slotAllocInfo.m_varTtiAllocInfo.size () <<
                " including DL CTRL");
-  m_macSchedSapUser->SchedConfigInd (dlSlot);
+  ReportSlotStats (dlSlot.m_slotAllocInfo);
+  SendSchedConfigInd (dlSlot);
 }
 
 /**
@@ -1941,7 +2515,8 @@ NrMacSchedulerNs3::ScheduleUl (const NrMacSchedSapProvider::SchedUlTriggerReqPar
 
   NS_LOG_INFO ("Total DCI for UL : " << ulSlot.m_slotAllocInfo.m_varTtiAllocInfo.size () <<
                " including UL CTRL");
-  m_macSchedSapUser->SchedConfigInd (ulSlot);
+  ReportSlotStats (ulSlot.m_slotAllocInfo);
+  SendSchedConfigInd (ulSlot);
 }
 
 /**
@@ -1996,8 +2571,10 @@ NrMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedback,
       dataSymPerSlot -= m_dlCtrlSymbols;
     }
 
+  NrMacSchedulerPhaseTimer activeHarqTimer (GetSlotStats (), NrMacSchedulerSlotStats::ACTIVE_UE);
   ActiveHarqMap activeUlHarq;
   ComputeActiveHarq (&activeUlHarq, ulHarqFeedback);
+  activeHarqTimer.Stop ();
 
   // Start the assignation from the last available data symbol, and like a shrimp
   // go backward.
@@ -2024,6 +2601,7 @@ NrMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedback,
 
   if (activeUlHarq.size () > 0)
     {
+      NrMacSchedulerPhaseTimer harqTimer (GetSlotStats (), NrMacSchedulerSlotStats::HARQ);
       uint8_t usedHarq = ScheduleUlHarq (&ulAssignationStartPoint, ulSymAvail,
                                          m_ueMap, &m_ulHarqToRetransmit, ulHarqFeedback,
                                          allocInfo);
@@ -2036,15 +2614,26 @@ NrMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedback,
 
   NS_ASSERT (ulAssignationStartPoint.m_rbg == 0);
 
+  if (ulSymAvail > 0 && m_ulCg.size () > 0)
+    {
+      uint8_t usedCg = DoScheduleUlConfiguredGrant (&ulAssignationStartPoint, ulSymAvail,
+                                                    ulSfn, allocInfo);
+      NS_ASSERT (ulSymAvail >= usedCg);
+      NS_LOG_INFO ("For the slot " << ulSfn << " reserved " <<
+                   static_cast<uint32_t> (usedCg) << " symbols for UL configured grants");
+      ulSymAvail -= usedCg;
+    }
+
   if (ulSymAvail > 0 && m_srList.size () > 0)
     {
       DoScheduleUlSr (&ulAssignationStartPoint, m_srList);
       m_srList.clear ();
     }
 
+  NrMacSchedulerPhaseTimer activeTimer (GetSlotStats (), NrMacSchedulerSlotStats::ACTIVE_UE);
   ActiveUeMap activeUlUe;
   ComputeActiveUe (&activeUlUe, &NrMacSchedulerUeInfo::GetUlLCG,
-                   &NrMacSchedulerUeInfo::GetUlHarqVector, "UL");
+                   &NrMacSchedulerUeInfo::GetUlHarqVector, m_ulCg, "UL");
 
   GetSecond GetUeInfoList;
   for (const auto & alloc : allocInfo->m_varTtiAllocInfo)
@@ -2070,6 +2659,8 @@ NrMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedback,
         }
     }
 
+  activeTimer.Stop ();
+
   if (ulSymAvail > 0 && activeUlUe.size () > 0)
     {
       uint8_t usedUl = DoScheduleUlData (&ulAssignationStartPoint, ulSymAvail,
@@ -2167,19 +2758,17 @@ NrMacSchedulerNs3::DoScheduleSrs (PointInFTPlane *spoint, SlotAllocInfo *allocIn
 
   for (uint32_t i = 0; i < m_srsCtrlSymbols; ++i)
     {
-      std::vector<uint8_t> rbgAssigned (GetBandwidthInRbg (), 1);
-
       NS_LOG_INFO ("UE " << rnti << " assigned symbol " << +spoint->m_sym << " for SRS tx");
 
-      std::vector<uint8_t> rbgBitmask (GetBandwidthInRbg (), 1);
+      NrRbMask rbgBitmask (GetBandwidthInRbg (), true);
 
       spoint->m_sym--;
 
       //Due to MIMO implementation MCS, TB size, ndi, rv, are vectors
-      std::vector<uint8_t> mcs = {0};
-      std::vector<uint32_t> tbs = {0};
-      std::vector<uint8_t> ndi = {1};
-      std::vector<uint8_t> rv = {0};
+      NrStreamArray<uint8_t> mcs = {0};
+      NrStreamArray<uint32_t> tbs = {0};
+      NrStreamArray<uint8_t> ndi = {1};
+      NrStreamArray<uint8_t> rv = {0};
 
       auto dci = std::make_shared<DciInfoElementTdma> (rnti, DciInfoElementTdma::UL,
                                                        spoint->m_sym, 1, mcs, tbs,
@@ -2274,6 +2863,7 @@ NrMacSchedulerNs3::DoScheduleDl (const std::vector <DlHarqInfo> &dlHarqFeedback,
 
   if (activeDlHarq.size () > 0)
     {
+      NrMacSchedulerPhaseTimer harqTimer (GetSlotStats (), NrMacSchedulerSlotStats::HARQ);
       uint8_t usedHarq = ScheduleDlHarq (&dlAssignationStartPoint, dlSymAvail,
                                          activeDlHarq, m_ueMap, &m_dlHarqToRetransmit,
                                          dlHarqFeedback, allocInfo);
@@ -2281,6 +2871,14 @@ NrMacSchedulerNs3::DoScheduleDl (const std::vector <DlHarqInfo> &dlHarqFeedback,
       dlSymAvail -= usedHarq;
     }
 
+  if (dlSymAvail > 0 && m_dlSps.size () > 0)
+    {
+      uint8_t usedSps = DoScheduleDlSps (&dlAssignationStartPoint, dlSymAvail,
+                                         dlSfnSf, allocInfo);
+      NS_ASSERT (dlSymAvail >= usedSps);
+      dlSymAvail -= usedSps;
+    }
+
   GetSecond GetUeInfoList;
 
   for (const auto & alloc : allocInfo->m_varTtiAllocInfo)
@@ -2334,8 +2932,19 @@ NrMacSchedulerNs3::DoSchedDlTriggerReq (const NrMacSchedSapProvider::SchedDlTrig
 {
   NS_LOG_FUNCTION (this);
 
+  if (DeferSapCall ([this, params] { DoSchedDlTriggerReq (params); }, true))
+    {
+      return;
+    }
+
+  StartSlotStats (params.m_snfSf, true);
+
   // process received CQIs
+  NrMacSchedulerPhaseTimer cqiTimer (GetSlotStats (), NrMacSchedulerSlotStats::CQI_REFRESH);
   m_cqiManagement.RefreshDlCqiMaps (m_ueMap);
+  cqiTimer.Stop ();
+
+  NrMacSchedulerPhaseTimer harqTimer (GetSlotStats (), NrMacSchedulerSlotStats::HARQ);
 
   // reset expired HARQ
   for (const auto & itUe : m_ueMap)
@@ -2359,57 +2968,47 @@ NrMacSchedulerNs3::DoSchedDlTriggerReq (const NrMacSchedSapProvider::SchedDlTrig
                      " existing: " << existingSize << " received: " << inSize <<
                      " calculated: " << dlHarqFeedback.size ());
 
-      std::unordered_map<uint16_t, std::set<uint32_t>> feedbacksDup;
-
       // Let's find out:
       // 1) Feedback that arrived late (i.e., their process has been marked inactive
       //    due to timings
       // 2) Duplicated feedbacks (same UE, same process ID). I don't know why
       //    these are generated.. but anyway..
-      for (auto it = dlHarqFeedback.begin (); it != dlHarqFeedback.end (); /* no inc */)
+      // The HARQ vector of each UE remembers the processes already seen.
+      auto last = std::remove_if (dlHarqFeedback.begin (), dlHarqFeedback.end (),
+                                  [this] (const DlHarqInfo &feedback)
         {
-          auto & ueInfo = m_ueMap.find (it->m_rnti)->second;
-          auto & process = ueInfo->m_dlHarq.Find (it->m_harqProcessId)->second;
-          NS_LOG_INFO ("Analyzing feedback for UE " << it->m_rnti << " process " <<
-                       static_cast<uint32_t> (it->m_harqProcessId));
-          if (!process.m_active)
+          NrMacHarqVector & harq = m_ueMap.find (feedback.m_rnti)->second->m_dlHarq;
+          NS_LOG_INFO ("Analyzing feedback for UE " << feedback.m_rnti << " process " <<
+                       static_cast<uint32_t> (feedback.m_harqProcessId));
+          if (!harq.Get (feedback.m_harqProcessId).m_active)
             {
-              NS_LOG_INFO ("Feedback for UE " << it->m_rnti << " process " <<
-                           static_cast<uint32_t> (it->m_harqProcessId) <<
+              NS_LOG_INFO ("Feedback for UE " << feedback.m_rnti << " process " <<
+                           static_cast<uint32_t> (feedback.m_harqProcessId) <<
                            " ignored because process is INACTIVE");
-              it = dlHarqFeedback.erase (it);    /* INC */
+              return true;
             }
-          else
+          if (!harq.MarkFeedback (feedback.m_harqProcessId))
             {
-              auto itDuplicated = feedbacksDup.find(it->m_rnti);
-              if (itDuplicated == feedbacksDup.end())
-                {
-                  feedbacksDup.insert(std::make_pair (it->m_rnti, std::set<uint32_t> ()));
-                  feedbacksDup.at(it->m_rnti).insert(it->m_harqProcessId);
-                  ++it; /* INC */
-                }
-              else
-                {
-                  if (itDuplicated->second.find(it->m_harqProcessId) == itDuplicated->second.end())
-                    {
-                      itDuplicated->second.insert(it->m_harqProcessId);
-                      ++it; /* INC */
-                    }
-                  else
-                    {
-                      NS_LOG_INFO ("Feedback for UE " << it->m_rnti << " process " <<
-                                   static_cast<uint32_t> (it->m_harqProcessId) <<
-                                   " ignored because is a duplicate of another feedback");
-                      it = dlHarqFeedback.erase (it); /* INC */
-                    }
-                }
+              NS_LOG_INFO ("Feedback for UE " << feedback.m_rnti << " process " <<
+                           static_cast<uint32_t> (feedback.m_harqProcessId) <<
+                           " ignored because is a duplicate of another feedback");
+              return true;
             }
+          return false;
+        });
+      dlHarqFeedback.erase (last, dlHarqFeedback.end ());
+
+      for (const auto & feedback : dlHarqFeedback)
+        {
+          m_ueMap.find (feedback.m_rnti)->second->m_dlHarq.ClearFeedbackMarks ();
         }
 
       ProcessHARQFeedbacks (&dlHarqFeedback, NrMacSchedulerUeInfo::GetDlHarqVector,
                             "DL");
     }
 
+  harqTimer.Stop ();
+
   ScheduleDl (params, dlHarqFeedback);
 }
 
@@ -2428,8 +3027,19 @@ NrMacSchedulerNs3::DoSchedUlTriggerReq (const NrMacSchedSapProvider::SchedUlTrig
 {
   NS_LOG_FUNCTION (this);
 
+  if (DeferSapCall ([this, params] { DoSchedUlTriggerReq (params); }, true))
+    {
+      return;
+    }
+
+  StartSlotStats (params.m_snfSf, false);
+
   // process received CQIs
+  NrMacSchedulerPhaseTimer cqiTimer (GetSlotStats (), NrMacSchedulerSlotStats::CQI_REFRESH);
   m_cqiManagement.RefreshUlCqiMaps (m_ueMap);
+  cqiTimer.Stop ();
+
+  NrMacSchedulerPhaseTimer harqTimer (GetSlotStats (), NrMacSchedulerSlotStats::HARQ);
 
   // reset expired HARQ
   for (const auto & itUe : m_ueMap)
@@ -2453,27 +3063,27 @@ NrMacSchedulerNs3::DoSchedUlTriggerReq (const NrMacSchedSapProvider::SchedUlTrig
                      " calculated: " << ulHarqFeedback.size ());
 
       // if there are feedbacks for expired process, remove them
-      for (auto it = ulHarqFeedback.begin (); it != ulHarqFeedback.end (); /* no inc */)
+      auto last = std::remove_if (ulHarqFeedback.begin (), ulHarqFeedback.end (),
+                                  [this] (const UlHarqInfo &feedback)
         {
-          auto & ueInfo = m_ueMap.find (it->m_rnti)->second;
-          auto & process = ueInfo->m_ulHarq.Find (it->m_harqProcessId)->second;
-          if (!process.m_active)
+          const NrMacHarqVector & harq = m_ueMap.find (feedback.m_rnti)->second->m_ulHarq;
+          if (!harq.Get (feedback.m_harqProcessId).m_active)
             {
-              NS_LOG_INFO ("Feedback for UE " << it->m_rnti << " process " <<
-                           static_cast<uint32_t> (it->m_harqProcessId) <<
+              NS_LOG_INFO ("Feedback for UE " << feedback.m_rnti << " process " <<
+                           static_cast<uint32_t> (feedback.m_harqProcessId) <<
                            " ignored because process is INACTIVE");
-              it = ulHarqFeedback.erase (it);
-            }
-          else
-            {
-              ++it;
+              return true;
             }
-        }
+          return false;
+        });
+      ulHarqFeedback.erase (last, ulHarqFeedback.end ());
 
       ProcessHARQFeedbacks (&ulHarqFeedback, NrMacSchedulerUeInfo::GetUlHarqVector,
                             "UL");
     }
 
+  harqTimer.Stop ();
+
   ScheduleUl (params, ulHarqFeedback);
 }
 
@@ -2488,6 +3098,11 @@ NrMacSchedulerNs3::DoSchedUlSrInfoReq (const NrMacSchedSapProvider::SchedUlSrInf
 {
   NS_LOG_FUNCTION (this);
 
+  if (DeferSapCall ([this, params] { DoSchedUlSrInfoReq (params); }, false))
+    {
+      return;
+    }
+
   // Merge RNTI in our current list
   for (const auto & ue : params.m_srList)
     {
@@ -2502,4 +3117,72 @@ NrMacSchedulerNs3::DoSchedUlSrInfoReq (const NrMacSchedSapProvider::SchedUlSrInf
   NS_ASSERT (m_srList.size () >= params.m_srList.size ());
 }
 
+bool
+NrMacSchedulerNs3::DeferSapCall (std::function<void ()> &&call, bool isTrigger)
+{
+  if (! m_parallelScheduling || m_runningDeferred)
+    {
+      return false;
+    }
+
+  if (m_deferredSapCalls.empty ())
+    {
+      if (! isTrigger)
+        {
+          // No trigger is waiting: the call can be applied immediately
+          return false;
+        }
+      NrMacSchedulerSlotDispatcher::Get ()->Enqueue (this, m_parallelThreads);
+    }
+
+  // Everything that arrives after a deferred trigger is queued behind it,
+  // to be applied in the same order as in a sequential execution
+  m_deferredSapCalls.emplace_back (std::move (call));
+  return true;
+}
+
+void
+NrMacSchedulerNs3::RunDeferredSapCalls ()
+{
+  m_runningDeferred = true;
+  for (const auto & call : m_deferredSapCalls)
+    {
+      call ();
+    }
+  m_deferredSapCalls.clear ();
+  m_runningDeferred = false;
+}
+
+void
+NrMacSchedulerNs3::DeliverDeferredIndications ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_deferredSapCalls.empty ());
+
+  for (const auto & ind : m_deferredIndications)
+    {
+      m_macSchedSapUser->SchedConfigInd (ind);
+    }
+  m_deferredIndications.clear ();
+
+  for (const auto & stats : m_deferredSlotStats)
+    {
+      m_slotStatsTrace (stats);
+    }
+  m_deferredSlotStats.clear ();
+}
+
+void
+NrMacSchedulerNs3::SendSchedConfigInd (const NrMacSchedSapUser::SchedConfigIndParameters &params)
+{
+  if (m_runningDeferred)
+    {
+      m_deferredIndications.push_back (params);
+    }
+  else
+    {
+      m_macSchedSapUser->SchedConfigInd (params);
+    }
+}
+
 } // namespace ns3
@@ -25,6 +25,9 @@
 #include "nr-mac-scheduler-lcg.h"
 #include "nr-mac-scheduler-cqi-management.h"
 #include "nr-amc.h"
+#include "nr-mac-scheduler-slot-stats.h"
+#include <ns3/traced-callback.h>
+#include <array>
 #include <memory>
 #include <functional>
 #include <list>
@@ -34,6 +37,7 @@ namespace ns3 {
 class NrSchedGeneralTestCase;
 class NrMacSchedulerHarqRr;
 class NrMacSchedulerSrsDefault;
+class NrMacSchedulerSlotDispatcher;
 
 /**
  * \ingroup scheduler
@@ -227,12 +231,31 @@ class NrMacSchedulerSrsDefault;
  * The available schedulers are TDMA and OFDMA version of the Round Robin,
  * Proportional Fair, and Maximum Rate.
  *
+ * \section scheduler_parallel Parallel scheduling
+ *
+ * With the attribute ParallelScheduling, the trigger requests are not
+ * computed when they arrive. The scheduler queues them (together with any
+ * other SAP call received after them) and registers itself in the
+ * NrMacSchedulerSlotDispatcher, which, once all the cells have received
+ * their triggers for the current simulation time, executes the queues of
+ * the different schedulers on a pool of threads. The decisions are then
+ * indicated to the MAC from the main thread, in the order in which the
+ * schedulers received their triggers. Since the slots are scheduled
+ * in advance (the L1L2 control latency), the MAC and the PHY receive the
+ * decisions in time; the gNB PHY starts its slot (and sends the CTRL
+ * messages, such as the RAR, that the MAC enqueues with the decisions)
+ * after the decisions have been indicated. Logging, and the sinks connected to the scheduler
+ * trace sources, are not protected against concurrent calls: keep
+ * them disabled when this option is enabled.
+ *
  * \see NrMacSchedulerOfdmaPF
  * \see NrMacSchedulerOfdmaRR
  * \see NrMacSchedulerOfdmaMR
+ * \see NrMacSchedulerOfdmaQos
  * \see NrMacSchedulerTdmaPF
  * \see NrMacSchedulerTdmaRR
  * \see NrMacSchedulerTdmaMR
+ * \see NrMacSchedulerTdmaQos
  */
 class NrMacSchedulerNs3 : public NrMacScheduler
 {
@@ -534,7 +557,127 @@ public:
    */
   bool IsHarqReTxEnable () const;
 
+  /**
+   * \brief Periodic resources reserved to a UE: DL semi-persistent scheduling
+   * (SPS) or UL configured grant
+   *
+   * In a slot in which the normalized slot number, modulo the periodicity,
+   * is equal to the offset (an occasion), the UE gets m_numSym symbols over
+   * all the assignable RBGs, with the configured MCS, before any dynamic
+   * decision is taken. A UE with an active configuration is not
+   * considered for the dynamic scheduling of new data in that direction;
+   * HARQ retransmissions are still scheduled dynamically.
+   *
+   * - DL_SPS: the occasion is used only if the UE has DL data;
+   * - UL_TYPE1: the grant is given at each occasion, even without a BSR
+   * or a SR, so the UE does not have to ask for resources;
+   * - UL_TYPE2: the grant is activated by the first BSR (or SR) with data,
+   * and released after m_releaseAfter consecutive occasions in which the
+   * UE had nothing to transmit (0 means never).
+   */
+  struct SemiPersistentConfig
+  {
+    /**
+     * \brief Type of the configuration
+     */
+    enum Type : uint8_t
+    {
+      DL_SPS,   //!< DL semi-persistent scheduling
+      UL_TYPE1, //!< UL configured grant Type 1
+      UL_TYPE2  //!< UL configured grant Type 2
+    };
+
+    Type m_type {DL_SPS};        //!< Type of the configuration
+    uint16_t m_periodicity {0};  //!< Number of slots between two occasions
+    uint16_t m_offset {0};       //!< Slot of the occasions, modulo the periodicity
+    uint8_t m_numSym {1};        //!< Number of symbols of each occasion
+    uint8_t m_mcs {0};           //!< MCS of each occasion
+    uint8_t m_releaseAfter {0};  //!< Empty occasions before the release of a Type 2 grant (0: never)
+    bool m_active {false};       //!< True if the resources are in use
+    uint8_t m_emptyOccasions {0}; //!< Consecutive occasions without data
+  };
+
+  /**
+   * \brief Reserve periodic resources to a UE
+   * \param rnti the RNTI of the UE
+   * \param config the configuration
+   *
+   * A previous configuration of the UE in the same direction is replaced.
+   * The configuration is removed when the UE is released.
+   *
+   * The attributes DlSpsPeriodicity and UlConfiguredGrantPeriodicity give
+   * a configuration to each UE when it is added to the scheduler; this
+   * method is meant for a per-UE configuration.
+   */
+  void SetSemiPersistentConfig (uint16_t rnti, const SemiPersistentConfig &config);
+
+  /**
+   * \brief Release the periodic resources of a UE
+   * \param rnti the RNTI of the UE
+   * \param format DL to release the SPS, UL to release the configured grant
+   */
+  void ReleaseSemiPersistentConfig (uint16_t rnti, DciInfoElementTdma::DciFormat format);
+
+  /**
+   * \brief Enable or disable the collection of the per-slot statistics
+   * \param enable true to collect the statistics
+   *
+   * \see NrMacSchedulerSlotStats
+   */
+  void SetSlotStatsEnabled (bool enable);
+
+  /**
+   * \brief Check if the per-slot statistics are collected
+   * \return true if the statistics are collected
+   */
+  bool IsSlotStatsEnabled () const;
+
+  /**
+   * \brief Get the statistics accumulated since the start of the simulation
+   * \param isDl true for the DL decisions, false for the UL ones
+   * \return the sum of the statistics of all the slots
+   */
+  const NrMacSchedulerSlotStats & GetSlotStatsTotal (bool isDl) const;
+
+  /**
+   * TracedCallback signature for the per-slot statistics of the scheduler
+   *
+   * \param [in] stats the time and the work spent to decide the slot
+   */
+  typedef void (* SlotStatsTracedCallback) (const NrMacSchedulerSlotStats &stats);
+
 protected:
+  /**
+   * \brief Log the statistics summary, if the statistics are enabled
+   */
+  void DoDispose () override;
+
+  /**
+   * \brief Get the statistics of the slot being scheduled
+   * \return the statistics, or nullptr if they are disabled
+   *
+   * Use it with NrMacSchedulerPhaseTimer to measure a phase.
+   */
+  NrMacSchedulerSlotStats * GetSlotStats () const
+  {
+    return m_slotStats.get ();
+  }
+
+  /**
+   * \brief Add to a work counter of the slot being scheduled
+   * \param counter the counter
+   * \param value the value to add
+   *
+   * Nothing is done if the statistics are disabled.
+   */
+  void CountSlotStat (NrMacSchedulerSlotStats::Counter counter, uint64_t value = 1) const
+  {
+    if (m_slotStats != nullptr)
+      {
+        m_slotStats->m_counters[counter] += value;
+      }
+  }
+
   /**
    * \brief Create an UE representation for the scheduler.
    *
@@ -707,9 +850,9 @@ protected:
   struct Assignation
   {
     /**
-     * \brief Assignation constructor (deleted)
+     * \brief Assignation default constructor, for the slots of an AssignationArray
      */
-    Assignation () = delete;
+    Assignation () = default;
     /**
      * \brief Assignation copy constructor (deleted)
      * \param o other instance
@@ -720,6 +863,12 @@ protected:
       * \param o other instance
       */
     Assignation (Assignation &&o) = default;
+    /**
+      * \brief Assignation move assignment (default)
+      * \param o other instance
+      * \return this instance
+      */
+    Assignation & operator= (Assignation &&o) = default;
     /**
      * \brief Assignation constructor with parameters
      * \param lcg LCG ID
@@ -740,6 +889,15 @@ protected:
     uint32_t m_bytes {0};  //!< Bytes assigned to the LC
   };
 
+  /**
+   * \brief The assignations of a TB to the LCs of a UE
+   *
+   * The LC ids of a UE are unique, and they have 6 bits: the array has room
+   * for all of them, and it is filled by AssignBytesToLC() without any
+   * allocation.
+   */
+  typedef std::array<Assignation, 64> AssignationArray;
+
 protected:
   Ptr<NrAmc> m_dlAmc; //!< AMC pointer
   Ptr<NrAmc> m_ulAmc; //!< AMC pointer
@@ -766,7 +924,7 @@ private:
      * \param mcs MCS
      */
     AllocElem (uint16_t rnti, uint32_t tbs, uint8_t symStart, uint8_t numSym, uint8_t mcs,
-               const std::vector<uint8_t> &rbgMask)
+               const NrRbMask &rbgMask)
       : m_rnti (rnti), m_tbs (tbs), m_symStart (symStart), m_numSym (numSym), m_mcs (mcs),
         m_rbgMask (rbgMask)
     {
@@ -777,7 +935,7 @@ private:
     uint8_t m_symStart {0}; //!< Sym start
     uint8_t m_numSym {0}; //!< Allocated symbols
     uint8_t m_mcs   {0};  //!< MCS of the transmission
-    std::vector<uint8_t> m_rbgMask; //!< RBG Mask
+    NrRbMask m_rbgMask;   //!< RBG Mask
   };
 
   /**
@@ -807,8 +965,9 @@ private:
     std::vector<AllocElem> m_ulAllocations; //!< List of UL allocations
   };
 
-  std::vector<Assignation>
-  AssignBytesToLC (const std::unordered_map<uint8_t, LCGPtr> &ueLCG, uint32_t tbs) const;
+  uint8_t
+  AssignBytesToLC (const NrMacSchedulerLCGMap &ueLCG, uint32_t tbs,
+                   AssignationArray *assignations) const;
 
   void BSRReceivedFromUe (const MacCeElement &bsr);
 
@@ -840,8 +999,15 @@ private:
                           std::deque<VarTtiAllocInfo> *allocations) const;
 
 
+  /**
+   * \brief Map between the RNTI and its periodic resources in one direction,
+   * ordered by RNTI to visit the occasions always in the same order
+   */
+  typedef std::map<uint16_t, SemiPersistentConfig> SemiPersistentMap;
+
   void ComputeActiveUe (ActiveUeMap *activeDlUe, const NrMacSchedulerUeInfo::GetLCGFn &GetLCGFn,
                         const NrMacSchedulerUeInfo::GetHarqVectorFn &GetHarqVector,
+                        const SemiPersistentMap &semiPersistent,
                         const std::string &mode) const;
   void ComputeActiveHarq (ActiveHarqMap *activeDlHarq, const std::vector <DlHarqInfo> &dlHarqFeedback) const;
   void ComputeActiveHarq (ActiveHarqMap *activeUlHarq, const std::vector <UlHarqInfo> &ulHarqFeedback) const;
@@ -857,6 +1023,53 @@ private:
   uint8_t DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedback, const SfnSf &ulSfn,
                         SlotAllocInfo *allocInfo, LteNrTddSlotType type);
   uint8_t DoScheduleSrs (PointInFTPlane *spoint, SlotAllocInfo *allocInfo);
+  uint8_t DoScheduleDlSps (PointInFTPlane *spoint, uint8_t symAvail, const SfnSf &dlSfn,
+                           SlotAllocInfo *allocInfo);
+  uint8_t DoScheduleUlConfiguredGrant (PointInFTPlane *spoint, uint8_t symAvail,
+                                       const SfnSf &ulSfn, SlotAllocInfo *allocInfo);
+
+  /**
+   * \brief Defer a SAP call when the parallel scheduling is enabled
+   * \param call the call to (eventually) defer
+   * \param isTrigger true if the call is a DL or UL trigger request
+   * \return true if the call has been queued, false if it has to be executed now
+   *
+   * A trigger request is always queued, and the scheduler is registered
+   * within the NrMacSchedulerSlotDispatcher. Any other call is queued only
+   * if a trigger is already waiting, so that the order of the calls is
+   * the same as in a sequential execution.
+   */
+  bool DeferSapCall (std::function<void ()> &&call, bool isTrigger);
+  /**
+   * \brief Execute, in order, the queued SAP calls
+   *
+   * Called by the dispatcher, possibly from a worker thread.
+   */
+  void RunDeferredSapCalls ();
+  /**
+   * \brief Indicate to the MAC the decisions taken while executing the queued calls
+   *
+   * Called by the dispatcher from the main thread.
+   */
+  void DeliverDeferredIndications ();
+  /**
+   * \brief Indicate a scheduling decision to the MAC, or store it if
+   * the call comes from RunDeferredSapCalls()
+   * \param params the decision
+   */
+  void SendSchedConfigInd (const NrMacSchedSapUser::SchedConfigIndParameters &params);
+  /**
+   * \brief Prepare the statistics for a new slot, if they are enabled
+   * \param sfnSf the slot
+   * \param isDl true for a DL decision, false for UL
+   */
+  void StartSlotStats (const SfnSf &sfnSf, bool isDl);
+  /**
+   * \brief Complete the statistics of the slot, and report them through
+   * the trace source (or store them if the call comes from RunDeferredSapCalls())
+   * \param allocInfo the decision
+   */
+  void ReportSlotStats (const SlotAllocInfo &allocInfo);
 
   static const unsigned m_macHdrSize = 0;  //!< Mac Header size
   static const uint32_t m_subHdrSize = 4;  //!< Sub Header size (?)
@@ -880,6 +1093,20 @@ protected:
    */
   uint16_t GetBandwidthInRbg () const;
 
+  /**
+   * \brief Get the RBGs that can be assigned in the DL
+   * \return a mask with 1 in the RBGs that are not notched (all 1s if no
+   * notched mask has been set)
+   */
+  NrRbMask GetDlAssignableRbgMask () const;
+
+  /**
+   * \brief Get the RBGs that can be assigned in the UL
+   * \return a mask with 1 in the RBGs that are not notched (all 1s if no
+   * notched mask has been set)
+   */
+  NrRbMask GetUlAssignableRbgMask () const;
+
 private:
   std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > m_ueMap; //!< The map of between RNTI and their data
 
@@ -903,6 +1130,16 @@ private:
 
   std::list<uint16_t> m_srList;  //!< List of RNTI of UEs that asked for a SR
 
+  SemiPersistentMap m_dlSps; //!< DL SPS configurations
+  SemiPersistentMap m_ulCg;  //!< UL configured grants
+
+  uint16_t m_defaultDlSpsPeriodicity {0}; //!< Periodicity of the DL SPS of the new UEs (attribute)
+  uint16_t m_defaultUlCgPeriodicity {0};  //!< Periodicity of the UL configured grant of the new UEs (attribute)
+  SemiPersistentConfig::Type m_defaultUlCgType {SemiPersistentConfig::UL_TYPE1}; //!< Type of the UL configured grant of the new UEs (attribute)
+  uint8_t m_defaultUlCgReleaseAfter {0};  //!< Release of the Type 2 grants of the new UEs (attribute)
+  uint8_t m_defaultSemiPersistentSym {1}; //!< Symbols of the occasions of the new UEs (attribute)
+  uint8_t m_defaultSemiPersistentMcs {0}; //!< MCS of the occasions of the new UEs (attribute)
+
   std::vector <struct RachListElement_s> m_rachList; //!< rach list
 
   uint16_t m_bandwidth {0}; //!< Bandwidth in number of RBG
@@ -912,8 +1149,8 @@ private:
   bool m_enableSrsInUlSlots  {true}; //!< SRS allowed in UL slots (attribute)
   bool m_enableSrsInFSlots  {true}; //!< SRS allowed in F slots (attribute)
 
-  std::vector<uint8_t> m_dlNotchedRbgsMask; //!< The mask of notched (blank) RBGs for the DL
-  std::vector<uint8_t> m_ulNotchedRbgsMask; //!< The mask of notched (blank) RBGs for the UL
+  NrRbMask m_dlNotchedRbgsMask; //!< The mask of notched (blank) RBGs for the DL
+  NrRbMask m_ulNotchedRbgsMask; //!< The mask of notched (blank) RBGs for the UL
 
   std::unique_ptr <NrMacSchedulerHarqRr> m_schedHarq; //!< Pointer to the real HARQ scheduler
 
@@ -922,8 +1159,21 @@ private:
   uint32_t m_srsSlotCounter {0}; //!< Counter for UL slots
 
   friend NrSchedGeneralTestCase;
+  friend class NrMacSchedulerSlotDispatcher;
 
   bool m_enableHarqReTx  {true}; //!< Flag to enable or disable HARQ ReTx (attribute)
+
+  bool m_parallelScheduling {false}; //!< Compute the triggers in the slot dispatcher (attribute)
+  uint32_t m_parallelThreads {0};    //!< Max threads of the slot dispatcher (attribute)
+  bool m_runningDeferred {false};    //!< True while executing the queued SAP calls
+  std::vector<std::function<void ()> > m_deferredSapCalls; //!< SAP calls waiting for the dispatcher
+  std::vector<NrMacSchedSapUser::SchedConfigIndParameters> m_deferredIndications; //!< Decisions waiting to be indicated to the MAC
+
+  std::unique_ptr<NrMacSchedulerSlotStats> m_slotStats; //!< Statistics of the current slot (nullptr if disabled)
+  NrMacSchedulerSlotStats m_dlSlotStatsTotal;          //!< Sum of the DL statistics
+  NrMacSchedulerSlotStats m_ulSlotStatsTotal;          //!< Sum of the UL statistics
+  std::vector<NrMacSchedulerSlotStats> m_deferredSlotStats; //!< Statistics waiting to be traced
+  TracedCallback<const NrMacSchedulerSlotStats &> m_slotStatsTrace; //!< Per-slot statistics trace
 };
 
 } //namespace ns3
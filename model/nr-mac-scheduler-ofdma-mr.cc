@@ -18,6 +18,7 @@
  */
 #include "nr-mac-scheduler-ofdma-mr.h"
 #include "nr-mac-scheduler-ue-info-mr.h"
+#include "nr-mac-scheduler-policy.h"
 #include <ns3/log.h>
 
 namespace ns3 {
@@ -62,4 +63,26 @@ NrMacSchedulerOfdmaMR::GetUeCompareUlFn () const
   return NrMacSchedulerUeInfoMR::CompareUeWeightsUl;
 }
 
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaMR::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerOfdma::AssignDLRBG (symAvail, activeDl);
+    }
+  return AssignDLRBGWithMetric (symAvail, activeDl, NrMacSchedulerMetricMR (m_dlAmc, m_ulAmc));
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaMR::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerOfdma::AssignULRBG (symAvail, activeUl);
+    }
+  return AssignULRBGWithMetric (symAvail, activeUl, NrMacSchedulerMetricMR (m_dlAmc, m_ulAmc));
+}
+
 } // namespace ns3
@@ -18,6 +18,7 @@
  */
 #include "nr-mac-scheduler-ofdma-pf.h"
 #include "nr-mac-scheduler-ue-info-pf.h"
+#include "nr-mac-scheduler-policy.h"
 #include <algorithm>
 #include <ns3/double.h>
 #include <ns3/log.h>
@@ -162,4 +163,26 @@ NrMacSchedulerOfdmaPF::BeforeUlSched (const UePtrAndBufferReq &ue,
   uePtr->CalculatePotentialTPutUl (assignableInIteration, m_ulAmc);
 }
 
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaPF::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerOfdma::AssignDLRBG (symAvail, activeDl);
+    }
+  return AssignDLRBGWithMetric (symAvail, activeDl, NrMacSchedulerMetricPF (m_dlAmc, m_ulAmc, m_timeWindow));
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaPF::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerOfdma::AssignULRBG (symAvail, activeUl);
+    }
+  return AssignULRBGWithMetric (symAvail, activeUl, NrMacSchedulerMetricPF (m_dlAmc, m_ulAmc, m_timeWindow));
+}
+
 } // namespace ns3
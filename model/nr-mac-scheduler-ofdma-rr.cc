@@ -18,6 +18,7 @@
  */
 #include "nr-mac-scheduler-ofdma-rr.h"
 #include "nr-mac-scheduler-ue-info-rr.h"
+#include "nr-mac-scheduler-policy.h"
 #include <ns3/log.h>
 
 namespace ns3 {
@@ -80,4 +81,26 @@ NrMacSchedulerOfdmaRR::GetUeCompareUlFn () const
   return NrMacSchedulerUeInfoRR::CompareUeWeightsUl;
 }
 
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaRR::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerOfdma::AssignDLRBG (symAvail, activeDl);
+    }
+  return AssignDLRBGWithMetric (symAvail, activeDl, NrMacSchedulerMetricRR (m_dlAmc, m_ulAmc));
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaRR::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerOfdma::AssignULRBG (symAvail, activeUl);
+    }
+  return AssignULRBGWithMetric (symAvail, activeUl, NrMacSchedulerMetricRR (m_dlAmc, m_ulAmc));
+}
+
 } // namespace ns3
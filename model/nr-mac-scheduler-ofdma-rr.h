@@ -61,6 +61,29 @@ public:
   }
 
 protected:
+  /**
+   * \brief Assign the DL RBG with the static policy NrMacSchedulerMetricRR
+   * \param symAvail Number of available symbols
+   * \param activeDl active DL flows and UE
+   * \return a map between the beam and the symbols assigned to each one
+   *
+   * If the instance is of a subclass (with a different TypeId), which may
+   * redefine the metric methods, NrMacSchedulerOfdma::AssignDLRBG is used instead.
+   */
+  virtual BeamSymbolMap
+  AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const override;
+
+  /**
+   * \brief Assign the UL RBG with the static policy NrMacSchedulerMetricRR
+   * \param symAvail Number of available symbols
+   * \param activeUl active UL flows and UE
+   * \return a map between the beam and the symbols assigned to each one
+   *
+   * \see AssignDLRBG
+   */
+  virtual BeamSymbolMap
+  AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const override;
+
   /**
    * \brief Create an UE representation of the type NrMacSchedulerUeInfoRR
    * \param params parameters
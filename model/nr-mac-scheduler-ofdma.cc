@@ -26,6 +26,7 @@
   while (false);
 
 #include "nr-mac-scheduler-ofdma.h"
+#include "nr-mac-scheduler-policy.h"
 #include <ns3/log.h>
 #include <algorithm>
 
@@ -136,6 +137,7 @@ NrMacSchedulerOfdma::GetSymPerBeam (uint32_t symAvail,
  * \brief Assign the available DL RBG to the UEs
  * \param symAvail Available symbols
  * \param activeDl Map of active UE and their beams
+ * \param metric the metric policy
  * \return a map between beams and the symbol they need
  *
  * The algorithm redistributes the frequencies to all the UEs inside a beam.
@@ -151,14 +153,16 @@ NrMacSchedulerOfdma::GetSymPerBeam (uint32_t symAvail,
  *    UpdateUeDlMetric (ueVector.first());
  * </pre>
  *
- * To sort the UEs, the method uses the function returned by GetUeCompareDlFn().
+ * To sort the UEs, the method uses the comparison of the metric policy.
  * Two fairness helper are hard-coded in the method: the first one is avoid
  * to assign resources to UEs that already have their buffer requirement covered,
  * and the other one is avoid to assign symbols when all the UEs have their
  * requirements covered.
  */
+template <typename Metric>
 NrMacSchedulerNs3::BeamSymbolMap
-NrMacSchedulerOfdma::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+NrMacSchedulerOfdma::AssignDLRBGWithMetric (uint32_t symAvail, const ActiveUeMap &activeDl,
+                                            const Metric &metric) const
 {
   NS_LOG_FUNCTION (this);
 
@@ -176,10 +180,7 @@ NrMacSchedulerOfdma::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl
       uint32_t rbgAssignable = 1 * beamSym;
       std::vector<UePtrAndBufferReq> ueVector;
       FTResources assigned (0,0);
-      const std::vector<uint8_t> dlNotchedRBGsMask = GetDlNotchedRbgMask ();
-      uint32_t resources = dlNotchedRBGsMask.size () > 0 ? std::count (dlNotchedRBGsMask.begin (),
-                                                                     dlNotchedRBGsMask.end (),
-                                                                     1) : GetBandwidthInRbg ();
+      uint32_t resources = GetDlAssignableRbgMask ().Count ();
       NS_ASSERT (resources > 0);
 
       for (const auto &ue : GetUeVector (el))
@@ -189,75 +190,56 @@ NrMacSchedulerOfdma::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl
 
       for (auto & ue : ueVector)
         {
-          BeforeDlSched (ue, FTResources (rbgAssignable * beamSym, beamSym));
+          metric.BeforeDl (ue, FTResources (rbgAssignable * beamSym, beamSym));
+        }
+
+      // With HEAP_ORDER, the heap keeps on top the UE that the sort would put first
+      auto heapCompare = [&metric] (const UePtrAndBufferReq &lue, const UePtrAndBufferReq &rue)
+        {
+          return metric.CompareDl (rue, lue);
+        };
+      if constexpr (Metric::HEAP_ORDER)
+        {
+          std::make_heap (ueVector.begin (), ueVector.end (), heapCompare);
+          CountSlotStat (NrMacSchedulerSlotStats::SORT_CALLS);
         }
 
       while (resources > 0)
         {
           GetFirst GetUe;
-          std::sort (ueVector.begin (), ueVector.end (), GetUeCompareDlFn ());
-          auto schedInfoIt = ueVector.begin ();
+          auto schedInfoIt = ueVector.end ();
 
-          // Ensure fairness: pass over UEs which already has enough resources to transmit
-          while (schedInfoIt != ueVector.end ())
+          if constexpr (Metric::HEAP_ORDER)
             {
-              uint32_t bufQueueSize = schedInfoIt->second;
-
-              //if there are two streams we add the TbSizes of the two
-              //streams to satisfy the bufQueueSize
-              uint32_t tbSize = 0;
-              for (const auto &it:GetUe (*schedInfoIt)->m_dlTbSize)
-                {
-                  tbSize += it;
-                }
-
-              if (tbSize >= std::max (bufQueueSize, 7U))
+              // Ensure fairness: remove the UEs which already has enough resources
+              // to transmit, they will not get anything else in this slot
+              while (! ueVector.empty ())
                 {
-                  if (GetUe (*schedInfoIt)->m_dlTbSize.size () > 1)
+                  std::pop_heap (ueVector.begin (), ueVector.end (), heapCompare);
+                  if (! HasEnoughResources (ueVector.back (), true))
                     {
-                      // This "if" is purely for MIMO. In MIMO, for example, if the
-                      // first TB size is big enough to empty the buffer then we
-                      // should not allocate anything to the second stream. In this
-                      // case, if we allocate bytes to the second stream, the UE
-                      // would expect the TB but the gNB would not be able to transmit
-                      // it. This would break HARQ TX state machine at UE PHY.
-
-                      uint8_t streamCounter = 0;
-                      uint32_t copyBufQueueSize = bufQueueSize;
-                      auto dlTbSizeIt = GetUe (*schedInfoIt)->m_dlTbSize.begin ();
-                      while (dlTbSizeIt != GetUe (*schedInfoIt)->m_dlTbSize.end ())
-                        {
-                          if (copyBufQueueSize != 0)
-                            {
-                              NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *dlTbSizeIt << " needed to TX MIMO TB");
-                              if (*dlTbSizeIt >= copyBufQueueSize)
-                                {
-                                  copyBufQueueSize = 0;
-                                }
-                              else
-                                {
-                                  copyBufQueueSize = copyBufQueueSize - *dlTbSizeIt;
-                                }
-                              streamCounter++;
-                              dlTbSizeIt++;
-                            }
-                          else
-                            {
-                              // if we are here, that means previously iterated
-                              // streams were enough to empty the buffer. We do
-                              // not need this stream. Make its TB size zero.
-                              NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *dlTbSizeIt << " not needed to TX MIMO TB");
-                              *dlTbSizeIt = 0;
-                              streamCounter++;
-                              dlTbSizeIt++;
-                            }
-                        }
+                      break;
                     }
-                  schedInfoIt++;
+                  ueVector.pop_back ();
                 }
-              else
+              // The UE to serve is the last one, which has been popped from the heap
+              schedInfoIt = ueVector.empty () ? ueVector.end () : ueVector.end () - 1;
+            }
+          else
+            {
+              std::sort (ueVector.begin (), ueVector.end (),
+                         [&metric] (const UePtrAndBufferReq &lue, const UePtrAndBufferReq &rue)
+                         {
+                           return metric.CompareDl (lue, rue);
+                         });
+              CountSlotStat (NrMacSchedulerSlotStats::SORT_CALLS);
+
+              // Ensure fairness: pass over UEs which already has enough resources to transmit
+              schedInfoIt = ueVector.begin ();
+              while (schedInfoIt != ueVector.end ()
+                     && HasEnoughResources (*schedInfoIt, true))
                 {
-                  break;
+                  schedInfoIt++;
                 }
             }
 
@@ -282,31 +264,104 @@ NrMacSchedulerOfdma::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl
           NS_LOG_DEBUG ("Assigned " << rbgAssignable <<
                         " DL RBG, spanned over " << beamSym << " SYM, to UE " <<
                         GetUe (*schedInfoIt)->m_rnti);
-          //Following call to AssignedDlResources would update the
+          //Following call to AssignedDl would update the
           //TB size in the NrMacSchedulerUeInfo of this particular UE
           //according the Rank Indicator reported by it. Only one call
           //to this method is enough even if the UE reported rank indicator 2,
           //since the number of RBG assigned to both the streams are the same.
-          AssignedDlResources (*schedInfoIt, FTResources (rbgAssignable, beamSym),
-                               assigned);
+          metric.AssignedDl (*schedInfoIt, FTResources (rbgAssignable, beamSym), assigned);
+          CountSlotStat (NrMacSchedulerSlotStats::TBS_COMPUTATIONS);
 
-          // Update metrics for the unsuccessfull UEs (who did not get any resource in this iteration)
-          for (auto & ue : ueVector)
+          if constexpr (Metric::HEAP_ORDER)
             {
-              if (GetUe (ue)->m_rnti != GetUe (*schedInfoIt)->m_rnti)
+              // The other UEs did not change: put the UE back in the heap
+              std::push_heap (ueVector.begin (), ueVector.end (), heapCompare);
+            }
+          else
+            {
+              // Update metrics for the unsuccessfull UEs (who did not get any resource in this iteration)
+              for (auto & ue : ueVector)
                 {
-                  NotAssignedDlResources (ue, FTResources (rbgAssignable, beamSym),
-                                          assigned);
+                  if (GetUe (ue)->m_rnti != GetUe (*schedInfoIt)->m_rnti)
+                    {
+                      metric.NotAssignedDl (ue, FTResources (rbgAssignable, beamSym), assigned);
+                    }
                 }
             }
         }
+
+      PlaceDlRbgOnSubbands (GetUeVector (el), beamSym);
     }
 
   return symPerBeam;
 }
 
+void
+NrMacSchedulerOfdma::PlaceDlRbgOnSubbands (const std::vector<UePtrAndBufferReq> &ueVector,
+                                           uint32_t beamSym) const
+{
+  NS_LOG_FUNCTION (this);
+  GetFirst GetUe;
+
+  if (std::none_of (ueVector.begin (), ueVector.end (),
+                    [&GetUe] (const UePtrAndBufferReq &ue)
+                    {
+                      return GetUe (ue)->m_dlCqi.m_cqiType == NrMacSchedulerUeInfo::DlCqiInfo::SB;
+                    }))
+    {
+      return;
+    }
+
+  const NrRbMask assignable = GetDlAssignableRbgMask ();
+  const uint32_t numRbg = assignable.GetSize ();
+
+  // RBG still to be placed, and offset of each RBG, for each UE
+  std::vector<uint32_t> quota (ueVector.size (), 0);
+  std::vector<int8_t> offset (ueVector.size () * numRbg, 0);
+  uint32_t toPlace = 0;
+  for (uint32_t i = 0; i < ueVector.size (); ++i)
+    {
+      const auto & ue = GetUe (ueVector.at (i));
+      ue->m_dlRbgMask = NrRbMask (numRbg);
+      quota.at (i) = ue->m_dlRBG / beamSym;
+      toPlace += quota.at (i);
+      if (quota.at (i) > 0)
+        {
+          for (uint32_t rbg : assignable)
+            {
+              offset.at (i * numRbg + rbg) = ue->GetDlSubbandOffset (rbg);
+            }
+        }
+    }
+
+  NrRbMask freeRbg = assignable;
+  for (int8_t level = NrSubbandCqi::MAX_OFFSET; level >= NrSubbandCqi::MIN_OFFSET && toPlace > 0; --level)
+    {
+      for (uint32_t rbg = freeRbg.FindNextSet (0);
+           rbg < numRbg && toPlace > 0;
+           rbg = freeRbg.FindNextSet (rbg + 1))
+        {
+          for (uint32_t i = 0; i < ueVector.size (); ++i)
+            {
+              if (quota.at (i) > 0 && offset.at (i * numRbg + rbg) >= level)
+                {
+                  GetUe (ueVector.at (i))->m_dlRbgMask.Set (rbg);
+                  freeRbg.Reset (rbg);
+                  quota.at (i)--;
+                  toPlace--;
+                  break;
+                }
+            }
+        }
+    }
+
+  NS_ASSERT_MSG (toPlace == 0, "Assigned more RBG than the available ones");
+}
+
+template <typename Metric>
 NrMacSchedulerNs3::BeamSymbolMap
-NrMacSchedulerOfdma::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+NrMacSchedulerOfdma::AssignULRBGWithMetric (uint32_t symAvail, const ActiveUeMap &activeUl,
+                                            const Metric &metric) const
 {
   NS_LOG_FUNCTION (this);
 
@@ -324,10 +379,7 @@ NrMacSchedulerOfdma::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl
       uint32_t rbgAssignable = 1 * beamSym;
       std::vector<UePtrAndBufferReq> ueVector;
       FTResources assigned (0,0);
-      const std::vector<uint8_t> ulNotchedRBGsMask = GetUlNotchedRbgMask ();
-      uint32_t resources = ulNotchedRBGsMask.size () > 0 ? std::count (ulNotchedRBGsMask.begin (),
-                                                                     ulNotchedRBGsMask.end (),
-                                                                     1) : GetBandwidthInRbg ();
+      uint32_t resources = GetUlAssignableRbgMask ().Count ();
       NS_ASSERT (resources > 0);
 
       for (const auto &ue : GetUeVector (el))
@@ -337,26 +389,56 @@ NrMacSchedulerOfdma::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl
 
       for (auto & ue : ueVector)
         {
-          BeforeUlSched (ue, FTResources (rbgAssignable * beamSym, beamSym));
+          metric.BeforeUl (ue, FTResources (rbgAssignable * beamSym, beamSym));
+        }
+
+      // With HEAP_ORDER, the heap keeps on top the UE that the sort would put first
+      auto heapCompare = [&metric] (const UePtrAndBufferReq &lue, const UePtrAndBufferReq &rue)
+        {
+          return metric.CompareUl (rue, lue);
+        };
+      if constexpr (Metric::HEAP_ORDER)
+        {
+          std::make_heap (ueVector.begin (), ueVector.end (), heapCompare);
+          CountSlotStat (NrMacSchedulerSlotStats::SORT_CALLS);
         }
 
       while (resources > 0)
         {
           GetFirst GetUe;
-          std::sort (ueVector.begin (), ueVector.end (), GetUeCompareUlFn ());
-          auto schedInfoIt = ueVector.begin ();
+          auto schedInfoIt = ueVector.end ();
 
-          // Ensure fairness: pass over UEs which already has enough resources to transmit
-          while (schedInfoIt != ueVector.end ())
+          if constexpr (Metric::HEAP_ORDER)
             {
-              uint32_t bufQueueSize = schedInfoIt->second;
-              if (GetUe (*schedInfoIt)->m_ulTbSize >= std::max (bufQueueSize, 7U))
+              // Ensure fairness: remove the UEs which already has enough resources
+              // to transmit, they will not get anything else in this slot
+              while (! ueVector.empty ())
                 {
-                  schedInfoIt++;
+                  std::pop_heap (ueVector.begin (), ueVector.end (), heapCompare);
+                  if (! HasEnoughResources (ueVector.back (), false))
+                    {
+                      break;
+                    }
+                  ueVector.pop_back ();
                 }
-              else
+              // The UE to serve is the last one, which has been popped from the heap
+              schedInfoIt = ueVector.empty () ? ueVector.end () : ueVector.end () - 1;
+            }
+          else
+            {
+              std::sort (ueVector.begin (), ueVector.end (),
+                         [&metric] (const UePtrAndBufferReq &lue, const UePtrAndBufferReq &rue)
+                         {
+                           return metric.CompareUl (lue, rue);
+                         });
+              CountSlotStat (NrMacSchedulerSlotStats::SORT_CALLS);
+
+              // Ensure fairness: pass over UEs which already has enough resources to transmit
+              schedInfoIt = ueVector.begin ();
+              while (schedInfoIt != ueVector.end ()
+                     && HasEnoughResources (*schedInfoIt, false))
                 {
-                  break;
+                  schedInfoIt++;
                 }
             }
 
@@ -381,16 +463,23 @@ NrMacSchedulerOfdma::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl
           NS_LOG_DEBUG ("Assigned " << rbgAssignable <<
                         " UL RBG, spanned over " << beamSym << " SYM, to UE " <<
                         GetUe (*schedInfoIt)->m_rnti);
-          AssignedUlResources (*schedInfoIt, FTResources (rbgAssignable, beamSym),
-                               assigned);
+          metric.AssignedUl (*schedInfoIt, FTResources (rbgAssignable, beamSym), assigned);
+          CountSlotStat (NrMacSchedulerSlotStats::TBS_COMPUTATIONS);
 
-          // Update metrics for the unsuccessfull UEs (who did not get any resource in this iteration)
-          for (auto & ue : ueVector)
+          if constexpr (Metric::HEAP_ORDER)
             {
-              if (GetUe (ue)->m_rnti != GetUe (*schedInfoIt)->m_rnti)
+              // The other UEs did not change: put the UE back in the heap
+              std::push_heap (ueVector.begin (), ueVector.end (), heapCompare);
+            }
+          else
+            {
+              // Update metrics for the unsuccessfull UEs (who did not get any resource in this iteration)
+              for (auto & ue : ueVector)
                 {
-                  NotAssignedUlResources (ue, FTResources (rbgAssignable, beamSym),
-                                          assigned);
+                  if (GetUe (ue)->m_rnti != GetUe (*schedInfoIt)->m_rnti)
+                    {
+                      metric.NotAssignedUl (ue, FTResources (rbgAssignable, beamSym), assigned);
+                    }
                 }
             }
         }
@@ -399,6 +488,37 @@ NrMacSchedulerOfdma::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl
   return symPerBeam;
 }
 
+/// \cond
+#define NR_OFDMA_INSTANTIATE_METRIC(Metric)                                                  \
+  template NrMacSchedulerNs3::BeamSymbolMap                                                  \
+  NrMacSchedulerOfdma::AssignDLRBGWithMetric<Metric> (uint32_t, const ActiveUeMap &,         \
+                                                      const Metric &) const;                 \
+  template NrMacSchedulerNs3::BeamSymbolMap                                                  \
+  NrMacSchedulerOfdma::AssignULRBGWithMetric<Metric> (uint32_t, const ActiveUeMap &,         \
+                                                      const Metric &) const;
+
+NR_OFDMA_INSTANTIATE_METRIC (NrMacSchedulerTdma::VirtualMetric)
+NR_OFDMA_INSTANTIATE_METRIC (NrMacSchedulerMetricRR)
+NR_OFDMA_INSTANTIATE_METRIC (NrMacSchedulerMetricMR)
+NR_OFDMA_INSTANTIATE_METRIC (NrMacSchedulerMetricPF)
+NR_OFDMA_INSTANTIATE_METRIC (NrMacSchedulerMetricQos)
+#undef NR_OFDMA_INSTANTIATE_METRIC
+/// \endcond
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdma::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+  return AssignDLRBGWithMetric (symAvail, activeDl, VirtualMetric (this));
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdma::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+{
+  NS_LOG_FUNCTION (this);
+  return AssignULRBGWithMetric (symAvail, activeUl, VirtualMetric (this));
+}
+
 /**
  * \brief Create the DL DCI in OFDMA mode
  * \param spoint Starting point
@@ -416,17 +536,32 @@ NrMacSchedulerOfdma::CreateDlDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
   NS_LOG_FUNCTION (this);
 
   uint16_t countLessThan7B = 0;
+  std::vector<uint8_t> mcs = ueInfo->m_dlMcs;
 
   //we do not need to recalculate the TB size here because we already
   //computed it in side the method AssignDLRBG called before this method.
   //otherwise, we need to repeat the logic of NrMacSchedulerUeInfo::UpdateDlMetric
-  //here to cover MIMO
+  //here to cover MIMO. The exception are the RBG placed on the subband CQI,
+  //whose MCS is the one of the worst subband used.
+  if (! ueInfo->m_dlRbgMask.IsEmpty ())
+    {
+      NS_ASSERT (ueInfo->m_dlRbgMask.Count () * maxSym == ueInfo->m_dlRBG);
+      for (uint8_t stream = 0; stream < ueInfo->m_dlTbSize.size (); stream++)
+        {
+          if (ueInfo->m_dlTbSize.at (stream) == 0)
+            {
+              continue; // Not needed to transmit the buffer
+            }
+          mcs.at (stream) = ueInfo->GetDlMcsOnRbg (stream, ueInfo->m_dlRbgMask);
+          ueInfo->m_dlTbSize.at (stream) = m_dlAmc->CalculateTbSize (mcs.at (stream),
+                                                                     ueInfo->m_dlRBG * GetNumRbPerRbg ());
+          CountSlotStat (NrMacSchedulerSlotStats::TBS_COMPUTATIONS);
+        }
+    }
 
   //Due to MIMO implementation MCS, TB size, ndi, rv, are vectors
-  std::vector<uint8_t> ndi;
-  ndi.resize (ueInfo->m_dlTbSize.size ());
-  std::vector<uint8_t> rv;
-  rv.resize (ueInfo->m_dlTbSize.size ());
+  NrStreamArray<uint8_t> ndi (ueInfo->m_dlTbSize.size ());
+  NrStreamArray<uint8_t> rv (ueInfo->m_dlTbSize.size ());
 
   for (uint32_t numTb = 0; numTb < ueInfo->m_dlTbSize.size (); numTb++)
     {
@@ -461,60 +596,55 @@ NrMacSchedulerOfdma::CreateDlDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
     }
 
   uint32_t RBGNum = ueInfo->m_dlRBG / maxSym;
-  std::vector<uint8_t> rbgBitmask = GetDlNotchedRbgMask ();
+  NrRbMask assignableRbgs = GetDlAssignableRbgMask ();
 
-  if (rbgBitmask.size () == 0)
-    {
-      rbgBitmask = std::vector<uint8_t> (GetBandwidthInRbg (), 1);
-    }
-
-  // rbgBitmask is all 1s or have 1s in the place we are allowed to transmit.
+  // assignableRbgs is all 1s or have 1s in the place we are allowed to transmit.
 
-  NS_ASSERT (rbgBitmask.size () == GetBandwidthInRbg ());
+  NS_ASSERT (assignableRbgs.GetSize () == GetBandwidthInRbg ());
 
+  NrRbMask rbgBitmask (GetBandwidthInRbg ());
   uint32_t lastRbg = spoint->m_rbg;
 
-  // Limit the places in which we can transmit following the starting point
-  // and the number of RBG assigned to the UE
-  for (uint32_t i = 0; i < GetBandwidthInRbg (); ++i)
+  if (! ueInfo->m_dlRbgMask.IsEmpty ())
     {
-      if (i >= spoint->m_rbg && RBGNum > 0 && rbgBitmask[i] == 1)
-        {
-          // assigned! Decrement RBGNum and continue the for
-          RBGNum--;
-          lastRbg = i;
-        }
-      else
-        {
-          // Set to 0 the position < spoint->m_rbg OR the remaining RBG when
-          // we already assigned the number of requested RBG
-          rbgBitmask[i] = 0;
-        }
+      // Already placed on the subbands by PlaceDlRbgOnSubbands; the UEs of
+      // the beam do not use the starting point, so leave it where it is
+      rbgBitmask = ueInfo->m_dlRbgMask;
+      RBGNum = 0;
     }
 
-  NS_ASSERT_MSG (RBGNum == 0,
-                 "If you see this message, it means that the AssignRBG and CreateDci method are unaligned");
-
-  std::ostringstream oss;
-  for (const auto & x: rbgBitmask)
+  // Take, following the starting point, the first RBGs in which we are
+  // allowed to transmit, until the number of RBG assigned to the UE
+  for (uint32_t i = assignableRbgs.FindNextSet (spoint->m_rbg);
+       i < assignableRbgs.GetSize () && RBGNum > 0;
+       i = assignableRbgs.FindNextSet (i + 1))
     {
-      oss << std::to_string (x) << " ";
+      // assigned! Decrement RBGNum and continue the for
+      rbgBitmask.Set (i);
+      RBGNum--;
+      lastRbg = i;
     }
 
+  NS_ASSERT_MSG (RBGNum == 0,
+                 "If you see this message, it means that the AssignRBG and CreateDci method are unaligned");
+
   NS_LOG_INFO ("UE " << ueInfo->m_rnti << " assigned RBG from " <<
                static_cast<uint32_t> (spoint->m_rbg) << " with mask " <<
-               oss.str () << " for " << static_cast<uint32_t> (maxSym) << " SYM.");
+               rbgBitmask << " for " << static_cast<uint32_t> (maxSym) << " SYM.");
 
 
   std::shared_ptr<DciInfoElementTdma> dci = std::make_shared<DciInfoElementTdma>
-      (ueInfo->m_rnti, DciInfoElementTdma::DL, spoint->m_sym, maxSym, ueInfo->m_dlMcs,
+      (ueInfo->m_rnti, DciInfoElementTdma::DL, spoint->m_sym, maxSym, mcs,
        ueInfo->m_dlTbSize, ndi, rv, DciInfoElementTdma::DATA, GetBwpId (), GetTpc());
 
-  dci->m_rbgBitmask = std::move (rbgBitmask);
+  dci->m_rbgBitmask = rbgBitmask;
 
-  NS_ASSERT (std::count (dci->m_rbgBitmask.begin (), dci->m_rbgBitmask.end (), 0) != GetBandwidthInRbg ());
+  NS_ASSERT (dci->m_rbgBitmask.Any ());
 
-  spoint->m_rbg = lastRbg + 1;
+  if (ueInfo->m_dlRbgMask.IsEmpty ())
+    {
+      spoint->m_rbg = lastRbg + 1;
+    }
 
   return dci;
 }
@@ -528,6 +658,7 @@ NrMacSchedulerOfdma::CreateUlDci (PointInFTPlane *spoint,
 
   uint32_t tbs = m_ulAmc->CalculateTbSize (ueInfo->m_ulMcs,
                                            ueInfo->m_ulRBG * GetNumRbPerRbg ());
+  CountSlotStat (NrMacSchedulerSlotStats::TBS_COMPUTATIONS);
 
   // If is less than 7 (3 mac header, 2 rlc header, 2 data), then we can't
   // transmit any new data, so don't create dci.
@@ -539,36 +670,26 @@ NrMacSchedulerOfdma::CreateUlDci (PointInFTPlane *spoint,
     }
 
   uint32_t RBGNum = ueInfo->m_ulRBG / maxSym;
-  std::vector<uint8_t> rbgBitmask = GetUlNotchedRbgMask ();
+  NrRbMask assignableRbgs = GetUlAssignableRbgMask ();
 
-  if (rbgBitmask.size () == 0)
-    {
-      rbgBitmask = std::vector<uint8_t> (GetBandwidthInRbg (), 1);
-    }
-
-  // rbgBitmask is all 1s or have 1s in the place we are allowed to transmit.
+  // assignableRbgs is all 1s or have 1s in the place we are allowed to transmit.
 
-  NS_ASSERT (rbgBitmask.size () == GetBandwidthInRbg ());
+  NS_ASSERT (assignableRbgs.GetSize () == GetBandwidthInRbg ());
 
+  NrRbMask rbgBitmask (GetBandwidthInRbg ());
   uint32_t lastRbg = spoint->m_rbg;
   uint32_t assigned = RBGNum;
 
-  // Limit the places in which we can transmit following the starting point
-  // and the number of RBG assigned to the UE
-  for (uint32_t i = 0; i < GetBandwidthInRbg (); ++i)
+  // Take, following the starting point, the first RBGs in which we are
+  // allowed to transmit, until the number of RBG assigned to the UE
+  for (uint32_t i = assignableRbgs.FindNextSet (spoint->m_rbg);
+       i < assignableRbgs.GetSize () && RBGNum > 0;
+       i = assignableRbgs.FindNextSet (i + 1))
     {
-      if (i >= spoint->m_rbg && RBGNum > 0 && rbgBitmask[i] == 1)
-        {
-          // assigned! Decrement RBGNum and continue the for
-          RBGNum--;
-          lastRbg = i;
-        }
-      else
-        {
-          // Set to 0 the position < spoint->m_rbg OR the remaining RBG when
-          // we already assigned the number of requested RBG
-          rbgBitmask[i] = 0;
-        }
+      // assigned! Decrement RBGNum and continue the for
+      rbgBitmask.Set (i);
+      RBGNum--;
+      lastRbg = i;
     }
 
   NS_ASSERT_MSG (RBGNum == 0,
@@ -580,26 +701,21 @@ NrMacSchedulerOfdma::CreateUlDci (PointInFTPlane *spoint,
                static_cast<uint32_t> (maxSym) << " SYM.");
 
   //Due to MIMO implementation MCS, TB size, ndi, rv, are vectors
-  std::vector<uint8_t> ulMcs = {ueInfo->m_ulMcs};
-  std::vector<uint32_t> ulTbs = {tbs};
-  std::vector<uint8_t> ndi = {1};
-  std::vector<uint8_t> rv = {0};
+  NrStreamArray<uint8_t> ulMcs = {ueInfo->m_ulMcs};
+  NrStreamArray<uint32_t> ulTbs = {tbs};
+  NrStreamArray<uint8_t> ndi = {1};
+  NrStreamArray<uint8_t> rv = {0};
 
   NS_ASSERT (spoint->m_sym >= maxSym);
   std::shared_ptr<DciInfoElementTdma> dci = std::make_shared<DciInfoElementTdma>
       (ueInfo->m_rnti, DciInfoElementTdma::UL, spoint->m_sym - maxSym, maxSym, ulMcs,
        ulTbs, ndi, rv, DciInfoElementTdma::DATA, GetBwpId (), GetTpc());
 
-  dci->m_rbgBitmask = std::move (rbgBitmask);
+  dci->m_rbgBitmask = rbgBitmask;
 
-  std::ostringstream oss;
-  for (auto x: dci->m_rbgBitmask)
-  {
-   oss << std::to_string(x) << " ";
-  }
-  NS_LOG_INFO ("UE " << ueInfo->m_rnti << " DCI RBG mask: " << oss.str());
+  NS_LOG_INFO ("UE " << ueInfo->m_rnti << " DCI RBG mask: " << dci->m_rbgBitmask);
 
-  NS_ASSERT (std::count (dci->m_rbgBitmask.begin (), dci->m_rbgBitmask.end (), 0) != GetBandwidthInRbg ());
+  NS_ASSERT (dci->m_rbgBitmask.Any ());
 
   spoint->m_rbg = lastRbg + 1;
 
@@ -58,6 +58,7 @@ namespace ns3 {
  * \see NrMacSchedulerOfdmaRR
  * \see NrMacSchedulerOfdmaPF
  * \see NrMacSchedulerOfdmaMR
+ * \see NrMacSchedulerOfdmaQos
  */
 class NrMacSchedulerOfdma : public NrMacSchedulerTdma
 {
@@ -110,7 +111,52 @@ protected:
 
   virtual uint8_t GetTpc () const override;
 
+  /**
+   * \brief Assign the available DL RBG to the UEs of each beam, with a metric policy
+   * \param symAvail Number of available symbols
+   * \param activeDl active DL flows and UE
+   * \param metric the metric policy (VirtualMetric, or one of the policies
+   * in nr-mac-scheduler-policy.h)
+   * \return a map between the beam and the symbols assigned to each one
+   *
+   * It hides NrMacSchedulerTdma::AssignDLRBGWithMetric, so the metric
+   * subclasses get the OFDMA repartition by calling it. The template is
+   * instantiated in nr-mac-scheduler-ofdma.cc for the metric policies of the module.
+   */
+  template <typename Metric>
+  BeamSymbolMap
+  AssignDLRBGWithMetric (uint32_t symAvail, const ActiveUeMap &activeDl, const Metric &metric) const;
+
+  /**
+   * \brief Assign the available UL RBG to the UEs of each beam, with a metric policy
+   * \param symAvail Number of available symbols
+   * \param activeUl active UL flows and UE
+   * \param metric the metric policy
+   * \return a map between the beam and the symbols assigned to each one
+   *
+   * \see AssignDLRBGWithMetric
+   */
+  template <typename Metric>
+  BeamSymbolMap
+  AssignULRBGWithMetric (uint32_t symAvail, const ActiveUeMap &activeUl, const Metric &metric) const;
+
 private:
+  /**
+   * \brief Choose the DL RBG of the UEs of a beam on their subband CQI
+   * \param ueVector the UEs of the beam
+   * \param beamSym the symbols of the beam
+   *
+   * If at least one UE of the beam reported subband CQI, the RBG are given
+   * to the UEs (each one receives the number of RBG calculated by the
+   * assignment loop) in passes: in the first pass, a UE receives only the RBG
+   * in which its offset is the highest (NrSubbandCqi::MAX_OFFSET), then the
+   * level decreases until all the RBG are placed. Ties go to the first UE
+   * of the list. The RBG are stored in NrMacSchedulerUeInfo::m_dlRbgMask,
+   * and CreateDlDci uses them, and the MCS of their subbands, instead of
+   * placing the RBG one after the other.
+   */
+  void PlaceDlRbgOnSubbands (const std::vector<UePtrAndBufferReq> &ueVector,
+                             uint32_t beamSym) const;
 
   TracedValue<uint32_t> m_tracedValueSymPerBeam;
 };
@@ -0,0 +1,423 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_MAC_SCHEDULER_POLICY_H
+#define NR_MAC_SCHEDULER_POLICY_H
+
+#include "nr-mac-scheduler-ue-info-rr.h"
+#include "nr-mac-scheduler-ue-info-mr.h"
+#include "nr-mac-scheduler-ue-info-pf.h"
+#include "nr-mac-scheduler-ue-info-qos.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief Round-robin metric, as a static policy of the resource assignment
+ *
+ * The TDMA and OFDMA schedulers distribute the resources with a loop that,
+ * for each RBG (or symbol), sorts the UEs and updates the metric of the UEs
+ * that got (or did not get) the resource. The metric subclasses implement
+ * these steps with the virtual methods of NrMacSchedulerTdma; the metric
+ * policies implement the same steps with non-virtual methods, so that
+ * the loop templates NrMacSchedulerTdma::AssignDLRBGWithMetric and
+ * NrMacSchedulerOfdma::AssignDLRBGWithMetric (and their UL counterparts)
+ * can inline them. A policy must provide:
+ *
+ * - CompareDl / CompareUl: the comparison used to sort the UEs;
+ * - BeforeDl / BeforeUl: called for each UE before the assignment;
+ * - AssignedDl / AssignedUl: called for the UE that got the resource;
+ * - NotAssignedDl / NotAssignedUl: called for the other UEs;
+ * - HEAP_ORDER: true if an assignment changes only the position of the UE
+ * that got the resource, and the NotAssigned methods do nothing. The loops
+ * then keep the UEs in a heap, instead of sorting all of them for each
+ * resource. RR and MR would qualify, but they keep the sort, so that the
+ * order of the UEs with the same weight is the same as in the previous versions.
+ *
+ * The policy must be used with UEs created by the matching scheduler
+ * (e.g., NrMacSchedulerUeInfoPF for NrMacSchedulerMetricPF).
+ */
+class NrMacSchedulerMetricRR
+{
+public:
+  static constexpr bool HEAP_ORDER = false; //!< Sort the UEs for each resource
+
+  /**
+   * \brief NrMacSchedulerMetricRR constructor
+   * \param dlAmc the DL AMC of the scheduler
+   * \param ulAmc the UL AMC of the scheduler
+   */
+  NrMacSchedulerMetricRR (const Ptr<const NrAmc> &dlAmc, const Ptr<const NrAmc> &ulAmc)
+    : m_dlAmc (dlAmc), m_ulAmc (ulAmc)
+  {
+  }
+
+  /**
+   * \brief Compare two UEs for the DL assignment
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return NrMacSchedulerUeInfoRR::CompareUeWeightsDl
+   */
+  static bool CompareDl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                         const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    return NrMacSchedulerUeInfoRR::CompareUeWeightsDl (lue, rue);
+  }
+
+  /**
+   * \brief Compare two UEs for the UL assignment
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return NrMacSchedulerUeInfoRR::CompareUeWeightsUl
+   */
+  static bool CompareUl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                         const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    return NrMacSchedulerUeInfoRR::CompareUeWeightsUl (lue, rue);
+  }
+
+  /**
+   * \brief Nothing to prepare before the DL assignment
+   */
+  void BeforeDl (const NrMacSchedulerNs3::UePtrAndBufferReq &,
+                 const NrMacSchedulerNs3::FTResources &) const
+  {
+  }
+
+  /**
+   * \brief Nothing to prepare before the UL assignment
+   */
+  void BeforeUl (const NrMacSchedulerNs3::UePtrAndBufferReq &,
+                 const NrMacSchedulerNs3::FTResources &) const
+  {
+  }
+
+  /**
+   * \brief Update the DL TBS of the UE that got the resource
+   * \param ue the UE
+   */
+  void AssignedDl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                   const NrMacSchedulerNs3::FTResources &,
+                   const NrMacSchedulerNs3::FTResources &) const
+  {
+    ue.first->UpdateDlMetric (m_dlAmc);
+  }
+
+  /**
+   * \brief Update the UL TBS of the UE that got the resource
+   * \param ue the UE
+   */
+  void AssignedUl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                   const NrMacSchedulerNs3::FTResources &,
+                   const NrMacSchedulerNs3::FTResources &) const
+  {
+    ue.first->UpdateUlMetric (m_ulAmc);
+  }
+
+  /**
+   * \brief Nothing to update for the UEs that did not get the DL resource
+   */
+  void NotAssignedDl (const NrMacSchedulerNs3::UePtrAndBufferReq &,
+                      const NrMacSchedulerNs3::FTResources &,
+                      const NrMacSchedulerNs3::FTResources &) const
+  {
+  }
+
+  /**
+   * \brief Nothing to update for the UEs that did not get the UL resource
+   */
+  void NotAssignedUl (const NrMacSchedulerNs3::UePtrAndBufferReq &,
+                      const NrMacSchedulerNs3::FTResources &,
+                      const NrMacSchedulerNs3::FTResources &) const
+  {
+  }
+
+protected:
+  Ptr<const NrAmc> m_dlAmc; //!< DL AMC
+  Ptr<const NrAmc> m_ulAmc; //!< UL AMC
+};
+
+/**
+ * \ingroup scheduler
+ * \brief Maximum rate metric, as a static policy of the resource assignment
+ *
+ * It differs from NrMacSchedulerMetricRR only in the comparison.
+ */
+class NrMacSchedulerMetricMR : public NrMacSchedulerMetricRR
+{
+public:
+  using NrMacSchedulerMetricRR::NrMacSchedulerMetricRR;
+
+  /**
+   * \brief Compare two UEs for the DL assignment
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return NrMacSchedulerUeInfoMR::CompareUeWeightsDl
+   */
+  static bool CompareDl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                         const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    return NrMacSchedulerUeInfoMR::CompareUeWeightsDl (lue, rue);
+  }
+
+  /**
+   * \brief Compare two UEs for the UL assignment
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return NrMacSchedulerUeInfoMR::CompareUeWeightsUl
+   */
+  static bool CompareUl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                         const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    return NrMacSchedulerUeInfoMR::CompareUeWeightsUl (lue, rue);
+  }
+};
+
+/**
+ * \ingroup scheduler
+ * \brief Proportional fair metric, as a static policy of the resource assignment
+ *
+ * The comparison is the one of NrMacSchedulerUeInfoPF, but the UE
+ * representations are accessed with a static cast, as the scheduler that
+ * uses the policy creates only NrMacSchedulerUeInfoPF instances.
+ */
+class NrMacSchedulerMetricPF : public NrMacSchedulerMetricRR
+{
+public:
+  static constexpr bool HEAP_ORDER = false; //!< The other UEs are updated for each resource
+
+  /**
+   * \brief NrMacSchedulerMetricPF constructor
+   * \param dlAmc the DL AMC of the scheduler
+   * \param ulAmc the UL AMC of the scheduler
+   * \param timeWindow the time window of the average throughput
+   */
+  NrMacSchedulerMetricPF (const Ptr<const NrAmc> &dlAmc, const Ptr<const NrAmc> &ulAmc,
+                          double timeWindow)
+    : NrMacSchedulerMetricRR (dlAmc, ulAmc), m_timeWindow (timeWindow)
+  {
+  }
+
+  /**
+   * \brief Compare two UEs for the DL assignment
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return true if the DL PF metric of lue is higher than the one of rue
+   */
+  static bool CompareDl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                         const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    const auto l = GetPF (lue);
+    const auto r = GetPF (rue);
+    return std::pow (l->m_potentialTputDl, l->m_alpha) / std::max (1E-9, l->m_avgTputDl) >
+           std::pow (r->m_potentialTputDl, r->m_alpha) / std::max (1E-9, r->m_avgTputDl);
+  }
+
+  /**
+   * \brief Compare two UEs for the UL assignment
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return true if the UL PF metric of lue is higher than the one of rue
+   */
+  static bool CompareUl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                         const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    const auto l = GetPF (lue);
+    const auto r = GetPF (rue);
+    return std::pow (l->m_potentialTputUl, l->m_alpha) / std::max (1E-9, l->m_avgTputUl) >
+           std::pow (r->m_potentialTputUl, r->m_alpha) / std::max (1E-9, r->m_avgTputUl);
+  }
+
+  /**
+   * \brief Calculate the DL potential throughput of the UE
+   * \param ue the UE
+   * \param assignableInIteration resources assignable in each iteration
+   */
+  void BeforeDl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                 const NrMacSchedulerNs3::FTResources &assignableInIteration) const
+  {
+    GetPF (ue)->CalculatePotentialTPutDl (assignableInIteration, m_dlAmc);
+  }
+
+  /**
+   * \brief Calculate the UL potential throughput of the UE
+   * \param ue the UE
+   * \param assignableInIteration resources assignable in each iteration
+   */
+  void BeforeUl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                 const NrMacSchedulerNs3::FTResources &assignableInIteration) const
+  {
+    GetPF (ue)->CalculatePotentialTPutUl (assignableInIteration, m_ulAmc);
+  }
+
+  /**
+   * \brief Update the DL PF metric of the UE that got the resource
+   * \param ue the UE
+   * \param totAssigned the resources assigned until now
+   */
+  void AssignedDl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                   const NrMacSchedulerNs3::FTResources &,
+                   const NrMacSchedulerNs3::FTResources &totAssigned) const
+  {
+    GetPF (ue)->UpdateDlPFMetric (totAssigned, m_timeWindow, m_dlAmc);
+  }
+
+  /**
+   * \brief Update the UL PF metric of the UE that got the resource
+   * \param ue the UE
+   * \param totAssigned the resources assigned until now
+   */
+  void AssignedUl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                   const NrMacSchedulerNs3::FTResources &,
+                   const NrMacSchedulerNs3::FTResources &totAssigned) const
+  {
+    GetPF (ue)->UpdateUlPFMetric (totAssigned, m_timeWindow, m_ulAmc);
+  }
+
+  /**
+   * \brief Update the DL PF metric of a UE that did not get the resource
+   * \param ue the UE
+   * \param totAssigned the resources assigned until now
+   */
+  void NotAssignedDl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                      const NrMacSchedulerNs3::FTResources &,
+                      const NrMacSchedulerNs3::FTResources &totAssigned) const
+  {
+    GetPF (ue)->UpdateDlPFMetric (totAssigned, m_timeWindow, m_dlAmc);
+  }
+
+  /**
+   * \brief Update the UL PF metric of a UE that did not get the resource
+   * \param ue the UE
+   * \param totAssigned the resources assigned until now
+   */
+  void NotAssignedUl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                      const NrMacSchedulerNs3::FTResources &,
+                      const NrMacSchedulerNs3::FTResources &totAssigned) const
+  {
+    GetPF (ue)->UpdateUlPFMetric (totAssigned, m_timeWindow, m_ulAmc);
+  }
+
+private:
+  /**
+   * \brief Get the PF representation of the UE
+   * \param ue the UE
+   * \return the UE as NrMacSchedulerUeInfoPF
+   */
+  static NrMacSchedulerUeInfoPF * GetPF (const NrMacSchedulerNs3::UePtrAndBufferReq &ue)
+  {
+    NS_ASSERT (dynamic_cast<NrMacSchedulerUeInfoPF*> (ue.first.get ()) != nullptr);
+    return static_cast<NrMacSchedulerUeInfoPF*> (ue.first.get ());
+  }
+
+  double m_timeWindow {99.0}; //!< Time window of the average throughput
+};
+
+/**
+ * \ingroup scheduler
+ * \brief Delay-aware QoS metric, as a static policy of the resource assignment
+ *
+ * Before the assignment, each UE calculates its QoS metric from the deadline
+ * of its flows and its achievable rate (see NrMacSchedulerUeInfoQos). The
+ * metric does not change during the assignment, and the ties are broken
+ * with the assigned RBG: only the UE that got the resource changes its
+ * position, so the UEs are kept in a deadline-ordered heap (HEAP_ORDER).
+ */
+class NrMacSchedulerMetricQos : public NrMacSchedulerMetricRR
+{
+public:
+  static constexpr bool HEAP_ORDER = true; //!< Only the assigned UE changes its position
+
+  /**
+   * \brief NrMacSchedulerMetricQos constructor
+   * \param dlAmc the DL AMC of the scheduler
+   * \param ulAmc the UL AMC of the scheduler
+   * \param now the current time
+   * \param minSlack the minimum slack (see NrMacSchedulerUeInfoQos)
+   */
+  NrMacSchedulerMetricQos (const Ptr<const NrAmc> &dlAmc, const Ptr<const NrAmc> &ulAmc,
+                           const Time &now, const Time &minSlack)
+    : NrMacSchedulerMetricRR (dlAmc, ulAmc), m_now (now), m_minSlack (minSlack)
+  {
+  }
+
+  /**
+   * \brief Compare two UEs for the DL assignment
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return NrMacSchedulerUeInfoQos::CompareUeWeightsDl
+   */
+  static bool CompareDl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                         const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    return NrMacSchedulerUeInfoQos::CompareUeWeightsDl (lue, rue);
+  }
+
+  /**
+   * \brief Compare two UEs for the UL assignment
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return NrMacSchedulerUeInfoQos::CompareUeWeightsUl
+   */
+  static bool CompareUl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                         const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    return NrMacSchedulerUeInfoQos::CompareUeWeightsUl (lue, rue);
+  }
+
+  /**
+   * \brief Calculate the DL QoS metric of the UE
+   * \param ue the UE
+   * \param assignableInIteration resources assignable in each iteration
+   */
+  void BeforeDl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                 const NrMacSchedulerNs3::FTResources &assignableInIteration) const
+  {
+    GetQos (ue)->CalculateDlQosMetric (assignableInIteration, m_dlAmc, m_now, m_minSlack);
+  }
+
+  /**
+   * \brief Calculate the UL QoS metric of the UE
+   * \param ue the UE
+   * \param assignableInIteration resources assignable in each iteration
+   */
+  void BeforeUl (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                 const NrMacSchedulerNs3::FTResources &assignableInIteration) const
+  {
+    GetQos (ue)->CalculateUlQosMetric (assignableInIteration, m_ulAmc, m_now, m_minSlack);
+  }
+
+private:
+  /**
+   * \brief Get the QoS representation of the UE
+   * \param ue the UE
+   * \return the UE as NrMacSchedulerUeInfoQos
+   */
+  static NrMacSchedulerUeInfoQos * GetQos (const NrMacSchedulerNs3::UePtrAndBufferReq &ue)
+  {
+    NS_ASSERT (dynamic_cast<NrMacSchedulerUeInfoQos*> (ue.first.get ()) != nullptr);
+    return static_cast<NrMacSchedulerUeInfoQos*> (ue.first.get ());
+  }
+
+  Time m_now;      //!< Current time
+  Time m_minSlack; //!< Minimum slack
+};
+
+} // namespace ns3
+
+#endif // NR_MAC_SCHEDULER_POLICY_H
@@ -0,0 +1,214 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-mac-scheduler-slot-dispatcher.h"
+#include "nr-mac-scheduler-ns3.h"
+
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerSlotDispatcher");
+
+NrMacSchedulerSlotDispatcher *
+NrMacSchedulerSlotDispatcher::Get ()
+{
+  static NrMacSchedulerSlotDispatcher instance;
+  return &instance;
+}
+
+NrMacSchedulerSlotDispatcher::~NrMacSchedulerSlotDispatcher ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_cvWork.notify_all ();
+
+  for (auto & worker : m_workers)
+    {
+      worker.join ();
+    }
+}
+
+void
+NrMacSchedulerSlotDispatcher::Enqueue (const Ptr<NrMacSchedulerNs3> &scheduler, uint32_t maxThreads)
+{
+  NS_LOG_FUNCTION (this << scheduler);
+
+  if (m_pending.empty ())
+    {
+      // Executed after all the events already scheduled for now
+      m_flushEvent = Simulator::ScheduleNow (&NrMacSchedulerSlotDispatcher::Flush, this);
+      m_maxThreads = 0;
+
+      if (! m_destroyScheduled)
+        {
+          Simulator::ScheduleDestroy (&NrMacSchedulerSlotDispatcher::DoSimulatorDestroy, this);
+          m_destroyScheduled = true;
+        }
+    }
+
+  if (maxThreads == 0)
+    {
+      maxThreads = std::max (1U, std::thread::hardware_concurrency ());
+    }
+
+  m_maxThreads = std::max (m_maxThreads, maxThreads);
+  m_pending.push_back (scheduler);
+}
+
+bool
+NrMacSchedulerSlotDispatcher::HasPending () const
+{
+  return ! m_pending.empty ();
+}
+
+void
+NrMacSchedulerSlotDispatcher::DoSimulatorDestroy ()
+{
+  NS_LOG_FUNCTION (this);
+  if (! m_pending.empty ())
+    {
+      NS_LOG_INFO ("Dropping " << m_pending.size () << " schedulers not flushed");
+    }
+  m_pending.clear ();
+  m_flushEvent = EventId ();
+  m_destroyScheduled = false;
+}
+
+void
+NrMacSchedulerSlotDispatcher::Flush ()
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<Ptr<NrMacSchedulerNs3> > pending;
+  pending.swap (m_pending);
+
+  // The workers only see raw pointers: the reference count of the
+  // schedulers is touched only by the main thread.
+  std::vector<NrMacSchedulerNs3*> jobs;
+  jobs.reserve (pending.size ());
+  for (const auto & scheduler : pending)
+    {
+      jobs.push_back (PeekPointer (scheduler));
+    }
+
+  size_t numThreads = std::min (static_cast<size_t> (m_maxThreads), jobs.size ());
+
+  NS_LOG_INFO ("Computing " << jobs.size () << " schedulers with " <<
+               numThreads << " threads");
+
+  if (numThreads <= 1)
+    {
+      for (const auto & job : jobs)
+        {
+          job->RunDeferredSapCalls ();
+        }
+    }
+  else
+    {
+      // the main thread works as well
+      StartWorkers (numThreads - 1);
+
+      m_nextJob = 0;
+      m_remainingJobs = jobs.size ();
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_jobs = &jobs;
+        ++m_generation;
+      }
+      m_cvWork.notify_all ();
+
+      RunJobs (jobs);
+
+      std::unique_lock<std::mutex> lock (m_mutex);
+      m_cvDone.wait (lock, [this] { return m_remainingJobs == 0 && m_busyWorkers == 0; });
+      m_jobs = nullptr;
+    }
+
+  for (const auto & scheduler : pending)
+    {
+      scheduler->DeliverDeferredIndications ();
+    }
+}
+
+void
+NrMacSchedulerSlotDispatcher::StartWorkers (size_t numWorkers)
+{
+  while (m_workers.size () < numWorkers)
+    {
+      NS_LOG_INFO ("Starting worker " << m_workers.size ());
+      m_workers.emplace_back (&NrMacSchedulerSlotDispatcher::WorkerLoop, this);
+    }
+}
+
+void
+NrMacSchedulerSlotDispatcher::WorkerLoop ()
+{
+  uint64_t lastGeneration = 0;
+
+  while (true)
+    {
+      const std::vector<NrMacSchedulerNs3*> *jobs = nullptr;
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        m_cvWork.wait (lock, [&] { return m_stop || m_generation != lastGeneration; });
+        if (m_stop)
+          {
+            return;
+          }
+        lastGeneration = m_generation;
+        if (m_jobs == nullptr)
+          {
+            // Woken too late: the batch is already over
+            continue;
+          }
+        jobs = m_jobs;
+        ++m_busyWorkers;
+      }
+
+      RunJobs (*jobs);
+
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        --m_busyWorkers;
+      }
+      m_cvDone.notify_one ();
+    }
+}
+
+void
+NrMacSchedulerSlotDispatcher::RunJobs (const std::vector<NrMacSchedulerNs3*> &jobs)
+{
+  for (size_t i = m_nextJob++; i < jobs.size (); i = m_nextJob++)
+    {
+      jobs.at (i)->RunDeferredSapCalls ();
+
+      if (--m_remainingJobs == 0)
+        {
+          std::lock_guard<std::mutex> lock (m_mutex);
+          m_cvDone.notify_one ();
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,153 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_MAC_SCHEDULER_SLOT_DISPATCHER_H
+#define NR_MAC_SCHEDULER_SLOT_DISPATCHER_H
+
+#include <ns3/ptr.h>
+#include <ns3/event-id.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+class NrMacSchedulerNs3;
+
+/**
+ * \ingroup scheduler
+ * \brief Gather the schedulers triggered at the same time, and compute them in parallel
+ *
+ * When a scheduler with the attribute ParallelScheduling enabled receives a
+ * trigger request, it queues the request and calls Enqueue(). The first
+ * call for a given simulation time schedules, for the same time, a flush
+ * event, which is executed after all the events already scheduled for that
+ * time (i.e., after the slot start of all the other cells).
+ *
+ * At the flush, the queued calls of each scheduler are executed on a pool
+ * of threads (one scheduler is never executed by more than one thread at
+ * the same time). When all of them are finished, the decisions are
+ * indicated to the MACs, from the main thread, in the order of Enqueue().
+ * The outcome is therefore the same as a sequential execution, as long as
+ * the schedulers do not share any writable state. The gNB PHYs that
+ * start a slot while a flush is pending (see HasPending()) wait for it
+ * before popping the CTRL messages of the slot, so that the messages
+ * enqueued by the MAC with the decisions go out in the same slot as in a
+ * sequential execution.
+ *
+ * The class is a singleton; the threads are created the first time that
+ * they are needed, and they live until the end of the program. The
+ * schedulers that are still waiting when the simulator is destroyed (e.g.,
+ * after Simulator::Stop) are dropped, so that a later simulation in the
+ * same process starts with an empty dispatcher.
+ */
+class NrMacSchedulerSlotDispatcher
+{
+public:
+  /**
+   * \brief Get the dispatcher instance
+   * \return the dispatcher
+   */
+  static NrMacSchedulerSlotDispatcher * Get ();
+
+  /**
+   * \brief ~NrMacSchedulerSlotDispatcher
+   *
+   * Stop and join the worker threads.
+   */
+  ~NrMacSchedulerSlotDispatcher ();
+
+  /**
+   * \brief Register a scheduler that has queued a trigger request
+   * \param scheduler the scheduler
+   * \param maxThreads maximum number of threads the scheduler would like to
+   * be used (0 means one per hardware thread)
+   */
+  void Enqueue (const Ptr<NrMacSchedulerNs3> &scheduler, uint32_t maxThreads);
+
+  /**
+   * \brief Check if some scheduler is waiting for the flush
+   * \return true if the decisions of at least one scheduler have not been
+   * indicated to its MAC yet
+   *
+   * The gNB PHY uses it to delay the transmission of the CTRL messages of
+   * the slot after the flush, as the MAC enqueues some of them (e.g., the
+   * RAR) when it receives the decisions.
+   */
+  bool HasPending () const;
+
+private:
+  /**
+   * \brief NrMacSchedulerSlotDispatcher constructor
+   */
+  NrMacSchedulerSlotDispatcher () = default;
+
+  /**
+   * \brief Execute the registered schedulers and deliver their decisions
+   */
+  void Flush ();
+
+  /**
+   * \brief Drop the schedulers still waiting for a flush that will never run
+   *
+   * Called by Simulator::Destroy: the destroyed simulator drops the flush
+   * event, and the dispatcher must be empty for the next simulation of the
+   * process.
+   */
+  void DoSimulatorDestroy ();
+
+  /**
+   * \brief Start new workers until the pool has the specified size
+   * \param numWorkers the number of workers
+   */
+  void StartWorkers (size_t numWorkers);
+
+  /**
+   * \brief Main function of a worker
+   */
+  void WorkerLoop ();
+
+  /**
+   * \brief Execute jobs until the current batch is exhausted
+   * \param jobs the current batch
+   */
+  void RunJobs (const std::vector<NrMacSchedulerNs3*> &jobs);
+
+  std::vector<Ptr<NrMacSchedulerNs3> > m_pending; //!< Schedulers waiting for the flush, in order of arrival
+  EventId m_flushEvent;         //!< The flush event
+  bool m_destroyScheduled {false}; //!< True if DoSimulatorDestroy is scheduled in the current simulation
+  uint32_t m_maxThreads {0};    //!< Threads requested for the current batch
+
+  std::vector<std::thread> m_workers;  //!< Worker threads
+  std::mutex m_mutex;                  //!< Protect the fields below
+  std::condition_variable m_cvWork;    //!< Signal a new batch, or the stop, to the workers
+  std::condition_variable m_cvDone;    //!< Signal the end of the work to the main thread
+  const std::vector<NrMacSchedulerNs3*> *m_jobs {nullptr}; //!< Current batch (nullptr if none)
+  uint64_t m_generation {0};           //!< Incremented at each batch
+  uint32_t m_busyWorkers {0};          //!< Workers that are working on the current batch
+  bool m_stop {false};                 //!< Tell the workers to exit
+  std::atomic<size_t> m_nextJob {0};   //!< Next job to be picked
+  std::atomic<size_t> m_remainingJobs {0}; //!< Jobs not yet finished
+};
+
+} // namespace ns3
+
+#endif // NR_MAC_SCHEDULER_SLOT_DISPATCHER_H
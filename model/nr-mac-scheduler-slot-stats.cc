@@ -0,0 +1,121 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-mac-scheduler-slot-stats.h"
+#include "nr-phy-mac-common.h"
+
+namespace ns3 {
+
+const char *
+NrMacSchedulerSlotStats::GetPhaseName (Phase phase)
+{
+  switch (phase)
+    {
+    case CQI_REFRESH:
+      return "CqiRefresh";
+    case HARQ:
+      return "Harq";
+    case ACTIVE_UE:
+      return "ActiveUe";
+    case BEAM_REPARTITION:
+      return "BeamRepartition";
+    case LC_ASSIGNMENT:
+      return "LcAssignment";
+    case DCI_CREATION:
+      return "DciCreation";
+    default:
+      return "Unknown";
+    }
+}
+
+const char *
+NrMacSchedulerSlotStats::GetCounterName (Counter counter)
+{
+  switch (counter)
+    {
+    case UE_CONSIDERED:
+      return "UeConsidered";
+    case SORT_CALLS:
+      return "SortCalls";
+    case TBS_COMPUTATIONS:
+      return "TbsComputations";
+    case DCI_EMITTED:
+      return "DciEmitted";
+    default:
+      return "Unknown";
+    }
+}
+
+void
+NrMacSchedulerSlotStats::Reset (const SfnSf &sfnSf, bool isDl)
+{
+  m_sfnSf = sfnSf;
+  m_isDl = isDl;
+  m_numSlots = 1;
+  m_phaseNs.fill (0);
+  m_counters.fill (0);
+}
+
+NrMacSchedulerSlotStats &
+NrMacSchedulerSlotStats::operator+= (const NrMacSchedulerSlotStats &o)
+{
+  m_sfnSf = o.m_sfnSf;
+  m_numSlots += o.m_numSlots;
+  for (uint32_t i = 0; i < NUM_PHASES; ++i)
+    {
+      m_phaseNs[i] += o.m_phaseNs[i];
+    }
+  for (uint32_t i = 0; i < NUM_COUNTERS; ++i)
+    {
+      m_counters[i] += o.m_counters[i];
+    }
+  return *this;
+}
+
+std::ostream &
+operator<< (std::ostream &os, const NrMacSchedulerSlotStats &stats)
+{
+  os << "CellId " << stats.m_cellId << " BwpId " << stats.m_bwpId <<
+    (stats.m_isDl ? " DL" : " UL");
+  if (stats.m_numSlots == 1)
+    {
+      os << " slot " << stats.m_sfnSf;
+    }
+  else
+    {
+      os << " slots " << stats.m_numSlots;
+    }
+
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < NrMacSchedulerSlotStats::NUM_PHASES; ++i)
+    {
+      os << " " << NrMacSchedulerSlotStats::GetPhaseName (static_cast<NrMacSchedulerSlotStats::Phase> (i)) <<
+        "Ns " << stats.m_phaseNs[i];
+      total += stats.m_phaseNs[i];
+    }
+  os << " TotalNs " << total;
+
+  for (uint32_t i = 0; i < NrMacSchedulerSlotStats::NUM_COUNTERS; ++i)
+    {
+      os << " " << NrMacSchedulerSlotStats::GetCounterName (static_cast<NrMacSchedulerSlotStats::Counter> (i)) <<
+        " " << stats.m_counters[i];
+    }
+  return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,174 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_MAC_SCHEDULER_SLOT_STATS_H
+#define NR_MAC_SCHEDULER_SLOT_STATS_H
+
+#include "sfnsf.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief Wall-clock time and work done by a scheduler to decide one slot
+ *
+ * When the attribute NrMacSchedulerNs3::EnableSlotStats is true, the
+ * scheduler fills one instance for each DL and UL trigger request, and
+ * reports it through the trace source NrMacSchedulerNs3::SlotStats.
+ * The time is measured for each phase of the scheduling (see Phase), and
+ * the work with a set of counters (see Counter).
+ *
+ * The same structure, with m_numSlots greater than one, is used for the
+ * totals over all the slots (see NrMacSchedulerNs3::GetSlotStatsTotal).
+ */
+struct NrMacSchedulerSlotStats
+{
+  /**
+   * \brief Phases of the scheduling
+   */
+  enum Phase : uint8_t
+  {
+    CQI_REFRESH = 0,   //!< Refresh of the CQI maps
+    HARQ,              //!< Expired processes, merge of the feedbacks, and retx scheduling
+    ACTIVE_UE,         //!< Computation of the active UEs and HARQ processes
+    BEAM_REPARTITION,  //!< Repartition of the resources (AssignDLRBG/AssignULRBG)
+    LC_ASSIGNMENT,     //!< Distribution of the TBS between the LCs
+    DCI_CREATION,      //!< Creation of the DCIs of new data
+    NUM_PHASES         //!< Number of phases
+  };
+
+  /**
+   * \brief Work counters
+   */
+  enum Counter : uint8_t
+  {
+    UE_CONSIDERED = 0, //!< UEs considered for new data
+    SORT_CALLS,        //!< Sorts of the UEs during the repartition
+    TBS_COMPUTATIONS,  //!< TBS updates after an assignment, and TBS calculated for a DCI
+    DCI_EMITTED,       //!< Data DCIs in the decision
+    NUM_COUNTERS       //!< Number of counters
+  };
+
+  /**
+   * \brief Get the name of a phase
+   * \param phase the phase
+   * \return the name
+   */
+  static const char * GetPhaseName (Phase phase);
+
+  /**
+   * \brief Get the name of a counter
+   * \param counter the counter
+   * \return the name
+   */
+  static const char * GetCounterName (Counter counter);
+
+  /**
+   * \brief Prepare the statistics for a new slot
+   * \param sfnSf the slot
+   * \param isDl true for a DL decision, false for UL
+   */
+  void Reset (const SfnSf &sfnSf, bool isDl);
+
+  /**
+   * \brief Sum the time and the counters of another instance
+   * \param o the other instance
+   * \return this instance
+   */
+  NrMacSchedulerSlotStats & operator+= (const NrMacSchedulerSlotStats &o);
+
+  SfnSf m_sfnSf;             //!< The slot (or the last slot, for the totals)
+  uint16_t m_cellId {0};     //!< Cell ID
+  uint16_t m_bwpId {0};      //!< BWP ID
+  bool m_isDl {true};        //!< DL or UL decision
+  uint64_t m_numSlots {0};   //!< Number of slots accounted
+  std::array<uint64_t, NUM_PHASES> m_phaseNs {};     //!< Time spent in each phase (ns)
+  std::array<uint64_t, NUM_COUNTERS> m_counters {};  //!< Work counters
+};
+
+/**
+ * \brief Print the statistics
+ * \param os the output stream
+ * \param stats the statistics
+ * \return the output stream
+ */
+std::ostream & operator<< (std::ostream &os, const NrMacSchedulerSlotStats &stats);
+
+/**
+ * \ingroup scheduler
+ * \brief Add to a phase of NrMacSchedulerSlotStats the time spent in a scope
+ *
+ * If the statistics pointer is null (statistics disabled), the clock is
+ * never read.
+ */
+class NrMacSchedulerPhaseTimer
+{
+public:
+  /**
+   * \brief Start the measure
+   * \param stats the statistics (can be nullptr)
+   * \param phase the phase to which the time is added
+   */
+  NrMacSchedulerPhaseTimer (NrMacSchedulerSlotStats *stats, NrMacSchedulerSlotStats::Phase phase)
+    : m_stats (stats), m_phase (phase)
+  {
+    if (m_stats != nullptr)
+      {
+        m_start = std::chrono::steady_clock::now ();
+      }
+  }
+
+  /**
+   * \brief Stop the measure, and add the elapsed time to the phase
+   */
+  ~NrMacSchedulerPhaseTimer ()
+  {
+    Stop ();
+  }
+
+  /**
+   * \brief Stop the measure before the end of the scope
+   */
+  void Stop ()
+  {
+    if (m_stats != nullptr)
+      {
+        auto elapsed = std::chrono::steady_clock::now () - m_start;
+        m_stats->m_phaseNs[m_phase] += static_cast<uint64_t> (
+            std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ());
+        m_stats = nullptr;
+      }
+  }
+
+  NrMacSchedulerPhaseTimer (const NrMacSchedulerPhaseTimer &) = delete;
+  NrMacSchedulerPhaseTimer & operator= (const NrMacSchedulerPhaseTimer &) = delete;
+
+private:
+  NrMacSchedulerSlotStats *m_stats {nullptr};        //!< The statistics
+  NrMacSchedulerSlotStats::Phase m_phase;            //!< The phase
+  std::chrono::steady_clock::time_point m_start;     //!< Start of the measure
+};
+
+} // namespace ns3
+
+#endif // NR_MAC_SCHEDULER_SLOT_STATS_H
@@ -18,6 +18,7 @@
  */
 #include "nr-mac-scheduler-tdma-mr.h"
 #include "nr-mac-scheduler-ue-info-mr.h"
+#include "nr-mac-scheduler-policy.h"
 
 namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerTdmaMR");
@@ -60,4 +61,26 @@ NrMacSchedulerTdmaMR::GetUeCompareUlFn () const
   return NrMacSchedulerUeInfoMR::CompareUeWeightsUl;
 }
 
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerTdmaMR::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerTdma::AssignDLRBG (symAvail, activeDl);
+    }
+  return AssignDLRBGWithMetric (symAvail, activeDl, NrMacSchedulerMetricMR (m_dlAmc, m_ulAmc));
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerTdmaMR::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerTdma::AssignULRBG (symAvail, activeUl);
+    }
+  return AssignULRBGWithMetric (symAvail, activeUl, NrMacSchedulerMetricMR (m_dlAmc, m_ulAmc));
+}
+
 } // namespace ns3
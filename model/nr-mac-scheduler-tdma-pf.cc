@@ -18,6 +18,7 @@
  */
 #include "nr-mac-scheduler-tdma-pf.h"
 #include "nr-mac-scheduler-ue-info-pf.h"
+#include "nr-mac-scheduler-policy.h"
 #include <ns3/log.h>
 #include <ns3/double.h>
 #include <algorithm>
@@ -162,4 +163,26 @@ NrMacSchedulerTdmaPF::BeforeUlSched (const UePtrAndBufferReq &ue,
   uePtr->CalculatePotentialTPutUl (assignableInIteration, m_ulAmc);
 }
 
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerTdmaPF::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerTdma::AssignDLRBG (symAvail, activeDl);
+    }
+  return AssignDLRBGWithMetric (symAvail, activeDl, NrMacSchedulerMetricPF (m_dlAmc, m_ulAmc, m_timeWindow));
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerTdmaPF::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerTdma::AssignULRBG (symAvail, activeUl);
+    }
+  return AssignULRBGWithMetric (symAvail, activeUl, NrMacSchedulerMetricPF (m_dlAmc, m_ulAmc, m_timeWindow));
+}
+
 } //namespace ns3
@@ -0,0 +1,130 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-mac-scheduler-tdma-qos.h"
+#include "nr-mac-scheduler-ue-info-qos.h"
+#include "nr-mac-scheduler-policy.h"
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerTdmaQos");
+NS_OBJECT_ENSURE_REGISTERED (NrMacSchedulerTdmaQos);
+
+TypeId
+NrMacSchedulerTdmaQos::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NrMacSchedulerTdmaQos")
+    .SetParent<NrMacSchedulerTdmaRR> ()
+    .AddConstructor<NrMacSchedulerTdmaQos> ()
+    .AddAttribute ("MinSlack",
+                   "Minimum time to the deadline used in the QoS metric, that bounds "
+                   "the priority of the flows that are violating their delay budget",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&NrMacSchedulerTdmaQos::SetMinSlack,
+                                     &NrMacSchedulerTdmaQos::GetMinSlack),
+                   MakeTimeChecker (NanoSeconds (1)))
+  ;
+  return tid;
+}
+
+NrMacSchedulerTdmaQos::NrMacSchedulerTdmaQos () : NrMacSchedulerTdmaRR ()
+{
+
+}
+
+void
+NrMacSchedulerTdmaQos::SetMinSlack (const Time &v)
+{
+  NS_LOG_FUNCTION (this);
+  m_minSlack = v;
+}
+
+Time
+NrMacSchedulerTdmaQos::GetMinSlack () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_minSlack;
+}
+
+std::shared_ptr<NrMacSchedulerUeInfo>
+NrMacSchedulerTdmaQos::CreateUeRepresentation (const NrMacCschedSapProvider::CschedUeConfigReqParameters &params) const
+{
+  NS_LOG_FUNCTION (this);
+  return std::make_shared <NrMacSchedulerUeInfoQos> (params.m_rnti, params.m_beamConfId,
+                                                     std::bind (&NrMacSchedulerTdmaQos::GetNumRbPerRbg, this));
+}
+
+std::function<bool(const NrMacSchedulerNs3::UePtrAndBufferReq &lhs,
+                   const NrMacSchedulerNs3::UePtrAndBufferReq &rhs )>
+NrMacSchedulerTdmaQos::GetUeCompareDlFn () const
+{
+  return NrMacSchedulerUeInfoQos::CompareUeWeightsDl;
+}
+
+std::function<bool (const NrMacSchedulerNs3::UePtrAndBufferReq &lhs,
+                    const NrMacSchedulerNs3::UePtrAndBufferReq &rhs)>
+NrMacSchedulerTdmaQos::GetUeCompareUlFn () const
+{
+  return NrMacSchedulerUeInfoQos::CompareUeWeightsUl;
+}
+
+void
+NrMacSchedulerTdmaQos::BeforeDlSched (const UePtrAndBufferReq &ue,
+                                      const FTResources &assignableInIteration) const
+{
+  NS_LOG_FUNCTION (this);
+  auto uePtr = std::dynamic_pointer_cast<NrMacSchedulerUeInfoQos> (ue.first);
+  uePtr->CalculateDlQosMetric (assignableInIteration, m_dlAmc, Simulator::Now (), m_minSlack);
+}
+
+void
+NrMacSchedulerTdmaQos::BeforeUlSched (const UePtrAndBufferReq &ue,
+                                      const FTResources &assignableInIteration) const
+{
+  NS_LOG_FUNCTION (this);
+  auto uePtr = std::dynamic_pointer_cast<NrMacSchedulerUeInfoQos> (ue.first);
+  uePtr->CalculateUlQosMetric (assignableInIteration, m_ulAmc, Simulator::Now (), m_minSlack);
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerTdmaQos::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerTdma::AssignDLRBG (symAvail, activeDl);
+    }
+  return AssignDLRBGWithMetric (symAvail, activeDl,
+                                NrMacSchedulerMetricQos (m_dlAmc, m_ulAmc, Simulator::Now (), m_minSlack));
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerTdmaQos::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerTdma::AssignULRBG (symAvail, activeUl);
+    }
+  return AssignULRBGWithMetric (symAvail, activeUl,
+                                NrMacSchedulerMetricQos (m_dlAmc, m_ulAmc, Simulator::Now (), m_minSlack));
+}
+
+} // namespace ns3
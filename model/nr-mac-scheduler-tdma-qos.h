@@ -0,0 +1,149 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#pragma once
+
+#include "nr-mac-scheduler-tdma-rr.h"
+#include <ns3/nstime.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief Assign entire symbols in a delay-aware fashion
+ *
+ * The UEs are sorted by the QoS metric of NrMacSchedulerUeInfoQos, which
+ * favours the UEs whose oldest byte is closer to violate the packet delay
+ * budget of its flow, weighted by the rate that the UE can achieve. The UEs
+ * without data with a budget are served in a round-robin fashion.
+ *
+ * The UEs are kept in a heap ordered by the metric: the metric does not
+ * change during the slot, so after each assignment only the UE that got the
+ * resources is moved.
+ *
+ * \see NrMacSchedulerUeInfoQos
+ * \see NrMacSchedulerMetricQos
+ */
+class NrMacSchedulerTdmaQos : public NrMacSchedulerTdmaRR
+{
+public:
+  /**
+   * \brief GetTypeId
+   * \return The TypeId of the class
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief NrMacSchedulerTdmaQos constructor
+   */
+  NrMacSchedulerTdmaQos ();
+
+  /**
+   * \brief ~NrMacSchedulerTdmaQos deconstructor
+   */
+  virtual ~NrMacSchedulerTdmaQos () override
+  {
+  }
+
+  /**
+   * \brief Set the attribute "MinSlack"
+   * \param v the minimum slack
+   */
+  void SetMinSlack (const Time &v);
+
+  /**
+   * \brief Get the attribute "MinSlack"
+   * \return the minimum slack
+   */
+  Time GetMinSlack () const;
+
+protected:
+  /**
+   * \brief Assign the DL RBG with the static policy NrMacSchedulerMetricQos
+   * \param symAvail Number of available symbols
+   * \param activeDl active DL flows and UE
+   * \return a map between the beam and the symbols assigned to each one
+   *
+   * If the instance is of a subclass (with a different TypeId), which may
+   * redefine the metric methods, NrMacSchedulerTdma::AssignDLRBG is used instead.
+   */
+  virtual BeamSymbolMap
+  AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const override;
+
+  /**
+   * \brief Assign the UL RBG with the static policy NrMacSchedulerMetricQos
+   * \param symAvail Number of available symbols
+   * \param activeUl active UL flows and UE
+   * \return a map between the beam and the symbols assigned to each one
+   *
+   * \see AssignDLRBG
+   */
+  virtual BeamSymbolMap
+  AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const override;
+
+  /**
+   * \brief Create an UE representation of the type NrMacSchedulerUeInfoQos
+   * \param params parameters
+   * \return NrMacSchedulerUeInfoQos instance
+   */
+  virtual std::shared_ptr<NrMacSchedulerUeInfo>
+  CreateUeRepresentation (const NrMacCschedSapProvider::CschedUeConfigReqParameters& params) const override;
+
+  /**
+   * \brief Return the comparison function to sort DL UE according to the scheduler policy
+   * \return a pointer to NrMacSchedulerUeInfoQos::CompareUeWeightsDl
+   */
+  virtual std::function<bool(const NrMacSchedulerNs3::UePtrAndBufferReq &lhs,
+                             const NrMacSchedulerNs3::UePtrAndBufferReq &rhs )>
+  GetUeCompareDlFn () const override;
+
+  /**
+   * \brief Return the comparison function to sort UL UE according to the scheduler policy
+   * \return a pointer to NrMacSchedulerUeInfoQos::CompareUeWeightsUl
+   */
+  virtual std::function<bool(const NrMacSchedulerNs3::UePtrAndBufferReq &lhs,
+                             const NrMacSchedulerNs3::UePtrAndBufferReq &rhs )>
+  GetUeCompareUlFn () const override;
+
+  /**
+   * \brief Calculate the DL QoS metric of the UE
+   * \param ue UE
+   * \param assignableInIteration the minimum amount of resources to be assigned
+   *
+   * Calls NrMacSchedulerUeInfoQos::CalculateDlQosMetric.
+   */
+  virtual void
+  BeforeDlSched (const UePtrAndBufferReq &ue,
+                 const FTResources &assignableInIteration) const override;
+
+  /**
+   * \brief Calculate the UL QoS metric of the UE
+   * \param ue UE
+   * \param assignableInIteration the minimum amount of resources to be assigned
+   *
+   * Calls NrMacSchedulerUeInfoQos::CalculateUlQosMetric.
+   */
+  virtual void
+  BeforeUlSched (const UePtrAndBufferReq &ue,
+                 const FTResources &assignableInIteration) const override;
+
+private:
+  Time m_minSlack {MilliSeconds (1)}; //!< Minimum slack used in the QoS metric
+};
+
+} // namespace ns3
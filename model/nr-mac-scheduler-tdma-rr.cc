@@ -18,6 +18,7 @@
  */
 #include "nr-mac-scheduler-tdma-rr.h"
 #include "nr-mac-scheduler-ue-info-rr.h"
+#include "nr-mac-scheduler-policy.h"
 #include <ns3/log.h>
 #include <algorithm>
 #include <functional>
@@ -85,4 +86,26 @@ NrMacSchedulerTdmaRR::GetUeCompareUlFn () const
   return NrMacSchedulerUeInfoRR::CompareUeWeightsUl;
 }
 
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerTdmaRR::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerTdma::AssignDLRBG (symAvail, activeDl);
+    }
+  return AssignDLRBGWithMetric (symAvail, activeDl, NrMacSchedulerMetricRR (m_dlAmc, m_ulAmc));
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerTdmaRR::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInstanceTypeId () != GetTypeId ())
+    {
+      return NrMacSchedulerTdma::AssignULRBG (symAvail, activeUl);
+    }
+  return AssignULRBGWithMetric (symAvail, activeUl, NrMacSchedulerMetricRR (m_dlAmc, m_ulAmc));
+}
+
 } //namespace ns3
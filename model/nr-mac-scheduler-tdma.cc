@@ -26,7 +26,7 @@
   while (false);
 
 #include "nr-mac-scheduler-tdma.h"
-#include "nr-mac-scheduler-ue-info-pf.h"
+#include "nr-mac-scheduler-policy.h"
 #include <ns3/log.h>
 #include <algorithm>
 #include <functional>
@@ -70,38 +70,232 @@ NrMacSchedulerTdma::GetUeVectorFromActiveUeMap (const NrMacSchedulerNs3::ActiveU
   return ueVector;
 }
 
+/**
+ * \brief Check if the UE already has enough resources to transmit its buffer
+ * \param ue the UE and its buffer requirement
+ * \param isDl true to check the DL TBS, false for the UL
+ * \return true if the UE should not get more resources
+ */
+bool
+NrMacSchedulerTdma::HasEnoughResources (const UePtrAndBufferReq &ue, bool isDl) const
+{
+  GetFirst GetUe;
+  uint32_t bufQueueSize = ue.second;
+  uint32_t tbSize = isDl ? NrMacSchedulerUeInfo::GetDlTBS (GetUe (ue)) : GetUe (ue)->m_ulTbSize;
+
+  if (tbSize < std::max (bufQueueSize, 7U))
+    {
+      return false;
+    }
+
+  if (isDl && GetUe (ue)->m_dlTbSize.size () > 1)
+    {
+      // This "if" is purely for DL MIMO. In MIMO, for example, if the
+      // first TB size is big enough to empty the buffer then we
+      // should not allocate anything to the second stream. In this
+      // case, if we allocate bytes to the second stream, the UE
+      // would expect the TB but the gNB would not be able to transmit
+      // it. This would break HARQ TX state machine at UE PHY.
+
+      // I am not generalizing the code here because MIMO is implemented
+      // only for DL; therefore, m_dlTbSize is a vector. On the other
+      // hand, in uplink m_ulTbSize is an integer. When UL MIMO is implemented
+      // we can do the following two things to generalize this code.
+      // 1. GetUe (ue)->m_dlTbSize.size () > 1
+      // above is used to check if the UE have more than one stream.
+      // When the UL MIMO is implemented maybe we can implement
+      // a method in UeInfo for DL and UL to return the number of
+      // streams. Here we can call those specific methods
+      // by looking at the type.
+      // 2. Initialize the m_dlTbSize.begin and m_dlTbSize.end iterators
+      // before the TBS check, by checking isDl.
+
+      uint8_t streamCounter = 0;
+      uint32_t copyBufQueueSize = bufQueueSize;
+      auto dlTbSizeIt = GetUe (ue)->m_dlTbSize.begin ();
+      while (dlTbSizeIt != GetUe (ue)->m_dlTbSize.end ())
+        {
+          if (copyBufQueueSize != 0)
+            {
+              NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *dlTbSizeIt << " needed to TX MIMO TB");
+              if (*dlTbSizeIt >= copyBufQueueSize)
+                {
+                  copyBufQueueSize = 0;
+                }
+              else
+                {
+                  copyBufQueueSize = copyBufQueueSize - *dlTbSizeIt;
+                }
+              streamCounter++;
+              dlTbSizeIt++;
+            }
+          else
+            {
+              // if we are here, that means previously iterated
+              // streams were enough to empty the buffer. We do
+              // not need this stream. Make its TB size zero.
+              NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *dlTbSizeIt << " not needed to TX MIMO TB");
+              *dlTbSizeIt = 0;
+              streamCounter++;
+              dlTbSizeIt++;
+            }
+        }
+    }
+  NS_LOG_INFO ("UE " << GetUe (ue)->m_rnti << " TBS " << tbSize <<
+               " queue " << bufQueueSize << ", passing");
+  return true;
+}
+
+
+namespace {
+
+/**
+ * \brief DL view of a metric policy, used by NrMacSchedulerTdma::AssignRBGTDMA
+ */
+template <typename Metric>
+class TdmaDlDirection
+{
+public:
+  static constexpr bool IS_DL = true; //!< DL direction
+  static constexpr bool HEAP_ORDER = Metric::HEAP_ORDER; //!< Keep the UEs in a heap
+
+  /**
+   * \brief TdmaDlDirection constructor
+   * \param metric the metric policy
+   */
+  TdmaDlDirection (const Metric &metric) : m_metric (metric)
+  {
+  }
+
+  static const char * GetName ()
+  {
+    return "DL";
+  }
+  static uint32_t GetTbs (const UePtr &ue)
+  {
+    return NrMacSchedulerUeInfo::GetDlTBS (ue);
+  }
+  static uint32_t & GetRbg (const UePtr &ue)
+  {
+    return NrMacSchedulerUeInfo::GetDlRBG (ue);
+  }
+  static uint8_t & GetSym (const UePtr &ue)
+  {
+    return NrMacSchedulerUeInfo::GetDlSym (ue);
+  }
+  bool Compare (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                const NrMacSchedulerNs3::UePtrAndBufferReq &rue) const
+  {
+    return m_metric.CompareDl (lue, rue);
+  }
+  void Before (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+               const NrMacSchedulerNs3::FTResources &assignable) const
+  {
+    m_metric.BeforeDl (ue, assignable);
+  }
+  void Assigned (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                 const NrMacSchedulerNs3::FTResources &assigned,
+                 const NrMacSchedulerNs3::FTResources &totAssigned) const
+  {
+    m_metric.AssignedDl (ue, assigned, totAssigned);
+  }
+  void NotAssigned (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                    const NrMacSchedulerNs3::FTResources &notAssigned,
+                    const NrMacSchedulerNs3::FTResources &totAssigned) const
+  {
+    m_metric.NotAssignedDl (ue, notAssigned, totAssigned);
+  }
+
+private:
+  const Metric &m_metric; //!< The metric policy
+};
+
+/**
+ * \brief UL view of a metric policy, used by NrMacSchedulerTdma::AssignRBGTDMA
+ */
+template <typename Metric>
+class TdmaUlDirection
+{
+public:
+  static constexpr bool IS_DL = false; //!< UL direction
+  static constexpr bool HEAP_ORDER = Metric::HEAP_ORDER; //!< Keep the UEs in a heap
+
+  /**
+   * \brief TdmaUlDirection constructor
+   * \param metric the metric policy
+   */
+  TdmaUlDirection (const Metric &metric) : m_metric (metric)
+  {
+  }
+
+  static const char * GetName ()
+  {
+    return "UL";
+  }
+  static uint32_t GetTbs (const UePtr &ue)
+  {
+    return NrMacSchedulerUeInfo::GetUlTBS (ue);
+  }
+  static uint32_t & GetRbg (const UePtr &ue)
+  {
+    return NrMacSchedulerUeInfo::GetUlRBG (ue);
+  }
+  static uint8_t & GetSym (const UePtr &ue)
+  {
+    return NrMacSchedulerUeInfo::GetUlSym (ue);
+  }
+  bool Compare (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                const NrMacSchedulerNs3::UePtrAndBufferReq &rue) const
+  {
+    return m_metric.CompareUl (lue, rue);
+  }
+  void Before (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+               const NrMacSchedulerNs3::FTResources &assignable) const
+  {
+    m_metric.BeforeUl (ue, assignable);
+  }
+  void Assigned (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                 const NrMacSchedulerNs3::FTResources &assigned,
+                 const NrMacSchedulerNs3::FTResources &totAssigned) const
+  {
+    m_metric.AssignedUl (ue, assigned, totAssigned);
+  }
+  void NotAssigned (const NrMacSchedulerNs3::UePtrAndBufferReq &ue,
+                    const NrMacSchedulerNs3::FTResources &notAssigned,
+                    const NrMacSchedulerNs3::FTResources &totAssigned) const
+  {
+    m_metric.NotAssignedUl (ue, notAssigned, totAssigned);
+  }
+
+private:
+  const Metric &m_metric; //!< The metric policy
+};
+
+} // unnamed namespace
 
 /**
  * \brief Assign the available RBG in a TDMA fashion
  * \param symAvail Number of available symbols
  * \param activeUe active flows and UE
- * \param type String representing the type of allocation currently in act (DL or UL)
- * \param BeforeSchedFn Function to call before any scheduling is started
- * \param GetCompareFn Function to call to compare UEs during assignment
- * \param GetTBSFn Function to call to get a reference of the UL or DL TBS
- * \param GetRBGFn Function to call to get a reference of the UL or DL RBG
- * \param GetSymFn Function to call to get a reference of the UL or DL symbols
- * \param SuccessfullAssignmentFn Function to call one time for the UE that got the resources assigned in one iteration
- * \param UnSuccessfullAssignmentFn Function to call for the UEs that did not get anything in one iteration
- *
+ * \param dir DL or UL view of the metric policy, and of the UE fields
  * \return a map between the beam and the symbols assigned to each one
  *
  * The algorithm redistributes the number of symbols to all the UEs. The
  * pseudocode is the following:
  * <pre>
  * for (ue : activeUe):
- *    BeforeSchedFn (ue);
+ *    dir.Before (ue);
  *
  * while symbols > 0:
  *    sort (ueVector);
- *    GetRBGFn(ueVector.first()) += BandwidthInRBG();
+ *    dir.GetRbg (ueVector.first()) += BandwidthInRBG();
  *    symbols--;
- *    SuccessfullAssignmentFn (ueVector.first());
+ *    dir.Assigned (ueVector.first());
  *    for each ue that did not get anything assigned:
- *        UnSuccessfullAssignmentFn (ue);
+ *        dir.NotAssigned (ue);
  * </pre>
  *
- * To sort the UEs, the method uses the function returned by GetUeCompareDlFn().
+ * To sort the UEs, the method uses the comparison of the metric policy.
  * Two fairness helper are hard-coded in the method: the first one is avoid
  * to assign resources to UEs that already have their buffer requirement covered,
  * and the other one is avoid to assign symbols when all the UEs have their
@@ -110,24 +304,18 @@ NrMacSchedulerTdma::GetUeVectorFromActiveUeMap (const NrMacSchedulerNs3::ActiveU
  * The distribution of each symbol is called 'iteration' in other part of the
  * class documentation.
  *
- * The function, thanks to the callback parameters, can be adapted to do
- * a UL or DL allocation. Please make sure the callbacks return references
- * (or no effects will be seen on the caller).
+ * The function, thanks to the Direction parameter (TdmaDlDirection or
+ * TdmaUlDirection), can be adapted to do a UL or DL allocation.
  *
  * \see BeforeDlSched
  */
+template <typename Direction>
 NrMacSchedulerTdma::BeamSymbolMap
 NrMacSchedulerTdma::AssignRBGTDMA (uint32_t symAvail, const ActiveUeMap &activeUe,
-                                       const std::string &type, const BeforeSchedFn &BeforeSchedFn,
-                                       const GetCompareUeFn &GetCompareFn,
-                                       const GetTBSFn &GetTBSFn,
-                                       const GetRBGFn &GetRBGFn,
-                                       const GetSymFn &GetSymFn,
-                                       const AfterSuccessfullAssignmentFn &SuccessfullAssignmentFn,
-                                       const AfterUnsucessfullAssignmentFn &UnSuccessfullAssignmentFn) const
+                                   const Direction &dir) const
 {
   NS_LOG_FUNCTION (this);
-  NS_LOG_DEBUG ("Assigning RBG in " << type <<  ", # beams active flows: " <<
+  NS_LOG_DEBUG ("Assigning RBG in " << Direction::GetName () <<  ", # beams active flows: " <<
                 activeUe.size () << ", # sym: " << symAvail);
 
   // Create vector of UE (without considering the beam)
@@ -137,92 +325,63 @@ NrMacSchedulerTdma::AssignRBGTDMA (uint32_t symAvail, const ActiveUeMap &activeU
   uint32_t resources = symAvail;
   FTResources assigned (0, 0);
 
-  const std::vector<uint8_t> notchedRBGsMask = type == "DL" ? GetDlNotchedRbgMask () : GetUlNotchedRbgMask ();
-  int zeroes = std::count (notchedRBGsMask.begin (), notchedRBGsMask.end (), 0);
-  uint32_t numOfAssignableRbgs = GetBandwidthInRbg () - zeroes;
+  uint32_t numOfAssignableRbgs = Direction::IS_DL ? GetDlAssignableRbgMask ().Count () :
+                                                GetUlAssignableRbgMask ().Count ();
   NS_ASSERT (numOfAssignableRbgs > 0);
 
   for (auto & ue : ueVector)
     {
-      BeforeSchedFn (ue, FTResources (numOfAssignableRbgs, 1));
+      dir.Before (ue, FTResources (numOfAssignableRbgs, 1));
+    }
+
+  // With HEAP_ORDER, the heap keeps on top the UE that the sort would put first
+  auto heapCompare = [&dir] (const UePtrAndBufferReq &lue, const UePtrAndBufferReq &rue)
+    {
+      return dir.Compare (rue, lue);
+    };
+  if constexpr (Direction::HEAP_ORDER)
+    {
+      std::make_heap (ueVector.begin (), ueVector.end (), heapCompare);
+      CountSlotStat (NrMacSchedulerSlotStats::SORT_CALLS);
     }
 
   while (resources > 0)
     {
       GetFirst GetUe;
 
-      auto schedInfoIt = ueVector.begin ();
+      auto schedInfoIt = ueVector.end ();
 
-      std::sort (ueVector.begin (), ueVector.end (), GetCompareFn ());
-
-      // Ensure fairness: pass over UEs which already has enough resources to transmit
-      while (schedInfoIt != ueVector.end ())
+      if constexpr (Direction::HEAP_ORDER)
         {
-          uint32_t bufQueueSize = schedInfoIt->second;
-
-          if (GetTBSFn (GetUe (*schedInfoIt)) >= std::max (bufQueueSize, 7U))
+          // Ensure fairness: remove the UEs which already has enough resources
+          // to transmit, they will not get anything else in this slot
+          while (! ueVector.empty ())
             {
-              if (GetUe (*schedInfoIt)->m_dlTbSize.size () > 1 && type == "DL")
+              std::pop_heap (ueVector.begin (), ueVector.end (), heapCompare);
+              if (! HasEnoughResources (ueVector.back (), Direction::IS_DL))
                 {
-                  // This "if" is purely for DL MIMO. In MIMO, for example, if the
-                  // first TB size is big enough to empty the buffer then we
-                  // should not allocate anything to the second stream. In this
-                  // case, if we allocate bytes to the second stream, the UE
-                  // would expect the TB but the gNB would not be able to transmit
-                  // it. This would break HARQ TX state machine at UE PHY.
-
-                  // I am not generalizing the code here because MIMO is implemented
-                  // only for DL; therefore, m_dlTbSize is a vector. On the other
-                  // hand, in uplink m_ulTbSize is an integer. When UL MIMO is implemented
-                  // we can do the following two things to generalize this code.
-                  // 1. GetUe (*schedInfoIt)->m_dlTbSize.size () > 1
-                  // above is used to check if the UE have more than one stream.
-                  // When the UL MIMO is implemented maybe we can implement
-                  // a method in UeInfo for DL and UL to return the number of
-                  // streams. Here we can call those specific methods
-                  // by looking at the type.
-                  // 2. Initialize the m_dlTbSize.begin and m_dlTbSize.end iterators before
-                  // "if (GetTBSFn (GetUe (*schedInfoIt)) >= std::max (bufQueueSize, 7U))"
-                  // by checking the "type".
-
-                  uint8_t streamCounter = 0;
-                  uint32_t copyBufQueueSize = bufQueueSize;
-                  auto dlTbSizeIt = GetUe (*schedInfoIt)->m_dlTbSize.begin ();
-                  while (dlTbSizeIt != GetUe (*schedInfoIt)->m_dlTbSize.end ())
-                    {
-                      if (copyBufQueueSize != 0)
-                        {
-                          NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *dlTbSizeIt << " needed to TX MIMO TB");
-                          if (*dlTbSizeIt >= copyBufQueueSize)
-                            {
-                              copyBufQueueSize = 0;
-                            }
-                          else
-                            {
-                              copyBufQueueSize = copyBufQueueSize - *dlTbSizeIt;
-                            }
-                          streamCounter++;
-                          dlTbSizeIt++;
-                        }
-                      else
-                        {
-                          // if we are here, that means previously iterated
-                          // streams were enough to empty the buffer. We do
-                          // not need this stream. Make its TB size zero.
-                          NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *dlTbSizeIt << " not needed to TX MIMO TB");
-                          *dlTbSizeIt = 0;
-                          streamCounter++;
-                          dlTbSizeIt++;
-                        }
-                    }
+                  break;
                 }
-              NS_LOG_INFO ("UE " << GetUe (*schedInfoIt)->m_rnti << " TBS " <<
-                           GetTBSFn (GetUe (*schedInfoIt)) << " queue " << bufQueueSize << ", passing");
-              schedInfoIt++;
+              ueVector.pop_back ();
             }
-          else
+          // The UE to serve is the last one, which has been popped from the heap
+          schedInfoIt = ueVector.empty () ? ueVector.end () : ueVector.end () - 1;
+        }
+      else
+        {
+          std::sort (ueVector.begin (), ueVector.end (),
+                     [&dir] (const UePtrAndBufferReq &lue, const UePtrAndBufferReq &rue)
+                     {
+                       return dir.Compare (lue, rue);
+                     });
+          CountSlotStat (NrMacSchedulerSlotStats::SORT_CALLS);
+
+          // Ensure fairness: pass over UEs which already has enough resources to transmit
+          schedInfoIt = ueVector.begin ();
+          while (schedInfoIt != ueVector.end ()
+                 && HasEnoughResources (*schedInfoIt, Direction::IS_DL))
             {
-              break;
+              schedInfoIt++;
             }
         }
 
@@ -236,10 +395,10 @@ NrMacSchedulerTdma::AssignRBGTDMA (uint32_t symAvail, const ActiveUeMap &activeU
 
       // Assign 1 entire symbol (full RBG) to the selected UE and to the total
       // resources assigned count
-      GetRBGFn (GetUe (*schedInfoIt)) += numOfAssignableRbgs;
+      Direction::GetRbg (GetUe (*schedInfoIt)) += numOfAssignableRbgs;
       assigned.m_rbg += numOfAssignableRbgs;
 
-      GetSymFn (GetUe (*schedInfoIt)) += 1;
+      Direction::GetSym (GetUe (*schedInfoIt)) += 1;
       assigned.m_sym += 1;
 
       // substract 1 SYM from the number of sym available for the while loop
@@ -247,19 +406,26 @@ NrMacSchedulerTdma::AssignRBGTDMA (uint32_t symAvail, const ActiveUeMap &activeU
 
       // Update metrics for the successfull UE
       NS_LOG_DEBUG ("Assigned " << numOfAssignableRbgs <<
-                    " " << type << " RBG (= 1 SYM) to UE " << GetUe (*schedInfoIt)->m_rnti <<
-                    " total assigned up to now: " << GetRBGFn (GetUe (*schedInfoIt)) <<
+                    " " << Direction::GetName () << " RBG (= 1 SYM) to UE " << GetUe (*schedInfoIt)->m_rnti <<
+                    " total assigned up to now: " << Direction::GetRbg (GetUe (*schedInfoIt)) <<
                     " that corresponds to " << assigned.m_rbg);
-      SuccessfullAssignmentFn (*schedInfoIt, FTResources (numOfAssignableRbgs, 1),
-                               assigned);
+      dir.Assigned (*schedInfoIt, FTResources (numOfAssignableRbgs, 1), assigned);
+      CountSlotStat (NrMacSchedulerSlotStats::TBS_COMPUTATIONS);
 
-      // Update metrics for the unsuccessfull UEs (who did not get any resource in this iteration)
-      for (auto & ue : ueVector)
+      if constexpr (Direction::HEAP_ORDER)
+        {
+          // The other UEs did not change: put the UE back in the heap
+          std::push_heap (ueVector.begin (), ueVector.end (), heapCompare);
+        }
+      else
         {
-          if (GetUe (ue)->m_rnti != GetUe (*schedInfoIt)->m_rnti)
+          // Update metrics for the unsuccessfull UEs (who did not get any resource in this iteration)
+          for (auto & ue : ueVector)
             {
-              UnSuccessfullAssignmentFn (ue, FTResources (numOfAssignableRbgs, 1),
-                                         assigned);
+              if (GetUe (ue)->m_rnti != GetUe (*schedInfoIt)->m_rnti)
+                {
+                  dir.NotAssigned (ue, FTResources (numOfAssignableRbgs, 1), assigned);
+                }
             }
         }
     }
@@ -271,73 +437,78 @@ NrMacSchedulerTdma::AssignRBGTDMA (uint32_t symAvail, const ActiveUeMap &activeU
       uint32_t symOfBeam = 0;
       for (const auto &ue : el.second)
         {
-          symOfBeam += GetRBGFn (ue.first) / numOfAssignableRbgs;
+          symOfBeam += Direction::GetRbg (ue.first) / numOfAssignableRbgs;
         }
       ret.insert (std::make_pair (el.first, symOfBeam));
     }
   return ret;
 }
 
+template <typename Metric>
+NrMacSchedulerTdma::BeamSymbolMap
+NrMacSchedulerTdma::AssignDLRBGWithMetric (uint32_t symAvail, const ActiveUeMap &activeDl,
+                                           const Metric &metric) const
+{
+  NS_LOG_FUNCTION (this);
+  return AssignRBGTDMA (symAvail, activeDl, TdmaDlDirection<Metric> (metric));
+}
+
+template <typename Metric>
+NrMacSchedulerTdma::BeamSymbolMap
+NrMacSchedulerTdma::AssignULRBGWithMetric (uint32_t symAvail, const ActiveUeMap &activeUl,
+                                           const Metric &metric) const
+{
+  NS_LOG_FUNCTION (this);
+  return AssignRBGTDMA (symAvail, activeUl, TdmaUlDirection<Metric> (metric));
+}
+
+/// \cond
+#define NR_TDMA_INSTANTIATE_METRIC(Metric)                                                   \
+  template NrMacSchedulerTdma::BeamSymbolMap                                                 \
+  NrMacSchedulerTdma::AssignDLRBGWithMetric<Metric> (uint32_t, const ActiveUeMap &,          \
+                                                     const Metric &) const;                  \
+  template NrMacSchedulerTdma::BeamSymbolMap                                                 \
+  NrMacSchedulerTdma::AssignULRBGWithMetric<Metric> (uint32_t, const ActiveUeMap &,          \
+                                                     const Metric &) const;
+
+NR_TDMA_INSTANTIATE_METRIC (NrMacSchedulerTdma::VirtualMetric)
+NR_TDMA_INSTANTIATE_METRIC (NrMacSchedulerMetricRR)
+NR_TDMA_INSTANTIATE_METRIC (NrMacSchedulerMetricMR)
+NR_TDMA_INSTANTIATE_METRIC (NrMacSchedulerMetricPF)
+NR_TDMA_INSTANTIATE_METRIC (NrMacSchedulerMetricQos)
+#undef NR_TDMA_INSTANTIATE_METRIC
+/// \endcond
+
 /**
  * \brief Assign the available DL RBG to the UEs
  * \param symAvail Number of available symbols
  * \param activeDl active DL flows and UE
  * \return a map between the beam and the symbols assigned to each one
  *
- * The function will prepare all the needed callbacks to return UE DL parameters
- * (e.g., the DL TBS, the DL RBG) and then will call NrMacSchedulerTdma::AssignRBGTDMA.
+ * The default implementation uses the virtual methods of the class
+ * (through VirtualMetric). The metric subclasses override it to use their
+ * static metric policy.
  */
 NrMacSchedulerTdma::BeamSymbolMap
 NrMacSchedulerTdma::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
 {
   NS_LOG_FUNCTION (this);
-
-  BeforeSchedFn beforeSched = std::bind (&NrMacSchedulerTdma::BeforeDlSched, this,
-                                         std::placeholders::_1, std::placeholders::_2);
-  AfterSuccessfullAssignmentFn SuccFn = std::bind (&NrMacSchedulerTdma::AssignedDlResources, this,
-                                                   std::placeholders::_1, std::placeholders::_2,
-                                                   std::placeholders::_3);
-  AfterUnsucessfullAssignmentFn UnSuccFn = std::bind (&NrMacSchedulerTdma::NotAssignedDlResources, this,
-                                                      std::placeholders::_1, std::placeholders::_2,
-                                                      std::placeholders::_3);
-  GetCompareUeFn compareFn = std::bind (&NrMacSchedulerTdma::GetUeCompareDlFn, this);
-
-  GetTBSFn GetTbs = &NrMacSchedulerUeInfo::GetDlTBS;
-  GetRBGFn GetRBG = &NrMacSchedulerUeInfo::GetDlRBG;
-  GetSymFn GetSym = &NrMacSchedulerUeInfo::GetDlSym;
-
-  return AssignRBGTDMA (symAvail, activeDl, "DL", beforeSched, compareFn,
-                        GetTbs, GetRBG, GetSym, SuccFn, UnSuccFn);
+  return AssignDLRBGWithMetric (symAvail, activeDl, VirtualMetric (this));
 }
 
 /**
  * \brief Assign the available UL RBG to the UEs
  * \param symAvail Number of available symbols
- * \param activeUl active DL flows and UE
+ * \param activeUl active UL flows and UE
  * \return a map between the beam and the symbols assigned to each one
  *
- * The function will prepare all the needed callbacks to return UE UL parameters
- * (e.g., the UL TBS, the UL RBG) and then will call NrMacSchedulerTdma::AssignRBGTDMA.
+ * \see AssignDLRBG
  */
 NrMacSchedulerTdma::BeamSymbolMap
 NrMacSchedulerTdma::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl) const
 {
   NS_LOG_FUNCTION (this);
-  BeforeSchedFn beforeSched = std::bind (&NrMacSchedulerTdma::BeforeUlSched, this,
-                                         std::placeholders::_1, std::placeholders::_2);
-  AfterSuccessfullAssignmentFn SuccFn = std::bind (&NrMacSchedulerTdma::AssignedUlResources, this,
-                                                   std::placeholders::_1, std::placeholders::_2,
-                                                   std::placeholders::_3);
-  GetCompareUeFn compareFn = std::bind (&NrMacSchedulerTdma::GetUeCompareUlFn, this);
-  AfterUnsucessfullAssignmentFn UnSuccFn = std::bind (&NrMacSchedulerTdma::NotAssignedUlResources, this,
-                                                      std::placeholders::_1, std::placeholders::_2,
-                                                      std::placeholders::_3);
-  GetTBSFn GetTbs = &NrMacSchedulerUeInfo::GetUlTBS;
-  GetRBGFn GetRBG = &NrMacSchedulerUeInfo::GetUlRBG;
-  GetSymFn GetSym = &NrMacSchedulerUeInfo::GetUlSym;
-
-  return AssignRBGTDMA (symAvail, activeUl, "UL", beforeSched, compareFn,
-                        GetTbs, GetRBG, GetSym, SuccFn, UnSuccFn);
+  return AssignULRBGWithMetric (symAvail, activeUl, VirtualMetric (this));
 }
 
 /**
@@ -364,10 +535,8 @@ NrMacSchedulerTdma::CreateDlDci (PointInFTPlane *spoint,
   //here to cover MIMO
 
   //Due to MIMO implementation MCS, TB size, ndi, rv, are vectors
-    std::vector<uint8_t> ndi;
-    ndi.resize (ueInfo->m_dlTbSize.size ());
-    std::vector<uint8_t> rv;
-    rv.resize (ueInfo->m_dlTbSize.size ());
+    NrStreamArray<uint8_t> ndi (ueInfo->m_dlTbSize.size ());
+    NrStreamArray<uint8_t> rv (ueInfo->m_dlTbSize.size ());
     uint32_t tbs = 0;
     for (uint32_t numTb = 0; numTb < ueInfo->m_dlTbSize.size (); numTb++)
       {
@@ -396,9 +565,7 @@ NrMacSchedulerTdma::CreateDlDci (PointInFTPlane *spoint,
       return nullptr;
     }
 
-  const std::vector<uint8_t> notchedRBGsMask = GetDlNotchedRbgMask ();
-  int zeroes = std::count (notchedRBGsMask.begin (), notchedRBGsMask.end (), 0);
-  uint32_t numOfAssignableRbgs = GetBandwidthInRbg () - zeroes;
+  uint32_t numOfAssignableRbgs = GetDlAssignableRbgMask ().Count ();
 
   uint8_t numSym = static_cast<uint8_t> (ueInfo->m_dlRBG / numOfAssignableRbgs);
 
@@ -432,6 +599,7 @@ NrMacSchedulerTdma::CreateUlDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
   NS_LOG_FUNCTION (this);
   uint32_t tbs = m_ulAmc->CalculateTbSize (ueInfo->m_ulMcs,
                                            ueInfo->m_ulRBG * GetNumRbPerRbg ());
+  CountSlotStat (NrMacSchedulerSlotStats::TBS_COMPUTATIONS);
 
   // If is less than 7 (3 mac header, 2 rlc header, 2 data), then we can't
   // transmit any new data, so don't create dci.
@@ -442,9 +610,7 @@ NrMacSchedulerTdma::CreateUlDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
       return nullptr;
     }
 
-  const std::vector<uint8_t> notchedRBGsMask = GetUlNotchedRbgMask ();
-  int zeroes = std::count (notchedRBGsMask.begin (), notchedRBGsMask.end (), 0);
-  uint32_t numOfAssignableRbgs = GetBandwidthInRbg () - zeroes;
+  uint32_t numOfAssignableRbgs = GetUlAssignableRbgMask ().Count ();
 
   uint8_t numSym = static_cast<uint8_t> (std::max (ueInfo->m_ulRBG / numOfAssignableRbgs, 1U));
   numSym = std::min (numSym, static_cast<uint8_t> (maxSym));
@@ -455,10 +621,10 @@ NrMacSchedulerTdma::CreateUlDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
   spoint->m_sym -= numSym;
 
   //Due to MIMO implementation MCS and TB size are vectors
-  std::vector<uint8_t> ulMcs = {ueInfo->m_ulMcs};
-  std::vector<uint32_t> ulTbs = {tbs};
-  std::vector<uint8_t> ndi = {1};
-  std::vector<uint8_t> rv = {0};
+  NrStreamArray<uint8_t> ulMcs = {ueInfo->m_ulMcs};
+  NrStreamArray<uint32_t> ulTbs = {tbs};
+  NrStreamArray<uint8_t> ndi = {1};
+  NrStreamArray<uint8_t> rv = {0};
 
   auto dci = CreateDci (spoint, ueInfo, ulTbs, DciInfoElementTdma::UL, ulMcs,
                         ndi, rv, numSym);
@@ -492,9 +658,9 @@ NrMacSchedulerTdma::GetTpc () const
 std::shared_ptr<DciInfoElementTdma>
 NrMacSchedulerTdma::CreateDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
                                const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
-                               std::vector<uint32_t> tbs, DciInfoElementTdma::DciFormat fmt,
-                               std::vector<uint8_t> mcs, std::vector<uint8_t> ndi,
-                               std::vector<uint8_t> rv,uint8_t numSym) const
+                               const NrStreamArray<uint32_t> &tbs, DciInfoElementTdma::DciFormat fmt,
+                               const NrStreamArray<uint8_t> &mcs, const NrStreamArray<uint8_t> &ndi,
+                               const NrStreamArray<uint8_t> &rv, uint8_t numSym) const
 {
   NS_LOG_FUNCTION (this);
   uint32_t sumTbSize = 0;
@@ -509,29 +675,16 @@ NrMacSchedulerTdma::CreateDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
       (ueInfo->m_rnti, fmt, spoint->m_sym, numSym, mcs, tbs, ndi, rv, DciInfoElementTdma::DATA,
        GetBwpId (), GetTpc());
 
-  std::vector<uint8_t> rbgAssigned = fmt == DciInfoElementTdma::DL ? GetDlNotchedRbgMask () :
-                                                                     GetUlNotchedRbgMask ();
-
-  if (rbgAssigned.size() == 0)
-    {
-      rbgAssigned = std::vector<uint8_t> (GetBandwidthInRbg (), 1);
-    }
-
-  NS_ASSERT (rbgAssigned.size () == GetBandwidthInRbg ());
-
-  dci->m_rbgBitmask = std::move (rbgAssigned);
+  dci->m_rbgBitmask = fmt == DciInfoElementTdma::DL ? GetDlAssignableRbgMask () :
+                                                      GetUlAssignableRbgMask ();
 
-  std::ostringstream oss;
-  for (auto & x: dci->m_rbgBitmask)
-    {
-      oss << std::to_string (x) << " ";
-    }
+  NS_ASSERT (dci->m_rbgBitmask.GetSize () == GetBandwidthInRbg ());
 
   NS_LOG_INFO ("UE " << ueInfo->m_rnti << " assigned RBG from " <<
                static_cast<uint32_t> (spoint->m_rbg) << " with mask " <<
-               oss.str() << " for " << static_cast<uint32_t> (numSym) << " SYM ");
+               dci->m_rbgBitmask << " for " << static_cast<uint32_t> (numSym) << " SYM ");
 
-  NS_ASSERT (std::count (dci->m_rbgBitmask.begin (), dci->m_rbgBitmask.end (), 0) != GetBandwidthInRbg ());
+  NS_ASSERT (dci->m_rbgBitmask.Any ());
 
   return dci;
 }
@@ -70,6 +70,7 @@ namespace ns3 {
  * \see NrMacSchedulerTdmaRR
  * \see NrMacSchedulerTdmaPF
  * \see NrMacSchedulerTdmaMR
+ * \see NrMacSchedulerTdmaQos
  */
 class NrMacSchedulerTdma : public NrMacSchedulerNs3
 {
@@ -122,6 +123,12 @@ protected:
 
   virtual uint8_t GetTpc () const override;
 
+  /**
+   * \brief Function to compare two UEs (true if the first has an higher priority)
+   */
+  typedef std::function<bool (const NrMacSchedulerNs3::UePtrAndBufferReq &lhs,
+                              const NrMacSchedulerNs3::UePtrAndBufferReq &rhs )> CompareUeFn;
+
   /**
    * \brief Provide the comparison function to order the UE when scheduling DL
    * \return a function that should order two UEs based on their priority: if
@@ -217,6 +224,116 @@ protected:
   virtual void
   BeforeUlSched (const UePtrAndBufferReq &ue,
                  const FTResources &assignableInIteration) const = 0;
+
+  /**
+   * \brief Check if the UE already has enough resources to transmit its buffer
+   * \param ue the UE and its buffer requirement (in B)
+   * \param isDl true to check the DL TBS, false for the UL
+   * \return true if the UE should not get more resources
+   *
+   * For DL MIMO, the TB size of the streams not needed to empty the buffer
+   * is set to zero.
+   */
+  bool HasEnoughResources (const UePtrAndBufferReq &ue, bool isDl) const;
+
+  /**
+   * \brief Metric policy that calls the virtual methods of the scheduler
+   *
+   * It is the policy used by the default AssignDLRBG() and AssignULRBG(),
+   * so that a subclass that only implements the virtual methods
+   * (GetUeCompareDlFn(), AssignedDlResources(), and so on) keeps working.
+   * The comparison functions are retrieved once, when the policy is created.
+   *
+   * \see NrMacSchedulerMetricRR for the description of a metric policy
+   */
+  class VirtualMetric
+  {
+  public:
+    static constexpr bool HEAP_ORDER = false; //!< The virtual methods may update every UE
+
+    /**
+     * \brief VirtualMetric constructor
+     * \param scheduler the scheduler
+     */
+    VirtualMetric (const NrMacSchedulerTdma *scheduler)
+      : m_scheduler (scheduler),
+      m_compareDl (scheduler->GetUeCompareDlFn ()),
+      m_compareUl (scheduler->GetUeCompareUlFn ())
+    {
+    }
+
+    bool CompareDl (const UePtrAndBufferReq &lue, const UePtrAndBufferReq &rue) const
+    {
+      return m_compareDl (lue, rue);
+    }
+    bool CompareUl (const UePtrAndBufferReq &lue, const UePtrAndBufferReq &rue) const
+    {
+      return m_compareUl (lue, rue);
+    }
+    void BeforeDl (const UePtrAndBufferReq &ue, const FTResources &assignable) const
+    {
+      m_scheduler->BeforeDlSched (ue, assignable);
+    }
+    void BeforeUl (const UePtrAndBufferReq &ue, const FTResources &assignable) const
+    {
+      m_scheduler->BeforeUlSched (ue, assignable);
+    }
+    void AssignedDl (const UePtrAndBufferReq &ue, const FTResources &assigned,
+                     const FTResources &totAssigned) const
+    {
+      m_scheduler->AssignedDlResources (ue, assigned, totAssigned);
+    }
+    void AssignedUl (const UePtrAndBufferReq &ue, const FTResources &assigned,
+                     const FTResources &totAssigned) const
+    {
+      m_scheduler->AssignedUlResources (ue, assigned, totAssigned);
+    }
+    void NotAssignedDl (const UePtrAndBufferReq &ue, const FTResources &notAssigned,
+                        const FTResources &totAssigned) const
+    {
+      m_scheduler->NotAssignedDlResources (ue, notAssigned, totAssigned);
+    }
+    void NotAssignedUl (const UePtrAndBufferReq &ue, const FTResources &notAssigned,
+                        const FTResources &totAssigned) const
+    {
+      m_scheduler->NotAssignedUlResources (ue, notAssigned, totAssigned);
+    }
+
+  private:
+    const NrMacSchedulerTdma *m_scheduler {nullptr}; //!< The scheduler
+    CompareUeFn m_compareDl; //!< DL comparison function
+    CompareUeFn m_compareUl; //!< UL comparison function
+  };
+
+  /**
+   * \brief Assign the available DL RBG to the UEs, with a metric policy
+   * \param symAvail Number of available symbols
+   * \param activeDl active DL flows and UE
+   * \param metric the metric policy (VirtualMetric, or one of the policies
+   * in nr-mac-scheduler-policy.h)
+   * \return a map between the beam and the symbols assigned to each one
+   *
+   * The metric is a template parameter, so its calls are resolved (and
+   * possibly inlined) at compile time. The template is instantiated in
+   * nr-mac-scheduler-tdma.cc for the metric policies of the module.
+   */
+  template <typename Metric>
+  BeamSymbolMap
+  AssignDLRBGWithMetric (uint32_t symAvail, const ActiveUeMap &activeDl, const Metric &metric) const;
+
+  /**
+   * \brief Assign the available UL RBG to the UEs, with a metric policy
+   * \param symAvail Number of available symbols
+   * \param activeUl active UL flows and UE
+   * \param metric the metric policy
+   * \return a map between the beam and the symbols assigned to each one
+   *
+   * \see AssignDLRBGWithMetric
+   */
+  template <typename Metric>
+  BeamSymbolMap
+  AssignULRBGWithMetric (uint32_t symAvail, const ActiveUeMap &activeUl, const Metric &metric) const;
+
 private:
   /**
    * \brief Retrieve the UE vector from an ActiveUeMap
@@ -228,35 +345,21 @@ private:
   static std::vector<UePtrAndBufferReq>
   GetUeVectorFromActiveUeMap (const ActiveUeMap &activeUes);
 
-private:
-  typedef std::function<void (const UePtrAndBufferReq &, const FTResources &)> BeforeSchedFn; //!< Before scheduling function
-  /**
-   * \brief //!< Function to notify a successfull assignment
-   */
-  typedef std::function<void (const UePtrAndBufferReq &, const FTResources &, const FTResources &)> AfterSuccessfullAssignmentFn;
   /**
-   * \brief Function to notify that the UE did not get any resource in one iteration
+   * \brief Assign the available RBG in a TDMA fashion
+   * \param symAvail Number of available symbols
+   * \param activeUe active flows and UE
+   * \param dir DL or UL view of the metric policy, and of the UE fields
+   * \return a map between the beam and the symbols assigned to each one
    */
-  typedef std::function<void (const UePtrAndBufferReq &, const FTResources &, const FTResources &)> AfterUnsucessfullAssignmentFn;
-  typedef std::function<uint32_t& (const UePtr &ue)> GetRBGFn; //!< Getter for the RBG of an UE
-  typedef std::function<uint32_t (const UePtr &ue)> GetTBSFn; //!< Getter for the TBS of an UE
-  typedef std::function<uint8_t& (const UePtr &ue)> GetSymFn;  //!< Getter for the number of symbols of an UE
-  typedef std::function<bool (const NrMacSchedulerNs3::UePtrAndBufferReq &lhs,
-                              const NrMacSchedulerNs3::UePtrAndBufferReq &rhs )> CompareUeFn;
-  typedef std::function<CompareUeFn ()> GetCompareUeFn;
-
+  template <typename Direction>
   BeamSymbolMap
-  AssignRBGTDMA (uint32_t symAvail, const ActiveUeMap &activeUe,
-                 const std::string &type, const BeforeSchedFn &BeforeSchedFn,
-                 const GetCompareUeFn &GetCompareFn, const GetTBSFn &GetTBSFn, const GetRBGFn &GetRBGFn,
-                 const GetSymFn &GetSymFn, const AfterSuccessfullAssignmentFn &SuccessfullAssignmentFn,
-                 const AfterUnsucessfullAssignmentFn &UnSuccessfullAssignmentFn) const;
-
+  AssignRBGTDMA (uint32_t symAvail, const ActiveUeMap &activeUe, const Direction &dir) const;
 
   std::shared_ptr<DciInfoElementTdma> CreateDci (PointInFTPlane *spoint, const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
-                                                 std::vector<uint32_t> tbs, DciInfoElementTdma::DciFormat fmt,
-                                                 std::vector<uint8_t> mcs, std::vector<uint8_t> ndi,
-                                                 std::vector<uint8_t> rv, uint8_t numSym) const;
+                                                 const NrStreamArray<uint32_t> &tbs, DciInfoElementTdma::DciFormat fmt,
+                                                 const NrStreamArray<uint8_t> &mcs, const NrStreamArray<uint8_t> &ndi,
+                                                 const NrStreamArray<uint8_t> &rv, uint8_t numSym) const;
 };
 
 } // namespace ns3
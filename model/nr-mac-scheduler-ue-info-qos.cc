@@ -0,0 +1,106 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-mac-scheduler-ue-info-qos.h"
+#include <ns3/log.h>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerUeInfoQos");
+
+/**
+ * \brief Calculate the QoS metric from the deadline and the potential throughput
+ * \param deadline the earliest deadline of the UE
+ * \param potentialTput the potential throughput
+ * \param now the current time
+ * \param minSlack the minimum slack
+ * \return the QoS metric (0 if the UE has no deadline)
+ */
+static double
+QosMetric (const Time &deadline, double potentialTput, const Time &now, const Time &minSlack)
+{
+  if (deadline == Time::Max ())
+    {
+      return 0.0;
+    }
+  Time slack = std::max (minSlack, deadline - now);
+  return potentialTput / slack.GetSeconds ();
+}
+
+void
+NrMacSchedulerUeInfoQos::CalculateDlQosMetric (const NrMacSchedulerNs3::FTResources &assignableInIteration,
+                                               const Ptr<const NrAmc> &amc, const Time &now,
+                                               const Time &minSlack)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t rbsAssignable = assignableInIteration.m_rbg * GetNumRbPerRbg ();
+  double potentialTput = 0.0;
+
+  if (m_dlCqi.m_ri == 1)
+    {
+      auto mcsIt = std::max_element (m_dlMcs.begin (), m_dlMcs.end ());
+      potentialTput = amc->CalculateTbSize (*mcsIt, rbsAssignable);
+    }
+  else
+    {
+      for (const auto &mcs : m_dlMcs)
+        {
+          potentialTput += amc->CalculateTbSize (mcs, rbsAssignable);
+        }
+    }
+  potentialTput /= assignableInIteration.m_sym;
+
+  m_dlDeadline = Time::Max ();
+  for (const auto &lcg : m_dlLCG)
+    {
+      m_dlDeadline = std::min (m_dlDeadline, lcg.GetEarliestDeadline ());
+    }
+  m_dlQosMetric = QosMetric (m_dlDeadline, potentialTput, now, minSlack);
+
+  NS_LOG_INFO ("UE " << m_rnti << " potentialTputDl " << potentialTput <<
+               " DL deadline " << m_dlDeadline.As (Time::MS) <<
+               " DL QoS metric " << m_dlQosMetric);
+}
+
+void
+NrMacSchedulerUeInfoQos::CalculateUlQosMetric (const NrMacSchedulerNs3::FTResources &assignableInIteration,
+                                               const Ptr<const NrAmc> &amc, const Time &now,
+                                               const Time &minSlack)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t rbsAssignable = assignableInIteration.m_rbg * GetNumRbPerRbg ();
+  double potentialTput = amc->CalculateTbSize (m_ulMcs, rbsAssignable);
+  potentialTput /= assignableInIteration.m_sym;
+
+  m_ulDeadline = Time::Max ();
+  for (const auto &lcg : m_ulLCG)
+    {
+      m_ulDeadline = std::min (m_ulDeadline, lcg.GetEarliestDeadline ());
+    }
+  m_ulQosMetric = QosMetric (m_ulDeadline, potentialTput, now, minSlack);
+
+  NS_LOG_INFO ("UE " << m_rnti << " potentialTputUl " << potentialTput <<
+               " UL deadline " << m_ulDeadline.As (Time::MS) <<
+               " UL QoS metric " << m_ulQosMetric);
+}
+
+} // namespace ns3
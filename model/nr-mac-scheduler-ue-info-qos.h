@@ -0,0 +1,154 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#pragma once
+
+#include "nr-mac-scheduler-ue-info-rr.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief UE representation for a delay-aware QoS scheduler
+ *
+ * Before each assignment, the UE calculates its deadline, i.e., the time
+ * at which the oldest byte of its LCs violates the packet delay budget of
+ * the flow (see NrMacSchedulerLCG::GetEarliestDeadline), and the slack
+ * between the deadline and the current time. The QoS metric is then:
+ *
+ * \f$ qosMetric_{i} = potentialTPut_{i} / max (minSlack, slack_{i}) \f$
+ *
+ * so that the resources go first to the flows closer to violate their
+ * budget, weighted by the rate they can achieve. The potential throughput
+ * is calculated as in NrMacSchedulerUeInfoPF. The metric does not depend
+ * on the resources assigned to the other UEs, so it is calculated only once
+ * per slot (see CalculateDlQosMetric).
+ *
+ * \see CompareUeWeightsDl
+ */
+class NrMacSchedulerUeInfoQos : public NrMacSchedulerUeInfo
+{
+public:
+  /**
+   * \brief NrMacSchedulerUeInfoQos constructor
+   * \param rnti RNTI of the UE
+   * \param beamConfId BeamConfId of the UE
+   * \param fn A function that tells how many RB per RBG
+   */
+  NrMacSchedulerUeInfoQos (uint16_t rnti, BeamConfId beamConfId, const GetRbPerRbgFn &fn)
+    : NrMacSchedulerUeInfo (rnti, beamConfId, fn)
+  {
+  }
+
+  /**
+   * \brief Reset DL QoS scheduler info
+   *
+   * It calls also NrMacSchedulerUeInfo::ResetDlSchedInfo.
+   */
+  virtual void ResetDlSchedInfo () override
+  {
+    m_dlQosMetric = 0.0;
+    NrMacSchedulerUeInfo::ResetDlSchedInfo ();
+  }
+
+  /**
+   * \brief Reset UL QoS scheduler info
+   *
+   * It also calls NrMacSchedulerUeInfo::ResetUlSchedInfo.
+   */
+  virtual void ResetUlSchedInfo () override
+  {
+    m_ulQosMetric = 0.0;
+    NrMacSchedulerUeInfo::ResetUlSchedInfo ();
+  }
+
+  /**
+   * \brief Calculate the QoS metric for downlink
+   * \param assignableInIteration resources assignable
+   * \param amc a pointer to the AMC
+   * \param now the current time
+   * \param minSlack the minimum slack, used for the flows that already
+   * violated (or are about to violate) their budget
+   */
+  void CalculateDlQosMetric (const NrMacSchedulerNs3::FTResources &assignableInIteration,
+                             const Ptr<const NrAmc> &amc, const Time &now, const Time &minSlack);
+
+  /**
+   * \brief Calculate the QoS metric for uplink
+   * \param assignableInIteration resources assignable
+   * \param amc a pointer to the AMC
+   * \param now the current time
+   * \param minSlack the minimum slack
+   */
+  void CalculateUlQosMetric (const NrMacSchedulerNs3::FTResources &assignableInIteration,
+                             const Ptr<const NrAmc> &amc, const Time &now, const Time &minSlack);
+
+  /**
+   * \brief comparison function object (i.e. an object that satisfies the
+   * requirements of Compare) which returns ​true if the first argument is less
+   * than (i.e. is ordered before) the second.
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return true if the QoS metric of the left UE is higher than the right UE
+   *
+   * If the metrics are equal (e.g., the UEs have no flow with a budget), the
+   * UE with less RBG assigned comes first, as in a RR scheduler.
+   */
+  static bool CompareUeWeightsDl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                                  const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    auto luePtr = static_cast<const NrMacSchedulerUeInfoQos*> (lue.first.get ());
+    auto ruePtr = static_cast<const NrMacSchedulerUeInfoQos*> (rue.first.get ());
+
+    if (luePtr->m_dlQosMetric == ruePtr->m_dlQosMetric)
+      {
+        return NrMacSchedulerUeInfoRR::CompareUeWeightsDl (lue, rue);
+      }
+    return (luePtr->m_dlQosMetric > ruePtr->m_dlQosMetric);
+  }
+
+  /**
+   * \brief comparison function object (i.e. an object that satisfies the
+   * requirements of Compare) which returns ​true if the first argument is less
+   * than (i.e. is ordered before) the second.
+   * \param lue Left UE
+   * \param rue Right UE
+   * \return true if the QoS metric of the left UE is higher than the right UE
+   *
+   * \see CompareUeWeightsDl
+   */
+  static bool CompareUeWeightsUl (const NrMacSchedulerNs3::UePtrAndBufferReq &lue,
+                                  const NrMacSchedulerNs3::UePtrAndBufferReq &rue)
+  {
+    auto luePtr = static_cast<const NrMacSchedulerUeInfoQos*> (lue.first.get ());
+    auto ruePtr = static_cast<const NrMacSchedulerUeInfoQos*> (rue.first.get ());
+
+    if (luePtr->m_ulQosMetric == ruePtr->m_ulQosMetric)
+      {
+        return NrMacSchedulerUeInfoRR::CompareUeWeightsUl (lue, rue);
+      }
+    return (luePtr->m_ulQosMetric > ruePtr->m_ulQosMetric);
+  }
+
+  Time m_dlDeadline {Time::Max ()}; //!< Earliest DL deadline, calculated by CalculateDlQosMetric
+  double m_dlQosMetric {0.0};       //!< DL QoS metric
+  Time m_ulDeadline {Time::Max ()}; //!< Earliest UL deadline, calculated by CalculateUlQosMetric
+  double m_ulQosMetric {0.0};       //!< UL QoS metric
+};
+
+} // namespace ns3
@@ -99,13 +99,13 @@ NrMacSchedulerUeInfo::GetUlTBS (const UePtr &ue)
   return ue->m_ulTbSize;
 }
 
-std::unordered_map<uint8_t, LCGPtr> &
+NrMacSchedulerLCGMap &
 NrMacSchedulerUeInfo::GetDlLCG (const UePtr &ue)
 {
   return ue->m_dlLCG;
 }
 
-std::unordered_map<uint8_t, LCGPtr> &
+NrMacSchedulerLCGMap &
 NrMacSchedulerUeInfo::GetUlLCG (const UePtr &ue)
 {
   return ue->m_ulLCG;
@@ -129,12 +129,46 @@ NrMacSchedulerUeInfo::ResetDlSchedInfo ()
   m_dlMRBRetx = 0;
   m_dlRBG = 0;
   m_dlSym = 0;
+  m_dlRbgMask = NrRbMask ();
   for (auto &it:m_dlTbSize)
     {
       it = 0;
     }
 }
 
+int8_t
+NrMacSchedulerUeInfo::GetDlSubbandOffset (uint32_t rbg) const
+{
+  if (m_dlCqi.m_cqiType != DlCqiInfo::SB || m_dlCqi.m_sbCqi.empty ())
+    {
+      return 0;
+    }
+  uint32_t rbPerRbg = GetNumRbPerRbg ();
+  return m_dlCqi.m_sbCqi.at (0).GetMinOffset (rbg * rbPerRbg, rbPerRbg);
+}
+
+uint8_t
+NrMacSchedulerUeInfo::GetDlMcsOnRbg (uint8_t stream, const NrRbMask &rbgMask) const
+{
+  if (m_dlCqi.m_cqiType != DlCqiInfo::SB || stream >= m_dlCqi.m_sbCqi.size ())
+    {
+      return m_dlMcs.at (stream);
+    }
+
+  const NrSubbandCqi &sbCqi = m_dlCqi.m_sbCqi.at (stream);
+  uint32_t rbPerRbg = GetNumRbPerRbg ();
+  int8_t minOffset = NrSubbandCqi::MAX_OFFSET;
+  for (uint32_t rbg : rbgMask)
+    {
+      minOffset = std::min (minOffset, sbCqi.GetMinOffset (rbg * rbPerRbg, rbPerRbg));
+      if (minOffset == NrSubbandCqi::MIN_OFFSET)
+        {
+          break;
+        }
+    }
+  return m_dlCqi.m_sbMcs.at (stream).at (NrSubbandCqi::EncodeOffset (minOffset));
+}
+
 void
 NrMacSchedulerUeInfo::ResetUlSchedInfo ()
 {
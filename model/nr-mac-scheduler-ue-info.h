@@ -141,13 +141,13 @@ public:
    * \param ue UE pointer from which obtain the value
    * \return
    */
-  static std::unordered_map<uint8_t, LCGPtr> & GetDlLCG (const UePtr &ue);
+  static NrMacSchedulerLCGMap & GetDlLCG (const UePtr &ue);
   /**
    * \brief GetUlLCG
    * \param ue UE pointer from which obtain the value
    * \return
    */
-  static std::unordered_map<uint8_t, LCGPtr> & GetUlLCG (const UePtr &ue);
+  static NrMacSchedulerLCGMap & GetUlLCG (const UePtr &ue);
   /**
    * \brief GetDlHarqVector
    * \param ue UE pointer from which obtain the value
@@ -161,7 +161,7 @@ public:
    */
   static NrMacHarqVector & GetUlHarqVector (const UePtr &ue);
 
-  typedef std::function<std::unordered_map<uint8_t, LCGPtr> &(const UePtr &ue)> GetLCGFn;
+  typedef std::function<NrMacSchedulerLCGMap &(const UePtr &ue)> GetLCGFn;
   typedef std::function<NrMacHarqVector& (const UePtr &ue)> GetHarqVectorFn;
 
   /**
@@ -212,6 +212,23 @@ public:
    */
   virtual void ResetUlMetric ();
 
+  /**
+   * \brief Get the DL subband CQI offset of a RBG
+   * \param rbg the RBG index
+   * \return the worst offset (first stream) of the subbands that contain
+   * the RBG, or 0 if the UE did not report subband CQI
+   */
+  int8_t GetDlSubbandOffset (uint32_t rbg) const;
+
+  /**
+   * \brief Get the DL MCS of a stream for a set of RBG
+   * \param stream the stream
+   * \param rbgMask the RBG
+   * \return the MCS of the worst subband that contains the RBG, or the
+   * wideband MCS if the UE did not report subband CQI
+   */
+  uint8_t GetDlMcsOnRbg (uint8_t stream, const NrRbMask &rbgMask) const;
+
   /**
    * \brief Received CQI information
    */
@@ -249,14 +266,16 @@ public:
     uint8_t m_ri    {0}; //!< The rank indicator, by default UE would have only one stream
     std::vector<double> m_sinr;   //!< Vector of SINR for the entire band
     std::vector<uint8_t> m_wbCqi; //!< CQI for each stream
+    std::vector<NrSubbandCqi> m_sbCqi; //!< Subband CQI for each stream (only for SB)
+    std::vector<std::array<uint8_t, NrSubbandCqi::NUM_CODES> > m_sbMcs; //!< MCS of each subband code, for each stream (only for SB)
     uint32_t m_timer {0};  //!< Timer (in slot number). When the timer is 0, the value is discarded
   };
 
   uint16_t m_rnti {0};          //!< RNTI of the UE
   BeamConfId   m_beamConfId;    //!< Beam ID of the UE (kept updated as much as possible by MAC)
 
-  std::unordered_map<uint8_t, LCGPtr> m_dlLCG;//!< DL LCG
-  std::unordered_map<uint8_t, LCGPtr> m_ulLCG;//!< UL LCG
+  NrMacSchedulerLCGMap m_dlLCG; //!< DL LCG
+  NrMacSchedulerLCGMap m_ulLCG; //!< UL LCG
 
   uint32_t        m_dlMRBRetx {0};  //!< MRB assigned for retx. To update the name, what is MRB is not defined
   uint32_t        m_ulMRBRetx {0};  //!< MRB assigned for retx. To update the name, what is MRB is not defined
@@ -264,6 +283,7 @@ public:
   uint32_t        m_ulRBG     {0};  //!< UL Resource Block Group assigned in this slot
   uint8_t         m_dlSym     {0};  //!< Number of (new data) symbols assigned in this slot.
   uint8_t         m_ulSym     {0};  //!< Number of (new data) symbols assigned in this slot.
+  NrRbMask        m_dlRbgMask;      //!< DL RBG chosen on the subband CQI in this slot (empty if not chosen)
 
   std::vector<uint8_t> m_dlMcs;  //!< DL MCS per stream, it is initialized with a starting MCS upon UE addition to gNB and the scheduler
   uint8_t m_ulMcs     {0};  //!< UL MCS
@@ -255,39 +255,19 @@ std::ostream &operator<< (std::ostream &os, const DciInfoElementTdma &item)
      << "|BWP=" << +item.m_bwpIndex << "|HARQP=" << +item.m_harqProcess
      << "|RBG=";
 
-  uint16_t start = 65000, end = 0;
-  bool canPrint = false;
-  for (uint32_t i = 0; i < item.m_rbgBitmask.size(); ++i)
+  // print the ranges of consecutive RBG in use
+  const NrRbMask &mask = item.m_rbgBitmask;
+  for (uint32_t start = mask.FindNextSet (0); start < mask.GetSize (); )
     {
-      if (item.m_rbgBitmask[i] == 1)
+      uint32_t end = start;
+      while (end + 1 < mask.GetSize () && mask.IsSet (end + 1))
         {
-          canPrint = true;
+          ++end;
         }
-
-      if (item.m_rbgBitmask[i] == 1 && end < i)
-        {
-          end = i;
-        }
-      if (item.m_rbgBitmask[i] == 1 && start > i)
-        {
-          start = i;
-        }
-
-      if (item.m_rbgBitmask[i] == 0 && canPrint)
-        {
-          os << "[" << +start << ";" << +end << "]";
-          start = 65000;
-          end = 0;
-          canPrint = false;
-        }
-    }
-
-  if (canPrint)
-    {
-      os << "[" << +start << ";" << +end << "]";
+      os << "[" << start << ";" << end << "]";
+      start = mask.FindNextSet (end + 1);
     }
 
-
   return os;
 }
 
@@ -35,9 +35,13 @@
 #include <ns3/component-carrier.h>
 #include <ns3/enum.h>
 #include <memory>
+#include <type_traits>
 #include <ns3/string.h>
 
 #include "sfnsf.h"
+#include "nr-rb-mask.h"
+#include "nr-stream-array.h"
+#include "nr-subband-cqi.h"
 
 namespace ns3 {
 
@@ -168,7 +172,7 @@ struct DciInfoElementTdma
    * \param rbgBitmask Bitmask of RBG
    */
   DciInfoElementTdma (uint8_t symStart, uint8_t numSym, DciFormat format, VarTtiType type,
-                      const std::vector<uint8_t> &rbgBitmask)
+                      const NrRbMask &rbgBitmask)
     : m_format (format),
     m_symStart (symStart),
     m_numSym (numSym),
@@ -191,9 +195,9 @@ struct DciInfoElementTdma
    * \param rv Redundancy Version per stream
    */
   DciInfoElementTdma (uint16_t rnti, DciFormat format, uint8_t symStart,
-                      uint8_t numSym, std::vector<uint8_t> mcs,
-                      std::vector<uint32_t> tbs, std::vector<uint8_t> ndi,
-                      std::vector<uint8_t> rv, VarTtiType type,
+                      uint8_t numSym, const NrStreamArray<uint8_t> &mcs,
+                      const NrStreamArray<uint32_t> &tbs, const NrStreamArray<uint8_t> &ndi,
+                      const NrStreamArray<uint8_t> &rv, VarTtiType type,
                       uint8_t bwpIndex, uint8_t tpc)
     : m_rnti (rnti), m_format (format), m_symStart (symStart),
     m_numSym (numSym), m_mcs (mcs), m_tbSize (tbs), m_ndi (ndi), m_rv (rv),
@@ -210,8 +214,8 @@ struct DciInfoElementTdma
    * \param rv Retransmission value
    * \param o Other object from which copy all that is not specified as parameter
    */
-  DciInfoElementTdma (uint8_t symStart, uint8_t numSym, std::vector<uint8_t> ndi,
-                      std::vector<uint8_t> rv, const DciInfoElementTdma &o)
+  DciInfoElementTdma (uint8_t symStart, uint8_t numSym, const NrStreamArray<uint8_t> &ndi,
+                      const NrStreamArray<uint8_t> &rv, const DciInfoElementTdma &o)
     : m_rnti (o.m_rnti),
       m_format (o.m_format),
       m_symStart (symStart),
@@ -232,17 +236,21 @@ struct DciInfoElementTdma
   const DciFormat m_format    {DL}; //!< DCI format
   const uint8_t m_symStart    {0}; //!< starting symbol index for flexible TTI scheme
   const uint8_t m_numSym      {0}; //!< number of symbols for flexible TTI scheme
-  const std::vector<uint8_t> m_mcs; //!< MCS per stream
-  const std::vector<uint32_t> m_tbSize; //!< TB size per stream
-  const std::vector<uint8_t> m_ndi; //!< New Data Indicator per stream (Old comment: By default is retransmission. Zoraze to check if it has any effect)
-  const std::vector<uint8_t> m_rv; //!< Redundancy Version per stream (Old comment: // not used for UL DCI. Zoraze to check why?)
+  const NrStreamArray<uint8_t> m_mcs; //!< MCS per stream
+  const NrStreamArray<uint32_t> m_tbSize; //!< TB size per stream
+  const NrStreamArray<uint8_t> m_ndi; //!< New Data Indicator per stream (Old comment: By default is retransmission. Zoraze to check if it has any effect)
+  const NrStreamArray<uint8_t> m_rv; //!< Redundancy Version per stream (Old comment: // not used for UL DCI. Zoraze to check why?)
   const VarTtiType m_type     {SRS}; //!< Var TTI type
   const uint8_t m_bwpIndex    {0}; //!< BWP Index to identify to which BWP this DCI applies to.
   uint8_t m_harqProcess       {0}; //!< HARQ process id
-  std::vector<uint8_t> m_rbgBitmask  {};   //!< RBG mask: 0 if the RBG is not used, 1 otherwise
+  NrRbMask m_rbgBitmask       {};   //!< RBG mask: 0 if the RBG is not used, 1 otherwise
   const uint8_t m_tpc         {0}; //!< Tx power control command
+  uint16_t m_cgPeriodicity    {0}; //!< Periodicity (in slots) of the configured grant of which the DCI is an occasion, 0 for a dynamic grant
 };
 
+static_assert (std::is_trivially_copyable<DciInfoElementTdma>::value,
+               "The DCI must be copied without allocations");
+
 /**
  * \ingroup utils
  * \brief The TbAllocInfo struct
@@ -305,6 +313,12 @@ struct VarTtiAllocInfo
  */
 struct SlotAllocInfo
 {
+  /**
+   * \brief Create an empty allocation for the slot 0 (used by the
+   * containers that reuse the allocations, see NrSlotRing)
+   */
+  SlotAllocInfo () = default;
+
   SlotAllocInfo (SfnSf sfn)
     : m_sfnSf (sfn)
   {
@@ -373,6 +387,7 @@ struct DlCqiInfo
     WB, SB
   } m_cqiType {WB}; //!< The type of the CQI
   std::vector<uint8_t> m_wbCqi;   //!< WB CQI for each MIMO stream
+  std::vector<NrSubbandCqi> m_sbCqi; //!< SB CQI for each MIMO stream (only for SB reports)
   uint8_t m_wbPmi {0}; //!< The reported wideband pre-coding matrix index
 };
 
@@ -96,6 +96,15 @@ public:
    */
   virtual void NotifyConnectionSuccessful () = 0;
 
+  /**
+   * \brief Notify PHY that the MAC has UL data to send
+   *
+   * A UE PHY that suspended its slot loop (see the NrUePhy attribute
+   * IdleSlotSkipping) resumes it, so that the MAC receives the slot
+   * indications needed to request the resources.
+   */
+  virtual void NotifyUlDataAvailable () = 0;
+
   /**
    * \brief Get the beam conf ID from the RNTI specified. Not in any standard.
    * \param rnti RNTI of the user
@@ -301,6 +310,17 @@ public:
    * \return the number of the configured HARQ processes.
    */
   virtual uint8_t GetNumHarqProcess () const = 0;
+
+  /**
+   * \brief Tell if the MAC has nothing to do in the next slots
+   *
+   * Used by the PHY to suspend the slot loop (see the NrUePhy attribute
+   * IdleSlotSkipping).
+   *
+   * \return true if the MAC has no data to send, no SR to send, and it
+   * is not waiting for a RA response
+   */
+  virtual bool IsIdle () const = 0;
 };
 
 }
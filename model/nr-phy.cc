@@ -35,6 +35,7 @@
 #include <ns3/boolean.h>
 
 #include <algorithm>
+#include <iterator>
 
 namespace ns3 {
 
@@ -62,6 +63,8 @@ public:
 
   virtual void NotifyConnectionSuccessful () override;
 
+  virtual void NotifyUlDataAvailable () override;
+
   virtual uint16_t GetBwpId () const override;
 
   virtual uint16_t GetCellId () const override;
@@ -124,6 +127,12 @@ NrMemberPhySapProvider::NotifyConnectionSuccessful ()
   m_phy->NotifyConnectionSuccessful ();
 }
 
+void
+NrMemberPhySapProvider::NotifyUlDataAvailable ()
+{
+  m_phy->WakeUp ();
+}
+
 uint16_t
 NrMemberPhySapProvider::GetBwpId () const
 {
@@ -168,25 +177,10 @@ NrPhy::GetTypeId ()
   return tid;
 }
 
-std::vector<int>
-NrPhy::FromRBGBitmaskToRBAssignment (const std::vector<uint8_t> rbgBitmask) const
+NrRbMask
+NrPhy::FromRBGBitmaskToRBAssignment (const NrRbMask &rbgBitmask) const
 {
-  std::vector<int> ret;
-
-  for (uint32_t i = 0; i < rbgBitmask.size (); ++i)
-    {
-      if (rbgBitmask.at (i) == 1)
-        {
-          for (uint32_t k = 0; k < GetNumRbPerRbg (); ++k)
-            {
-              ret.push_back ((i * GetNumRbPerRbg ()) + k);
-            }
-        }
-    }
-
-  NS_ASSERT (static_cast<uint32_t> (std::count (rbgBitmask.begin (), rbgBitmask.end (), 1) * GetNumRbPerRbg ())
-             == ret.size ());
-  return ret;
+  return rbgBitmask.ExpandRbgToRb (GetNumRbPerRbg ());
 }
 
 NrPhy::NrPhy ()
@@ -206,12 +200,14 @@ void
 NrPhy::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
-  m_slotAllocInfo.clear ();
+  m_slotAllocInfo.Clear ();
   m_controlMessageQueue.clear ();
-  m_packetBurstMap.clear();
+  m_controlMessageHead = 0;
+  m_packetBursts.Clear ();
   m_ctrlMsgs.clear ();
   m_tddPattern.clear ();
   m_netDevice = nullptr;
+  m_slotClock = nullptr;
 
   for (uint8_t streamIndex = 0; streamIndex < m_spectrumPhys.size(); streamIndex++)
     {
@@ -343,14 +339,26 @@ NrPhy::SetMacPdu (const Ptr<Packet> &p, const SfnSf & sfn, uint8_t symStart, uin
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (sfn.GetNumerology () == GetNumerology());
-  uint64_t key = sfn.GetEncForStreamWithSymStart (streamId, symStart);
-  auto it = m_packetBurstMap.find (key);
+  uint64_t slot = sfn.Normalize ();
+  std::vector<PacketBurstInfo> *bursts = m_packetBursts.Find (slot);
+
+  if (bursts == nullptr)
+    {
+      bursts = &m_packetBursts.Insert (slot);
+      bursts->clear ();
+    }
 
-  if (it == m_packetBurstMap.end ())
+  // A slot has a burst for each stream of each DATA allocation, so a few
+  // elements at most.
+  auto it = std::find_if (bursts->begin (), bursts->end (),
+                          [symStart, streamId] (const PacketBurstInfo &b)
+                            { return b.m_symStart == symStart && b.m_streamId == streamId; });
+  if (it == bursts->end ())
     {
-      it = m_packetBurstMap.insert (std::make_pair (key, CreateObject<PacketBurst> ())).first;
+      bursts->push_back ({symStart, streamId, CreateObject<PacketBurst> ()});
+      it = std::prev (bursts->end ());
     }
-  it->second->AddPacket (p);
+  it->m_burst->AddPacket (p);
   NS_LOG_INFO ("Adding a packet for the Packet Burst of " << sfn <<
                " at sym " << +symStart << std::endl);
 }
@@ -361,15 +369,25 @@ NrPhy::NotifyConnectionSuccessful ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+NrPhy::WakeUp ()
+{
+}
+
 Ptr<PacketBurst>
 NrPhy::GetPacketBurst (SfnSf sfn, uint8_t sym, uint8_t streamId)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (sfn.GetNumerology () == GetNumerology());
   Ptr<PacketBurst> pburst;
-  auto it = m_packetBurstMap.find (sfn.GetEncForStreamWithSymStart (streamId, sym));
-
-  if (it == m_packetBurstMap.end ())
+  uint64_t slot = sfn.Normalize ();
+  std::vector<PacketBurstInfo> *bursts = m_packetBursts.Find (slot);
+  auto it = bursts == nullptr ? std::vector<PacketBurstInfo>::iterator ()
+                              : std::find_if (bursts->begin (), bursts->end (),
+                                              [sym, streamId] (const PacketBurstInfo &b)
+                                                { return b.m_symStart == sym && b.m_streamId == streamId; });
+
+  if (bursts == nullptr || it == bursts->end ())
     {
       // For instance, this can happen with low BW and low MCS: The MAC
       // ignores the txOpportunity.
@@ -378,8 +396,13 @@ NrPhy::GetPacketBurst (SfnSf sfn, uint8_t sym, uint8_t streamId)
     }
   else
     {
-      pburst = it->second;
-      m_packetBurstMap.erase (it);
+      pburst = it->m_burst;
+      *it = std::move (bursts->back ());
+      bursts->pop_back ();
+      if (bursts->empty ())
+        {
+          m_packetBursts.Erase (slot);
+        }
     }
   return pburst;
 }
@@ -391,7 +414,7 @@ NrPhy::GetNoisePowerSpectralDensity ()
 }
 
 Ptr<SpectrumValue>
-NrPhy::GetTxPowerSpectralDensity (const std::vector<int> &rbIndexVector, uint8_t activeStreams)
+NrPhy::GetTxPowerSpectralDensity (const NrRbMask &rbMask, uint8_t activeStreams)
 {
   NS_LOG_FUNCTION (this);
   Ptr<const SpectrumModel> sm = GetSpectrumModel ();
@@ -401,7 +424,7 @@ NrPhy::GetTxPowerSpectralDensity (const std::vector<int> &rbIndexVector, uint8_t
   // Share the total transmission power among active streams
   double txPowerPerStreamDbm = 10 * log10 (txPowerLinear/activeStreams);
   // Pass the TX power per stream, each stream will have the same TX PSD
-  return NrSpectrumValueHelper::CreateTxPowerSpectralDensity (txPowerPerStreamDbm, rbIndexVector, sm, m_powerAllocationType );
+  return NrSpectrumValueHelper::CreateTxPowerSpectralDensity (txPowerPerStreamDbm, rbMask, sm, m_powerAllocationType );
 }
 
 double
@@ -446,12 +469,27 @@ NrPhy::GetPowerAllocationType () const
   return m_powerAllocationType;
 }
 
+void
+NrPhy::SetSlotClock (const Ptr<NrSlotClock> &clock)
+{
+  NS_LOG_FUNCTION (this << clock);
+  m_slotClock = clock;
+}
+
+Ptr<NrSlotClock>
+NrPhy::GetSlotClock () const
+{
+  return m_slotClock;
+}
+
 void
 NrPhy::EnqueueCtrlMessage (const Ptr<NrControlMessage> &m)
 {
   NS_LOG_FUNCTION (this);
 
-  m_controlMessageQueue.at (m_controlMessageQueue.size () - 1).push_back (m);
+  uint32_t size = static_cast<uint32_t> (m_controlMessageQueue.size ());
+  m_controlMessageQueue.at ((m_controlMessageHead + size - 1) % size).push_back (m);
+  WakeUp ();
 }
 
 void
@@ -459,7 +497,8 @@ NrPhy::EnqueueCtrlMsgNow (const Ptr<NrControlMessage> &msg)
 {
   NS_LOG_FUNCTION (this);
 
-  m_controlMessageQueue.at (0).push_back (msg);
+  m_controlMessageQueue.at (m_controlMessageHead).push_back (msg);
+  WakeUp ();
 }
 
 void
@@ -467,7 +506,11 @@ NrPhy::EnqueueCtrlMsgNow (const std::list<Ptr<NrControlMessage> > &listOfMsgs)
 {
   for (const auto & msg : listOfMsgs)
     {
-      m_controlMessageQueue.at (0).push_back (msg);
+      m_controlMessageQueue.at (m_controlMessageHead).push_back (msg);
+    }
+  if (! listOfMsgs.empty ())
+    {
+      WakeUp ();
     }
 }
 
@@ -607,6 +650,7 @@ NrPhy::InitializeMessageList ()
 {
   NS_LOG_FUNCTION (this);
   m_controlMessageQueue.clear ();
+  m_controlMessageHead = 0;
 
   for (unsigned i = 0; i <= GetL1L2CtrlLatency (); i++)
     {
@@ -625,22 +669,12 @@ NrPhy::PopCurrentSlotCtrlMsgs (void)
       return (emptylist);
     }
 
-  if (m_controlMessageQueue.at (0).size () > 0)
-    {
-      std::list<Ptr<NrControlMessage> > ret = m_controlMessageQueue.front ();
-      m_controlMessageQueue.erase (m_controlMessageQueue.begin ());
-      std::list<Ptr<NrControlMessage> > newlist;
-      m_controlMessageQueue.push_back (newlist);
-      return (ret);
-    }
-  else
-    {
-      m_controlMessageQueue.erase (m_controlMessageQueue.begin ());
-      std::list<Ptr<NrControlMessage> > newlist;
-      m_controlMessageQueue.push_back (newlist);
-      std::list<Ptr<NrControlMessage> > emptylist;
-      return (emptylist);
-    }
+  // The list of the current slot is moved out, and its position becomes
+  // the last one of the queue, without moving the others.
+  std::list<Ptr<NrControlMessage> > ret;
+  ret.swap (m_controlMessageQueue.at (m_controlMessageHead));
+  m_controlMessageHead = (m_controlMessageHead + 1) % m_controlMessageQueue.size ();
+  return (ret);
 }
 
 void
@@ -702,32 +736,21 @@ NrPhy::PushBackSlotAllocInfo (const SlotAllocInfo &slotAllocInfo)
 
   NS_LOG_DEBUG ("setting info for slot " << slotAllocInfo.m_sfnSf);
 
-  // That's not so complex, as the list would typically be of 2 or 3 elements.
-  bool updated = false;
-  for (auto & alloc : m_slotAllocInfo)
+  uint64_t slot = slotAllocInfo.m_sfnSf.Normalize ();
+  SlotAllocInfo *alloc = m_slotAllocInfo.Find (slot);
+  if (alloc != nullptr)
     {
-      if (alloc.m_sfnSf == slotAllocInfo.m_sfnSf)
-        {
-          NS_LOG_INFO ("Merging inside existing allocation");
-          alloc.Merge (slotAllocInfo);
-          updated = true;
-          break;
-        }
+      NS_LOG_INFO ("Merging inside existing allocation");
+      alloc->Merge (slotAllocInfo);
     }
-  if (! updated)
+  else
     {
-      m_slotAllocInfo.push_back (slotAllocInfo);
-      m_slotAllocInfo.sort ();
-      NS_LOG_INFO ("Pushing allocation at the end of the list");
+      alloc = &m_slotAllocInfo.Insert (slot);
+      *alloc = slotAllocInfo;
+      NS_LOG_INFO ("Storing a new allocation");
     }
 
-  std::stringstream output;
-
-  for (const auto & alloc : m_slotAllocInfo)
-    {
-      output << alloc;
-    }
-  NS_LOG_INFO (output.str ());
+  NS_LOG_INFO (*alloc);
 }
 
 void
@@ -735,52 +758,49 @@ NrPhy::PushFrontSlotAllocInfo (const SfnSf &newSfnSf, const SlotAllocInfo &slotA
 {
   NS_LOG_FUNCTION (this);
 
-  m_slotAllocInfo.push_front (slotAllocInfo);
-  SfnSf currentSfn = newSfnSf;
-  std::unordered_map<uint64_t, Ptr<PacketBurst>> newBursts; // map between new sfn and the packet burst
-  std::unordered_map<uint64_t, uint64_t> sfnMap; // map between new and old sfn, for debugging
+  // All the slot allocations (and their packet bursts) have to be "adjusted":
+  // take them out in order, with the new allocation as the first one, and
+  // store them again from newSfnSf onwards.
+  std::vector<std::pair<SlotAllocInfo, std::vector<PacketBurstInfo>>> slots;
+  slots.reserve (m_slotAllocInfo.Size () + 1);
+  slots.emplace_back (slotAllocInfo, std::vector<PacketBurstInfo> ());
 
-  // all the slot allocations  (and their packet burst) have to be "adjusted":
-  // directly modify the sfn for the allocation, and temporarly store the
-  // burst (along with the new sfn) into newBursts.
-  for (auto it = m_slotAllocInfo.begin (); it != m_slotAllocInfo.end (); ++it)
+  for (uint64_t slot : m_slotAllocInfo.GetSlots ())
     {
-      auto slotSfn = it->m_sfnSf;
-      for (const auto &alloc : it->m_varTtiAllocInfo)
+      slots.emplace_back (std::move (*m_slotAllocInfo.Find (slot)), std::vector<PacketBurstInfo> ());
+      m_slotAllocInfo.Erase (slot);
+
+      std::vector<PacketBurstInfo> *bursts = m_packetBursts.Find (slot);
+      if (bursts != nullptr)
         {
-          if (alloc.m_dci->m_type == DciInfoElementTdma::DATA)
-            {
-              //move the pkt burst of all the streams correctly.
-              for (uint8_t stream = 0; stream < alloc.m_dci->m_tbSize.size (); stream++)
-                {
-                  Ptr<PacketBurst> pburst = GetPacketBurst (slotSfn, alloc.m_dci->m_symStart, stream);
-                  if (pburst && pburst->GetNPackets() > 0)
-                    {
-                      newBursts.insert (std::make_pair (currentSfn.GetEncodingWithSymStart (alloc.m_dci->m_symStart), pburst));
-                      sfnMap.insert (std::make_pair (currentSfn.GetEncodingWithSymStart (alloc.m_dci->m_symStart),
-                                                     it->m_sfnSf.GetEncodingWithSymStart (alloc.m_dci->m_symStart)));
-                    }
-                  else
-                    {
-                      NS_LOG_INFO ("No packet burst found for " << slotSfn);
-                    }
-                }
-            }
+          slots.back ().second.swap (*bursts);
+          m_packetBursts.Erase (slot);
         }
-
-      NS_LOG_INFO ("Set slot allocation for " << it->m_sfnSf << " to " << currentSfn);
-      it->m_sfnSf = currentSfn;
-      currentSfn.Add (1);
     }
 
-  for (const auto & burstPair : newBursts)
+  SfnSf currentSfn = newSfnSf;
+  for (auto & slot : slots)
     {
-      SfnSf old, latest;
-      old.Decode (sfnMap.at (burstPair.first));
-      latest.Decode (burstPair.first);
-      m_packetBurstMap.insert (std::make_pair (burstPair.first, burstPair.second));
-      NS_LOG_INFO ("PacketBurst with " << burstPair.second->GetNPackets() <<
-                   "packets for SFN " << old << " now moved to SFN " << latest);
+      NS_LOG_INFO ("Set slot allocation for " << slot.first.m_sfnSf << " to " << currentSfn);
+      uint64_t newSlot = currentSfn.Normalize ();
+      slot.first.m_sfnSf = currentSfn;
+      m_slotAllocInfo.Insert (newSlot) = std::move (slot.first);
+
+      if (! slot.second.empty ())
+        {
+          NS_LOG_INFO ("PacketBursts of " << slot.second.size () <<
+                       " transmissions now moved to SFN " << currentSfn);
+          std::vector<PacketBurstInfo> *bursts = m_packetBursts.Find (newSlot);
+          if (bursts == nullptr)
+            {
+              m_packetBursts.Insert (newSlot) = std::move (slot.second);
+            }
+          else
+            {
+              bursts->insert (bursts->end (), slot.second.begin (), slot.second.end ());
+            }
+        }
+      currentSfn.Add (1);
     }
 }
 
@@ -790,22 +810,17 @@ NrPhy::SlotAllocInfoExists (const SfnSf &retVal) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (retVal.GetNumerology () == GetNumerology ());
-  for (const auto & alloc : m_slotAllocInfo)
-    {
-      if (alloc.m_sfnSf == retVal)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_slotAllocInfo.Find (retVal.Normalize ()) != nullptr;
 }
 
 SlotAllocInfo
 NrPhy::RetrieveSlotAllocInfo ()
 {
   NS_LOG_FUNCTION (this);
-  SlotAllocInfo ret = *m_slotAllocInfo.begin ();
-  m_slotAllocInfo.erase (m_slotAllocInfo.begin ());
+  uint64_t slot = m_slotAllocInfo.GetFirstSlot ();
+  NS_ASSERT (m_slotAllocInfo.Find (slot) != nullptr);
+  SlotAllocInfo ret = std::move (*m_slotAllocInfo.Find (slot));
+  m_slotAllocInfo.Erase (slot);
   return ret;
 }
 
@@ -816,14 +831,13 @@ NrPhy::RetrieveSlotAllocInfo (const SfnSf &sfnsf)
   NS_LOG_FUNCTION (" slot " << sfnsf);
   NS_ASSERT (sfnsf.GetNumerology () == GetNumerology ());
 
-  for (auto allocIt = m_slotAllocInfo.begin(); allocIt != m_slotAllocInfo.end (); ++allocIt)
+  uint64_t slot = sfnsf.Normalize ();
+  SlotAllocInfo *alloc = m_slotAllocInfo.Find (slot);
+  if (alloc != nullptr)
     {
-      if (allocIt->m_sfnSf == sfnsf)
-        {
-          SlotAllocInfo ret = *allocIt;
-          m_slotAllocInfo.erase (allocIt);
-          return ret;
-        }
+      SlotAllocInfo ret = std::move (*alloc);
+      m_slotAllocInfo.Erase (slot);
+      return ret;
     }
 
   NS_FATAL_ERROR("Didn't found the slot");
@@ -835,12 +849,10 @@ NrPhy::PeekSlotAllocInfo (const SfnSf &sfnsf)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (sfnsf.GetNumerology () == GetNumerology ());
-  for (auto & alloc : m_slotAllocInfo)
+  SlotAllocInfo *alloc = m_slotAllocInfo.Find (sfnsf.Normalize ());
+  if (alloc != nullptr)
     {
-      if (alloc.m_sfnSf == sfnsf)
-        {
-          return alloc;
-        }
+      return *alloc;
     }
 
   NS_FATAL_ERROR ("Didn't found the slot");
@@ -850,14 +862,22 @@ size_t
 NrPhy::SlotAllocInfoSize() const
 {
   NS_LOG_FUNCTION (this);
-  return m_slotAllocInfo.size ();
+  return m_slotAllocInfo.Size ();
 }
 
 bool
 NrPhy::IsCtrlMsgListEmpty() const
 {
   NS_LOG_FUNCTION (this);
-  return m_controlMessageQueue.empty () || m_controlMessageQueue.at (0).empty();
+  return m_controlMessageQueue.empty () || m_controlMessageQueue.at (m_controlMessageHead).empty ();
+}
+
+bool
+NrPhy::IsCtrlMsgQueueEmpty () const
+{
+  NS_LOG_FUNCTION (this);
+  return std::all_of (m_controlMessageQueue.begin (), m_controlMessageQueue.end (),
+                      [] (const std::list<Ptr<NrControlMessage>> &l) { return l.empty (); });
 }
 
 Ptr<const SpectrumModel>
@@ -22,6 +22,8 @@
 
 #include "nr-phy-sap.h"
 #include "nr-phy-mac-common.h"
+#include "nr-slot-ring.h"
+#include "nr-slot-clock.h"
 #include <ns3/nr-spectrum-value-helper.h>
 
 namespace ns3 {
@@ -44,7 +46,7 @@ class BeamConfId;
  *
  * \section phy_management_ctrl Management of the control message list
  *
- * The control message list is maintained as a list that has, always, a number
+ * The control message list is maintained as a ring of lists that has, always, a number
  * of element equals to the latency between PHY and MAC, plus one. The list
  * is initialized by a call to InitializeMessageList(). The messages
  * are enqueued by MAC at the end of the list through the method EnqueueCtrlMessage().
@@ -60,13 +62,15 @@ class BeamConfId;
  * At the gNb, After the MAC does the slot allocation, it is saved in the PHY with the method
  * PushBackSlotAllocInfo(), and if an allocation for the same slot is already
  * present, the two will be merged together. The slot allocation is stored
- * inside the variable m_slotAllocInfo.
+ * inside the variable m_slotAllocInfo, a ring indexed by the slot number
+ * (see NrSlotRing).
  *
  * \section phy_mac_pdu Management of the MAC PDU that waits to be transmitted
  *
  * With each allocation, will come also one (or more) MAC PDU, that are stored
  * within the method SetMacPdu(). The storage is based on the SfnSf inside the
- * variable m_packetBurstMap.
+ * variable m_packetBursts, a ring indexed by the slot number that keeps, for
+ * each slot, the bursts of each symbol and stream.
  *
  * \section phy_numerology Configuration of the numerology and the related settings
  *
@@ -140,6 +144,15 @@ public:
    */
   void NotifyConnectionSuccessful ();
 
+  /**
+   * \brief Notify the PHY that there is something to transmit
+   *
+   * Called when a CTRL message is enqueued, or by the MAC when it has UL
+   * data. The default implementation does nothing; the UE PHY uses it to
+   * resume its slot loop, if suspended.
+   */
+  virtual void WakeUp ();
+
   /**
    * \brief Configures TB decode latency
    * \param us decode latency
@@ -413,6 +426,20 @@ public:
    */
   enum NrSpectrumValueHelper::PowerAllocationType GetPowerAllocationType () const;
 
+  /**
+   * \brief Set the slot clock that runs the slot boundaries of this PHY
+   * \param clock the slot clock, or nullptr to use an event per slot boundary
+   *
+   * Set by the helper (see NrHelper attribute UseSlotClock), before the start
+   * of the event loop.
+   */
+  void SetSlotClock (const Ptr<NrSlotClock> &clock);
+
+  /**
+   * \return the slot clock of this PHY (can be nullptr)
+   */
+  Ptr<NrSlotClock> GetSlotClock () const;
+
 protected:
   /**
    * \brief DoDispose method inherited from Object
@@ -442,20 +469,19 @@ protected:
   static bool IsTdd (const std::vector<LteNrTddSlotType> &pattern);
 
   /**
-   * \brief Transform a MAC-made vector of RBG to a PHY-ready vector of SINR indices
+   * \brief Transform a MAC-made mask of RBG to a PHY-ready mask of RB
    * \param rbgBitmask Bitmask which indicates with 1 the RBG in which there is a transmission,
    * with 0 a RBG in which there is not a transmission
-   * \return a vector of indices.
+   * \return the mask of the RB (i.e., of the SINR indices)
    *
    * Example (4 RB per RBG, 4 total RBG assignable):
    * rbgBitmask = <0,1,1,0>
-   * output = <4,5,6,7,8,9,10,11>
+   * output = <0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0>
    *
-   * (the rbgBitmask expressed as rbBitmask would be:
-   * <0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0> , and therefore the places in which there
-   * is a 1 are from the 4th to the 11th, and that is reflected in the output)
+   * (the places in which there is a 1 are from the 4th to the 11th, and
+   * these are the indices visited when iterating over the output)
    */
-  std::vector<int> FromRBGBitmaskToRBAssignment (const std::vector<uint8_t> rbgBitmask) const;
+  NrRbMask FromRBGBitmaskToRBAssignment (const NrRbMask &rbgBitmask) const;
 
   /**
    * \brief Protected function that is used to get the number of resource
@@ -481,15 +507,15 @@ protected:
 
   /**
    * Create Tx Power Spectral Density
-   * \param rbIndexVector vector of the index of the RB (in SpectrumValue array)
+   * \param rbMask mask of the RB (in SpectrumValue array)
    * in which there is a transmission
    * \param activeStreams the number of active streams
    * \return A SpectrumValue array with fixed size, in which each value
-   * is updated to a particular value if the correspond RB index was inside the rbIndexVector,
+   * is updated to a particular value if the correspond RB is set in the rbMask,
    * or is left untouched otherwise.
    * \see NrSpectrumValueHelper::CreateTxPowerSpectralDensity
    */
-  Ptr<SpectrumValue> GetTxPowerSpectralDensity (const std::vector<int> &rbIndexVector, uint8_t activeStreams);
+  Ptr<SpectrumValue> GetTxPowerSpectralDensity (const NrRbMask &rbMask, uint8_t activeStreams);
 
   /**
    * \brief Store the slot allocation info at the front
@@ -543,6 +569,12 @@ protected:
    */
   bool IsCtrlMsgListEmpty () const;
 
+  /**
+   * \brief Check if there are no control messages queued for any slot
+   * \return true if all the lists of the control message queue are empty
+   */
+  bool IsCtrlMsgQueueEmpty () const;
+
   /**
    * \brief Enqueue a CTRL message without considering L1L2CtrlLatency
    * \param msg The message to enqueue
@@ -572,12 +604,24 @@ protected:
   double m_txPower {0.0};                //!< Transmission power (attribute)
   double m_noiseFigure {0.0};            //!< Noise figure (attribute)
 
-  std::unordered_map<uint64_t, Ptr<PacketBurst> > m_packetBurstMap; //!< Map between SfnSf and PacketBurst
+  /**
+   * \brief The MAC PDUs of a slot to be transmitted from a symbol, in a stream
+   */
+  struct PacketBurstInfo
+  {
+    uint8_t m_symStart {0};   //!< Symbol at which the transmission starts
+    uint8_t m_streamId {0};   //!< Stream of the transmission
+    Ptr<PacketBurst> m_burst; //!< The MAC PDUs
+  };
+
+  NrSlotRing<std::vector<PacketBurstInfo>> m_packetBursts; //!< Packet bursts of each slot
 
   SlotAllocInfo m_currSlotAllocInfo;  //!< Current slot allocation
 
   NrPhySapProvider* m_phySapProvider; //!< Pointer to the MAC
 
+  Ptr<NrSlotClock> m_slotClock; //!< Slot clock, if the slot boundaries are batched
+
   uint32_t m_raPreambleId {0}; //!< Preamble ID
 
   std::list <Ptr<NrControlMessage>> m_ctrlMsgs; //!< CTRL messages to be sent
@@ -585,8 +629,9 @@ protected:
   std::vector<LteNrTddSlotType> m_tddPattern = { F, F, F, F, F, F, F, F, F, F}; //!< Pattern
 
 private:
-  std::list<SlotAllocInfo> m_slotAllocInfo; //!< slot allocation info list
-  std::vector<std::list<Ptr<NrControlMessage>>> m_controlMessageQueue; //!< CTRL message queue
+  NrSlotRing<SlotAllocInfo> m_slotAllocInfo; //!< slot allocation info of the next slots
+  std::vector<std::list<Ptr<NrControlMessage>>> m_controlMessageQueue; //!< CTRL message queue (ring)
+  uint32_t m_controlMessageHead {0}; //!< Position of the list of the current slot in m_controlMessageQueue
 
   Time m_tbDecodeLatencyUs {MicroSeconds(100)}; //!< transport block decode latency
   double m_centralFrequency {-1.0};             //!< Channel central frequency -- set by the helper
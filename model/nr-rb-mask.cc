@@ -0,0 +1,230 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-rb-mask.h"
+
+#include <ns3/abort.h>
+
+#include <algorithm>
+
+namespace ns3 {
+
+NrRbMask::NrRbMask (uint32_t size, bool value)
+  : m_size (size)
+{
+  NS_ABORT_MSG_IF (size > MAX_SIZE, "A mask of " << size << " RB is not supported, the maximum is "
+                   << MAX_SIZE << ". Increase NrRbMask::MAX_SIZE");
+  if (value)
+    {
+      SetAll (true);
+    }
+}
+
+NrRbMask
+NrRbMask::FromVector (const std::vector<uint8_t> &mask)
+{
+  NrRbMask ret (static_cast<uint32_t> (mask.size ()));
+  for (uint32_t i = 0; i < mask.size (); ++i)
+    {
+      if (mask[i] != 0)
+        {
+          ret.Set (i);
+        }
+    }
+  return ret;
+}
+
+std::vector<uint8_t>
+NrRbMask::ToVector () const
+{
+  std::vector<uint8_t> ret (m_size, 0);
+  for (uint32_t i : *this)
+    {
+      ret[i] = 1;
+    }
+  return ret;
+}
+
+std::vector<int>
+NrRbMask::ToIndexVector () const
+{
+  std::vector<int> ret;
+  ret.reserve (Count ());
+  for (uint32_t i : *this)
+    {
+      ret.push_back (static_cast<int> (i));
+    }
+  return ret;
+}
+
+void
+NrRbMask::SetRange (uint32_t start, uint32_t num)
+{
+  NS_ASSERT (start + num <= m_size);
+
+  while (num > 0)
+    {
+      uint32_t offset = start % WORD_BITS;
+      uint32_t bits = std::min (num, WORD_BITS - offset);
+      uint64_t mask = bits == WORD_BITS ? ~uint64_t {0} : ((uint64_t {1} << bits) - 1) << offset;
+      m_words[start / WORD_BITS] |= mask;
+      start += bits;
+      num -= bits;
+    }
+}
+
+void
+NrRbMask::SetAll (bool value)
+{
+  uint32_t words = UsedWords ();
+  for (uint32_t w = 0; w < words; ++w)
+    {
+      m_words[w] = value ? ~uint64_t {0} : 0;
+    }
+
+  // keep the bits above the size to 0
+  if (value && m_size % WORD_BITS != 0)
+    {
+      m_words[words - 1] &= (uint64_t {1} << (m_size % WORD_BITS)) - 1;
+    }
+}
+
+uint32_t
+NrRbMask::Count () const
+{
+  uint32_t ret = 0;
+  uint32_t words = UsedWords ();
+  for (uint32_t w = 0; w < words; ++w)
+    {
+      ret += static_cast<uint32_t> (__builtin_popcountll (m_words[w]));
+    }
+  return ret;
+}
+
+bool
+NrRbMask::Any () const
+{
+  uint32_t words = UsedWords ();
+  for (uint32_t w = 0; w < words; ++w)
+    {
+      if (m_words[w] != 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+uint32_t
+NrRbMask::FindNextSet (uint32_t from) const
+{
+  if (from >= m_size)
+    {
+      return m_size;
+    }
+
+  uint32_t w = from / WORD_BITS;
+  // discard the bits before "from"
+  uint64_t word = m_words[w] & (~uint64_t {0} << (from % WORD_BITS));
+  uint32_t words = UsedWords ();
+
+  while (true)
+    {
+      if (word != 0)
+        {
+          return w * WORD_BITS + static_cast<uint32_t> (__builtin_ctzll (word));
+        }
+      if (++w == words)
+        {
+          return m_size;
+        }
+      word = m_words[w];
+    }
+}
+
+NrRbMask
+NrRbMask::ExpandRbgToRb (uint32_t numRbPerRbg) const
+{
+  NrRbMask ret (m_size * numRbPerRbg);
+
+  if (numRbPerRbg == 1)
+    {
+      ret.m_words = m_words;
+      return ret;
+    }
+
+  for (uint32_t rbg : *this)
+    {
+      ret.SetRange (rbg * numRbPerRbg, numRbPerRbg);
+    }
+  return ret;
+}
+
+NrRbMask &
+NrRbMask::operator|= (const NrRbMask &o)
+{
+  NS_ASSERT (m_size == o.m_size);
+  uint32_t words = UsedWords ();
+  for (uint32_t w = 0; w < words; ++w)
+    {
+      m_words[w] |= o.m_words[w];
+    }
+  return *this;
+}
+
+NrRbMask &
+NrRbMask::operator&= (const NrRbMask &o)
+{
+  NS_ASSERT (m_size == o.m_size);
+  uint32_t words = UsedWords ();
+  for (uint32_t w = 0; w < words; ++w)
+    {
+      m_words[w] &= o.m_words[w];
+    }
+  return *this;
+}
+
+bool
+NrRbMask::operator== (const NrRbMask &o) const
+{
+  if (m_size != o.m_size)
+    {
+      return false;
+    }
+  uint32_t words = UsedWords ();
+  for (uint32_t w = 0; w < words; ++w)
+    {
+      if (m_words[w] != o.m_words[w])
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+std::ostream &
+operator<< (std::ostream &os, const NrRbMask &mask)
+{
+  for (uint32_t i = 0; i < mask.GetSize (); ++i)
+    {
+      os << (mask.IsSet (i) ? '1' : '0');
+    }
+  return os;
+}
+
+} // namespace ns3
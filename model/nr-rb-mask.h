@@ -0,0 +1,363 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_RB_MASK_H
+#define NR_RB_MASK_H
+
+#include <ns3/assert.h>
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief Fixed-capacity bit mask of RB or RBG
+ *
+ * The mask has a size (the number of RB, or RBG, of the bandwidth) and one
+ * bit for each of them: 1 if the RB (RBG) is used, 0 otherwise. It replaces
+ * the `std::vector<uint8_t>` RBG bitmasks and the `std::vector<int>` lists
+ * of RB indexes: the storage is inline (no allocations, and the object
+ * is trivially copyable), and counting, merging and expanding are done
+ * 64 RB at a time.
+ *
+ * Iterating over the mask visits the indexes of the bits set, in
+ * increasing order:
+ *
+ * \code{.cpp}
+ * NrRbMask rbMask = rbgMask.ExpandRbgToRb (numRbPerRbg);
+ * for (uint32_t rb : rbMask)
+ *   {
+ *     ... rb is used ...
+ *   }
+ * \endcode
+ *
+ * The capacity is fixed at compile time (MAX_SIZE): it covers 400 MHz
+ * with a subcarrier spacing of 15 kHz (2222 RB). The bits above the size
+ * are always 0.
+ */
+class NrRbMask
+{
+public:
+  static constexpr uint32_t MAX_SIZE = 2304;   //!< Maximum number of RB (or RBG) in a mask
+
+  /**
+   * \brief Iterator over the indexes of the bits set
+   */
+  class ConstIterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag; //!< Iterator category
+    using value_type = uint32_t;                          //!< Value type
+    using difference_type = std::ptrdiff_t;               //!< Difference type
+    using pointer = const uint32_t*;                      //!< Pointer type
+    using reference = uint32_t;                           //!< Reference type
+
+    /**
+     * \brief ConstIterator constructor
+     * \param mask the mask
+     * \param pos the position of a bit set, or the size of the mask for the end
+     */
+    ConstIterator (const NrRbMask *mask, uint32_t pos) : m_mask (mask), m_pos (pos)
+    {
+    }
+    /**
+     * \brief Get the index of the current bit
+     * \return the index of the current bit
+     */
+    uint32_t operator* () const
+    {
+      return m_pos;
+    }
+    /**
+     * \brief Move to the next bit set
+     * \return the iterator
+     */
+    ConstIterator & operator++ ()
+    {
+      m_pos = m_mask->FindNextSet (m_pos + 1);
+      return *this;
+    }
+    /**
+     * \brief Move to the next bit set
+     * \return the iterator before the increment
+     */
+    ConstIterator operator++ (int)
+    {
+      ConstIterator ret = *this;
+      ++(*this);
+      return ret;
+    }
+    /**
+     * \brief Compare two iterators
+     * \param o the other iterator
+     * \return true if the two iterators point to the same bit
+     */
+    bool operator== (const ConstIterator &o) const
+    {
+      return m_pos == o.m_pos;
+    }
+    /**
+     * \brief Compare two iterators
+     * \param o the other iterator
+     * \return true if the two iterators point to different bits
+     */
+    bool operator!= (const ConstIterator &o) const
+    {
+      return m_pos != o.m_pos;
+    }
+
+  private:
+    const NrRbMask *m_mask {nullptr}; //!< The mask
+    uint32_t m_pos {0};               //!< Current position
+  };
+
+  /**
+   * \brief Create an empty mask, of size 0
+   */
+  NrRbMask () = default;
+
+  /**
+   * \brief Create a mask of the specified size
+   * \param size number of RB (or RBG)
+   * \param value initial value of all the bits
+   */
+  explicit NrRbMask (uint32_t size, bool value = false);
+
+  /**
+   * \brief Create a mask from a vector of 0s and 1s
+   * \param mask the vector (any value different from 0 sets the bit)
+   * \return the mask
+   */
+  static NrRbMask FromVector (const std::vector<uint8_t> &mask);
+
+  /**
+   * \brief Convert the mask to a vector of 0s and 1s
+   * \return a vector of GetSize () elements
+   */
+  std::vector<uint8_t> ToVector () const;
+
+  /**
+   * \brief Convert the mask to the list of indexes of the bits set
+   * \return a vector of Count () elements
+   */
+  std::vector<int> ToIndexVector () const;
+
+  /**
+   * \brief Get the size of the mask
+   * \return the number of RB (or RBG) represented by the mask
+   */
+  uint32_t GetSize () const
+  {
+    return m_size;
+  }
+
+  /**
+   * \brief Check if the mask has size 0
+   * \return true if the size is 0
+   */
+  bool IsEmpty () const
+  {
+    return m_size == 0;
+  }
+
+  /**
+   * \brief Check a bit
+   * \param i index
+   * \return true if the bit is set
+   */
+  bool IsSet (uint32_t i) const
+  {
+    NS_ASSERT (i < m_size);
+    return (m_words[i / WORD_BITS] >> (i % WORD_BITS)) & 1U;
+  }
+
+  /**
+   * \brief Check a bit
+   * \param i index
+   * \return true if the bit is set
+   */
+  bool operator[] (uint32_t i) const
+  {
+    return IsSet (i);
+  }
+
+  /**
+   * \brief Set a bit
+   * \param i index
+   */
+  void Set (uint32_t i)
+  {
+    NS_ASSERT (i < m_size);
+    m_words[i / WORD_BITS] |= uint64_t {1} << (i % WORD_BITS);
+  }
+
+  /**
+   * \brief Set or reset a bit
+   * \param i index
+   * \param value the new value of the bit
+   */
+  void Set (uint32_t i, bool value)
+  {
+    value ? Set (i) : Reset (i);
+  }
+
+  /**
+   * \brief Reset a bit
+   * \param i index
+   */
+  void Reset (uint32_t i)
+  {
+    NS_ASSERT (i < m_size);
+    m_words[i / WORD_BITS] &= ~(uint64_t {1} << (i % WORD_BITS));
+  }
+
+  /**
+   * \brief Set the bits [start, start + num)
+   * \param start first bit
+   * \param num number of bits
+   */
+  void SetRange (uint32_t start, uint32_t num);
+
+  /**
+   * \brief Set (or reset) all the bits
+   * \param value the new value of the bits
+   */
+  void SetAll (bool value);
+
+  /**
+   * \brief Count the bits set
+   * \return the number of bits set
+   */
+  uint32_t Count () const;
+
+  /**
+   * \brief Check if at least one bit is set
+   * \return true if at least one bit is set
+   */
+  bool Any () const;
+
+  /**
+   * \brief Check if no bit is set
+   * \return true if no bit is set
+   */
+  bool None () const
+  {
+    return !Any ();
+  }
+
+  /**
+   * \brief Find the first bit set at or after a position
+   * \param from the starting position
+   * \return the index of the bit, or GetSize () if there is none
+   */
+  uint32_t FindNextSet (uint32_t from) const;
+
+  /**
+   * \brief Expand a RBG mask into the corresponding RB mask
+   * \param numRbPerRbg number of RB in each RBG
+   * \return a mask of GetSize () * numRbPerRbg RB
+   *
+   * For instance, with 2 RB per RBG, the RBG mask <0,1,1,0> becomes the
+   * RB mask <0,0,1,1,1,1,0,0>.
+   */
+  NrRbMask ExpandRbgToRb (uint32_t numRbPerRbg) const;
+
+  /**
+   * \brief Set the bits that are set in another mask of the same size
+   * \param o the other mask
+   * \return this mask
+   */
+  NrRbMask & operator|= (const NrRbMask &o);
+
+  /**
+   * \brief Keep only the bits that are set in another mask of the same size
+   * \param o the other mask
+   * \return this mask
+   */
+  NrRbMask & operator&= (const NrRbMask &o);
+
+  /**
+   * \brief Compare two masks
+   * \param o the other mask
+   * \return true if the masks have the same size and the same bits
+   */
+  bool operator== (const NrRbMask &o) const;
+
+  /**
+   * \brief Compare two masks
+   * \param o the other mask
+   * \return true if the masks are different
+   */
+  bool operator!= (const NrRbMask &o) const
+  {
+    return !(*this == o);
+  }
+
+  /**
+   * \brief Iterator to the first bit set
+   * \return the iterator
+   */
+  ConstIterator begin () const
+  {
+    return ConstIterator (this, FindNextSet (0));
+  }
+
+  /**
+   * \brief Iterator past the last bit set
+   * \return the iterator
+   */
+  ConstIterator end () const
+  {
+    return ConstIterator (this, m_size);
+  }
+
+private:
+  static constexpr uint32_t WORD_BITS = 64;                          //!< Bits per word
+  static constexpr uint32_t MAX_WORDS = MAX_SIZE / WORD_BITS;        //!< Words of storage
+
+  static_assert (MAX_SIZE % WORD_BITS == 0, "MAX_SIZE must be a multiple of 64");
+
+  /**
+   * \brief Number of words in use
+   * \return the number of words that contain the bits of the mask
+   */
+  uint32_t UsedWords () const
+  {
+    return (m_size + WORD_BITS - 1) / WORD_BITS;
+  }
+
+  std::array<uint64_t, MAX_WORDS> m_words {}; //!< The bits
+  uint32_t m_size {0};                        //!< Number of valid bits
+};
+
+/**
+ * \brief Print the mask as a sequence of 0 and 1
+ * \param os the output stream
+ * \param mask the mask
+ * \return the output stream
+ */
+std::ostream & operator<< (std::ostream &os, const NrRbMask &mask);
+
+} // namespace ns3
+
+#endif // NR_RB_MASK_H
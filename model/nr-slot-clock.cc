@@ -0,0 +1,108 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-slot-clock.h"
+
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrSlotClock");
+NS_OBJECT_ENSURE_REGISTERED (NrSlotClock);
+
+TypeId
+NrSlotClock::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NrSlotClock")
+    .SetParent<Object> ()
+    .AddConstructor<NrSlotClock> ()
+    ;
+  return tid;
+}
+
+NrSlotClock::NrSlotClock ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NrSlotClock::~NrSlotClock ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NrSlotClock::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_batches.clear ();
+  Object::DoDispose ();
+}
+
+void
+NrSlotClock::Schedule (const Time &delay, Phase phase, const std::function<void ()> &fn)
+{
+  NS_ASSERT (phase < NUM_PHASES);
+  NS_ASSERT (! delay.IsStrictlyNegative ());
+  const Time now = Simulator::Now ();
+  BatchKey key ((now + delay).GetTimeStep (), phase, now.GetTimeStep ());
+
+  auto it = m_batches.find (key);
+  if (it == m_batches.end ())
+    {
+      it = m_batches.emplace (key, std::vector<std::function<void ()>> ()).first;
+      Simulator::Schedule (delay, &NrSlotClock::RunBatch, this, key);
+      ++m_events;
+    }
+  it->second.push_back (fn);
+}
+
+void
+NrSlotClock::RunBatch (const BatchKey &key)
+{
+  NS_LOG_FUNCTION (this << std::get<0> (key) << std::get<1> (key) << std::get<2> (key));
+  auto it = m_batches.find (key);
+  NS_ASSERT (it != m_batches.end ());
+
+  // The batch is closed before running it: a method given to the clock by
+  // the batch itself (e.g., the end of a slot starts the next one with no
+  // delay) goes in a new batch, with its own event, as it would have with
+  // the per-PHY events.
+  std::vector<std::function<void ()>> methods = std::move (it->second);
+  m_batches.erase (it);
+
+  for (const auto & fn : methods)
+    {
+      fn ();
+      ++m_calls;
+    }
+}
+
+uint64_t
+NrSlotClock::GetEvents () const
+{
+  return m_events;
+}
+
+uint64_t
+NrSlotClock::GetCalls () const
+{
+  return m_calls;
+}
+
+} // namespace ns3
@@ -0,0 +1,130 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_SLOT_CLOCK_H
+#define NR_SLOT_CLOCK_H
+
+#include <ns3/object.h>
+#include <ns3/nstime.h>
+
+#include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief Slot-boundary batcher: runs the slot boundaries of many PHYs in one event
+ *
+ * All the NR PHYs start their slots on the same time grid, but each of them
+ * schedules its own slot boundary events, and the simulator has to order
+ * thousands of events with the same time stamp at each slot. When a PHY has
+ * a slot clock (see NrHelper attribute UseSlotClock), it gives its slot
+ * boundary methods to the clock, which runs the ones of the same time
+ * stamp and of the same phase (END_SLOT or START_SLOT), given at the same
+ * time, in a single event. Only the slot boundaries go through the clock:
+ * the variable TTIs and the receptions are still scheduled by each PHY.
+ *
+ * The event of a batch is scheduled when its first method is given to the
+ * clock, with the delay of that method, so the batch runs in the place
+ * that the event of its first method would have had with respect to the
+ * other events of the same time stamp. A method given later for the same
+ * time stamp (e.g., the end of a slot of numerology 1, given half a
+ * millisecond after the end of the slot of numerology 0 that happens at the
+ * same time, or the start of a slot given with no delay at the end of the
+ * previous one) would run after the events queued in between: it goes in
+ * a new batch, with its own event. Inside a batch, the methods are called
+ * in the order in which they were given to the clock.
+ *
+ * The event of a batch has the context (node id) of the PHY that created
+ * it, so the events scheduled by the other PHYs of the batch inherit that
+ * context. This changes only the node id printed by the logging.
+ */
+class NrSlotClock : public Object
+{
+public:
+  /**
+   * \brief Phases of a slot boundary
+   */
+  enum Phase
+  {
+    END_SLOT = 0,   //!< The end of the previous slot
+    START_SLOT = 1, //!< The start of the new slot
+    NUM_PHASES = 2  //!< Number of phases
+  };
+
+  /**
+   * \brief Get the type id
+   * \return the type id of the class
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief NrSlotClock constructor
+   */
+  NrSlotClock ();
+
+  /**
+   * \brief ~NrSlotClock
+   */
+  ~NrSlotClock () override;
+
+  /**
+   * \brief Run a slot boundary method in the batch of its time and phase
+   * \param delay delay from now (as in Simulator::Schedule)
+   * \param phase phase of the method
+   * \param fn the method
+   */
+  void Schedule (const Time &delay, Phase phase, const std::function<void ()> &fn);
+
+  /**
+   * \return the number of simulator events used so far
+   */
+  uint64_t GetEvents () const;
+
+  /**
+   * \return the number of methods run so far
+   */
+  uint64_t GetCalls () const;
+
+protected:
+  void DoDispose () override;
+
+private:
+  /**
+   * \brief Key of a batch: time stamp, phase, and time stamp at which its
+   * methods were given to the clock
+   */
+  typedef std::tuple<int64_t, Phase, int64_t> BatchKey;
+
+  /**
+   * \brief Run a batch
+   * \param key the key of the batch (its time stamp is now)
+   */
+  void RunBatch (const BatchKey &key);
+
+  std::map<BatchKey, std::vector<std::function<void ()>>> m_batches; //!< Pending batches
+  uint64_t m_events {0};              //!< Simulator events used
+  uint64_t m_calls {0};               //!< Methods run
+};
+
+} // namespace ns3
+
+#endif // NR_SLOT_CLOCK_H
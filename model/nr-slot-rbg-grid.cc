@@ -0,0 +1,81 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-slot-rbg-grid.h"
+
+#include <ns3/abort.h>
+
+namespace ns3 {
+
+void
+NrSlotRbgGrid::Clear (uint32_t numRbg)
+{
+  for (uint32_t sym = 0; sym < MAX_SYMBOLS; ++sym)
+    {
+      if (IsUsed (sym) || m_rows[sym].GetSize () != numRbg)
+        {
+          m_rows[sym] = NrRbMask (numRbg);
+        }
+    }
+  m_usedSymbols = 0;
+  m_numRbg = numRbg;
+}
+
+void
+NrSlotRbgGrid::Store (uint8_t symStart, uint8_t numSym, const NrRbMask &rbgMask)
+{
+  NS_ABORT_MSG_IF (symStart + numSym > MAX_SYMBOLS,
+                   "Allocation from symbol " << +symStart << " for " << +numSym <<
+                   " symbols does not fit in a slot");
+  NS_ASSERT (rbgMask.GetSize () == m_numRbg);
+  for (uint32_t sym = symStart; sym < static_cast<uint32_t> (symStart + numSym); ++sym)
+    {
+      m_rows[sym] |= rbgMask;
+      m_usedSymbols |= 1U << sym;
+    }
+}
+
+uint32_t
+NrSlotRbgGrid::FindNextUsedSymbol (uint32_t from) const
+{
+  if (from >= MAX_SYMBOLS)
+    {
+      return MAX_SYMBOLS;
+    }
+  uint32_t left = m_usedSymbols >> from;
+  return left == 0 ? MAX_SYMBOLS : from + static_cast<uint32_t> (__builtin_ctz (left));
+}
+
+uint32_t
+NrSlotRbgGrid::GetUsedSymbols () const
+{
+  return static_cast<uint32_t> (__builtin_popcount (m_usedSymbols));
+}
+
+uint32_t
+NrSlotRbgGrid::CountRbg () const
+{
+  uint32_t count = 0;
+  for (uint32_t sym = FindNextUsedSymbol (0); sym < MAX_SYMBOLS; sym = FindNextUsedSymbol (sym + 1))
+    {
+      count += m_rows[sym].Count ();
+    }
+  return count;
+}
+
+} // namespace ns3
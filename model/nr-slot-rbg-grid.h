@@ -0,0 +1,170 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_SLOT_RBG_GRID_H
+#define NR_SLOT_RBG_GRID_H
+
+#include "nr-rb-mask.h"
+
+#include <array>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief Symbol x RBG grid of the resources used in a slot
+ *
+ * The grid has a row for each symbol of the slot: a NrRbMask of the RBG
+ * used in that symbol, plus a bit that tells if the symbol has any
+ * allocation. The storage is inline and reused from one slot to the next:
+ * Clear() resets only the rows that were used. Checking an RBG is O(1),
+ * and counting the RBG used is done with the popcount of the rows.
+ *
+ * \code{.cpp}
+ * NrSlotRbgGrid grid;
+ * grid.Clear (numRbg);
+ * grid.Store (dci->m_symStart, dci->m_numSym, dci->m_rbgBitmask);
+ * for (uint32_t sym = grid.FindNextUsedSymbol (0); sym < NrSlotRbgGrid::MAX_SYMBOLS;
+ *      sym = grid.FindNextUsedSymbol (sym + 1))
+ *   {
+ *     ... grid.GetRow (sym) are the RBG used in sym ...
+ *   }
+ * \endcode
+ */
+class NrSlotRbgGrid
+{
+public:
+  static constexpr uint32_t MAX_SYMBOLS = 14; //!< Maximum number of symbols in a slot
+
+  /**
+   * \brief Empty the grid
+   * \param numRbg number of RBG of each row
+   */
+  void Clear (uint32_t numRbg);
+
+  /**
+   * \brief Mark the RBG of an allocation as used
+   * \param symStart first symbol of the allocation
+   * \param numSym number of symbols of the allocation
+   * \param rbgMask RBG of the allocation (with the size given to Clear())
+   */
+  void Store (uint8_t symStart, uint8_t numSym, const NrRbMask &rbgMask);
+
+  /**
+   * \brief Mark the RBG of an allocation as used, only in the first symbol
+   * \param symStart first symbol of the allocation
+   * \param rbgMask RBG of the allocation (with the size given to Clear())
+   */
+  void Store (uint8_t symStart, const NrRbMask &rbgMask)
+  {
+    Store (symStart, 1, rbgMask);
+  }
+
+  /**
+   * \param sym the symbol
+   * \return true if any allocation was stored in the symbol
+   */
+  bool IsUsed (uint32_t sym) const
+  {
+    NS_ASSERT (sym < MAX_SYMBOLS);
+    return (m_usedSymbols >> sym) & 1U;
+  }
+
+  /**
+   * \param sym the symbol
+   * \param rbg the RBG
+   * \return true if the RBG is used in the symbol
+   */
+  bool IsUsed (uint32_t sym, uint32_t rbg) const
+  {
+    return IsUsed (sym) && m_rows[sym].IsSet (rbg);
+  }
+
+  /**
+   * \param sym the symbol
+   * \return the RBG used in the symbol (an empty mask of the grid size
+   * if the symbol is not used)
+   */
+  const NrRbMask & GetRow (uint32_t sym) const
+  {
+    NS_ASSERT (sym < MAX_SYMBOLS);
+    return m_rows[sym];
+  }
+
+  /**
+   * \param from the first symbol to check
+   * \return the first used symbol from (and including) from, or MAX_SYMBOLS
+   * if there is none
+   */
+  uint32_t FindNextUsedSymbol (uint32_t from) const;
+
+  /**
+   * \return true if no allocation was stored
+   */
+  bool IsEmpty () const
+  {
+    return m_usedSymbols == 0;
+  }
+
+  /**
+   * \return the number of symbols used
+   */
+  uint32_t GetUsedSymbols () const;
+
+  /**
+   * \param sym the symbol
+   * \return the number of RBG used in the symbol
+   */
+  uint32_t CountRbg (uint32_t sym) const
+  {
+    return IsUsed (sym) ? m_rows[sym].Count () : 0;
+  }
+
+  /**
+   * \return the number of (symbol, RBG) used in the slot
+   */
+  uint32_t CountRbg () const;
+
+  /**
+   * \param sym the symbol
+   * \param numRbPerRbg number of RB per RBG
+   * \return the RB used in the symbol, to build the transmit PSD
+   */
+  NrRbMask GetRbMask (uint32_t sym, uint32_t numRbPerRbg) const
+  {
+    return GetRow (sym).ExpandRbgToRb (numRbPerRbg);
+  }
+
+  /**
+   * \return the number of RBG of each row
+   */
+  uint32_t GetNumRbg () const
+  {
+    return m_numRbg;
+  }
+
+private:
+  std::array<NrRbMask, MAX_SYMBOLS> m_rows {}; //!< RBG used in each symbol
+  uint32_t m_usedSymbols {0};                  //!< Bit i set if the symbol i is used
+  uint32_t m_numRbg {0};                       //!< Number of RBG of each row
+};
+
+} // namespace ns3
+
+#endif // NR_SLOT_RBG_GRID_H
@@ -0,0 +1,228 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_SLOT_RING_H
+#define NR_SLOT_RING_H
+
+#include <ns3/assert.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief Per-slot storage indexed by the slot number modulo a window
+ *
+ * The PHY keeps some information (allocations, packet bursts) for the few
+ * slots between the MAC processing and the air interface. The slots are
+ * stored in a vector whose size (the window) is a power of two, at the
+ * position given by the normalized slot number (see SfnSf::Normalize) modulo
+ * the window, so that the lookup is O(1) and the slots do not allocate
+ * a node each. If two slots stored at the same time fall in the same
+ * position, the window is doubled.
+ *
+ * The value of a slot is not destroyed when the slot is erased, so that
+ * its memory can be reused by the next slot in the same position: the
+ * user has to reset (or assign) the value returned by Insert().
+ */
+template <typename T>
+class NrSlotRing
+{
+public:
+  /**
+   * \brief NrSlotRing constructor
+   * \param window initial number of positions (rounded to a power of two)
+   */
+  explicit NrSlotRing (uint32_t window = 16)
+  {
+    uint32_t size = 1;
+    while (size < window)
+      {
+        size <<= 1;
+      }
+    m_entries.resize (size);
+  }
+
+  /**
+   * \brief Get the value of a slot
+   * \param slot normalized slot number
+   * \return a pointer to the value, or nullptr if the slot is not stored
+   */
+  T * Find (uint64_t slot)
+  {
+    Entry &e = m_entries[slot & (m_entries.size () - 1)];
+    return e.m_slot == slot ? &e.m_value : nullptr;
+  }
+
+  /**
+   * \brief Get the value of a slot
+   * \param slot normalized slot number
+   * \return a pointer to the value, or nullptr if the slot is not stored
+   */
+  const T * Find (uint64_t slot) const
+  {
+    const Entry &e = m_entries[slot & (m_entries.size () - 1)];
+    return e.m_slot == slot ? &e.m_value : nullptr;
+  }
+
+  /**
+   * \brief Store a slot that is not stored yet
+   * \param slot normalized slot number
+   * \return a reference to the value, with the content left by the last
+   * slot stored in the same position (see the class description)
+   *
+   * The references returned by Find() and Insert() are invalidated if the
+   * window grows.
+   */
+  T & Insert (uint64_t slot)
+  {
+    NS_ASSERT (slot != EMPTY && Find (slot) == nullptr);
+    while (m_entries[slot & (m_entries.size () - 1)].m_slot != EMPTY)
+      {
+        Grow ();
+      }
+    Entry &e = m_entries[slot & (m_entries.size () - 1)];
+    e.m_slot = slot;
+    ++m_size;
+    return e.m_value;
+  }
+
+  /**
+   * \brief Remove a slot
+   * \param slot normalized slot number
+   * \return true if the slot was stored
+   */
+  bool Erase (uint64_t slot)
+  {
+    Entry &e = m_entries[slot & (m_entries.size () - 1)];
+    if (e.m_slot != slot)
+      {
+        return false;
+      }
+    e.m_slot = EMPTY;
+    --m_size;
+    return true;
+  }
+
+  /**
+   * \brief Get the first (lowest) slot stored
+   * \return the normalized slot number, or UINT64_MAX if the ring is empty
+   */
+  uint64_t GetFirstSlot () const
+  {
+    uint64_t first = EMPTY;
+    for (const auto &e : m_entries)
+      {
+        first = e.m_slot < first ? e.m_slot : first;
+      }
+    return first;
+  }
+
+  /**
+   * \brief Get the stored slots, in increasing order
+   * \return the normalized slot numbers
+   */
+  std::vector<uint64_t> GetSlots () const
+  {
+    std::vector<uint64_t> slots;
+    slots.reserve (m_size);
+    for (const auto &e : m_entries)
+      {
+        if (e.m_slot != EMPTY)
+          {
+            auto it = slots.begin ();
+            while (it != slots.end () && *it < e.m_slot)
+              {
+                ++it;
+              }
+            slots.insert (it, e.m_slot);
+          }
+      }
+    return slots;
+  }
+
+  /**
+   * \return the number of slots stored
+   */
+  size_t Size () const
+  {
+    return m_size;
+  }
+
+  /**
+   * \return the current window
+   */
+  size_t GetWindow () const
+  {
+    return m_entries.size ();
+  }
+
+  /**
+   * \brief Remove all the slots
+   */
+  void Clear ()
+  {
+    for (auto &e : m_entries)
+      {
+        e.m_slot = EMPTY;
+        e.m_value = T ();
+      }
+    m_size = 0;
+  }
+
+private:
+  static constexpr uint64_t EMPTY = UINT64_MAX; //!< Slot number of a free position
+
+  /**
+   * \brief A position of the ring
+   */
+  struct Entry
+  {
+    uint64_t m_slot {EMPTY}; //!< Slot stored, or EMPTY
+    T m_value {};            //!< Value of the slot
+  };
+
+  /**
+   * \brief Double the window, moving the stored slots to their new position
+   */
+  void Grow ()
+  {
+    std::vector<Entry> entries (m_entries.size () * 2);
+    for (auto &e : m_entries)
+      {
+        if (e.m_slot != EMPTY)
+          {
+            Entry &n = entries[e.m_slot & (entries.size () - 1)];
+            NS_ASSERT (n.m_slot == EMPTY);
+            n.m_slot = e.m_slot;
+            n.m_value = std::move (e.m_value);
+          }
+      }
+    m_entries.swap (entries);
+  }
+
+  std::vector<Entry> m_entries; //!< Positions of the ring
+  size_t m_size {0};            //!< Number of slots stored
+};
+
+} // namespace ns3
+
+#endif // NR_SLOT_RING_H
@@ -29,6 +29,7 @@
 #include "nr-lte-mi-error-model.h"
 #include "ns3/uniform-planar-array.h"
 
+#include <algorithm>
 
 namespace ns3 {
 
@@ -157,6 +158,14 @@ NrSpectrumPhy::GetTypeId (void)
                    DoubleValue (0.0),
                    MakeDoubleAccessor (&NrSpectrumPhy::SetInterStreamInterferenceRatio),
                    MakeDoubleChecker <double> (0.0, 1.0))
+    .AddAttribute ("DlCtrlAddressedOnly",
+                   "If true, a UE receives the DL CTRL of its cell only if it has "
+                   "messages for all the UEs (MIB, SIB1, RAR) or a DCI for its RNTI. "
+                   "The other DL CTRL signals are only measured (DL CTRL SINR and "
+                   "RSRP): their messages are not received nor processed.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrSpectrumPhy::m_dlCtrlAddressedOnly),
+                   MakeBooleanChecker ())
 
     .AddTraceSource ("RxPacketTraceEnb",
                      "The no. of packets received and transmitted by the Base Station",
@@ -414,6 +423,13 @@ NrSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
           if (dlCtrlRxParams->cellId == GetCellId () && dlCtrlRxParams->txPhy->GetObject<NrSpectrumPhy> ()->GetStreamId () == m_streamId)
             {
               m_interferenceCtrl->StartRx(rxPsd);
+              if (m_dlCtrlAddressedOnly && ! IsDlCtrlForThisUe (dlCtrlRxParams))
+                {
+                  // Measure the RSRP and the SINR, but do not receive the messages
+                  NS_LOG_INFO ("Received DL CTRL without messages for this UE, measuring it only");
+                  Simulator::Schedule (dlCtrlRxParams->duration, &NrSpectrumPhy::EndRxCtrlMeasurement, this);
+                  return;
+                }
               StartRxDlCtrl (dlCtrlRxParams);
             }
           else
@@ -569,6 +585,28 @@ NrSpectrumPhy::StartTxDlControlFrames (const std::list<Ptr<NrControlMessage> > &
         txParams->cellId = GetCellId ();
         txParams->pss = true;
         txParams->ctrlMsgList = ctrlMsgList;
+        txParams->broadcast = false;
+        for (const auto & msg : ctrlMsgList)
+          {
+            std::shared_ptr<DciInfoElementTdma> dci;
+            if (msg->GetMessageType () == NrControlMessage::DL_DCI)
+              {
+                dci = DynamicCast<NrDlDciMessage> (msg)->GetDciInfoElement ();
+              }
+            else if (msg->GetMessageType () == NrControlMessage::UL_DCI)
+              {
+                dci = DynamicCast<NrUlDciMessage> (msg)->GetDciInfoElement ();
+              }
+
+            if (dci != nullptr && dci->m_rnti != 0)
+              {
+                txParams->rntis.push_back (dci->m_rnti);
+              }
+            else
+              {
+                txParams->broadcast = true;
+              }
+          }
 
         m_txCtrlTrace (duration);
         if (m_channel)
@@ -778,7 +816,7 @@ NrSpectrumPhy::GetNrInterference (void) const
 
 void
 NrSpectrumPhy::AddExpectedTb (uint16_t rnti, uint8_t ndi, uint32_t size, uint8_t mcs,
-                                  const std::vector<int> &rbMap, uint8_t harqId, uint8_t rv, bool downlink,
+                                  const NrRbMask &rbMap, uint8_t harqId, uint8_t rv, bool downlink,
                                   uint8_t symStart, uint8_t numSym, const SfnSf &sfn)
 {
   NS_LOG_FUNCTION (this);
@@ -955,6 +993,20 @@ NrSpectrumPhy::StartRxDlCtrl (const Ptr<NrSpectrumSignalParametersDlCtrlFrame>&
     }
 }
 
+bool
+NrSpectrumPhy::IsDlCtrlForThisUe (const Ptr<NrSpectrumSignalParametersDlCtrlFrame>& params) const
+{
+  if (params->broadcast)
+    {
+      return true;
+    }
+  Ptr<NrUePhy> phy = DynamicCast<NrUePhy> (m_phy);
+  NS_ABORT_MSG_UNLESS (phy, "This function should only be called for NrSpectrumPhy belonging to NrUePhy");
+  uint16_t rnti = phy->GetRnti ();
+  // Without a RNTI, the UE is in the random access and reads everything
+  return rnti == 0 || std::find (params->rntis.begin (), params->rntis.end (), rnti) != params->rntis.end ();
+}
+
 void
 NrSpectrumPhy::StartRxUlCtrl (const Ptr<NrSpectrumSignalParametersUlCtrlFrame>& params)
 {
@@ -1144,7 +1196,7 @@ NrSpectrumPhy::EndRxData ()
             }
         }
 
-      GetTBInfo(tbIt).m_sinrAvg = GetTBInfo(tbIt).m_sinrAvg / GetTBInfo(tbIt).m_expected.m_rbBitmap.size ();
+      GetTBInfo(tbIt).m_sinrAvg = GetTBInfo(tbIt).m_sinrAvg / GetTBInfo(tbIt).m_expected.m_rbBitmap.Count ();
 
       NS_LOG_INFO ("Finishing RX, sinrAvg=" << GetTBInfo(tbIt).m_sinrAvg <<
                    " sinrMin=" << GetTBInfo(tbIt).m_sinrMin <<
@@ -1195,7 +1247,7 @@ NrSpectrumPhy::EndRxData ()
                        +GetTBInfo(tbIt).m_expected.m_harqProcessId << " size " <<
                        GetTBInfo (tbIt).m_expected.m_tbSize << " mcs " <<
                        (uint32_t)GetTBInfo (tbIt).m_expected.m_mcs << " bitmap " <<
-                       GetTBInfo (tbIt).m_expected.m_rbBitmap.size () << " rv from MAC: " <<
+                       GetTBInfo (tbIt).m_expected.m_rbBitmap.Count () << " rv from MAC: " <<
                        +GetTBInfo (tbIt).m_expected.m_rv << " elements in the history: " <<
                        harqInfoList.size () << " TBLER " <<
                        GetTBInfo(tbIt).m_outputOfEM->m_tbler << " corrupted " <<
@@ -1263,7 +1315,7 @@ NrSpectrumPhy::EndRxData ()
           traceParams.m_numSym = GetTBInfo(*itTb).m_expected.m_numSym;
           traceParams.m_bwpId = GetBwpId ();
           traceParams.m_streamId = m_streamId;
-          traceParams.m_rbAssignedNum = static_cast<uint32_t> (GetTBInfo(*itTb).m_expected.m_rbBitmap.size ());
+          traceParams.m_rbAssignedNum = static_cast<uint32_t> (GetTBInfo(*itTb).m_expected.m_rbBitmap.Count ());
 
           if (enbRx)
             {
@@ -1404,6 +1456,13 @@ NrSpectrumPhy::EndRxCtrl ()
   m_rxControlMessageList.clear ();
 }
 
+void
+NrSpectrumPhy::EndRxCtrlMeasurement ()
+{
+  NS_LOG_FUNCTION (this);
+  m_interferenceCtrl->EndRx ();
+}
+
 void
 NrSpectrumPhy::EndRxSrs ()
 {
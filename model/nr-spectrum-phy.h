@@ -344,7 +344,7 @@ public:
    * \param ndi New data indicator (0 for retx)
    * \param size TB Size
    * \param mcs MCS of the transmission
-   * \param rbMap Resource Block map (PHY-ready vector of SINR indices)
+   * \param rbMap Resource Block map (PHY-ready mask of SINR indices)
    * \param harqId ID of the HARQ process in the MAC
    * \param rv Redundancy Version: number of times the HARQ has been retransmitted
    * \param downlink indicate if it is downling
@@ -352,7 +352,7 @@ public:
    * \param numSym Num of symbols
    * \param sfn SFN
    */
-  void AddExpectedTb (uint16_t rnti, uint8_t ndi, uint32_t size, uint8_t mcs, const std::vector<int> &rbMap,
+  void AddExpectedTb (uint16_t rnti, uint8_t ndi, uint32_t size, uint8_t mcs, const NrRbMask &rbMap,
                       uint8_t harqId, uint8_t rv, bool downlink, uint8_t symStart, uint8_t numSym,
                       const SfnSf &sfn);
 
@@ -454,6 +454,18 @@ private:
    * \param params holds DL CTRL frame signal parameters structure
    */
   void StartRxDlCtrl (const Ptr<NrSpectrumSignalParametersDlCtrlFrame>& params);
+  /**
+   * \brief Check if a DL CTRL signal of this cell has to be received by this UE
+   * \param params holds DL CTRL frame signal parameters structure
+   * \return true if the signal has messages for all the UEs, or DCIs for the
+   * RNTI of this UE (or if the UE has no RNTI yet)
+   */
+  bool IsDlCtrlForThisUe (const Ptr<NrSpectrumSignalParametersDlCtrlFrame>& params) const;
+  /**
+   * \brief End the measurement of a DL CTRL signal that is not received
+   * (see IsDlCtrlForThisUe), notifying the CTRL chunk processors
+   */
+  void EndRxCtrlMeasurement ();
   /**
    * \brief Function that is called when is being received UL CTRL
    * \param params holds UL CTRL frame signal parameters structure
@@ -526,7 +538,7 @@ private:
     */
   struct ExpectedTb
   {
-    ExpectedTb (uint8_t ndi, uint32_t tbSize, uint8_t mcs, const std::vector<int> &rbBitmap,
+    ExpectedTb (uint8_t ndi, uint32_t tbSize, uint8_t mcs, const NrRbMask &rbBitmap,
                 uint8_t harqProcessId, uint8_t rv, bool isDownlink, uint8_t symStart,
                 uint8_t numSym, const SfnSf &sfn) :
       m_ndi (ndi),
@@ -545,7 +557,7 @@ private:
     uint8_t m_ndi               {0}; //!< New data indicator
     uint32_t m_tbSize           {0}; //!< TBSize
     uint8_t m_mcs               {0}; //!< MCS
-    std::vector<int> m_rbBitmap;     //!< RB Bitmap
+    NrRbMask m_rbBitmap;             //!< RB Bitmap
     uint8_t m_harqProcessId     {0}; //!< HARQ process ID (MAC)
     uint8_t m_rv                {0}; //!< RV
     bool m_isDownlink           {0}; //!< is Downlink?
@@ -622,6 +634,7 @@ private:
   uint8_t m_streamId {UINT8_MAX}; //!< StreamId of this NrSpectrumPhy instance
 
   double m_interStrInerfRatio {0.0}; //!< The inter-stream interference ratio.
+  bool m_dlCtrlAddressedOnly {false}; //!< Receive only the DL CTRL with messages for this UE, attribute DlCtrlAddressedOnly
 };
 
 }
@@ -75,6 +75,8 @@ NrSpectrumSignalParametersDlCtrlFrame::NrSpectrumSignalParametersDlCtrlFrame (co
   cellId = p.cellId;
   pss = p.pss;
   ctrlMsgList = p.ctrlMsgList;
+  rntis = p.rntis;
+  broadcast = p.broadcast;
 }
 
 Ptr<SpectrumSignalParameters>
@@ -22,6 +22,7 @@
 #define NR_SPECTRUM_SIGNAL_PARAMETERS_H
 
 #include <list>
+#include <vector>
 #include <ns3/spectrum-signal-parameters.h>
 
 namespace ns3 {
@@ -68,6 +69,11 @@ struct NrSpectrumSignalParametersDataFrame : public SpectrumSignalParameters
  *
  * This struct provides the generic signal representation to be used by the module
  * for what regards the downlink control part.
+ *
+ * Besides the messages, the signal carries the RNTIs addressed by its DCIs,
+ * and whether it carries messages for all the UEs (e.g., MIB, SIB1, RAR),
+ * so that a UE can skip the reception of DL CTRL that is not for it (see
+ * the attribute NrSpectrumPhy::DlCtrlAddressedOnly).
  */
 struct NrSpectrumSignalParametersDlCtrlFrame : public SpectrumSignalParameters
 {
@@ -90,6 +96,8 @@ struct NrSpectrumSignalParametersDlCtrlFrame : public SpectrumSignalParameters
   std::list<Ptr<NrControlMessage> > ctrlMsgList;  //!< CTRL message list
   bool pss;                                           //!< PSS (?)
   uint16_t cellId;                                    //!< cell id
+  std::vector<uint16_t> rntis;                        //!< RNTIs addressed by the DCIs of ctrlMsgList
+  bool broadcast {true};                              //!< True if ctrlMsgList has messages that are not DCIs for a RNTI
 };
 
 /**
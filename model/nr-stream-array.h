@@ -0,0 +1,206 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_STREAM_ARRAY_H
+#define NR_STREAM_ARRAY_H
+
+#include <ns3/abort.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief Fixed-capacity array with one value per stream
+ *
+ * The DCI carries MCS, TB size, NDI and RV for each of the streams of the
+ * UE. The number of streams is bounded (MAX_STREAMS, the same limit used
+ * by the gNB MAC for the DL HARQ buffers), so the values are stored inline
+ * and the array can be copied without any allocation. The interface is
+ * the subset of `std::vector` used by the MAC and the PHY (size (), at (),
+ * operator[], iterators), and an array can be built from a vector:
+ *
+ * \code{.cpp}
+ * NrStreamArray<uint8_t> ndi = {1};                 // one stream
+ * NrStreamArray<uint32_t> tbs = ueInfo->m_dlTbSize; // one value per stream
+ * \endcode
+ */
+template <typename T>
+class NrStreamArray
+{
+public:
+  static constexpr uint8_t MAX_STREAMS = 2;  //!< Maximum number of streams
+
+  /**
+   * \brief Create an empty array
+   */
+  NrStreamArray () = default;
+
+  /**
+   * \brief Create an array of the specified size
+   * \param size number of streams
+   * \param value initial value of all the elements
+   */
+  explicit NrStreamArray (std::size_t size, const T &value = T ())
+  {
+    CheckSize (size);
+    m_size = static_cast<uint8_t> (size);
+    m_values.fill (value);
+  }
+
+  /**
+   * \brief Create an array from a list of values
+   * \param values the values, one per stream
+   */
+  NrStreamArray (std::initializer_list<T> values)
+  {
+    CheckSize (values.size ());
+    std::copy (values.begin (), values.end (), m_values.begin ());
+    m_size = static_cast<uint8_t> (values.size ());
+  }
+
+  /**
+   * \brief Create an array from a vector
+   * \param values the values, one per stream
+   */
+  NrStreamArray (const std::vector<T> &values)
+  {
+    CheckSize (values.size ());
+    std::copy (values.begin (), values.end (), m_values.begin ());
+    m_size = static_cast<uint8_t> (values.size ());
+  }
+
+  /**
+   * \brief Get the number of streams
+   * \return the number of elements
+   */
+  std::size_t size () const
+  {
+    return m_size;
+  }
+
+  /**
+   * \brief Check if the array is empty
+   * \return true if there are no elements
+   */
+  bool empty () const
+  {
+    return m_size == 0;
+  }
+
+  /**
+   * \brief Access an element, with bound check
+   * \param i the stream index
+   * \return the element
+   */
+  const T & at (std::size_t i) const
+  {
+    NS_ABORT_MSG_IF (i >= m_size, "Stream " << i << " out of " << +m_size);
+    return m_values[i];
+  }
+
+  /**
+   * \brief Access an element, with bound check
+   * \param i the stream index
+   * \return the element
+   */
+  T & at (std::size_t i)
+  {
+    NS_ABORT_MSG_IF (i >= m_size, "Stream " << i << " out of " << +m_size);
+    return m_values[i];
+  }
+
+  /**
+   * \brief Access an element
+   * \param i the stream index
+   * \return the element
+   */
+  const T & operator[] (std::size_t i) const
+  {
+    return m_values[i];
+  }
+
+  /**
+   * \brief Access an element
+   * \param i the stream index
+   * \return the element
+   */
+  T & operator[] (std::size_t i)
+  {
+    return m_values[i];
+  }
+
+  /**
+   * \brief Iterator to the first element
+   * \return the iterator
+   */
+  const T * begin () const
+  {
+    return m_values.data ();
+  }
+
+  /**
+   * \brief Iterator past the last element
+   * \return the iterator
+   */
+  const T * end () const
+  {
+    return m_values.data () + m_size;
+  }
+
+  /**
+   * \brief Iterator to the first element
+   * \return the iterator
+   */
+  T * begin ()
+  {
+    return m_values.data ();
+  }
+
+  /**
+   * \brief Iterator past the last element
+   * \return the iterator
+   */
+  T * end ()
+  {
+    return m_values.data () + m_size;
+  }
+
+private:
+  /**
+   * \brief Abort if the number of streams is not supported
+   * \param size the number of streams
+   */
+  static void CheckSize (std::size_t size)
+  {
+    NS_ABORT_MSG_IF (size > MAX_STREAMS, size << " streams are not supported, the maximum is "
+                     << +MAX_STREAMS);
+  }
+
+  std::array<T, MAX_STREAMS> m_values {}; //!< The values
+  uint8_t m_size {0};                     //!< Number of streams
+};
+
+} // namespace ns3
+
+#endif // NR_STREAM_ARRAY_H
@@ -0,0 +1,209 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_SUBBAND_CQI_H
+#define NR_SUBBAND_CQI_H
+
+#include <ns3/abort.h>
+#include <ns3/assert.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief Subband CQI of one stream, as differential values over the wideband CQI
+ *
+ * As in TS 38.214 Table 5.2.2.1-1, the CQI of each subband is reported
+ * as a 2-bit offset with respect to the wideband CQI of the same report:
+ *
+ * | Code | Offset  |
+ * |------|---------|
+ * | 0    | 0       |
+ * | 1    | 1       |
+ * | 2    | >= 2    |
+ * | 3    | <= -1   |
+ *
+ * The offsets are packed in two 64-bit words, so that the report (and the
+ * copy stored by the scheduler) has a fixed size of a few bytes even for
+ * 273 RB. The subbands are groups of GetRbPerSubband() contiguous RB,
+ * starting from RB 0; the last one may be smaller.
+ */
+class NrSubbandCqi
+{
+public:
+  static constexpr uint32_t MAX_SUBBANDS = 64; //!< Maximum number of subbands
+  static constexpr uint8_t NUM_CODES = 4;      //!< Number of differential codes
+  static constexpr int8_t MAX_OFFSET = 2;      //!< Offset of the best code
+  static constexpr int8_t MIN_OFFSET = -1;     //!< Offset of the worst code
+
+  /**
+   * \brief Create an empty report (no subbands)
+   */
+  NrSubbandCqi () = default;
+
+  /**
+   * \brief Create a report with all the offsets to zero
+   * \param numRb number of RB of the bandwidth
+   * \param rbPerSubband number of RB in each subband, at least
+   * GetMinRbPerSubband (numRb)
+   */
+  NrSubbandCqi (uint32_t numRb, uint32_t rbPerSubband)
+  {
+    NS_ABORT_MSG_IF (rbPerSubband == 0 || rbPerSubband > UINT16_MAX,
+                     "Invalid subband size " << rbPerSubband);
+    uint32_t numSubbands = (numRb + rbPerSubband - 1) / rbPerSubband;
+    NS_ABORT_MSG_IF (numSubbands > MAX_SUBBANDS,
+                     "Subbands of " << rbPerSubband << " RB give " << numSubbands <<
+                     " subbands for " << numRb << " RB, the maximum is " << MAX_SUBBANDS);
+    m_rbPerSubband = static_cast<uint16_t> (rbPerSubband);
+    m_numSubbands = static_cast<uint8_t> (numSubbands);
+  }
+
+  /**
+   * \brief Get the smallest subband size that fits a bandwidth in MAX_SUBBANDS
+   * \param numRb number of RB of the bandwidth
+   * \return the minimum number of RB in each subband
+   */
+  static uint32_t GetMinRbPerSubband (uint32_t numRb)
+  {
+    return std::max<uint32_t> (1, (numRb + MAX_SUBBANDS - 1) / MAX_SUBBANDS);
+  }
+
+  /**
+   * \brief Get the number of subbands
+   * \return the number of subbands (0 for an empty report)
+   */
+  uint32_t GetNumSubbands () const
+  {
+    return m_numSubbands;
+  }
+
+  /**
+   * \brief Get the number of RB in each subband
+   * \return the subband size
+   */
+  uint32_t GetRbPerSubband () const
+  {
+    return m_rbPerSubband;
+  }
+
+  /**
+   * \brief Get the subband that contains a RB
+   * \param rb the RB index
+   * \return the subband index
+   */
+  uint32_t GetSubbandOfRb (uint32_t rb) const
+  {
+    NS_ASSERT (m_rbPerSubband > 0);
+    uint32_t sb = rb / m_rbPerSubband;
+    return sb < m_numSubbands ? sb : m_numSubbands - 1u;
+  }
+
+  /**
+   * \brief Convert a CQI difference into the code that represents it
+   * \param diff subband CQI minus wideband CQI
+   * \return the code
+   */
+  static uint8_t EncodeOffset (int32_t diff)
+  {
+    if (diff <= -1)
+      {
+        return 3;
+      }
+    return static_cast<uint8_t> (diff >= MAX_OFFSET ? MAX_OFFSET : diff);
+  }
+
+  /**
+   * \brief Convert a code into the CQI offset
+   * \param code the code
+   * \return the offset to add to the wideband CQI
+   */
+  static int8_t DecodeOffset (uint8_t code)
+  {
+    NS_ASSERT (code < NUM_CODES);
+    return code == 3 ? MIN_OFFSET : static_cast<int8_t> (code);
+  }
+
+  /**
+   * \brief Set the offset of a subband
+   * \param sb subband index
+   * \param diff subband CQI minus wideband CQI (quantized to the codes)
+   */
+  void SetOffset (uint32_t sb, int32_t diff)
+  {
+    NS_ASSERT (sb < m_numSubbands);
+    uint64_t &word = m_codes[sb / SUBBANDS_PER_WORD];
+    uint32_t shift = (sb % SUBBANDS_PER_WORD) * 2;
+    word &= ~(static_cast<uint64_t> (3) << shift);
+    word |= static_cast<uint64_t> (EncodeOffset (diff)) << shift;
+  }
+
+  /**
+   * \brief Get the code of a subband
+   * \param sb subband index
+   * \return the code (see the class description)
+   */
+  uint8_t GetCode (uint32_t sb) const
+  {
+    NS_ASSERT (sb < m_numSubbands);
+    uint32_t shift = (sb % SUBBANDS_PER_WORD) * 2;
+    return static_cast<uint8_t> ((m_codes[sb / SUBBANDS_PER_WORD] >> shift) & 3);
+  }
+
+  /**
+   * \brief Get the offset of a subband
+   * \param sb subband index
+   * \return the offset to add to the wideband CQI
+   */
+  int8_t GetOffset (uint32_t sb) const
+  {
+    return DecodeOffset (GetCode (sb));
+  }
+
+  /**
+   * \brief Get the worst offset of the subbands that contain a range of RB
+   * \param firstRb first RB of the range
+   * \param numRb number of RB of the range
+   * \return the minimum offset
+   */
+  int8_t GetMinOffset (uint32_t firstRb, uint32_t numRb) const
+  {
+    NS_ASSERT (numRb > 0);
+    int8_t ret = MAX_OFFSET;
+    for (uint32_t sb = GetSubbandOfRb (firstRb); sb <= GetSubbandOfRb (firstRb + numRb - 1); ++sb)
+      {
+        ret = std::min (ret, GetOffset (sb));
+      }
+    return ret;
+  }
+
+private:
+  static constexpr uint32_t SUBBANDS_PER_WORD = 32; //!< 2 bits per subband
+
+  std::array<uint64_t, MAX_SUBBANDS / SUBBANDS_PER_WORD> m_codes {}; //!< Packed codes
+  uint16_t m_rbPerSubband {0};  //!< Number of RB in each subband
+  uint8_t m_numSubbands {0};    //!< Number of subbands
+};
+
+} // namespace ns3
+
+#endif // NR_SUBBAND_CQI_H
@@ -178,6 +178,8 @@ public:
 
   virtual uint8_t GetNumHarqProcess () const override;
 
+  virtual bool IsIdle () const override;
+
 private:
   NrUeMac* m_mac;
 };
@@ -211,6 +213,12 @@ MacUeMemberPhySapUser::GetNumHarqProcess () const
   return m_mac->GetNumHarqProcess();
 }
 
+bool
+MacUeMemberPhySapUser::IsIdle () const
+{
+  return m_mac->DoIsIdle ();
+}
+
 //-----------------------------------------------------------------------
 
 TypeId
@@ -225,6 +233,14 @@ NrUeMac::GetTypeId (void)
                     MakeUintegerAccessor (&NrUeMac::SetNumHarqProcess,
                                           &NrUeMac::GetNumHarqProcess),
                     MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("UlConfiguredGrant",
+                   "If true, the UE does not send a SR when new data arrives while "
+                   "it has an active UL configured grant (i.e., while the gNB keeps "
+                   "sending the occasions of the grant): the data waits for the "
+                   "next occasion. Without an active grant, the SR is sent as usual",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&NrUeMac::m_ulConfiguredGrant),
+                   MakeBooleanChecker ())
     .AddTraceSource ("UeMacRxedCtrlMsgsTrace",
                      "Ue MAC Control Messages Traces.",
                      MakeTraceSourceAccessor (&NrUeMac::m_macRxedCtrlMsgsTrace),
@@ -398,11 +414,16 @@ NrUeMac::DoReportBufferStatus (LteMacSapProvider::ReportBufferStatusParameters p
       it = m_ulBsrReceived.insert (std::make_pair (params.lcid, params)).first;
     }
 
-  if (m_srState == INACTIVE)
+  if (m_srState == INACTIVE && ! IsUlConfiguredGrantActive ())
     {
       NS_LOG_INFO ("INACTIVE -> TO_SEND, bufSize " << GetTotalBufSize ());
       m_srState = TO_SEND;
     }
+
+  if (GetTotalBufSize () > 0)
+    {
+      m_phySapProvider->NotifyUlDataAvailable ();
+    }
 }
 
 
@@ -532,6 +553,14 @@ NrUeMac::DoSlotIndication (const SfnSf &sfn)
 
   RefreshHarqProcessesPacketBuffer ();
 
+  if (m_srState == INACTIVE && GetTotalBufSize () > 0 && ! IsUlConfiguredGrantActive ())
+    {
+      // The data was waiting for an occasion of the configured grant, but
+      // the grant is not active anymore
+      NS_LOG_INFO ("Configured grant expired, INACTIVE -> TO_SEND, bufSize " << GetTotalBufSize ());
+      m_srState = TO_SEND;
+    }
+
   if (m_srState == TO_SEND)
     {
       NS_LOG_INFO ("Sending SR to PHY in slot " << sfn);
@@ -542,6 +571,19 @@ NrUeMac::DoSlotIndication (const SfnSf &sfn)
   // Feedback missing
 }
 
+bool
+NrUeMac::IsUlConfiguredGrantActive () const
+{
+  return m_ulConfiguredGrant && m_currentSlot.Normalize () < m_ulCgExpiry;
+}
+
+bool
+NrUeMac::DoIsIdle () const
+{
+  return m_rnti != 0 && ! m_waitingForRaResponse && m_srState == INACTIVE
+         && GetTotalBufSize () == 0;
+}
+
 void
 NrUeMac::SendSR () const
 {
@@ -618,6 +660,14 @@ NrUeMac::ProcessUlDci (const Ptr<NrUlDciMessage> &dciMsg)
 
   m_macRxedCtrlMsgsTrace (m_currentSlot, GetCellId (), m_rnti, GetBwpId (), dciMsg);
 
+  if (m_ulDci->m_cgPeriodicity > 0)
+    {
+      // The grant is active until the next occasion: if the gNB does not
+      // send it, the grant has been released
+      m_ulCgExpiry = dataSfn.Normalize () + m_ulDci->m_cgPeriodicity;
+      NS_LOG_INFO ("Configured grant active until the slot " << m_ulCgExpiry);
+    }
+
   NS_LOG_INFO ("UL DCI received, transmit data in slot " << dataSfn <<
                " Harq Process " << +m_ulDci->m_harqProcess <<
                " TBS " << m_ulDci->m_tbSize.at (0) << " total queue " << GetTotalBufSize ());
@@ -1066,6 +1116,8 @@ void
 NrUeMac::DoReset ()
 {
   NS_LOG_FUNCTION (this);
+  // The configured grant of the old cell is not valid anymore
+  m_ulCgExpiry = 0;
 }
 //////////////////////////////////////////////
 
@@ -249,6 +249,20 @@ private:
    */
   void DoSlotIndication (const SfnSf &sfn);
 
+  /**
+   * \brief Tell if the MAC has nothing to do in the next slots
+   * \return true if there is no data to send, no SR/BSR procedure ongoing,
+   * and the RA procedure is completed
+   */
+  bool DoIsIdle () const;
+
+  /**
+   * \brief Tell if the UE can wait for a UL configured grant instead of sending a SR
+   * \return true if the attribute UlConfiguredGrant is true, and the gNB sent
+   * an occasion of a configured grant, whose next occasion is not in the past
+   */
+  bool IsUlConfiguredGrantActive () const;
+
   /**
    * \brief Get the total size of the RLC buffers.
    * \return The number of bytes that are in the RLC buffers
@@ -424,6 +438,8 @@ private:
     ACTIVE       //!< SR or BSR sent; now the source of information is the vector m_bsrReservedSpace
   };
   SrBsrMachine m_srState {INACTIVE};       //!< Current state for the SR/BSR machine.
+  bool m_ulConfiguredGrant {true};         //!< Don't send SR while a configured grant is active (attribute)
+  uint64_t m_ulCgExpiry {0};               //!< Normalized slot in which the configured grant expires, if the gNB does not renew it
 
   Ptr<UniformRandomVariable> m_raPreambleUniformVariable;
   uint8_t m_raPreambleId {0}; //!< The RA Preamble ID
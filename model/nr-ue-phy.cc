@@ -35,6 +35,8 @@
 #include <ns3/lte-radio-bearer-tag.h>
 #include <algorithm>
 #include <cfloat>
+#include <cmath>
+#include <functional>
 #include <ns3/boolean.h>
 #include <ns3/pointer.h>
 #include "beam-manager.h"
@@ -158,6 +160,38 @@ NrUePhy::GetTypeId (void)
                    MakeDoubleAccessor (&NrUePhy::SetRiSinrThreshold2,
                                        &NrUePhy::GetRiSinrThreshold2),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("SubbandCqiSize",
+                   "Number of RB of each subband of the DL CQI reports. If 0, the "
+                   "UE reports only the wideband CQI; otherwise, it also reports "
+                   "the offset of the CQI of each subband (see NrSubbandCqi). "
+                   "A size too small to fit the bandwidth in the maximum number "
+                   "of subbands is enlarged to the minimum one",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrUePhy::m_subbandCqiSize),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("IdleSlotSkipping",
+                   "If true, the UE suspends its slot loop when it has nothing "
+                   "to transmit or receive (no allocations, no CTRL messages, "
+                   "no UL data), and resumes it when a DCI, a CTRL message "
+                   "or UL data arrive",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrUePhy::m_idleSlotSkipping),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CsiReportPeriodicity",
+                   "Number of slots between two periodic DL CSI reports. If 0, "
+                   "the UE measures the CSI and sends a report at every DL data "
+                   "reception",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrUePhy::m_csiReportPeriodicity),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CsiSinrTriggerThreshold",
+                   "Change (in dB) of the average SINR of a stream, with respect "
+                   "to its last CSI measurement, that triggers an aperiodic CSI "
+                   "report before the period expires. If 0, only periodic "
+                   "reports are sent. Used only if CsiReportPeriodicity is not 0",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&NrUePhy::m_csiSinrTriggerThreshold),
+                   MakeDoubleChecker<double> (0.0))
     .AddTraceSource ("DlDataSinr",
                      "DL DATA SINR statistics.",
                      MakeTraceSourceAccessor (&NrUePhy::m_dlDataSinrTrace),
@@ -275,7 +309,7 @@ NrUePhy::SetDlAmc(const Ptr<const NrAmc> &amc)
 }
 
 void
-NrUePhy::SetSubChannelsForTransmission (const std::vector <int> &mask, uint32_t numSym, uint8_t activeStreams)
+NrUePhy::SetSubChannelsForTransmission (const NrRbMask &mask, uint32_t numSym, uint8_t activeStreams)
 {
   // in uplink we currently support maximum 1 stream for DATA and CTRL, only SRS will be sent using more than 1 stream
   Ptr<SpectrumValue> txPsd = GetTxPowerSpectralDensity (mask, activeStreams);
@@ -460,6 +494,11 @@ NrUePhy::PhyCtrlMessagesReceived (const Ptr<NrControlMessage> &msg)
 {
   NS_LOG_FUNCTION (this);
 
+  if (m_slotLoopSuspended)
+    {
+      SyncSuspendedSlot ();
+    }
+
   if (msg->GetMessageType () == NrControlMessage::DL_DCI)
     {
       auto dciMsg = DynamicCast<NrDlDciMessage> (msg);
@@ -472,6 +511,8 @@ NrUePhy::PhyCtrlMessagesReceived (const Ptr<NrControlMessage> &msg)
           return;   // DCI not for me
         }
 
+      WakeUp ();
+
       SfnSf dciSfn = m_currentSlot;
       uint32_t k0Delay = dciMsg->GetKDelay ();
       dciSfn.Add (k0Delay);
@@ -520,6 +561,8 @@ NrUePhy::PhyCtrlMessagesReceived (const Ptr<NrControlMessage> &msg)
           return;   // DCI not for me
         }
 
+      WakeUp ();
+
       SfnSf ulSfnSf = m_currentSlot;
       uint32_t k2Delay = dciMsg->GetKDelay ();
       ulSfnSf.Add (k2Delay);
@@ -670,7 +713,7 @@ NrUePhy::PushCtrlAllocations (const SfnSf currentSfnSf)
 
   // The UE does not know anything from the GNB yet, so listen on the default
   // bandwidth.
-  std::vector<uint8_t> rbgBitmask (GetRbNum (), 1);
+  NrRbMask rbgBitmask (GetRbNum (), true);
 
   // The UE still doesn't know the TDD pattern, so just add a DL CTRL
   if (m_tddPattern.size () == 0)
@@ -816,11 +859,7 @@ NrUePhy::UlSrs (const std::shared_ptr<DciInfoElementTdma> &dci)
 {
   NS_LOG_FUNCTION (this);
 
-  std::vector<int> channelRbs;
-  for (uint32_t i = 0; i < GetRbNum (); i++)
-    {
-      channelRbs.push_back (static_cast<int> (i));
-    }
+  NrRbMask channelRbs (GetRbNum (), true);
   // SRS is currently the only tranmsision in the uplink that is sent over all streams
   SetSubChannelsForTransmission (channelRbs, dci->m_numSym, m_spectrumPhys.size());
 
@@ -890,15 +929,11 @@ NrUePhy::UlCtrl (const std::shared_ptr<DciInfoElementTdma> &dci)
         }
     }
 
-  std::vector<int> channelRbs;
-  for (uint32_t i = 0; i < GetRbNum (); i++)
-    {
-      channelRbs.push_back (static_cast<int> (i));
-    }
+  NrRbMask channelRbs (GetRbNum (), true);
 
   if (m_enableUplinkPowerControl)
     {
-      m_txPower = m_powerControl->GetPucchTxPower (channelRbs.size());
+      m_txPower = m_powerControl->GetPucchTxPower (GetRbNum ());
     }
   // Currently uplink CTRLis transmitted only over 1 stream
   SetSubChannelsForTransmission (channelRbs, dci->m_numSym, 1);
@@ -925,6 +960,8 @@ NrUePhy::DlData (const std::shared_ptr<DciInfoElementTdma> &dci)
 
   m_activeDlDataStreams = 0;
 
+  const NrRbMask rbMap = FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask);
+
   for (uint8_t streamIndex = 0; streamIndex < dci->m_tbSize.size(); streamIndex++)
     {
       if (dci->m_tbSize.at (streamIndex) > 0)
@@ -936,7 +973,7 @@ NrUePhy::DlData (const std::shared_ptr<DciInfoElementTdma> &dci)
           m_spectrumPhys.at (streamIndex)->AddExpectedTb (dci->m_rnti, dci->m_ndi.at (streamIndex),
                                                          dci->m_tbSize.at (streamIndex),
                                                          dci->m_mcs.at (streamIndex),
-                                                         FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask),
+                                                         rbMap,
                                                          dci->m_harqProcess, dci->m_rv.at (streamIndex), true,
                                                          dci->m_symStart, dci->m_numSym, m_currentSlot);
                                                          
@@ -945,7 +982,7 @@ NrUePhy::DlData (const std::shared_ptr<DciInfoElementTdma> &dci)
                         " RXing DL DATA frame for"
                         " symbols "  << +dci->m_symStart <<
                         "-" << +(dci->m_symStart + dci->m_numSym - 1) <<
-                        " num of rbg assigned: " << FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask).size () <<
+                        " num of rbg assigned: " << rbMap.Count () <<
                         "\t start " << Simulator::Now () <<
                         " end " << (Simulator::Now () + varTtiPeriod));
         }
@@ -958,12 +995,13 @@ Time
 NrUePhy::UlData(const std::shared_ptr<DciInfoElementTdma> &dci)
 {
   NS_LOG_FUNCTION (this);
+  const NrRbMask rbMap = FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask);
   if (m_enableUplinkPowerControl)
     {
-      m_txPower = m_powerControl->GetPuschTxPower ((FromRBGBitmaskToRBAssignment(dci->m_rbgBitmask)).size());
+      m_txPower = m_powerControl->GetPuschTxPower (rbMap.Count ());
     }
   // Currently uplink DATA is transmitted over only 1 stream
-  SetSubChannelsForTransmission (FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask), dci->m_numSym, 1);
+  SetSubChannelsForTransmission (rbMap, dci->m_numSym, 1);
   Time varTtiPeriod = GetSymbolPeriod () * dci->m_numSym;
   std::list<Ptr<NrControlMessage> > ctrlMsg;
   //MIMO is not supported for UL yet.
@@ -1052,13 +1090,30 @@ NrUePhy::EndVarTti (const std::shared_ptr<DciInfoElementTdma> &dci)
       m_tryToPerformLbt = false;
     }
 
+  ScheduleNextVarTti ();
+
+  m_receptionEnabled = false;
+}
+
+void
+NrUePhy::ScheduleNextVarTti ()
+{
+  NS_LOG_FUNCTION (this);
+
   if (m_currSlotAllocInfo.m_varTtiAllocInfo.size () == 0)
     {
       // end of slot
       m_currentSlot.Add (1);
 
-      Simulator::Schedule (m_lastSlotStart + GetSlotPeriod () - Simulator::Now (),
-                           &NrUePhy::StartSlot, this, m_currentSlot);
+      if (IsIdle ())
+        {
+          NS_LOG_INFO ("UE " << m_rnti << " idle, suspending the slot loop before slot " << m_currentSlot);
+          m_slotLoopSuspended = true;
+          m_suspendedSlotStart = m_lastSlotStart + GetSlotPeriod ();
+          return;
+        }
+
+      ScheduleStartSlot (m_lastSlotStart + GetSlotPeriod () - Simulator::Now ());
     }
   else
     {
@@ -1070,8 +1125,95 @@ NrUePhy::EndVarTti (const std::shared_ptr<DciInfoElementTdma> &dci)
       Simulator::Schedule (nextVarTtiStart + m_lastSlotStart - Simulator::Now (),
                            &NrUePhy::StartVarTti, this, allocation.m_dci);
     }
+}
 
-  m_receptionEnabled = false;
+void
+NrUePhy::ScheduleStartSlot (const Time &delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  if (m_slotClock != nullptr)
+    {
+      m_slotClock->Schedule (delay, NrSlotClock::START_SLOT,
+                             std::bind (&NrUePhy::StartSlot, this, m_currentSlot));
+    }
+  else
+    {
+      Simulator::Schedule (delay, &NrUePhy::StartSlot, this, m_currentSlot);
+    }
+}
+
+bool
+NrUePhy::IsIdle () const
+{
+  return m_idleSlotSkipping && m_phySapUser->IsIdle () && SlotAllocInfoSize () == 0
+         && IsCtrlMsgQueueEmpty () && m_ctrlMsgs.empty ();
+}
+
+void
+NrUePhy::WakeUp ()
+{
+  if (m_slotLoopSuspended)
+    {
+      ResumeSlotLoop ();
+    }
+}
+
+void
+NrUePhy::SyncSuspendedSlot ()
+{
+  NS_ASSERT (m_slotLoopSuspended);
+
+  Time now = Simulator::Now ();
+  if (now < m_suspendedSlotStart + GetSlotPeriod ())
+    {
+      return;
+    }
+
+  int64_t skipped = (now - m_suspendedSlotStart).GetTimeStep () / GetSlotPeriod ().GetTimeStep ();
+  m_currentSlot.Add (static_cast<uint32_t> (skipped));
+  m_suspendedSlotStart += GetSlotPeriod () * skipped;
+}
+
+void
+NrUePhy::ResumeSlotLoop ()
+{
+  NS_LOG_FUNCTION (this);
+
+  SyncSuspendedSlot ();
+  m_slotLoopSuspended = false;
+
+  Time now = Simulator::Now ();
+  if (now < m_suspendedSlotStart)
+    {
+      NS_LOG_INFO ("UE " << m_rnti << " resuming the slot loop at slot " << m_currentSlot);
+      ScheduleStartSlot (m_suspendedSlotStart - now);
+      return;
+    }
+
+  // The slot already started: start it as StartSlot would have done, but
+  // skip the allocations that are already in the past
+  NS_LOG_INFO ("UE " << m_rnti << " resuming the slot loop in the middle of slot " << m_currentSlot);
+  m_lastSlotStart = m_suspendedSlotStart;
+  m_phySapUser->SlotIndication (m_currentSlot);
+
+  if (SlotAllocInfoExists (m_currentSlot))
+    {
+      m_currSlotAllocInfo = RetrieveSlotAllocInfo (m_currentSlot);
+    }
+  else
+    {
+      m_currSlotAllocInfo = SlotAllocInfo (m_currentSlot);
+    }
+  PushCtrlAllocations (m_currentSlot);
+
+  auto & allocs = m_currSlotAllocInfo.m_varTtiAllocInfo;
+  while (! allocs.empty () && m_lastSlotStart + GetSymbolPeriod () * allocs.front ().m_dci->m_symStart < now)
+    {
+      allocs.pop_front ();
+    }
+
+  // The caller may still insert the allocations of the DCI that woke us up
+  Simulator::ScheduleNow (&NrUePhy::ScheduleNextVarTti, this);
 }
 
 void
@@ -1130,36 +1272,51 @@ NrUePhy::GenerateDlCqiReport (const SpectrumValue& sinr, uint8_t streamId)
   // Not totally sure what this is about. We have to check.
   if (m_ulConfigured && (m_rnti > 0) && m_receptionEnabled)
     {
-      m_dlDataSinrTrace (GetCellId (), m_rnti, ComputeAvgSinr (sinr), GetBwpId (), streamId);
+      double avrgSinrLinear = ComputeAvgSinr (sinr);
+      m_dlDataSinrTrace (GetCellId (), m_rnti, avrgSinrLinear, GetBwpId (), streamId);
 
-      // TODO
-      // Not sure what this IF is about, seems that it can be removed,
-      // if not, then we have to support wbCqiLast time per stream
-      // if (Simulator::Now () > m_wbCqiLast)
       if (m_prevDlWbCqi.empty ()) // No DL CQI reported yet, initialize the vector
         {
           // Remember, scheduler uses MCS 0 for CQI 0.
           // See, NrMacSchedulerCQIManagement::DlWBCQIReported
           m_prevDlWbCqi = std::vector <uint8_t> (m_spectrumPhys.size (), 0);
+          m_prevDlSbCqi = std::vector <NrSubbandCqi> (m_spectrumPhys.size ());
+          m_lastCsiSinrdB = std::vector <double> (m_spectrumPhys.size (), UINT32_MAX);
           m_reportedRi2 = false; // already initialized to false in the header, added here for readability
         }
 
-      uint8_t mcs; // it is initialized by AMC in the following call
-      uint8_t wbCqi = m_amc->CreateCqiFeedbackWbTdma (sinr, mcs);
+      NS_ASSERT (streamId < m_prevDlWbCqi.size ());
+      double avrgSinrdB = 10 * log10 (avrgSinrLinear);
 
-      std::vector <double> avrgSinr = std::vector <double> (m_spectrumPhys.size (), UINT32_MAX);
+      if (IsCsiReportDue (avrgSinrdB, streamId))
+        {
+          uint8_t mcs; // it is initialized by AMC in the following call
+          uint8_t wbCqi = m_amc->CreateCqiFeedbackWbTdma (sinr, mcs);
 
-      NS_ASSERT (streamId < m_prevDlWbCqi.size ());
-      m_prevDlWbCqi [streamId] = wbCqi;
-      double avrgSinrdB = 10 * log10 (ComputeAvgSinr (sinr));
-      avrgSinr [streamId] = avrgSinrdB;
-      NS_LOG_DEBUG ("Stream " << +streamId << " WB CQI " << +wbCqi << " avrg MCS " << +mcs << " avrg SINR (dB) " << avrgSinrdB);
+          m_prevDlWbCqi [streamId] = wbCqi;
+          if (m_subbandCqiSize > 0)
+            {
+              m_prevDlSbCqi [streamId] = m_amc->CreateCqiFeedbackSbTdma (sinr, m_subbandCqiSize,
+                                                                        m_prevDlSbCqi [streamId]);
+            }
+          m_lastCsiSinrdB [streamId] = avrgSinrdB;
+          m_lastCsiStream = streamId;
+          m_lastCsiStreamSinrdB = avrgSinrdB;
+          m_csiReportPending = true;
+          NS_LOG_DEBUG ("Stream " << +streamId << " WB CQI " << +wbCqi << " avrg MCS " << +mcs << " avrg SINR (dB) " << avrgSinrdB);
+        }
       m_dlCqiFeedbackCounter++;
 
-      // if we received SINR from all the active streams,
-      // we can proceed to trigger the corresponding callback
-      if (m_dlCqiFeedbackCounter == m_activeDlDataStreams)
+      // if we received SINR from all the active streams, and at least
+      // one of them has been measured, we can proceed to trigger the
+      // corresponding callback
+      if (m_dlCqiFeedbackCounter == m_activeDlDataStreams && m_csiReportPending)
         {
+          // The RI is selected on the last stream measured, as if the
+          // other streams were not received
+          std::vector <double> avrgSinr = std::vector <double> (m_spectrumPhys.size (), UINT32_MAX);
+          avrgSinr [m_lastCsiStream] = m_lastCsiStreamSinrdB;
+
           DlCqiInfo dlcqi;
           dlcqi.m_rnti = m_rnti;
           dlcqi.m_cqiType = DlCqiInfo::WB;
@@ -1182,6 +1339,12 @@ NrUePhy::GenerateDlCqiReport (const SpectrumValue& sinr, uint8_t streamId)
           //if UE reports RI = 2 and one of the stream's CQI is 0, scheduler will
           //use MCS 0 to compute its TB size.
           dlcqi.m_wbCqi = m_prevDlWbCqi; // set DL CQI feedbacks
+          if (m_subbandCqiSize > 0)
+            {
+              // The subband offsets refer to the WB CQI of the same stream
+              dlcqi.m_cqiType = DlCqiInfo::SB;
+              dlcqi.m_sbCqi = m_prevDlSbCqi;
+            }
 
           NS_ASSERT_MSG (dlcqi.m_ri <= dlcqi.m_wbCqi.size (), "Mismatch between the RI and the number of CQIs in a CQI report");
 
@@ -1190,12 +1353,43 @@ NrUePhy::GenerateDlCqiReport (const SpectrumValue& sinr, uint8_t streamId)
             {
               DoSendControlMessage (msg);
             }
+          m_lastCsiReportSlot = m_currentSlot.Normalize ();
+        }
+
+      if (m_dlCqiFeedbackCounter == m_activeDlDataStreams)
+        {
           // reset the key variables
           m_dlCqiFeedbackCounter = 0;
+          m_csiReportPending = false;
         }
     }
 }
 
+bool
+NrUePhy::IsCsiReportDue (double avrgSinrdB, uint8_t streamId) const
+{
+  if (m_csiReportPeriodicity == 0 || m_lastCsiReportSlot == UINT64_MAX)
+    {
+      return true;
+    }
+
+  if (m_currentSlot.Normalize () - m_lastCsiReportSlot >= m_csiReportPeriodicity)
+    {
+      return true;
+    }
+
+  NS_ASSERT (streamId < m_lastCsiSinrdB.size ());
+  if (m_csiSinrTriggerThreshold > 0.0 && m_lastCsiSinrdB [streamId] != UINT32_MAX
+      && std::abs (avrgSinrdB - m_lastCsiSinrdB [streamId]) > m_csiSinrTriggerThreshold)
+    {
+      NS_LOG_INFO ("Stream " << +streamId << " SINR moved from " << m_lastCsiSinrdB [streamId] <<
+                   " dB to " << avrgSinrdB << " dB, triggering an aperiodic CSI report");
+      return true;
+    }
+
+  return false;
+}
+
 void
 NrUePhy::EnqueueDlHarqFeedback (const DlHarqInfo &m)
 {
@@ -1466,6 +1660,13 @@ NrUePhy::DoSetDlBandwidth (uint16_t dlBandwidth)
 
   SetChannelBandwidth (dlBandwidth);
 
+  if (m_subbandCqiSize > 0 && m_subbandCqiSize < NrSubbandCqi::GetMinRbPerSubband (GetRbNum ()))
+    {
+      NS_LOG_WARN ("SubbandCqiSize " << m_subbandCqiSize << " too small for " << GetRbNum () <<
+                   " RB, the subband CQI will use " <<
+                   NrSubbandCqi::GetMinRbPerSubband (GetRbNum ()) << " RB per subband");
+    }
+
   NS_LOG_DEBUG ("PHY reconfiguring. Result: "  << std::endl <<
                 "\t TxPower: " << m_txPower << " dB" << std::endl <<
                 "\t NoiseFigure: " << m_noiseFigure << std::endl <<
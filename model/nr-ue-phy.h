@@ -237,7 +237,9 @@ public:
   /**
    * \brief Generate a DL CQI report
    *
-   * Connected by the helper to a callback in corresponding ChunkProcessor
+   * Connected by the helper to a callback in corresponding ChunkProcessor.
+   * The CQI is calculated only if a report is due (see IsCsiReportDue);
+   * otherwise, the reception only updates the SINR trace.
    *
    * \param sinr the SINR
    * \param streamIndex the index of the stream for which is reported this SINR
@@ -451,6 +453,13 @@ public:
    */
   virtual void ScheduleStartEventLoop (uint32_t nodeId, uint16_t frame, uint8_t subframe, uint16_t slot) override;
 
+  /**
+   * \brief Resume the slot loop, if it was suspended
+   *
+   * \see IsIdle
+   */
+  virtual void WakeUp () override;
+
   /**
    * \brief Called when rsReceivedPower is fired
    * \param power the power received
@@ -619,13 +628,57 @@ private:
   void EndVarTti (const std::shared_ptr<DciInfoElementTdma> &dci);
 
   /**
-   * \brief Set the Tx power spectral density based on the RB index vector
-   * \param mask vector of the index of the RB (in SpectrumValue array)
+   * \brief Schedule the next variable TTI of the slot, or the next slot
+   *
+   * If there are no more allocations in the slot, and the UE is idle, the
+   * slot loop is suspended instead of scheduling the next slot.
+   */
+  void ScheduleNextVarTti ();
+
+  /**
+   * \brief Schedule the start of the current slot (m_currentSlot)
+   * \param delay delay from now
+   *
+   * The start is given to the slot clock, if any, or scheduled as an event.
+   */
+  void ScheduleStartSlot (const Time &delay);
+
+  /**
+   * \brief Tell if the slot loop can be suspended
+   *
+   * The UE is idle when the attribute IdleSlotSkipping is true, the MAC is
+   * idle (see NrUePhySapUser::IsIdle), and the PHY does not have allocations
+   * or CTRL messages queued for the next slots.
+   *
+   * \return true if the slot loop can be suspended
+   */
+  bool IsIdle () const;
+
+  /**
+   * \brief Bring m_currentSlot to the slot that includes the current time
+   *
+   * While the slot loop is suspended, m_currentSlot is the first slot not
+   * processed, and m_suspendedSlotStart is its start time.
+   */
+  void SyncSuspendedSlot ();
+
+  /**
+   * \brief Resume the slot loop
+   *
+   * If the current slot already started, the slot is resumed from the
+   * current time (the allocations that should have already started are
+   * skipped); otherwise, its start is scheduled.
+   */
+  void ResumeSlotLoop ();
+
+  /**
+   * \brief Set the Tx power spectral density based on the RB mask
+   * \param mask mask of the RB (in SpectrumValue array)
    * in which there is a transmission
    * \param numSym number of symbols of the transmission
    * \param activeStreams the number of active streams for the transmission
    */
-  void SetSubChannelsForTransmission (const std::vector<int> &mask, uint32_t numSym, uint8_t activeStreams);
+  void SetSubChannelsForTransmission (const NrRbMask &mask, uint32_t numSym, uint8_t activeStreams);
   /**
    * \brief Send ctrl msgs considering L1L2CtrlLatency
    * \param msg The ctrl msg to be sent
@@ -784,6 +837,21 @@ private:
    */
   uint8_t SelectRi (const std::vector<double> &avrgSinr);
 
+  /**
+   * \brief Tell if the CSI of a stream has to be measured in this reception
+   *
+   * The CSI is measured if the attribute CsiReportPeriodicity is 0 (i.e.,
+   * at every DL data reception), if at least CsiReportPeriodicity slots
+   * passed since the last report (periodic report), or if the average SINR
+   * of the stream moved more than CsiSinrTriggerThreshold dB from the one
+   * of its last measurement (aperiodic report).
+   *
+   * \param avrgSinrdB the average SINR of the reception, in dB
+   * \param streamId the stream
+   * \return true if the CQI of the stream has to be calculated
+   */
+  bool IsCsiReportDue (double avrgSinrdB, uint8_t streamId) const;
+
   NrUePhySapUser* m_phySapUser;             //!< SAP pointer
   LteUeCphySapProvider* m_ueCphySapProvider;    //!< SAP pointer
   LteUeCphySapUser* m_ueCphySapUser;            //!< SAP pointer
@@ -876,6 +944,19 @@ private:
   uint8_t m_activeDlDataStreams {0}; //!< The value is updated each time DlData function is called, first it is reset to 0, and then it is incremented each time is called AddExpectedTb
 
   std::vector <uint8_t> m_prevDlWbCqi; //!< Vector to cache the CQI values reported by this UE PHY
+  std::vector <NrSubbandCqi> m_prevDlSbCqi; //!< Vector to cache the SB CQI values reported by this UE PHY
+  uint16_t m_subbandCqiSize {0}; //!< RB of each subband of the CQI reports (0: only WB CQI)
+  uint16_t m_csiReportPeriodicity {0}; //!< Slots between two periodic CSI reports (0: at every DL data reception)
+  double m_csiSinrTriggerThreshold {0.0}; //!< SINR change (dB) that triggers an aperiodic CSI report (0: disabled)
+  uint64_t m_lastCsiReportSlot {UINT64_MAX}; //!< Normalized slot of the last CSI report
+  std::vector <double> m_lastCsiSinrdB; //!< Average SINR (dB) of the last CSI measurement of each stream
+  bool m_csiReportPending {false}; //!< True if a stream of the current reception has been measured
+  uint8_t m_lastCsiStream {0}; //!< Last stream measured for the current report
+  double m_lastCsiStreamSinrdB {0.0}; //!< Average SINR (dB) of m_lastCsiStream
+
+  bool m_idleSlotSkipping {false};  //!< Suspend the slot loop when idle (attribute)
+  bool m_slotLoopSuspended {false}; //!< True if the slot loop is suspended
+  Time m_suspendedSlotStart;        //!< Start of m_currentSlot, while the slot loop is suspended
   uint8_t m_dlCqiFeedbackCounter {0}; /**< Counter to count the number of DL CQI
                                            report(s) this UE PHY prepares upon
                                            receiving SINR from underlying one or
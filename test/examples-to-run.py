@@ -54,6 +54,7 @@ cpp_examples = [
     ("cttc-nr-mimo-demo --polSlantAngle1=0 --polSlantAngle2=90 --fixedRankIndicator=1", "True", "True"),
     ("cttc-nr-mimo-demo --polSlantAngle1=0 --polSlantAngle2=90 --useFixedRi=0", "True", "True"),
     ("cttc-nr-mimo-demo --crossPolarizedGnb=0 --crossPolarizedUe=0", "True", "True"),
+    ("cttc-nr-scheduler-benchmark --ueList=5 --beamList=1,2 --slots=100 --warmUpSlots=10", "True", "True"),
     ]
 
 # A list of Python examples to run in order to ensure that they remain
@@ -58,7 +58,7 @@ PowerAllocationTestCase::DoRun (void)
 {
   Ptr<const SpectrumModel> sm =  NrSpectrumValueHelper::GetSpectrumModel (200, 2e9, 15000);
 
-  std::vector<int> activeRbs;
+  NrRbMask activeRbs (sm->GetNumBands ());
   double totalPower = 30;
   double transmittedTxPsd = 0;
   Ptr<SpectrumValue> txPsd = nullptr;
@@ -66,33 +66,26 @@ PowerAllocationTestCase::DoRun (void)
   NS_LOG_INFO ("Testing for number of RBs:" << sm->GetNumBands ());
 
   // fill in all RBs
-  for (size_t rbId = 0; rbId < sm->GetNumBands (); rbId++)
-    {
-      activeRbs.push_back (rbId);
-    }
+  activeRbs.SetAll (true);
 
   txPsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity  (totalPower, activeRbs, sm, NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_BW);
   transmittedTxPsd = 10 * log10 (Integral (*txPsd) * 1000);
   NS_TEST_ASSERT_MSG_EQ_TOL (totalPower, transmittedTxPsd, 0.01, "Total power and transmitted power should be equal when all RBs are active regardless power allocation type.");
 
-  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_BW and using RBs: " << activeRbs.size () << " transmitted power is: " << transmittedTxPsd);
+  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_BW and using RBs: " << activeRbs.Count () << " transmitted power is: " << transmittedTxPsd);
 
   txPsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity  (totalPower, activeRbs, sm, NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_USED);
   transmittedTxPsd = 10 * log10 (Integral (*txPsd) * 1000);
   NS_TEST_ASSERT_MSG_EQ_TOL (totalPower, transmittedTxPsd, 0.01, "Total power and transmitted power should be equal when all RBs are active regardless power allocation type.");
 
-  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_USED and using RBs: " << activeRbs.size () << " transmitted power is: " << transmittedTxPsd);
+  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_USED and using RBs: " << activeRbs.Count () << " transmitted power is: " << transmittedTxPsd);
 
   // empty RBs list
-  activeRbs.erase (activeRbs.begin (), activeRbs.end ());
-  activeRbs.clear ();
-  NS_ABORT_IF (!activeRbs.empty ());
+  activeRbs.SetAll (false);
+  NS_ABORT_IF (activeRbs.Any ());
 
   // fill in only half RBs
-  for (size_t rbId = 0; rbId < sm->GetNumBands () / 10; rbId++)
-    {
-      activeRbs.push_back (rbId);
-    }
+  activeRbs.SetRange (0, sm->GetNumBands () / 10);
 
   NS_LOG_INFO ("Testing for number of RBs:" << sm->GetNumBands () / 2);
 
@@ -103,25 +96,21 @@ PowerAllocationTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (totalPower - 10, transmittedTxPsd, 0.05,"If only half of RBs are active then only half of total power should be transmitted when uniform "
                              "power allocation over all bandwidth is being configured.");
 
-  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_BW and using RBs: " << activeRbs.size () << " transmitted power is: " << transmittedTxPsd);
+  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_BW and using RBs: " << activeRbs.Count () << " transmitted power is: " << transmittedTxPsd);
 
   txPsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity  (totalPower, activeRbs, sm, NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_USED);
   transmittedTxPsd = 10 * log10 (Integral (*txPsd) * 1000);
   NS_TEST_ASSERT_MSG_EQ_TOL (totalPower, transmittedTxPsd, 0.01, "If only half of RBs are active then the total power should be transmitted when uniform "
                              "power allocation over active RBs is being configured.");
 
-  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_USED and using RBs: " << activeRbs.size () << " transmitted power is: " << transmittedTxPsd);
+  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_USED and using RBs: " << activeRbs.Count () << " transmitted power is: " << transmittedTxPsd);
 
   // empty RBs list
-  activeRbs.erase (activeRbs.begin (), activeRbs.end ());
-  activeRbs.clear ();
-  NS_ABORT_IF (!activeRbs.empty ());
+  activeRbs.SetAll (false);
+  NS_ABORT_IF (activeRbs.Any ());
 
   // fill in only half RBs
-  for (size_t rbId = 0; rbId < sm->GetNumBands () / 10; rbId++)
-    {
-      activeRbs.push_back (rbId);
-    }
+  activeRbs.SetRange (0, sm->GetNumBands () / 10);
 
   NS_LOG_INFO ("Testing for number of RBs:" << sm->GetNumBands () / 2);
 
@@ -132,14 +121,14 @@ PowerAllocationTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (totalPower - 10, transmittedTxPsd, 0.05,"If only half of RBs are active then only half of total power should be transmitted when uniform "
                              "power allocation over all bandwidth is being configured.");
 
-  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_BW and using RBs: " << activeRbs.size () << " transmitted power is: " << transmittedTxPsd);
+  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_BW and using RBs: " << activeRbs.Count () << " transmitted power is: " << transmittedTxPsd);
 
   txPsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity  (totalPower, activeRbs, sm, NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_USED);
   transmittedTxPsd = 10 * log10 (Integral (*txPsd) * 1000);
   NS_TEST_ASSERT_MSG_EQ_TOL (totalPower, transmittedTxPsd, 0.01, "If only half of RBs are active then the total power should be transmitted when uniform "
                              "power allocation over active RBs is being configured.");
 
-  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_USED and using RBs: " << activeRbs.size () << " transmitted power is: " << transmittedTxPsd);
+  NS_LOG_INFO ("Testing for power allocation type: UNIFORM_POWER_ALLOCATION_USED and using RBs: " << activeRbs.Count () << " transmitted power is: " << transmittedTxPsd);
 
 
   Simulator::Run ();
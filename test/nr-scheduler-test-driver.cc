@@ -0,0 +1,340 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-scheduler-test-driver.h"
+#include <ns3/simulator.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-short-bsr-ce.h>
+#include <ns3/nr-spectrum-value-helper.h>
+
+#include <algorithm>
+
+namespace ns3 {
+
+/**
+ * \brief CSCHED SAP user that ignores everything
+ */
+class NrSchedulerTestDriver::CschedSapUser : public NrMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf ([[maybe_unused]] const struct CschedCellConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeConfigCnf ([[maybe_unused]] const struct CschedUeConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedLcConfigCnf ([[maybe_unused]] const struct CschedLcConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedLcReleaseCnf ([[maybe_unused]] const struct CschedLcReleaseCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeReleaseCnf ([[maybe_unused]] const struct CschedUeReleaseCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeConfigUpdateInd ([[maybe_unused]] const struct CschedUeConfigUpdateIndParameters& params) override
+  {
+  }
+  virtual void CschedCellConfigUpdateInd ([[maybe_unused]] const struct CschedCellConfigUpdateIndParameters& params) override
+  {
+  }
+};
+
+/**
+ * \brief SCHED SAP user that forwards the decisions to the driver
+ */
+class NrSchedulerTestDriver::SchedSapUser : public NrMacSchedSapUser
+{
+public:
+  SchedSapUser (NrSchedulerTestDriver *driver, const Ptr<const SpectrumModel> &model,
+                const Time &slotPeriod)
+    : m_driver (driver),
+      m_model (model),
+      m_slotPeriod (slotPeriod)
+  {
+  }
+
+  virtual void SchedConfigInd (const struct SchedConfigIndParameters& params) override
+  {
+    m_driver->SchedConfigInd (params);
+  }
+  virtual Ptr<const SpectrumModel> GetSpectrumModel () const override
+  {
+    return m_model;
+  }
+  virtual uint32_t GetNumRbPerRbg () const override
+  {
+    return 1;
+  }
+  virtual uint8_t GetNumHarqProcess () const override
+  {
+    return 20;
+  }
+  virtual uint16_t GetBwpId () const override
+  {
+    return 0;
+  }
+  virtual uint16_t GetCellId () const override
+  {
+    return 1;
+  }
+  virtual uint32_t GetSymbolsPerSlot () const override
+  {
+    return 14;
+  }
+  virtual Time GetSlotPeriod () const override
+  {
+    return m_slotPeriod;
+  }
+
+private:
+  NrSchedulerTestDriver *m_driver {nullptr}; //!< The driver
+  Ptr<const SpectrumModel> m_model;          //!< The spectrum model
+  Time m_slotPeriod;                         //!< The slot period
+};
+
+NrSchedulerTestDriver::NrSchedulerTestDriver (const ObjectFactory &factory, uint32_t rbgs,
+                                              uint16_t numerology)
+  : m_current (0, 0, 0, static_cast<uint8_t> (numerology)),
+    m_slotPeriod (MicroSeconds (1000 >> numerology))
+{
+  double scs = 15e3 * static_cast<double> (1 << numerology);
+  auto model = NrSpectrumValueHelper::GetSpectrumModel (rbgs, 3.5e9, scs);
+
+  m_cschedSapUser = std::make_unique<CschedSapUser> ();
+  m_schedSapUser = std::make_unique<SchedSapUser> (this, model, m_slotPeriod);
+
+  m_sched = DynamicCast<NrMacSchedulerNs3> (factory.Create ());
+  NS_ABORT_MSG_IF (m_sched == nullptr, "Can't create a NrMacSchedulerNs3 from type " << factory.GetTypeId ());
+
+  m_sched->InstallDlAmc (CreateObject<NrAmc> ());
+  m_sched->InstallUlAmc (CreateObject<NrAmc> ());
+  m_sched->SetMacSchedSapUser (m_schedSapUser.get ());
+  m_sched->SetMacCschedSapUser (m_cschedSapUser.get ());
+
+  NrMacCschedSapProvider::CschedCellConfigReqParameters cellConf;
+  cellConf.m_dlBandwidth = static_cast<uint16_t> (rbgs);
+  cellConf.m_ulBandwidth = static_cast<uint16_t> (rbgs);
+  m_sched->GetMacCschedSapProvider ()->CschedCellConfigReq (cellConf);
+}
+
+NrSchedulerTestDriver::~NrSchedulerTestDriver ()
+{
+  m_sched->Dispose ();
+}
+
+Ptr<NrMacSchedulerNs3>
+NrSchedulerTestDriver::GetScheduler () const
+{
+  return m_sched;
+}
+
+void
+NrSchedulerTestDriver::AddUe (uint16_t rnti, uint16_t beam, uint8_t qci,
+                              LogicalChannelConfigListElement_s::QosBearerType_e type)
+{
+  NrMacCschedSapProvider::CschedUeConfigReqParameters ueConf;
+  ueConf.m_rnti = rnti;
+  ueConf.m_transmissionMode = 0;
+  ueConf.m_beamConfId = BeamConfId (BeamId (beam, 90.0), BeamId::GetEmptyBeamId ());
+  m_sched->GetMacCschedSapProvider ()->CschedUeConfigReq (ueConf);
+
+  LogicalChannelConfigListElement_s lc;
+  lc.m_logicalChannelIdentity = 3;
+  lc.m_logicalChannelGroup = 1;
+  lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+  lc.m_qosBearerType = type;
+  lc.m_qci = qci;
+  AddLc (rnti, lc);
+}
+
+void
+NrSchedulerTestDriver::AddLc (uint16_t rnti, const LogicalChannelConfigListElement_s &lc)
+{
+  NrMacCschedSapProvider::CschedLcConfigReqParameters lcConf;
+  lcConf.m_rnti = rnti;
+  lcConf.m_reconfigureFlag = false;
+  lcConf.m_logicalChannelConfigList.push_back (lc);
+  m_sched->GetMacCschedSapProvider ()->CschedLcConfigReq (lcConf);
+}
+
+void
+NrSchedulerTestDriver::ReleaseUe (uint16_t rnti)
+{
+  NrMacCschedSapProvider::CschedUeReleaseReqParameters params;
+  params.m_rnti = rnti;
+  m_sched->GetMacCschedSapProvider ()->CschedUeReleaseReq (params);
+
+  // As the MAC, do not report the feedback of a UE that does not exist anymore
+  m_dlHarq.erase (std::remove_if (m_dlHarq.begin (), m_dlHarq.end (),
+                                  [rnti] (const DlHarqInfo &h) { return h.m_rnti == rnti; }),
+                  m_dlHarq.end ());
+  m_ulHarq.erase (std::remove_if (m_ulHarq.begin (), m_ulHarq.end (),
+                                  [rnti] (const UlHarqInfo &h) { return h.m_rnti == rnti; }),
+                  m_ulHarq.end ());
+}
+
+void
+NrSchedulerTestDriver::DlBuffer (uint16_t rnti, uint32_t bytes, uint16_t holDelay, uint8_t lcId)
+{
+  NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+  rlc.m_rnti = rnti;
+  rlc.m_logicalChannelIdentity = lcId;
+  rlc.m_rlcTransmissionQueueSize = bytes;
+  rlc.m_rlcTransmissionQueueHolDelay = holDelay;
+  rlc.m_rlcRetransmissionQueueSize = 0;
+  rlc.m_rlcRetransmissionHolDelay = 0;
+  rlc.m_rlcStatusPduSize = 0;
+  m_sched->GetMacSchedSapProvider ()->SchedDlRlcBufferReq (rlc);
+}
+
+void
+NrSchedulerTestDriver::UlBsr (uint16_t rnti, uint32_t bytes)
+{
+  NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsrs;
+  bsrs.m_sfnSf = m_current;
+
+  MacCeElement bsr;
+  bsr.m_rnti = rnti;
+  bsr.m_macCeType = MacCeElement::BSR;
+  for (uint8_t lcg = 0; lcg < 4; ++lcg)
+    {
+      bsr.m_macCeValue.m_bufferStatus.push_back (lcg == 1 ? NrMacShortBsrCe::FromBytesToLevel (bytes) : 0);
+    }
+  bsrs.m_macCeList.push_back (bsr);
+  m_sched->GetMacSchedSapProvider ()->SchedUlMacCtrlInfoReq (bsrs);
+}
+
+void
+NrSchedulerTestDriver::Sr (uint16_t rnti)
+{
+  NrMacSchedSapProvider::SchedUlSrInfoReqParameters params;
+  params.m_snfSf = m_current;
+  params.m_srList.push_back (rnti);
+  m_sched->GetMacSchedSapProvider ()->SchedUlSrInfoReq (params);
+}
+
+void
+NrSchedulerTestDriver::DlCqi (const DlCqiInfo &cqi)
+{
+  NrMacSchedSapProvider::SchedDlCqiInfoReqParameters params;
+  params.m_sfnsf = m_current;
+  params.m_cqiList.push_back (cqi);
+  m_sched->GetMacSchedSapProvider ()->SchedDlCqiInfoReq (params);
+}
+
+void
+NrSchedulerTestDriver::DoSlot ()
+{
+  SfnSf target = m_current;
+  target.Add (2);
+
+  NrMacSchedSapProvider::SchedUlTriggerReqParameters ulParams;
+  ulParams.m_snfSf = target;
+  ulParams.m_slotType = LteNrTddSlotType::F;
+  ulParams.m_ulHarqInfoList.swap (m_ulHarq);
+
+  NrMacSchedSapProvider::SchedDlTriggerReqParameters dlParams;
+  dlParams.m_snfSf = target;
+  dlParams.m_slotType = LteNrTddSlotType::F;
+  dlParams.m_dlHarqInfoList.swap (m_dlHarq);
+
+  m_lastSlotStart = m_allocations.size ();
+  m_sched->GetMacSchedSapProvider ()->SchedUlTriggerReq (ulParams);
+  m_sched->GetMacSchedSapProvider ()->SchedDlTriggerReq (dlParams);
+
+  m_current.Add (1);
+  Simulator::Stop (m_slotPeriod);
+  Simulator::Run ();
+}
+
+const SfnSf &
+NrSchedulerTestDriver::GetCurrentSlot () const
+{
+  return m_current;
+}
+
+std::vector<NrSchedulerTestDriver::Allocation>
+NrSchedulerTestDriver::GetAllocations (uint16_t rnti, bool isDl) const
+{
+  std::vector<Allocation> ret;
+  for (const auto & alloc : m_allocations)
+    {
+      if (alloc.m_dci->m_rnti == rnti && (alloc.m_dci->m_format == DciInfoElementTdma::DL) == isDl)
+        {
+          ret.push_back (alloc);
+        }
+    }
+  return ret;
+}
+
+std::vector<NrSchedulerTestDriver::Allocation>
+NrSchedulerTestDriver::GetLastAllocations (bool isDl) const
+{
+  std::vector<Allocation> ret;
+  for (size_t i = m_lastSlotStart; i < m_allocations.size (); ++i)
+    {
+      if ((m_allocations.at (i).m_dci->m_format == DciInfoElementTdma::DL) == isDl)
+        {
+          ret.push_back (m_allocations.at (i));
+        }
+    }
+  return ret;
+}
+
+void
+NrSchedulerTestDriver::SchedConfigInd (const NrMacSchedSapUser::SchedConfigIndParameters &params)
+{
+  for (const auto & varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+      const auto & dci = varTti.m_dci;
+      if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+          continue;
+        }
+
+      m_allocations.push_back (Allocation {params.m_sfnSf, dci, varTti.m_rlcPduInfo});
+
+      if (dci->m_format == DciInfoElementTdma::DL)
+        {
+          DlHarqInfo harq;
+          harq.m_rnti = dci->m_rnti;
+          harq.m_harqProcessId = dci->m_harqProcess;
+          harq.m_bwpIndex = 0;
+          for (uint8_t stream = 0; stream < dci->m_tbSize.size (); ++stream)
+            {
+              harq.m_harqStatus.push_back (dci->m_tbSize.at (stream) == 0 ? DlHarqInfo::NONE : DlHarqInfo::ACK);
+              harq.m_numRetx.push_back (dci->m_rv.at (stream));
+            }
+          m_dlHarq.push_back (harq);
+        }
+      else
+        {
+          UlHarqInfo harq;
+          harq.m_rnti = dci->m_rnti;
+          harq.m_harqProcessId = dci->m_harqProcess;
+          harq.m_bwpIndex = 0;
+          harq.m_numRetx = dci->m_rv.at (0);
+          harq.m_receptionStatus = UlHarqInfo::Ok;
+          m_ulHarq.push_back (harq);
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,185 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_SCHEDULER_TEST_DRIVER_H
+#define NR_SCHEDULER_TEST_DRIVER_H
+
+#include <ns3/object-factory.h>
+#include <ns3/nr-mac-scheduler-ns3.h>
+#include <ns3/nr-mac-sched-sap.h>
+#include <ns3/nr-mac-csched-sap.h>
+
+#include <memory>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \file nr-scheduler-test-driver.h
+ * \ingroup test
+ *
+ * \brief A stand-in for the gNB MAC, used by the unit tests of the schedulers
+ */
+
+/**
+ * \ingroup test
+ * \brief Drive a scheduler through its SAP interfaces, as the gNB MAC does
+ *
+ * The driver creates the scheduler from a factory (with the type and the
+ * attributes of the test), configures a cell, and lets the test add UEs,
+ * report buffers and CQIs, and trigger the slots. Each call to DoSlot()
+ * asks the scheduler for the UL and the DL of the slot two slots
+ * ahead (all the slots are of type F), stores the data DCIs it returns,
+ * and then advances the simulation time by one slot. All the data DCIs
+ * are acknowledged in the next trigger.
+ *
+ * The test must call Simulator::Destroy () when it has finished.
+ */
+class NrSchedulerTestDriver
+{
+public:
+  /**
+   * \brief A data allocation returned by the scheduler
+   */
+  struct Allocation
+  {
+    SfnSf m_sfnSf;                             //!< Slot of the allocation
+    std::shared_ptr<DciInfoElementTdma> m_dci; //!< The DCI
+    std::vector<std::vector<RlcPduInfo> > m_rlcPduInfo; //!< The RLC PDUs (DL only)
+  };
+
+  /**
+   * \brief Create the scheduler and configure the cell
+   * \param factory factory of the scheduler, with its attributes
+   * \param rbgs bandwidth, in RBG of one RB
+   * \param numerology numerology of the cell
+   */
+  NrSchedulerTestDriver (const ObjectFactory &factory, uint32_t rbgs, uint16_t numerology = 0);
+
+  /**
+   * \brief ~NrSchedulerTestDriver
+   */
+  ~NrSchedulerTestDriver ();
+
+  /**
+   * \return the scheduler
+   */
+  Ptr<NrMacSchedulerNs3> GetScheduler () const;
+
+  /**
+   * \brief Add a UE with one LC (id 3, LCG 1) in both directions
+   * \param rnti RNTI of the UE
+   * \param beam sector of the beam of the UE
+   * \param qci QCI of the LC
+   * \param type bearer type of the LC
+   */
+  void AddUe (uint16_t rnti, uint16_t beam = 0, uint8_t qci = 9,
+              LogicalChannelConfigListElement_s::QosBearerType_e type = LogicalChannelConfigListElement_s::QBT_NON_GBR);
+
+  /**
+   * \brief Add a LC to a UE
+   * \param rnti RNTI of the UE
+   * \param lc the configuration of the LC
+   */
+  void AddLc (uint16_t rnti, const LogicalChannelConfigListElement_s &lc);
+
+  /**
+   * \brief Release a UE
+   * \param rnti RNTI of the UE
+   */
+  void ReleaseUe (uint16_t rnti);
+
+  /**
+   * \brief Report the DL RLC buffer of a LC
+   * \param rnti RNTI of the UE
+   * \param bytes bytes in the transmission queue
+   * \param holDelay head of line delay, in ms
+   * \param lcId id of the LC
+   */
+  void DlBuffer (uint16_t rnti, uint32_t bytes, uint16_t holDelay = 0, uint8_t lcId = 3);
+
+  /**
+   * \brief Report a UL BSR
+   * \param rnti RNTI of the UE
+   * \param bytes bytes in the LCG 1
+   */
+  void UlBsr (uint16_t rnti, uint32_t bytes);
+
+  /**
+   * \brief Report a SR
+   * \param rnti RNTI of the UE
+   */
+  void Sr (uint16_t rnti);
+
+  /**
+   * \brief Report a DL CQI
+   * \param cqi the CQI
+   */
+  void DlCqi (const DlCqiInfo &cqi);
+
+  /**
+   * \brief Trigger the scheduling of the slot two slots ahead, and advance the
+   * time by one slot
+   */
+  void DoSlot ();
+
+  /**
+   * \return the current slot
+   */
+  const SfnSf & GetCurrentSlot () const;
+
+  /**
+   * \brief Get the data allocations of a UE, from the beginning
+   * \param rnti RNTI of the UE
+   * \param isDl true for the DL allocations, false for the UL ones
+   * \return the allocations
+   */
+  std::vector<Allocation> GetAllocations (uint16_t rnti, bool isDl) const;
+
+  /**
+   * \brief Get the data allocations of the last slot scheduled, in the order
+   * returned by the scheduler
+   * \param isDl true for the DL allocations, false for the UL ones
+   * \return the allocations
+   */
+  std::vector<Allocation> GetLastAllocations (bool isDl) const;
+
+  /**
+   * \brief Called by the SAP user
+   * \param params the decisions of the scheduler
+   */
+  void SchedConfigInd (const NrMacSchedSapUser::SchedConfigIndParameters &params);
+
+private:
+  class CschedSapUser;
+  class SchedSapUser;
+
+  Ptr<NrMacSchedulerNs3> m_sched;                //!< The scheduler
+  std::unique_ptr<CschedSapUser> m_cschedSapUser; //!< CSCHED SAP user
+  std::unique_ptr<SchedSapUser> m_schedSapUser;   //!< SCHED SAP user
+  SfnSf m_current;                               //!< Current slot
+  Time m_slotPeriod;                             //!< Slot period
+  std::vector<Allocation> m_allocations;         //!< All the data allocations
+  size_t m_lastSlotStart {0};                    //!< First allocation of the last slot
+  std::vector<DlHarqInfo> m_dlHarq;              //!< DL feedback for the next trigger
+  std::vector<UlHarqInfo> m_ulHarq;              //!< UL feedback for the next trigger
+};
+
+} // namespace ns3
+
+#endif // NR_SCHEDULER_TEST_DRIVER_H
@@ -110,11 +110,7 @@ SetNoisePsdTestCase::DoRun (void)
   uint32_t rbNum = m_bandwidth / (12 * subcarrierSpacing);
   Ptr<const SpectrumModel> sm =  NrSpectrumValueHelper::GetSpectrumModel (rbNum, centerFrequency, subcarrierSpacing);
 
-  std::vector<int> activeRbs;
-  for (size_t rbId = 0; rbId < sm->GetNumBands (); rbId++)
-    {
-      activeRbs.push_back (rbId);
-    }
+  NrRbMask activeRbs (sm->GetNumBands (), true);
 
   Ptr<const SpectrumValue> txPsd = NrSpectrumValueHelper::CreateTxPowerSpectralDensity  (m_txPower, activeRbs, sm, NrSpectrumValueHelper::UNIFORM_POWER_ALLOCATION_BW);
   Ptr<const SpectrumValue> nsv0first = NrSpectrumValueHelper::CreateNoisePowerSpectralDensity (m_noiseFigureFirst, sm);
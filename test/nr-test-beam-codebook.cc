@@ -0,0 +1,127 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/nr-beam-codebook.h>
+
+/**
+ * \file nr-test-beam-codebook.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the shared beam codebooks. The beams of a codebook
+ * are compared with the ones computed by CreateDirectionalBfv and
+ * CreateQuasiOmniBfv, and the codebooks are checked to be shared only
+ * by the arrays with the same configuration.
+ */
+namespace ns3 {
+
+class TestNrBeamCodebookTestCase : public TestCase
+{
+public:
+  TestNrBeamCodebookTestCase (uint32_t numRows, uint32_t numColumns, double angleStep,
+                              const std::string &name)
+    : TestCase (name),
+      m_numRows (numRows),
+      m_numColumns (numColumns),
+      m_angleStep (angleStep)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Create an antenna array
+   * \param downtilt the downtilt of the array, in radians
+   * \return the array
+   */
+  Ptr<UniformPlanarArray> CreateArray (double downtilt) const;
+  uint32_t m_numRows {0};    //!< Rows of the array
+  uint32_t m_numColumns {0}; //!< Columns of the array
+  double m_angleStep {0.0};  //!< Angle step of the cell scan
+};
+
+Ptr<UniformPlanarArray>
+TestNrBeamCodebookTestCase::CreateArray (double downtilt) const
+{
+  Ptr<UniformPlanarArray> array = CreateObject<UniformPlanarArray> ();
+  array->SetAttribute ("NumRows", UintegerValue (m_numRows));
+  array->SetAttribute ("NumColumns", UintegerValue (m_numColumns));
+  array->SetAttribute ("DowntiltAngle", DoubleValue (downtilt));
+  return array;
+}
+
+void
+TestNrBeamCodebookTestCase::DoRun ()
+{
+  Ptr<UniformPlanarArray> a = CreateArray (0.0);
+  Ptr<UniformPlanarArray> b = CreateArray (0.0);
+  Ptr<UniformPlanarArray> c = CreateArray (0.1);
+  std::vector<double> elevations = NrBeamCodebook::GetCellScanElevations (m_angleStep);
+
+  Ptr<const NrBeamCodebook> codebook = NrBeamCodebook::GetSectorCodebook (a, elevations);
+  NS_TEST_ASSERT_MSG_EQ (codebook->GetNumBeams (), elevations.size () * (m_numRows + 1),
+                         "Wrong number of beams");
+  NS_TEST_ASSERT_MSG_EQ (codebook->GetNumElements (), a->GetNumberOfElements (),
+                         "Wrong number of elements");
+
+  size_t beam = 0;
+  for (double elevation : elevations)
+    {
+      for (uint16_t sector = 0; sector <= m_numRows; ++sector, ++beam)
+        {
+          complexVector_t expected = CreateDirectionalBfv (a, sector, elevation);
+          NS_TEST_ASSERT_MSG_EQ ((codebook->GetBeamId (beam) == BeamId (sector, elevation)), true,
+                                 "Wrong id of beam " << beam);
+          NS_TEST_ASSERT_MSG_EQ ((codebook->GetBeamformingVector (beam).first == expected), true,
+                                 "Wrong weights of beam " << beam);
+          NS_TEST_ASSERT_MSG_EQ ((codebook->GetWeights (beam)[0] == expected.at (0)), true,
+                                 "Wrong weights of beam " << beam);
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (NrBeamCodebook::GetSectorCodebook (b, elevations), codebook,
+                         "Arrays with the same configuration should share the codebook");
+  NS_TEST_ASSERT_MSG_NE (NrBeamCodebook::GetSectorCodebook (c, elevations), codebook,
+                         "Arrays with a different downtilt should not share the codebook");
+  NS_TEST_ASSERT_MSG_NE (NrBeamCodebook::GetSectorCodebook (a, NrBeamCodebook::GetCellScanElevations (m_angleStep * 2)),
+                         codebook, "Different elevations should not share the codebook");
+
+  Ptr<const NrBeamCodebook> omni = NrBeamCodebook::GetQuasiOmniCodebook (a);
+  NS_TEST_ASSERT_MSG_EQ (omni->GetNumBeams (), 1, "Wrong number of quasi-omni beams");
+  NS_TEST_ASSERT_MSG_EQ ((omni->GetBeamformingVector (0).first == CreateQuasiOmniBfv (m_numRows, m_numColumns)),
+                         true, "Wrong quasi-omni beam");
+  NS_TEST_ASSERT_MSG_EQ ((omni->GetBeamId (0) == OMNI_BEAM_ID), true, "Wrong quasi-omni beam id");
+  NS_TEST_ASSERT_MSG_EQ (NrBeamCodebook::GetQuasiOmniCodebook (b), omni,
+                         "Arrays with the same configuration should share the quasi-omni beam");
+}
+
+class TestNrBeamCodebook : public TestSuite
+{
+public:
+  TestNrBeamCodebook () : TestSuite ("nr-test-beam-codebook", UNIT)
+  {
+    AddTestCase (new TestNrBeamCodebookTestCase (2, 2, 30, "2x2 array, 30 degrees step"), QUICK);
+    AddTestCase (new TestNrBeamCodebookTestCase (4, 8, 10, "4x8 array, 10 degrees step"), QUICK);
+    AddTestCase (new TestNrBeamCodebookTestCase (8, 8, 22.5, "8x8 array, 22.5 degrees step"), QUICK);
+  }
+};
+
+static TestNrBeamCodebook testNrBeamCodebook; //!< Beam codebook test
+
+}  // namespace ns3
@@ -0,0 +1,191 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+#include <ns3/node.h>
+#include <ns3/simple-net-device.h>
+#include <ns3/uniform-planar-array.h>
+#include <ns3/beam-manager.h>
+
+/**
+ * \file nr-test-beam-manager.cc
+ * \ingroup test
+ *
+ * \brief Test the table of beams of BeamManager.
+ *
+ * Some devices save their beams: the devices with the same beam (same id
+ * and same weights) must share a handle, a beam must be freed when no
+ * device references it anymore, and its handle reused for a new beam. The
+ * antenna must always have the weights of the beam of the current handle,
+ * also when the current beam is freed, and the quasi-omni beam must be
+ * recomputed when the size of the antenna changes.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Check the handles and the weights of the beams of a BeamManager
+ */
+class NrBeamManagerTestCase : public TestCase
+{
+public:
+  NrBeamManagerTestCase () : TestCase ("Table of beams of BeamManager") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrBeamManagerTestCase::DoRun ()
+{
+  Ptr<UniformPlanarArray> antenna = CreateObject<UniformPlanarArray> ();
+  antenna->SetAttribute ("NumRows", UintegerValue (2));
+  antenna->SetAttribute ("NumColumns", UintegerValue (2));
+
+  Ptr<BeamManager> bm = CreateObject<BeamManager> ();
+  bm->Configure (antenna);
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), BeamManager::OMNI_BEAM_HANDLE,
+                         "The antenna must start quasi-omni");
+  NS_TEST_ASSERT_MSG_EQ ((antenna->GetBeamformingVector () == CreateQuasiOmniBfv (2, 2)), true,
+                         "Wrong quasi-omni weights");
+
+  std::vector<Ptr<NetDevice> > devs;
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      dev->SetNode (CreateObject<Node> ());
+      devs.push_back (dev);
+    }
+
+  auto beam = [antenna] (uint16_t sector, uint16_t idSector) {
+    return std::make_pair (CreateDirectionalBfv (antenna, sector, 90.0), BeamId (idSector, 90.0));
+  };
+  const BeamformingVector a = beam (0, 0);
+  const BeamformingVector b = beam (1, 1);
+  const BeamformingVector c = beam (2, 2);
+  const BeamformingVector aOther = beam (3, 0); // Same id of a, other weights
+
+  // The devices with the same beam share its handle
+  bm->SaveBeamformingVector (a, devs.at (0));
+  bm->SaveBeamformingVector (a, devs.at (1));
+  bm->SaveBeamformingVector (b, devs.at (2));
+  const BeamManager::BeamHandle hA = bm->GetBeamHandle (devs.at (0));
+  const BeamManager::BeamHandle hB = bm->GetBeamHandle (devs.at (2));
+  NS_TEST_ASSERT_MSG_NE (hA, BeamManager::OMNI_BEAM_HANDLE, "A beam can't use the quasi-omni handle");
+  NS_TEST_ASSERT_MSG_EQ (bm->GetBeamHandle (devs.at (1)), hA, "The same beam must be stored once");
+  NS_TEST_ASSERT_MSG_NE (hB, hA, "Different beams must have different handles");
+  NS_TEST_ASSERT_MSG_EQ (bm->GetBeamHandle (devs.at (4)), BeamManager::INVALID_BEAM_HANDLE,
+                         "A device without beam has no handle");
+
+  // Saving the same beam again keeps the handle
+  bm->SaveBeamformingVector (a, devs.at (0));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetBeamHandle (devs.at (0)), hA, "Saving the same beam must keep its handle");
+
+  // The weights are set in the antenna when the beam changes
+  bm->ChangeBeamformingVector (devs.at (0));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), hA, "Wrong current beam");
+  NS_TEST_ASSERT_MSG_EQ ((antenna->GetBeamformingVector () == a.first), true, "Wrong weights of beam a");
+  bm->ChangeBeamformingVector (devs.at (2));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), hB, "Wrong current beam");
+  NS_TEST_ASSERT_MSG_EQ ((antenna->GetBeamformingVector () == b.first), true, "Wrong weights of beam b");
+  NS_TEST_ASSERT_MSG_EQ (bm->GetBeamId (devs.at (1)), a.second, "Wrong beam id");
+
+  // Same id, other weights: another beam, and the other device keeps a
+  bm->SaveBeamformingVector (aOther, devs.at (1));
+  const BeamManager::BeamHandle hAOther = bm->GetBeamHandle (devs.at (1));
+  NS_TEST_ASSERT_MSG_NE (hAOther, hA, "Beams with the same id and different weights must be different");
+  NS_TEST_ASSERT_MSG_EQ (bm->GetBeamHandle (devs.at (0)), hA, "The beam of the other device must be kept");
+  NS_TEST_ASSERT_MSG_EQ ((bm->GetBeamformingVector (devs.at (0)) == a.first), true, "Beam a changed");
+  NS_TEST_ASSERT_MSG_EQ ((bm->GetBeamformingVector (devs.at (1)) == aOther.first), true, "Wrong weights");
+
+  // The last device of a moves to b: a is freed, and its handle is reused
+  bm->SaveBeamformingVector (b, devs.at (0));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetBeamHandle (devs.at (0)), hB, "The device must share the handle of b");
+  bm->SaveBeamformingVector (c, devs.at (3));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetBeamHandle (devs.at (3)), hA, "The handle of a freed beam must be reused");
+  NS_TEST_ASSERT_MSG_EQ ((bm->GetBeamformingVector (devs.at (3)) == c.first), true, "Wrong weights of beam c");
+
+  // A freed beam is not found anymore: saving a again needs a new handle
+  bm->SaveBeamformingVector (a, devs.at (4));
+  const BeamManager::BeamHandle hANew = bm->GetBeamHandle (devs.at (4));
+  NS_TEST_ASSERT_MSG_NE (hANew, hA, "A freed beam must not be found");
+  NS_TEST_ASSERT_MSG_NE (hANew, hB, "A freed beam must not be found");
+  NS_TEST_ASSERT_MSG_NE (hANew, hAOther, "A freed beam must not be found");
+
+  // Free the current beam: the antenna keeps its weights, but the handle is
+  // not valid anymore, and the next change must write the weights
+  bm->ChangeBeamformingVector (devs.at (1));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), hAOther, "Wrong current beam");
+  bm->SaveBeamformingVector (c, devs.at (1));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), BeamManager::INVALID_BEAM_HANDLE,
+                         "The current beam has been freed");
+  bm->SaveBeamformingVector (beam (4, 4), devs.at (2));
+  bm->SaveBeamformingVector (beam (4, 4), devs.at (0));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetBeamHandle (devs.at (0)), hAOther, "The handle of a freed beam must be reused");
+  bm->ChangeBeamformingVector (devs.at (0));
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), hAOther, "Wrong current beam");
+  NS_TEST_ASSERT_MSG_EQ ((antenna->GetBeamformingVector () == beam (4, 4).first), true,
+                         "The weights of the new beam in a reused handle must be written");
+
+  // Quasi-omni: the fast path keeps the handle, and a change of the size of
+  // the antenna recomputes the weights
+  bm->ChangeToQuasiOmniBeamformingVector ();
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), BeamManager::OMNI_BEAM_HANDLE, "Expected quasi-omni");
+  NS_TEST_ASSERT_MSG_EQ ((antenna->GetBeamformingVector () == CreateQuasiOmniBfv (2, 2)), true,
+                         "Wrong quasi-omni weights");
+  bm->ChangeToQuasiOmniBeamformingVector ();
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), BeamManager::OMNI_BEAM_HANDLE, "Expected quasi-omni");
+
+  antenna->SetAttribute ("NumRows", UintegerValue (4));
+  bm->ChangeToQuasiOmniBeamformingVector ();
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), BeamManager::OMNI_BEAM_HANDLE, "Expected quasi-omni");
+  NS_TEST_ASSERT_MSG_EQ ((antenna->GetBeamformingVector () == CreateQuasiOmniBfv (4, 2)), true,
+                         "The quasi-omni weights must follow the size of the antenna");
+
+  // A device without beam uses the predefined beam, if any
+  Ptr<SimpleNetDevice> unknown = CreateObject<SimpleNetDevice> ();
+  bm->ChangeBeamformingVector (unknown);
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), BeamManager::OMNI_BEAM_HANDLE,
+                         "Without predefined beam, an unknown device must use the quasi-omni beam");
+  bm->SetPredefinedBeam (5, 90.0);
+  NS_TEST_ASSERT_MSG_NE (bm->GetBeamHandle (unknown), BeamManager::INVALID_BEAM_HANDLE,
+                         "An unknown device must use the predefined beam");
+  bm->ChangeBeamformingVector (unknown);
+  NS_TEST_ASSERT_MSG_EQ (bm->GetCurrentBeamHandle (), bm->GetBeamHandle (unknown), "Wrong current beam");
+  NS_TEST_ASSERT_MSG_EQ ((antenna->GetBeamformingVector () == CreateDirectionalBfv (antenna, 5, 90.0)), true,
+                         "Wrong weights of the predefined beam");
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for BeamManager
+ */
+class NrBeamManagerTestSuite : public TestSuite
+{
+public:
+  NrBeamManagerTestSuite ()
+    : TestSuite ("nr-test-beam-manager", UNIT)
+  {
+    AddTestCase (new NrBeamManagerTestCase (), TestCase::QUICK);
+  }
+};
+
+static NrBeamManagerTestSuite nrBeamManagerTestSuite; //!< BeamManager test suite
+
+} // namespace ns3
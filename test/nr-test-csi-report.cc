@@ -0,0 +1,222 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/mobility-model.h>
+#include <ns3/node.h>
+#include <ns3/nr-helper.h>
+#include <ns3/nr-ue-phy.h>
+#include <ns3/nr-control-messages.h>
+#include "nr-trace-comparison-scenario.h"
+
+/**
+ * \file nr-test-csi-report.cc
+ * \ingroup test
+ *
+ * \brief Test the periodic and the SINR-triggered DL CSI reports of the UE
+ * (attributes CsiReportPeriodicity and CsiSinrTriggerThreshold of
+ * NrUePhy).
+ *
+ * A single UE receives DL data every two slots. The test counts the DL
+ * CQI messages sent by the UE, and the slots in which they are sent:
+ * without a period, each reception is reported; with a period, the
+ * reports between two periods are suppressed, but one is sent in each
+ * period. With a period longer than the simulation, only the first
+ * reception is reported, unless the SINR crosses the threshold: the UE is
+ * moved away from the gNB, and a report must follow the movement.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Check the slots of the CSI reports of a UE
+ */
+class NrCsiReportTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param periodicity value of CsiReportPeriodicity
+   * \param threshold value of CsiSinrTriggerThreshold
+   * \param move if true, move the UE away from the gNB
+   */
+  NrCsiReportTestCase (uint16_t periodicity, double threshold, bool move)
+    : TestCase ("CSI reports with period " + std::to_string (periodicity) + ", threshold " +
+                std::to_string (threshold) + " dB" + (move ? ", moving UE" : "")),
+      m_periodicity (periodicity),
+      m_threshold (threshold),
+      m_move (move)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Record the DL CQI messages sent by the UE
+   * \param sfn slot of the transmission
+   * \param nodeId node id
+   * \param rnti RNTI of the UE
+   * \param bwpId BWP id
+   * \param msg the message
+   */
+  void TxedCtrlMsgs (SfnSf sfn, uint16_t nodeId, uint16_t rnti, uint8_t bwpId,
+                     Ptr<const NrControlMessage> msg);
+
+  /**
+   * \brief Count the DL receptions of the UE
+   * \param cellId cell id
+   * \param rnti RNTI of the UE
+   * \param sinr average SINR of the reception
+   * \param bwpId BWP id
+   * \param streamId stream id
+   */
+  void DlDataSinr (uint16_t cellId, uint16_t rnti, double sinr, uint16_t bwpId, uint8_t streamId);
+
+  uint16_t m_periodicity {0};        //!< CsiReportPeriodicity
+  double m_threshold {0.0};          //!< CsiSinrTriggerThreshold
+  bool m_move {false};               //!< Move the UE
+  std::vector<uint64_t> m_reports;   //!< Normalized slots of the DL CQI messages
+  uint32_t m_receptions {0};         //!< Number of DL receptions
+};
+
+void
+NrCsiReportTestCase::TxedCtrlMsgs (SfnSf sfn, [[maybe_unused]] uint16_t nodeId,
+                                   [[maybe_unused]] uint16_t rnti, [[maybe_unused]] uint8_t bwpId,
+                                   Ptr<const NrControlMessage> msg)
+{
+  if (msg->GetMessageType () == NrControlMessage::DL_CQI)
+    {
+      m_reports.push_back (sfn.Normalize ());
+    }
+}
+
+void
+NrCsiReportTestCase::DlDataSinr ([[maybe_unused]] uint16_t cellId, [[maybe_unused]] uint16_t rnti,
+                                 [[maybe_unused]] double sinr, [[maybe_unused]] uint16_t bwpId,
+                                 [[maybe_unused]] uint8_t streamId)
+{
+  m_receptions++;
+}
+
+void
+NrCsiReportTestCase::DoRun ()
+{
+  NrTraceComparisonScenario scenario;
+  scenario.m_gnbNum = 1;
+  scenario.m_uesPerGnb = 1;
+  scenario.m_isUplink = false;
+  scenario.m_appStart = MilliSeconds (400);
+  scenario.m_simTime = MilliSeconds (700);
+
+  // The slot of 0.5 ms in which the UE is moved
+  const Time moveTime = MilliSeconds (550);
+  const uint64_t moveSlot = moveTime.GetMicroSeconds () / 500;
+
+  scenario.m_onInstalled = [this, moveTime] ([[maybe_unused]] const NetDeviceContainer &gnbDevs,
+                                             const NetDeviceContainer &ueDevs)
+    {
+      Ptr<NrUePhy> phy = NrHelper::GetUePhy (ueDevs.Get (0), 0);
+      phy->TraceConnectWithoutContext ("UePhyTxedCtrlMsgsTrace",
+                                       MakeCallback (&NrCsiReportTestCase::TxedCtrlMsgs, this));
+      phy->TraceConnectWithoutContext ("DlDataSinr",
+                                       MakeCallback (&NrCsiReportTestCase::DlDataSinr, this));
+      if (m_move)
+        {
+          // From about 11 m to about 60 m from the gNB: the SINR drops by
+          // more than 10 dB
+          Ptr<MobilityModel> mobility = ueDevs.Get (0)->GetNode ()->GetObject<MobilityModel> ();
+          Simulator::Schedule (moveTime, &MobilityModel::SetPosition, mobility, Vector (60.0, 10.0, 1.5));
+        }
+    };
+
+  scenario.Run ([this] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetUePhyAttribute ("CsiReportPeriodicity", UintegerValue (m_periodicity));
+    nrHelper->SetUePhyAttribute ("CsiSinrTriggerThreshold", DoubleValue (m_threshold));
+  });
+
+  NS_TEST_ASSERT_MSG_GT (m_receptions, 100, "The UE did not receive enough DL data");
+  NS_TEST_ASSERT_MSG_GT (m_reports.size (), 0, "The UE did not send any CSI report");
+
+  if (m_periodicity == 0)
+    {
+      // One report per reception; the last ones may still be in the queue
+      // of the CTRL messages at the end of the simulation
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (m_reports.size (), m_receptions, "More reports than receptions");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (m_reports.size () + 4, m_receptions, "Each reception must be reported");
+      return;
+    }
+
+  if (! m_move)
+    {
+      // The reports are suppressed between two periods, but the first
+      // reception of each period is reported (one every two slots)
+      NS_TEST_ASSERT_MSG_GT (m_reports.size (), 1, "The periodic reports must be sent");
+      for (size_t i = 1; i < m_reports.size (); ++i)
+        {
+          uint64_t gap = m_reports.at (i) - m_reports.at (i - 1);
+          NS_TEST_ASSERT_MSG_GT_OR_EQ (gap, m_periodicity, "Report " << i << " sent before the period");
+          NS_TEST_ASSERT_MSG_LT_OR_EQ (gap, m_periodicity + 4u, "Report " << i << " not sent in its period");
+        }
+      return;
+    }
+
+  // The period is longer than the simulation: only the first reception is
+  // reported, and then only if the SINR moved more than the threshold
+  NS_TEST_ASSERT_MSG_LT (m_reports.front (), moveSlot, "The first reception must be reported");
+  size_t beforeMove = 0;
+  for (uint64_t slot : m_reports)
+    {
+      beforeMove += slot < moveSlot ? 1 : 0;
+    }
+  NS_TEST_ASSERT_MSG_EQ (beforeMove, 1, "With a stable SINR, the reports must be suppressed");
+
+  if (m_threshold == 0.0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_reports.size (), 1, "Without threshold, the SINR must not trigger reports");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT (m_reports.size (), 1, "The change of SINR must trigger a report");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (m_reports.at (1), moveSlot + 10,
+                                   "The report must follow the change of SINR");
+    }
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the DL CSI reports of the UE
+ */
+class NrCsiReportTestSuite : public TestSuite
+{
+public:
+  NrCsiReportTestSuite ()
+    : TestSuite ("nr-test-csi-report", SYSTEM)
+  {
+    AddTestCase (new NrCsiReportTestCase (0, 0.0, false), TestCase::QUICK);
+    AddTestCase (new NrCsiReportTestCase (20, 0.0, false), TestCase::QUICK);
+    AddTestCase (new NrCsiReportTestCase (UINT16_MAX, 0.0, true), TestCase::QUICK);
+    AddTestCase (new NrCsiReportTestCase (UINT16_MAX, 3.0, true), TestCase::QUICK);
+  }
+};
+
+static NrCsiReportTestSuite nrCsiReportTestSuite; //!< CSI report test suite
+
+} // namespace ns3
@@ -0,0 +1,194 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/mobility-model.h>
+#include <ns3/node.h>
+#include <ns3/nr-helper.h>
+#include <ns3/nr-ue-phy.h>
+#include "nr-trace-comparison-scenario.h"
+
+#include <map>
+
+/**
+ * \file nr-test-dl-ctrl-addressed-only.cc
+ * \ingroup test
+ *
+ * \brief Test the attribute DlCtrlAddressedOnly of NrSpectrumPhy.
+ *
+ * Two UEs of a cell have a DL packet every 20 ms, so most DL CTRL signals
+ * have no DCI for them. With the attribute, the UEs must receive fewer CTRL
+ * messages, but the same DCIs and the same packets, at the same times, as
+ * without the attribute. The DL CTRL signals that are not received must
+ * still be measured: the UEs must trace the same number of DL CTRL SINR,
+ * and the RSRP of a UE moved between two of its packets, when no DL CTRL
+ * addresses it, must be updated.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Compare a run with and without DlCtrlAddressedOnly
+ */
+class NrDlCtrlAddressedOnlyTestCase : public TestCase
+{
+public:
+  NrDlCtrlAddressedOnlyTestCase () : TestCase ("DL CTRL received only by the UEs addressed") {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief The outcome of a run
+   */
+  struct RunResult
+  {
+    std::vector<std::string> m_ctrl;       //!< CTRL messages received by the UEs
+    std::vector<std::string> m_others;     //!< DCIs received by the UEs, and packets
+    std::map<uint16_t, uint32_t> m_dlCtrlSinr; //!< DL CTRL SINR traced by each UE, per RNTI
+    double m_rsrpBeforeMove {0.0};         //!< RSRP of UE 0 before its movement
+    double m_rsrpAfterMove {0.0};          //!< RSRP of UE 0 after its movement
+  };
+
+  /**
+   * \brief Run the scenario
+   * \param addressedOnly value of DlCtrlAddressedOnly
+   * \return the outcome of the run
+   */
+  RunResult Run (bool addressedOnly);
+
+  /**
+   * \brief Count the DL CTRL SINR traced by the UEs
+   * \param cellId cell id
+   * \param rnti RNTI of the UE
+   * \param sinr average SINR of the DL CTRL
+   * \param bwpId BWP id
+   * \param streamId stream id
+   */
+  void DlCtrlSinr (uint16_t cellId, uint16_t rnti, double sinr, uint16_t bwpId, uint8_t streamId);
+
+  RunResult *m_result {nullptr}; //!< Outcome of the current run
+};
+
+void
+NrDlCtrlAddressedOnlyTestCase::DlCtrlSinr ([[maybe_unused]] uint16_t cellId, uint16_t rnti,
+                                           [[maybe_unused]] double sinr, [[maybe_unused]] uint16_t bwpId,
+                                           [[maybe_unused]] uint8_t streamId)
+{
+  m_result->m_dlCtrlSinr[rnti]++;
+}
+
+NrDlCtrlAddressedOnlyTestCase::RunResult
+NrDlCtrlAddressedOnlyTestCase::Run (bool addressedOnly)
+{
+  NrTraceComparisonScenario scenario;
+  scenario.m_gnbNum = 1;
+  scenario.m_uesPerGnb = 2;
+  scenario.m_isUplink = false;
+  scenario.m_packetInterval = MilliSeconds (20);
+
+  // The packets arrive at 400 ms + k * 20 ms: UE 0 is moved, and its RSRP
+  // sampled, between two of its packets
+  const Time moveTime = MilliSeconds (545);
+
+  RunResult result;
+  m_result = &result;
+  scenario.m_onInstalled = [this, &result, moveTime] ([[maybe_unused]] const NetDeviceContainer &gnbDevs,
+                                                      const NetDeviceContainer &ueDevs)
+    {
+      for (uint32_t i = 0; i < ueDevs.GetN (); ++i)
+        {
+          NrHelper::GetUePhy (ueDevs.Get (i), 0)->TraceConnectWithoutContext (
+            "DlCtrlSinr", MakeCallback (&NrDlCtrlAddressedOnlyTestCase::DlCtrlSinr, this));
+        }
+
+      Ptr<NrUePhy> phy = NrHelper::GetUePhy (ueDevs.Get (0), 0);
+      Ptr<MobilityModel> mobility = ueDevs.Get (0)->GetNode ()->GetObject<MobilityModel> ();
+      Simulator::Schedule (moveTime - MilliSeconds (1), [&result, phy] () {
+        result.m_rsrpBeforeMove = phy->GetRsrp ();
+      });
+      Simulator::Schedule (moveTime, &MobilityModel::SetPosition, mobility, Vector (60.0, 10.0, 1.5));
+      Simulator::Schedule (moveTime + MilliSeconds (3), [&result, phy] () {
+        result.m_rsrpAfterMove = phy->GetRsrp ();
+      });
+    };
+
+  auto events = scenario.Run ([addressedOnly] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetUeSpectrumAttribute ("DlCtrlAddressedOnly", BooleanValue (addressedOnly));
+  });
+
+  for (const auto & event : events)
+    {
+      if (event.find (" ctrl ") != std::string::npos)
+        {
+          result.m_ctrl.push_back (event);
+        }
+      else
+        {
+          result.m_others.push_back (event);
+        }
+    }
+  m_result = nullptr;
+  return result;
+}
+
+void
+NrDlCtrlAddressedOnlyTestCase::DoRun ()
+{
+  RunResult all = Run (false);
+  RunResult addressed = Run (true);
+
+  NS_TEST_ASSERT_MSG_GT (all.m_others.size (), 0, "Nothing happened in the simulation");
+  NS_TEST_ASSERT_MSG_LT (addressed.m_ctrl.size (), all.m_ctrl.size (),
+                         "The UEs must not receive the DL CTRL without messages for them");
+  NS_TEST_ASSERT_MSG_EQ (NrTraceComparisonScenario::FirstDifference (all.m_others, addressed.m_others), "",
+                         "The UEs must receive the same DCIs and packets");
+
+  NS_TEST_ASSERT_MSG_EQ (all.m_dlCtrlSinr.size (), 2, "Each UE must measure the DL CTRL");
+  for (const auto & it : all.m_dlCtrlSinr)
+    {
+      NS_TEST_ASSERT_MSG_EQ (addressed.m_dlCtrlSinr[it.first], it.second,
+                             "UE " << it.first << " must measure all the DL CTRL of its cell");
+    }
+
+  NS_TEST_ASSERT_MSG_GT (all.m_rsrpBeforeMove - all.m_rsrpAfterMove, 3.0,
+                         "The movement of the UE must reduce its RSRP");
+  NS_TEST_ASSERT_MSG_EQ_TOL (addressed.m_rsrpBeforeMove, all.m_rsrpBeforeMove, 1e-9, "Wrong RSRP");
+  NS_TEST_ASSERT_MSG_EQ_TOL (addressed.m_rsrpAfterMove, all.m_rsrpAfterMove, 1e-9,
+                             "The UE must measure the RSRP of the DL CTRL that do not address it");
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the attribute DlCtrlAddressedOnly
+ */
+class NrDlCtrlAddressedOnlyTestSuite : public TestSuite
+{
+public:
+  NrDlCtrlAddressedOnlyTestSuite ()
+    : TestSuite ("nr-test-dl-ctrl-addressed-only", SYSTEM)
+  {
+    AddTestCase (new NrDlCtrlAddressedOnlyTestCase (), TestCase::QUICK);
+  }
+};
+
+static NrDlCtrlAddressedOnlyTestSuite nrDlCtrlAddressedOnlyTestSuite; //!< DlCtrlAddressedOnly test suite
+
+} // namespace ns3
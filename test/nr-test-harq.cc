@@ -80,12 +80,7 @@ TestHarqTestCase::GetTbDecodStats (std::vector<double> sinrRx, NrErrorModel::NrE
       sinrRxSpecVal [i] = pow (10.0, sinrRx.at (i) / 10.0);
     }
 
-  std::vector<int> rbMap;
-  int rbIndex = 0;
-  for (uint8_t i = 0; i < sinrRx.size (); i++, rbIndex++)
-    {
-      rbMap.push_back (rbIndex);
-    }
+  NrRbMask rbMap (sinrRx.size (), true);
 
   Ptr<NrErrorModelOutput> output;
   if (harqType == "IR")
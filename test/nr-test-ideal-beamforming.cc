@@ -0,0 +1,513 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/core-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/nr-module.h>
+#include <ns3/antenna-module.h>
+#include <ns3/beamforming-vector.h>
+#include "nr-trace-comparison-scenario.h"
+
+#include <algorithm>
+
+/**
+ * \file nr-test-ideal-beamforming.cc
+ * \ingroup test
+ *
+ * \brief Test the computation of the beams of IdealBeamformingHelper.
+ *
+ * A gNB and its UEs, at different directions and distances, are installed
+ * without running the simulation, and the beams of all the pairs are
+ * computed by an IdealBeamformingHelper.
+ *
+ * The first test checks that the beams saved by a run with many threads
+ * (attribute NumThreads) are the same as the ones of the serial run, for
+ * both the beam search methods of CellScanBeamforming, and for the direct
+ * path methods.
+ *
+ * The second test checks that the LongTermMatrix beam search selects the
+ * same beams as ChannelScan on the same channel, with an angle step that
+ * is not an integer (the scan truncates the elevations of the UE beams to
+ * integer degrees), whatever the number of threads.
+ *
+ * The last test checks the incremental update of the beams (attribute
+ * IncrementalUpdate) in a running simulation: the beams of a pair must be
+ * recomputed only when a device of the pair moved or, for the methods that
+ * depend on it, when its channel has been regenerated; the counters of the
+ * recomputed and of the skipped pairs must be the same in the serial and
+ * in the parallel runs.
+ */
+namespace ns3 {
+
+/**
+ * \brief The devices of the test, and their helper
+ */
+struct NrIdealBeamformingTestDevices
+{
+  Ptr<NrHelper> m_nrHelper;    //!< The helper that installed the devices
+  NetDeviceContainer m_gnbDevs; //!< The gNB device
+  NetDeviceContainer m_ueDevs;  //!< The UE devices
+};
+
+/**
+ * \brief Install a gNB and its UEs
+ * \param channelUpdatePeriod UpdatePeriod of the 3GPP channel model
+ * \return the devices
+ */
+static NrIdealBeamformingTestDevices
+CreateDevices (const Time &channelUpdatePeriod)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Config::SetDefault ("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue (channelUpdatePeriod));
+
+  NrIdealBeamformingTestDevices devices;
+  devices.m_nrHelper = CreateObject<NrHelper> ();
+  Ptr<NrHelper> nrHelper = devices.m_nrHelper;
+
+  NodeContainer gnbNodes;
+  NodeContainer ueNodes;
+  gnbNodes.Create (1);
+  ueNodes.Create (6);
+
+  // The UEs are around the gNB, at different distances
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 10.0));
+  positionAlloc->Add (Vector (20.0, 0.0, 1.5));
+  positionAlloc->Add (Vector (15.0, 25.0, 1.5));
+  positionAlloc->Add (Vector (-10.0, 40.0, 1.5));
+  positionAlloc->Add (Vector (30.0, -30.0, 1.5));
+  positionAlloc->Add (Vector (60.0, 10.0, 1.5));
+  positionAlloc->Add (Vector (8.0, -5.0, 1.5));
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (NodeContainer (gnbNodes, ueNodes));
+
+  nrHelper->SetPathlossAttribute ("ShadowingEnabled", BooleanValue (false));
+
+  CcBwpCreator::SimpleOperationBandConf bandConf (28e9, 20e6, 1, BandwidthPartInfo::UMi_StreetCanyon_LoS);
+  CcBwpCreator ccBwpCreator;
+  OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc (bandConf);
+  nrHelper->InitializeOperationBand (&band);
+  BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps ({band});
+
+  nrHelper->SetGnbAntennaAttribute ("NumRows", UintegerValue (4));
+  nrHelper->SetGnbAntennaAttribute ("NumColumns", UintegerValue (4));
+  nrHelper->SetGnbAntennaAttribute ("AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+  nrHelper->SetUeAntennaAttribute ("NumRows", UintegerValue (2));
+  nrHelper->SetUeAntennaAttribute ("NumColumns", UintegerValue (2));
+  nrHelper->SetUeAntennaAttribute ("AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+
+  devices.m_gnbDevs = nrHelper->InstallGnbDevice (gnbNodes, allBwps);
+  devices.m_ueDevs = nrHelper->InstallUeDevice (ueNodes, allBwps);
+
+  int64_t randomStream = 1;
+  randomStream += nrHelper->AssignStreams (devices.m_gnbDevs, randomStream);
+  randomStream += nrHelper->AssignStreams (devices.m_ueDevs, randomStream);
+
+  for (auto it = devices.m_gnbDevs.Begin (); it != devices.m_gnbDevs.End (); ++it)
+    {
+      DynamicCast<NrGnbNetDevice> (*it)->UpdateConfig ();
+    }
+  for (auto it = devices.m_ueDevs.Begin (); it != devices.m_ueDevs.End (); ++it)
+    {
+      DynamicCast<NrUeNetDevice> (*it)->UpdateConfig ();
+    }
+
+  return devices;
+}
+
+/**
+ * \brief Create an ideal beamforming helper, and compute the beams of all
+ * the pairs gNB-UE
+ * \param devices the devices
+ * \param method the beamforming method
+ * \param searchMethod the beam search method, if the method is CellScanBeamforming
+ * \param angleStep the BeamSearchAngleStep, if the method is CellScanBeamforming
+ * \param numThreads NumThreads of the helper
+ * \return the helper
+ */
+static Ptr<IdealBeamformingHelper>
+CreateBeamformingHelper (const NrIdealBeamformingTestDevices &devices, const TypeId &method,
+                         CellScanBeamforming::BeamSearchMethod searchMethod, double angleStep,
+                         uint32_t numThreads)
+{
+  Ptr<IdealBeamformingHelper> helper = CreateObject<IdealBeamformingHelper> ();
+  helper->SetAttribute ("BeamformingMethod", TypeIdValue (method));
+  helper->SetAttribute ("NumThreads", UintegerValue (numThreads));
+  if (method == CellScanBeamforming::GetTypeId ())
+    {
+      helper->SetBeamformingAlgorithmAttribute ("BeamSearchMethod", EnumValue (searchMethod));
+      helper->SetBeamformingAlgorithmAttribute ("BeamSearchAngleStep", DoubleValue (angleStep));
+    }
+
+  Ptr<NrGnbNetDevice> gnbDev = DynamicCast<NrGnbNetDevice> (devices.m_gnbDevs.Get (0));
+  for (auto it = devices.m_ueDevs.Begin (); it != devices.m_ueDevs.End (); ++it)
+    {
+      helper->AddBeamformingTask (gnbDev, DynamicCast<NrUeNetDevice> (*it));
+    }
+  return helper;
+}
+
+/**
+ * \brief Get the beams saved for the pairs gNB-UE
+ * \param devices the devices
+ * \return for each UE, the id of the beam of the gNB towards the UE, and
+ * the id of the beam of the UE towards the gNB
+ */
+static std::vector<std::pair<BeamId, BeamId>>
+GetSavedBeams (const NrIdealBeamformingTestDevices &devices)
+{
+  Ptr<NetDevice> gnbDev = devices.m_gnbDevs.Get (0);
+  Ptr<BeamManager> gnbBeamManager = NrHelper::GetGnbPhy (gnbDev, 0)->GetSpectrumPhy (0)->GetBeamManager ();
+
+  std::vector<std::pair<BeamId, BeamId>> beams;
+  for (auto it = devices.m_ueDevs.Begin (); it != devices.m_ueDevs.End (); ++it)
+    {
+      Ptr<BeamManager> ueBeamManager = NrHelper::GetUePhy (*it, 0)->GetSpectrumPhy (0)->GetBeamManager ();
+      beams.emplace_back (gnbBeamManager->GetBeamId (*it), ueBeamManager->GetBeamId (gnbDev));
+    }
+  return beams;
+}
+
+/**
+ * \brief Get the antenna weights saved for the pairs gNB-UE
+ * \param devices the devices
+ * \return for each UE, the weights of the gNB towards the UE, and the
+ * weights of the UE towards the gNB
+ */
+static std::vector<std::pair<complexVector_t, complexVector_t>>
+GetSavedWeights (const NrIdealBeamformingTestDevices &devices)
+{
+  Ptr<NetDevice> gnbDev = devices.m_gnbDevs.Get (0);
+  Ptr<BeamManager> gnbBeamManager = NrHelper::GetGnbPhy (gnbDev, 0)->GetSpectrumPhy (0)->GetBeamManager ();
+
+  std::vector<std::pair<complexVector_t, complexVector_t>> weights;
+  for (auto it = devices.m_ueDevs.Begin (); it != devices.m_ueDevs.End (); ++it)
+    {
+      Ptr<BeamManager> ueBeamManager = NrHelper::GetUePhy (*it, 0)->GetSpectrumPhy (0)->GetBeamManager ();
+      weights.emplace_back (gnbBeamManager->GetBeamformingVector (*it), ueBeamManager->GetBeamformingVector (gnbDev));
+    }
+  return weights;
+}
+
+/**
+ * \brief Replace the beams saved for the pairs gNB-UE with a beam that the
+ * cell scan never selects (sector 0, elevation 0)
+ * \param devices the devices
+ */
+static void
+ResetSavedBeams (const NrIdealBeamformingTestDevices &devices)
+{
+  Ptr<NetDevice> gnbDev = devices.m_gnbDevs.Get (0);
+  Ptr<NrSpectrumPhy> gnbSpectrumPhy = NrHelper::GetGnbPhy (gnbDev, 0)->GetSpectrumPhy (0);
+  Ptr<const UniformPlanarArray> gnbArray = gnbSpectrumPhy->GetAntenna ()->GetObject<UniformPlanarArray> ();
+
+  for (auto it = devices.m_ueDevs.Begin (); it != devices.m_ueDevs.End (); ++it)
+    {
+      Ptr<NrSpectrumPhy> ueSpectrumPhy = NrHelper::GetUePhy (*it, 0)->GetSpectrumPhy (0);
+      Ptr<const UniformPlanarArray> ueArray = ueSpectrumPhy->GetAntenna ()->GetObject<UniformPlanarArray> ();
+      gnbSpectrumPhy->GetBeamManager ()->SaveBeamformingVector (
+        std::make_pair (CreateDirectionalBfv (gnbArray, 0, 0.0), BeamId::GetEmptyBeamId ()), *it);
+      ueSpectrumPhy->GetBeamManager ()->SaveBeamformingVector (
+        std::make_pair (CreateDirectionalBfv (ueArray, 0, 0.0), BeamId::GetEmptyBeamId ()), gnbDev);
+    }
+}
+
+/**
+ * \ingroup test
+ * \brief The beams computed with many threads are the same as the ones
+ * computed by the serial run
+ */
+class NrIdealBeamformingThreadsTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param method the beamforming method
+   * \param searchMethod the beam search method, if the method is CellScanBeamforming
+   */
+  NrIdealBeamformingThreadsTestCase (const TypeId &method,
+                                     CellScanBeamforming::BeamSearchMethod searchMethod = CellScanBeamforming::CHANNEL_SCAN)
+    : TestCase ("Ideal beams with many threads, " + method.GetName () +
+                (method != CellScanBeamforming::GetTypeId () ? ""
+                 : searchMethod == CellScanBeamforming::CHANNEL_SCAN ? " ChannelScan" : " LongTermMatrix")),
+      m_method (method),
+      m_searchMethod (searchMethod)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  TypeId m_method;                                      //!< Beamforming method
+  CellScanBeamforming::BeamSearchMethod m_searchMethod; //!< Beam search method of the cell scan
+};
+
+void
+NrIdealBeamformingThreadsTestCase::DoRun ()
+{
+  NrIdealBeamformingTestDevices devices = CreateDevices (MilliSeconds (0));
+
+  // The tasks are computed by the serial run when they are added
+  Ptr<IdealBeamformingHelper> helper = CreateBeamformingHelper (devices, m_method, m_searchMethod, 30.0, 1);
+  auto serial = GetSavedBeams (devices);
+  auto serialWeights = GetSavedWeights (devices);
+
+  for (uint32_t numThreads : {4u, 0u})
+    {
+      ResetSavedBeams (devices);
+      helper->SetAttribute ("NumThreads", UintegerValue (numThreads));
+      uint64_t recomputed = helper->GetNumRecomputedTasks ();
+      helper->Run ();
+      auto parallel = GetSavedBeams (devices);
+      auto parallelWeights = GetSavedWeights (devices);
+
+      NS_TEST_ASSERT_MSG_EQ (helper->GetNumRecomputedTasks () - recomputed, devices.m_ueDevs.GetN (),
+                             "The run must compute the beams of all the pairs");
+      for (size_t i = 0; i < serial.size (); ++i)
+        {
+          // The direct path methods save their beams with an empty id
+          if (serial.at (i).first != BeamId::GetEmptyBeamId ())
+            {
+              NS_TEST_ASSERT_MSG_NE (parallel.at (i).first, BeamId::GetEmptyBeamId (),
+                                     "The beam of the gNB towards UE " << i << " was not saved");
+            }
+          NS_TEST_ASSERT_MSG_EQ ((parallelWeights.at (i).first == serialWeights.at (i).first), true,
+                                 "Wrong weights of the gNB towards UE " << i << " with " << numThreads << " threads");
+          NS_TEST_ASSERT_MSG_EQ ((parallelWeights.at (i).second == serialWeights.at (i).second), true,
+                                 "Wrong weights of UE " << i << " with " << numThreads << " threads");
+          NS_TEST_ASSERT_MSG_EQ (parallel.at (i).first, serial.at (i).first,
+                                 "Wrong beam of the gNB towards UE " << i << " with " << numThreads << " threads");
+          NS_TEST_ASSERT_MSG_EQ (parallel.at (i).second, serial.at (i).second,
+                                 "Wrong beam of UE " << i << " with " << numThreads << " threads");
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief The LongTermMatrix beam search selects the same beams as
+ * ChannelScan
+ */
+class NrIdealBeamformingLongTermMatrixTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param numThreads NumThreads of the helper of the LongTermMatrix search
+   */
+  NrIdealBeamformingLongTermMatrixTestCase (uint32_t numThreads)
+    : TestCase ("LongTermMatrix and ChannelScan beams with " + std::to_string (numThreads) + " threads"),
+      m_numThreads (numThreads)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_numThreads {1}; //!< NumThreads of the LongTermMatrix search
+};
+
+void
+NrIdealBeamformingLongTermMatrixTestCase::DoRun ()
+{
+  // The channel is never updated: both the searches see the same channel
+  NrIdealBeamformingTestDevices devices = CreateDevices (MilliSeconds (0));
+  const double angleStep = 12.5;
+
+  CreateBeamformingHelper (devices, CellScanBeamforming::GetTypeId (), CellScanBeamforming::CHANNEL_SCAN, angleStep, 1);
+  auto scan = GetSavedBeams (devices);
+
+  Ptr<IdealBeamformingHelper> helper = CreateBeamformingHelper (devices, CellScanBeamforming::GetTypeId (),
+                                                                CellScanBeamforming::LONG_TERM_MATRIX,
+                                                                angleStep, m_numThreads);
+  // Compute the beams again, with the threads of the helper
+  ResetSavedBeams (devices);
+  helper->Run ();
+  auto longTerm = GetSavedBeams (devices);
+
+  std::vector<double> ueElevations = NrBeamCodebook::GetCellScanUeElevations (angleStep);
+  for (size_t i = 0; i < scan.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((std::find (ueElevations.begin (), ueElevations.end (),
+                                         scan.at (i).second.GetElevation ()) != ueElevations.end ()),
+                             true, "The scan must use the truncated elevations for UE " << i);
+      NS_TEST_ASSERT_MSG_EQ (longTerm.at (i).first, scan.at (i).first,
+                             "Wrong beam of the gNB towards UE " << i);
+      NS_TEST_ASSERT_MSG_EQ (longTerm.at (i).second, scan.at (i).second,
+                             "Wrong beam of UE " << i);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief The incremental update recomputes only the beams of the pairs
+ * whose inputs changed
+ */
+class NrIdealBeamformingIncrementalTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param method the beamforming method
+   * \param channelUpdatePeriod UpdatePeriod of the 3GPP channel model, in ms
+   */
+  NrIdealBeamformingIncrementalTestCase (const TypeId &method, uint32_t channelUpdatePeriod)
+    : TestCase ("Incremental update of the ideal beams with " + method.GetName () +
+                ", channel update period " + std::to_string (channelUpdatePeriod) + " ms"),
+      m_method (method),
+      m_channelUpdatePeriod (channelUpdatePeriod)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief The counters of the helper after a run
+   */
+  typedef std::pair<uint64_t, uint64_t> Counters;
+
+  /**
+   * \brief Run the simulation, with the beams of the pairs of the first gNB
+   * recomputed at fixed times, and a UE moved in the meantime
+   * \param numThreads NumThreads of the helper
+   * \return the recomputed and the skipped pairs, after each run of the helper
+   */
+  std::vector<Counters> Run (uint32_t numThreads) const;
+
+  TypeId m_method;                    //!< Beamforming method
+  uint32_t m_channelUpdatePeriod {0}; //!< UpdatePeriod of the 3GPP channel model, in ms
+};
+
+std::vector<NrIdealBeamformingIncrementalTestCase::Counters>
+NrIdealBeamformingIncrementalTestCase::Run (uint32_t numThreads) const
+{
+  NrTraceComparisonScenario scenario;
+  scenario.m_simTime = MilliSeconds (100);
+
+  std::vector<Counters> counters;
+  Ptr<IdealBeamformingHelper> helper;
+  scenario.m_onInstalled = [this, numThreads, &counters, &helper] (const NetDeviceContainer &gnbDevs,
+                                                                   const NetDeviceContainer &ueDevs)
+    {
+      helper = CreateObject<IdealBeamformingHelper> ();
+      helper->SetAttribute ("BeamformingMethod", TypeIdValue (m_method));
+      helper->SetAttribute ("NumThreads", UintegerValue (numThreads));
+      helper->SetAttribute ("IncrementalUpdate", BooleanValue (true));
+      for (auto it = ueDevs.Begin (); it != ueDevs.End (); ++it)
+        {
+          helper->AddBeamformingTask (DynamicCast<NrGnbNetDevice> (gnbDevs.Get (0)),
+                                      DynamicCast<NrUeNetDevice> (*it));
+        }
+
+      auto run = [&counters, &helper] () {
+        helper->Run ();
+        counters.emplace_back (helper->GetNumRecomputedTasks (), helper->GetNumSkippedTasks ());
+      };
+      Ptr<MobilityModel> mobility = ueDevs.Get (0)->GetNode ()->GetObject<MobilityModel> ();
+
+      // Nothing changed; then the first UE moves; then nothing changed
+      // again; and finally the channel update period (if any) has expired
+      Simulator::Schedule (MilliSeconds (10), run);
+      Simulator::Schedule (MilliSeconds (20), &MobilityModel::SetPosition, mobility, Vector (20.0, 15.0, 1.5));
+      Simulator::Schedule (MilliSeconds (20), run);
+      Simulator::Schedule (MilliSeconds (30), run);
+      Simulator::Schedule (MilliSeconds (90), run);
+    };
+
+  const Time channelUpdatePeriod = MilliSeconds (m_channelUpdatePeriod);
+  scenario.Run ([channelUpdatePeriod] (const Ptr<NrHelper> &) {
+    Config::SetDefault ("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue (channelUpdatePeriod));
+  });
+  helper = nullptr;
+  Config::SetDefault ("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue (MilliSeconds (0)));
+  return counters;
+}
+
+void
+NrIdealBeamformingIncrementalTestCase::DoRun ()
+{
+  // The pairs of the first gNB with all the UEs of the scenario
+  NrTraceComparisonScenario scenario;
+  const uint64_t numPairs = scenario.m_gnbNum * scenario.m_uesPerGnb;
+
+  ObjectFactory factory;
+  factory.SetTypeId (m_method);
+  const bool regenerated = factory.Create<IdealBeamformingAlgorithm> ()->DependsOnChannel () &&
+    m_channelUpdatePeriod != 0;
+
+  // Recomputed and skipped pairs, after each run
+  std::vector<Counters> expected;
+  expected.emplace_back (0, numPairs);
+  expected.emplace_back (1, 2 * numPairs - 1);
+  expected.emplace_back (1, 3 * numPairs - 1);
+  expected.emplace_back (regenerated ? Counters (1 + numPairs, 3 * numPairs - 1) : Counters (1, 4 * numPairs - 1));
+
+  auto serial = Run (1);
+  auto parallel = Run (4);
+
+  NS_TEST_ASSERT_MSG_EQ (serial.size (), expected.size (), "Wrong number of runs");
+  NS_TEST_ASSERT_MSG_EQ (parallel.size (), expected.size (), "Wrong number of runs");
+  for (size_t i = 0; i < expected.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (serial.at (i).first, expected.at (i).first, "Wrong recomputed pairs at run " << i);
+      NS_TEST_ASSERT_MSG_EQ (serial.at (i).second, expected.at (i).second, "Wrong skipped pairs at run " << i);
+      NS_TEST_ASSERT_MSG_EQ (parallel.at (i).first, serial.at (i).first,
+                             "The parallel run recomputed other pairs at run " << i);
+      NS_TEST_ASSERT_MSG_EQ (parallel.at (i).second, serial.at (i).second,
+                             "The parallel run skipped other pairs at run " << i);
+    }
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the ideal beamforming helper
+ */
+class NrIdealBeamformingTestSuite : public TestSuite
+{
+public:
+  NrIdealBeamformingTestSuite ()
+    : TestSuite ("nr-test-ideal-beamforming", UNIT)
+  {
+    AddTestCase (new NrIdealBeamformingThreadsTestCase (CellScanBeamforming::GetTypeId (),
+                                                        CellScanBeamforming::CHANNEL_SCAN), TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingThreadsTestCase (CellScanBeamforming::GetTypeId (),
+                                                        CellScanBeamforming::LONG_TERM_MATRIX), TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingThreadsTestCase (DirectPathBeamforming::GetTypeId ()), TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingThreadsTestCase (QuasiOmniDirectPathBeamforming::GetTypeId ()), TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingThreadsTestCase (DirectPathQuasiOmniBeamforming::GetTypeId ()), TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingLongTermMatrixTestCase (1), TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingLongTermMatrixTestCase (4), TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingIncrementalTestCase (CellScanBeamforming::GetTypeId (), 0),
+                 TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingIncrementalTestCase (CellScanBeamforming::GetTypeId (), 50),
+                 TestCase::QUICK);
+    AddTestCase (new NrIdealBeamformingIncrementalTestCase (DirectPathBeamforming::GetTypeId (), 50),
+                 TestCase::QUICK);
+  }
+};
+
+static NrIdealBeamformingTestSuite nrIdealBeamformingTestSuite; //!< Ideal beamforming test suite
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/nr-helper.h>
+#include "nr-trace-comparison-scenario.h"
+
+#include <algorithm>
+
+/**
+ * \file nr-test-idle-slot-skipping.cc
+ * \ingroup test
+ *
+ * \brief Check that the attribute IdleSlotSkipping of NrUePhy does not
+ * change the outcome of a simulation.
+ *
+ * The UEs have a packet every 20 ms, in DL or in UL only, so they are idle
+ * most of the time: a DL DCI must wake up a UE in DL, and the data of the
+ * application must wake up a UE in UL. The CTRL messages and the DCI
+ * received by the UEs, traced with the slot of the UE, and the packets
+ * received by the applications must be the same as in a run without the
+ * attribute, at the same times, while the number of events executed by
+ * the simulator must be lower.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Compare a run with and without IdleSlotSkipping
+ */
+class NrIdleSlotSkippingTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param isDownlink true for DL traffic only, false for UL traffic only
+   */
+  NrIdleSlotSkippingTestCase (bool isDownlink)
+    : TestCase (std::string ("Idle slot skipping with ") + (isDownlink ? "DL" : "UL") + " traffic"),
+      m_isDownlink (isDownlink)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  bool m_isDownlink {true}; //!< DL or UL traffic
+};
+
+void
+NrIdleSlotSkippingTestCase::DoRun ()
+{
+  NrTraceComparisonScenario scenario;
+  scenario.m_isDownlink = m_isDownlink;
+  scenario.m_isUplink = ! m_isDownlink;
+  scenario.m_packetInterval = MilliSeconds (20);
+
+  // Number of events executed by the simulator, just before its end
+  uint64_t eventCount = 0;
+  scenario.m_onInstalled = [&scenario, &eventCount] (const NetDeviceContainer &, const NetDeviceContainer &)
+    {
+      Simulator::Schedule (scenario.m_simTime - NanoSeconds (1),
+                           [&eventCount] () { eventCount = Simulator::GetEventCount (); });
+    };
+
+  auto always = scenario.Run ({});
+  const uint64_t alwaysEvents = eventCount;
+
+  auto skipping = scenario.Run ([] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetUePhyAttribute ("IdleSlotSkipping", BooleanValue (true));
+  });
+  const uint64_t skippingEvents = eventCount;
+
+  auto delivered = std::count_if (always.begin (), always.end (),
+                                  [] (const std::string &event) { return event.find (" rx ") != std::string::npos; });
+  NS_TEST_ASSERT_MSG_GT (delivered, 0, "No packet delivered");
+  NS_TEST_ASSERT_MSG_EQ (NrTraceComparisonScenario::FirstDifference (always, skipping), "",
+                         "The idle slot skipping changed the simulation");
+  NS_TEST_ASSERT_MSG_LT (skippingEvents, alwaysEvents, "The idle UEs did not skip their slots");
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the idle slot skipping of the UEs
+ */
+class NrIdleSlotSkippingTestSuite : public TestSuite
+{
+public:
+  NrIdleSlotSkippingTestSuite ()
+    : TestSuite ("nr-test-idle-slot-skipping", SYSTEM)
+  {
+    AddTestCase (new NrIdleSlotSkippingTestCase (true), TestCase::QUICK);
+    AddTestCase (new NrIdleSlotSkippingTestCase (false), TestCase::QUICK);
+  }
+};
+
+static NrIdleSlotSkippingTestSuite nrIdleSlotSkippingTestSuite; //!< Idle slot skipping test suite
+
+} // namespace ns3
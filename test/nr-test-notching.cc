@@ -56,6 +56,7 @@ public:
   virtual void SendRachPreamble (uint8_t PreambleId, uint8_t Rnti) override;
   virtual void SetSlotAllocInfo (const SlotAllocInfo &slotAllocInfo) override;
   virtual void NotifyConnectionSuccessful () override;
+  virtual void NotifyUlDataAvailable () override;
   virtual uint32_t GetRbNum () const override;
   virtual BeamConfId GetBeamConfId (uint8_t rnti) const override;
   void SetParams (uint32_t numOfUesPerBeam, uint32_t numOfBeams);
@@ -131,6 +132,10 @@ void
 TestNotchingPhySapProvider::NotifyConnectionSuccessful ()
 {}
 
+void
+TestNotchingPhySapProvider::NotifyUlDataAvailable ()
+{}
+
 uint32_t
 TestNotchingPhySapProvider::GetRbNum () const
 {
@@ -225,25 +230,16 @@ TestNotchingGnbMac::DoSchedConfigIndication (NrMacSchedSapUser::SchedConfigIndPa
 
       if (m_verboseMac)
         {
-          std::ostringstream oss;
-          for (auto & x: varTtiAllocInfo.m_dci->m_rbgBitmask)
-            {
-              oss << std::to_string (x) << " ";
-            }
-
           std::cout << "UE " << varTtiAllocInfo.m_dci->m_rnti << " assigned RBG" <<
-            " with mask: " << oss.str () << std::endl;
+            " with mask: " << varTtiAllocInfo.m_dci->m_rbgBitmask << std::endl;
         }
 
-      NS_ASSERT_MSG (varTtiAllocInfo.m_dci->m_rbgBitmask.size () == m_inputMask.size (),
+      NS_ASSERT_MSG (varTtiAllocInfo.m_dci->m_rbgBitmask.GetSize () == m_inputMask.size (),
                      "dci bitmask is not of same size as the mask");
 
-      unsigned zeroes = std::count (varTtiAllocInfo.m_dci->m_rbgBitmask.begin (),
-                                    varTtiAllocInfo.m_dci->m_rbgBitmask.end (), 0);
-
-      NS_ASSERT_MSG (zeroes != m_inputMask.size (), "dci rbgBitmask is filled with zeros");
+      NS_ASSERT_MSG (varTtiAllocInfo.m_dci->m_rbgBitmask.Any (), "dci rbgBitmask is filled with zeros");
 
-      for (unsigned index = 0; index < varTtiAllocInfo.m_dci->m_rbgBitmask.size (); index++)
+      for (unsigned index = 0; index < varTtiAllocInfo.m_dci->m_rbgBitmask.GetSize (); index++)
         {
           if (m_inputMask[index] == 0)
             {
@@ -0,0 +1,178 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/nr-helper.h>
+#include <ns3/nr-mac-scheduler-slot-dispatcher.h>
+#include "nr-trace-comparison-scenario.h"
+
+/**
+ * \file nr-test-parallel-scheduling.cc
+ * \ingroup test
+ *
+ * \brief Check that the parallel scheduling of the cells does not change
+ * the outcome of a simulation. The same multi-cell scenario runs with the
+ * attribute ParallelScheduling of the schedulers disabled and enabled, and
+ * the scheduling decisions, the CTRL messages (including the RAR of the
+ * initial access) and the DCI received by the UEs, and the packets
+ * received by the applications, must be the same, at the same times.
+ * A parallel run stopped while the schedulers wait for their flush must not
+ * affect the next simulation of the process.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Compare a run with and without ParallelScheduling
+ */
+class NrParallelSchedulingTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param gnbNum number of gNBs
+   * \param threads value of ParallelSchedulingThreads
+   */
+  NrParallelSchedulingTestCase (uint16_t gnbNum, uint32_t threads)
+    : TestCase ("Parallel scheduling with " + std::to_string (gnbNum) + " gNBs and " +
+                std::to_string (threads) + " threads"),
+      m_gnbNum (gnbNum),
+      m_threads (threads)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  uint16_t m_gnbNum {0};  //!< Number of gNBs
+  uint32_t m_threads {0}; //!< Threads of the dispatcher
+};
+
+void
+NrParallelSchedulingTestCase::DoRun ()
+{
+  NrTraceComparisonScenario scenario;
+  scenario.m_gnbNum = m_gnbNum;
+
+  auto sequential = scenario.Run ({});
+  auto parallel = scenario.Run ([this] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetSchedulerAttribute ("ParallelScheduling", BooleanValue (true));
+    nrHelper->SetSchedulerAttribute ("ParallelSchedulingThreads", UintegerValue (m_threads));
+  });
+
+  NS_TEST_ASSERT_MSG_GT (sequential.size (), 0, "Nothing happened in the simulation");
+  NS_TEST_ASSERT_MSG_EQ (NrTraceComparisonScenario::FirstDifference (sequential, parallel), "",
+                         "The parallel scheduling changed the simulation");
+}
+
+/**
+ * \ingroup test
+ * \brief Stop a parallel run while a flush is pending, and check the next run
+ *
+ * The interrupted run leaves the dispatcher with schedulers that are never
+ * flushed; after Simulator::Destroy, the dispatcher must be empty, and a new
+ * parallel run must have the same outcome as a sequential one.
+ */
+class NrParallelSchedulingStopTestCase : public TestCase
+{
+public:
+  NrParallelSchedulingStopTestCase () : TestCase ("Parallel scheduling after a run stopped before the flush") {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Stop the simulator as soon as the dispatcher has a pending flush
+   *
+   * Re-scheduled for the current time until a scheduler is enqueued, so that
+   * it runs after the slot starts of the gNBs, but before the flush.
+   * \param attempts remaining attempts
+   */
+  void StopWhenPending (uint32_t attempts);
+
+  bool m_stoppedWithPending {false}; //!< The simulator was stopped with a pending flush
+};
+
+void
+NrParallelSchedulingStopTestCase::StopWhenPending (uint32_t attempts)
+{
+  if (NrMacSchedulerSlotDispatcher::Get ()->HasPending ())
+    {
+      m_stoppedWithPending = true;
+      Simulator::Stop ();
+    }
+  else if (attempts > 0)
+    {
+      Simulator::ScheduleNow (&NrParallelSchedulingStopTestCase::StopWhenPending, this, attempts - 1);
+    }
+}
+
+void
+NrParallelSchedulingStopTestCase::DoRun ()
+{
+  NrTraceComparisonScenario scenario;
+  scenario.m_gnbNum = 2;
+
+  auto configure = [] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetSchedulerAttribute ("ParallelScheduling", BooleanValue (true));
+    nrHelper->SetSchedulerAttribute ("ParallelSchedulingThreads", UintegerValue (2));
+  };
+
+  scenario.m_onInstalled = [this, &scenario] (const NetDeviceContainer &, const NetDeviceContainer &)
+    {
+      Simulator::Schedule (scenario.m_appStart + MilliSeconds (10),
+                           &NrParallelSchedulingStopTestCase::StopWhenPending, this, 100);
+    };
+  scenario.Run (configure);
+
+  NS_TEST_ASSERT_MSG_EQ (m_stoppedWithPending, true, "The run was not stopped before a flush");
+  NS_TEST_ASSERT_MSG_EQ (NrMacSchedulerSlotDispatcher::Get ()->HasPending (), false,
+                         "The destroyed simulator left schedulers in the dispatcher");
+
+  scenario.m_onInstalled = nullptr;
+  auto sequential = scenario.Run ({});
+  auto parallel = scenario.Run (configure);
+
+  NS_TEST_ASSERT_MSG_GT (sequential.size (), 0, "Nothing happened in the simulation");
+  NS_TEST_ASSERT_MSG_EQ (NrTraceComparisonScenario::FirstDifference (sequential, parallel), "",
+                         "The stopped run changed the next parallel simulation");
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the parallel scheduling
+ */
+class NrParallelSchedulingTestSuite : public TestSuite
+{
+public:
+  NrParallelSchedulingTestSuite ()
+    : TestSuite ("nr-test-parallel-scheduling", SYSTEM)
+  {
+    AddTestCase (new NrParallelSchedulingTestCase (1, 2), TestCase::QUICK);
+    AddTestCase (new NrParallelSchedulingTestCase (3, 1), TestCase::QUICK);
+    AddTestCase (new NrParallelSchedulingTestCase (3, 2), TestCase::QUICK);
+    AddTestCase (new NrParallelSchedulingStopTestCase (), TestCase::QUICK);
+  }
+};
+
+static NrParallelSchedulingTestSuite nrParallelSchedulingTestSuite; //!< Parallel scheduling test suite
+
+} // namespace ns3
@@ -0,0 +1,109 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-rb-mask.h>
+
+/**
+ * \file nr-test-rb-mask.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the RB/RBG mask. A random RBG mask is expanded
+ * into a RB mask, and the result is compared with the list of RB indexes
+ * built one by one (as the PHY did with vectors). The sizes are chosen to
+ * cross the boundaries of the internal words.
+ */
+namespace ns3 {
+
+class TestNrRbMaskTestCase : public TestCase
+{
+public:
+  TestNrRbMaskTestCase (uint32_t numRbg, uint32_t numRbPerRbg, const std::string &name)
+    : TestCase (name),
+      m_numRbg (numRbg),
+      m_numRbPerRbg (numRbPerRbg)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  uint32_t m_numRbg {0};       //!< Number of RBG
+  uint32_t m_numRbPerRbg {0};  //!< RB per RBG
+};
+
+void
+TestNrRbMaskTestCase::DoRun ()
+{
+  std::vector<uint8_t> rbgVector (m_numRbg, 0);
+  uint32_t seed = m_numRbg * 31 + m_numRbPerRbg;
+  for (auto & rbg : rbgVector)
+    {
+      seed = seed * 1103515245 + 12345;
+      rbg = (seed >> 16) % 2;
+    }
+
+  NrRbMask rbgMask = NrRbMask::FromVector (rbgVector);
+  NS_TEST_ASSERT_MSG_EQ (rbgMask.GetSize (), m_numRbg, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ ((rbgMask.ToVector () == rbgVector), true, "Conversion is not reversible");
+
+  std::vector<int> expected;
+  for (uint32_t i = 0; i < rbgVector.size (); ++i)
+    {
+      if (rbgVector.at (i) == 1)
+        {
+          for (uint32_t k = 0; k < m_numRbPerRbg; ++k)
+            {
+              expected.push_back (i * m_numRbPerRbg + k);
+            }
+        }
+    }
+
+  NrRbMask rbMask = rbgMask.ExpandRbgToRb (m_numRbPerRbg);
+  NS_TEST_ASSERT_MSG_EQ (rbMask.GetSize (), m_numRbg * m_numRbPerRbg, "Wrong RB size");
+  NS_TEST_ASSERT_MSG_EQ (rbMask.Count (), expected.size (), "Wrong number of RB");
+  NS_TEST_ASSERT_MSG_EQ ((rbMask.ToIndexVector () == expected), true, "Wrong RB expansion");
+
+  // the complement, merged, must fill the mask
+  NrRbMask all (rbMask.GetSize (), true);
+  NrRbMask complement (rbMask.GetSize ());
+  for (uint32_t i = 0; i < rbMask.GetSize (); ++i)
+    {
+      complement.Set (i, !rbMask.IsSet (i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (complement.Count () + rbMask.Count (), rbMask.GetSize (), "Wrong complement");
+  complement |= rbMask;
+  NS_TEST_ASSERT_MSG_EQ ((complement == all), true, "Merge should give a full mask");
+  complement &= rbMask;
+  NS_TEST_ASSERT_MSG_EQ ((complement == rbMask), true, "Intersection should give the RB mask");
+}
+
+class TestNrRbMask : public TestSuite
+{
+public:
+  TestNrRbMask () : TestSuite ("nr-test-rb-mask", UNIT)
+  {
+    AddTestCase (new TestNrRbMaskTestCase (17, 4, "17 RBG, 4 RB per RBG"), QUICK);
+    AddTestCase (new TestNrRbMaskTestCase (64, 1, "64 RBG, 1 RB per RBG"), QUICK);
+    AddTestCase (new TestNrRbMaskTestCase (65, 3, "65 RBG, 3 RB per RBG"), QUICK);
+    AddTestCase (new TestNrRbMaskTestCase (138, 16, "138 RBG, 16 RB per RBG"), QUICK);
+    AddTestCase (new TestNrRbMaskTestCase (2222, 1, "2222 RBG, 1 RB per RBG"), QUICK);
+  }
+};
+
+static TestNrRbMask testNrRbMask; //!< RB mask test
+
+}  // namespace ns3
@@ -0,0 +1,255 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/nr-mac-scheduler-lcg.h>
+#include <ns3/nr-mac-scheduler-ofdma-qos.h>
+#include <ns3/nr-mac-scheduler-tdma-qos.h>
+#include "nr-scheduler-test-driver.h"
+
+/**
+ * \file nr-test-sched-qos.cc
+ * \ingroup test
+ *
+ * \brief Unit tests of the delay-aware QoS schedulers.
+ *
+ * The first test checks the head-of-line (HOL) time of a LC, from which
+ * the deadline is derived: the HOL comes from the RLC delays in DL and
+ * from the time of the BSR in UL, it advances when a transmission drains
+ * the oldest bytes, and a new report re-derives it.
+ *
+ * The other tests drive NrMacSchedulerOfdmaQos and NrMacSchedulerTdmaQos
+ * (which keep the UEs in a heap, see NrMacSchedulerMetricQos) with a
+ * bandwidth that can serve a single UE per slot: the UE served must be the
+ * one with the earliest deadline, and once the oldest bytes of a UE have
+ * been sent, its deadline must move forward and let the other UEs pass.
+ */
+namespace ns3 {
+
+/**
+ * \brief Create the configuration of a LC
+ * \param lcId ID of the LC
+ * \return a configuration with QCI 9 (delay budget of 300 ms)
+ */
+static LogicalChannelConfigListElement_s
+CreateLcConfig (uint8_t lcId)
+{
+  LogicalChannelConfigListElement_s lc;
+  lc.m_logicalChannelIdentity = lcId;
+  lc.m_logicalChannelGroup = 1;
+  lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+  lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+  lc.m_qci = 9;
+  return lc;
+}
+
+/**
+ * \brief Create a DL RLC buffer report
+ * \param lcId ID of the LC
+ * \param bytes bytes in the transmission queue
+ * \param holDelay head of line delay, in ms
+ * \return the report
+ */
+static NrMacSchedSapProvider::SchedDlRlcBufferReqParameters
+CreateRlcReport (uint8_t lcId, uint32_t bytes, uint16_t holDelay)
+{
+  NrMacSchedSapProvider::SchedDlRlcBufferReqParameters params;
+  params.m_rnti = 1;
+  params.m_logicalChannelIdentity = lcId;
+  params.m_rlcTransmissionQueueSize = bytes;
+  params.m_rlcTransmissionQueueHolDelay = holDelay;
+  params.m_rlcRetransmissionQueueSize = 0;
+  params.m_rlcRetransmissionHolDelay = 0;
+  params.m_rlcStatusPduSize = 0;
+  return params;
+}
+
+/**
+ * \ingroup test
+ * \brief Head of line and deadline of the LCs
+ */
+class NrQosDeadlineTestCase : public TestCase
+{
+public:
+  NrQosDeadlineTestCase () : TestCase ("QoS head of line and deadline of the LCs") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrQosDeadlineTestCase::DoRun ()
+{
+  const uint8_t lcId = 3;
+  const Time budget = MilliSeconds (300);
+
+  // DL: the RLC reports the age of the oldest byte
+  NrMacSchedulerLCG dl (1);
+  dl.Insert (LCPtr (new NrMacSchedulerLC (CreateLcConfig (lcId))));
+  NS_TEST_ASSERT_MSG_EQ (dl.GetEarliestDeadline (), Time::Max (), "An empty LC has no deadline");
+
+  dl.UpdateInfo (CreateRlcReport (lcId, 100, 0), MilliSeconds (0));
+  dl.UpdateInfo (CreateRlcReport (lcId, 300, 10), MilliSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (dl.GetEarliestDeadline (), budget,
+                         "The deadline is the arrival of the oldest byte plus the budget");
+
+  // A transmission drains the 100 oldest bytes (2 bytes are RLC overhead):
+  // the head of line moves to the bytes arrived at 10 ms
+  dl.AssignedData (lcId, 102, "DL");
+  NS_TEST_ASSERT_MSG_EQ (dl.GetTotalSizeOfLC (lcId), 200, "Wrong queue after the transmission");
+  NS_TEST_ASSERT_MSG_EQ (dl.GetEarliestDeadline (), MilliSeconds (10) + budget,
+                         "The head of line must advance when the oldest bytes are sent");
+
+  // A partial transmission of the head does not change it
+  dl.AssignedData (lcId, 52, "DL");
+  NS_TEST_ASSERT_MSG_EQ (dl.GetEarliestDeadline (), MilliSeconds (10) + budget,
+                         "The head of line must not move while its bytes are queued");
+
+  // The RLC report replaces the estimate
+  dl.UpdateInfo (CreateRlcReport (lcId, 150, 5), MilliSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ (dl.GetEarliestDeadline (), MilliSeconds (15) + budget,
+                         "The report of the RLC must re-derive the head of line");
+
+  dl.UpdateInfo (CreateRlcReport (lcId, 0, 0), MilliSeconds (30));
+  NS_TEST_ASSERT_MSG_EQ (dl.GetEarliestDeadline (), Time::Max (), "An empty LC has no deadline");
+
+  // UL: the BSR carries no delay, the new bytes arrived at the report
+  NrMacSchedulerLCG ul (1);
+  ul.Insert (LCPtr (new NrMacSchedulerLC (CreateLcConfig (lcId))));
+  ul.UpdateInfo (500, MilliSeconds (0));
+  ul.UpdateInfo (800, MilliSeconds (5));
+  NS_TEST_ASSERT_MSG_EQ (ul.GetEarliestDeadline (), budget, "The oldest byte arrived at the first BSR");
+
+  // The grant drains 498 bytes: 2 bytes of the first BSR remain
+  ul.AssignedData (lcId, 500, "UL");
+  NS_TEST_ASSERT_MSG_EQ (ul.GetEarliestDeadline (), budget,
+                         "The head of line must not move while its bytes are queued");
+
+  // The next BSR shows that the bytes of the first BSR have gone
+  ul.UpdateInfo (300, MilliSeconds (8));
+  NS_TEST_ASSERT_MSG_EQ (ul.GetEarliestDeadline (), MilliSeconds (5) + budget,
+                         "The BSR must re-derive the head of line");
+
+  ul.UpdateInfo (0, MilliSeconds (9));
+  NS_TEST_ASSERT_MSG_EQ (ul.GetEarliestDeadline (), Time::Max (), "An empty LC has no deadline");
+  ul.UpdateInfo (400, MilliSeconds (12));
+  NS_TEST_ASSERT_MSG_EQ (ul.GetEarliestDeadline (), MilliSeconds (12) + budget,
+                         "After an empty BSR, the head of line is the next BSR");
+}
+
+/**
+ * \ingroup test
+ * \brief The QoS schedulers serve the UE with the earliest deadline, and
+ * update the deadline after the transmission of the oldest bytes
+ */
+class NrQosSchedulingOrderTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param scheduler type of the scheduler
+   */
+  NrQosSchedulingOrderTestCase (const TypeId &scheduler)
+    : TestCase ("QoS scheduling order of " + scheduler.GetName ()),
+      m_scheduler (scheduler)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Get the only UE served in the last slot
+   * \param driver the driver
+   * \return the RNTI of the UE, or 0 if zero or more than one UE are served
+   */
+  static uint16_t GetServedUe (const NrSchedulerTestDriver &driver);
+
+  TypeId m_scheduler; //!< Scheduler type
+};
+
+uint16_t
+NrQosSchedulingOrderTestCase::GetServedUe (const NrSchedulerTestDriver &driver)
+{
+  auto allocations = driver.GetLastAllocations (true);
+  return allocations.size () == 1 ? allocations.front ().m_dci->m_rnti : 0;
+}
+
+void
+NrQosSchedulingOrderTestCase::DoRun ()
+{
+  ObjectFactory factory;
+  factory.SetTypeId (m_scheduler);
+  factory.Set ("FixedMcsDl", BooleanValue (true));
+  factory.Set ("StartingMcsDl", UintegerValue (10));
+
+  // A small bandwidth, which is not enough for the buffer of a single UE
+  NrSchedulerTestDriver driver (factory, 4);
+
+  // The UEs have the same channel, the one with the earliest deadline wins:
+  // with a budget of 300 ms, the deadlines are 300, 100, 200 and 150 ms
+  const std::vector<uint16_t> holDelays = {0, 200, 100, 150};
+  for (uint16_t i = 0; i < holDelays.size (); ++i)
+    {
+      driver.AddUe (i + 1);
+      driver.DlBuffer (i + 1, 100000, holDelays.at (i));
+    }
+  driver.DoSlot ();
+  NS_TEST_ASSERT_MSG_EQ (GetServedUe (driver), 2, "The UE with the earliest deadline must be served");
+  driver.DoSlot ();
+  NS_TEST_ASSERT_MSG_EQ (GetServedUe (driver), 2, "The head of line of UE 2 did not change");
+
+  // UE 5 has few bytes with the earliest deadline (10 ms), followed by a
+  // large queue of new bytes
+  driver.AddUe (5);
+  driver.DlBuffer (5, 40, 290);
+  driver.DlBuffer (5, 100040, 290);
+  driver.DoSlot ();
+  NS_TEST_ASSERT_MSG_EQ (GetServedUe (driver), 5, "The UE with the earliest deadline must be served");
+
+  // The old bytes of UE 5 are gone: its deadline is now the one of the new
+  // bytes, and UE 2 is the most urgent again
+  driver.DoSlot ();
+  NS_TEST_ASSERT_MSG_EQ (GetServedUe (driver), 2,
+                         "The deadline of UE 5 must advance after the transmission of its oldest bytes");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the QoS schedulers
+ */
+class NrQosSchedulerTestSuite : public TestSuite
+{
+public:
+  NrQosSchedulerTestSuite ()
+    : TestSuite ("nr-test-sched-qos", UNIT)
+  {
+    AddTestCase (new NrQosDeadlineTestCase (), TestCase::QUICK);
+    AddTestCase (new NrQosSchedulingOrderTestCase (NrMacSchedulerOfdmaQos::GetTypeId ()), TestCase::QUICK);
+    AddTestCase (new NrQosSchedulingOrderTestCase (NrMacSchedulerTdmaQos::GetTypeId ()), TestCase::QUICK);
+  }
+};
+
+static NrQosSchedulerTestSuite nrQosSchedulerTestSuite; //!< QoS scheduler test suite
+
+} // namespace ns3
@@ -0,0 +1,209 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/nr-mac-scheduler-ofdma-rr.h>
+#include <ns3/nr-mac-scheduler-tdma-rr.h>
+#include "nr-scheduler-test-driver.h"
+
+/**
+ * \file nr-test-sched-slot-stats.cc
+ * \ingroup test
+ *
+ * \brief Test the per-slot statistics of the scheduler (attribute
+ * EnableSlotStats and trace source SlotStats).
+ *
+ * Some UEs with full buffers are scheduled for a number of slots. The test
+ * checks that one report is traced for each DL and UL decision, with the
+ * right slot and direction, that the data DCIs counted are the ones
+ * returned to the MAC, that each UE with data is considered once per slot,
+ * and that the totals are the sum of the reports. Without the attribute,
+ * nothing must be traced nor counted.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Check the counters of NrMacSchedulerSlotStats
+ */
+class NrSlotStatsTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param scheduler type of the scheduler
+   * \param enabled value of the attribute EnableSlotStats
+   */
+  NrSlotStatsTestCase (const TypeId &scheduler, bool enabled)
+    : TestCase ("Slot statistics of " + scheduler.GetName () +
+                (enabled ? " enabled" : " disabled")),
+      m_scheduler (scheduler),
+      m_enabled (enabled)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Record a report
+   * \param stats the statistics of the slot
+   */
+  void SlotStats (const NrMacSchedulerSlotStats &stats);
+
+  TypeId m_scheduler;                              //!< Scheduler type
+  bool m_enabled {false};                          //!< EnableSlotStats
+  std::vector<NrMacSchedulerSlotStats> m_reports;  //!< Traced reports
+};
+
+void
+NrSlotStatsTestCase::SlotStats (const NrMacSchedulerSlotStats &stats)
+{
+  m_reports.push_back (stats);
+}
+
+void
+NrSlotStatsTestCase::DoRun ()
+{
+  const uint16_t ues = 3;
+  const uint32_t slots = 20;
+
+  ObjectFactory factory;
+  factory.SetTypeId (m_scheduler);
+  factory.Set ("FixedMcsDl", BooleanValue (true));
+  factory.Set ("FixedMcsUl", BooleanValue (true));
+  factory.Set ("EnableSlotStats", BooleanValue (m_enabled));
+
+  NrSchedulerTestDriver driver (factory, 52);
+  driver.GetScheduler ()->TraceConnectWithoutContext ("SlotStats",
+                                                       MakeCallback (&NrSlotStatsTestCase::SlotStats, this));
+  NS_TEST_ASSERT_MSG_EQ (driver.GetScheduler ()->IsSlotStatsEnabled (), m_enabled,
+                         "The attribute must enable the statistics");
+
+  for (uint16_t rnti = 1; rnti <= ues; ++rnti)
+    {
+      driver.AddUe (rnti);
+      driver.DlBuffer (rnti, 10000000);
+      driver.UlBsr (rnti, 10000000);
+    }
+
+  std::vector<SfnSf> targets;
+  for (uint32_t i = 0; i < slots; ++i)
+    {
+      SfnSf target = driver.GetCurrentSlot ();
+      target.Add (2);
+      targets.push_back (target);
+      driver.DoSlot ();
+    }
+
+  uint64_t dlDci = 0;
+  uint64_t ulDci = 0;
+  for (uint16_t rnti = 1; rnti <= ues; ++rnti)
+    {
+      dlDci += driver.GetAllocations (rnti, true).size ();
+      ulDci += driver.GetAllocations (rnti, false).size ();
+    }
+  NS_TEST_ASSERT_MSG_GT (dlDci, 0, "No DL data scheduled");
+  NS_TEST_ASSERT_MSG_GT (ulDci, 0, "No UL data scheduled");
+
+  const NrMacSchedulerSlotStats & dlTotal = driver.GetScheduler ()->GetSlotStatsTotal (true);
+  const NrMacSchedulerSlotStats & ulTotal = driver.GetScheduler ()->GetSlotStatsTotal (false);
+
+  if (! m_enabled)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_reports.size (), 0, "Reports traced with the statistics disabled");
+      NS_TEST_ASSERT_MSG_EQ (dlTotal.m_numSlots + ulTotal.m_numSlots, 0,
+                             "Slots counted with the statistics disabled");
+      Simulator::Destroy ();
+      return;
+    }
+
+  // One UL and one DL report per trigger, in this order
+  NS_TEST_ASSERT_MSG_EQ (m_reports.size (), 2 * slots, "Expected one report per decision");
+  NrMacSchedulerSlotStats dlSum;
+  NrMacSchedulerSlotStats ulSum;
+  for (uint32_t i = 0; i < m_reports.size (); ++i)
+    {
+      const NrMacSchedulerSlotStats & report = m_reports.at (i);
+      NS_TEST_ASSERT_MSG_EQ (report.m_isDl, i % 2 == 1, "Wrong direction of report " << i);
+      NS_TEST_ASSERT_MSG_EQ (report.m_sfnSf, targets.at (i / 2), "Wrong slot of report " << i);
+      NS_TEST_ASSERT_MSG_EQ (report.m_numSlots, 1, "A report is for one slot");
+      NS_TEST_ASSERT_MSG_EQ (report.m_cellId, 1, "Wrong cell");
+      if (report.m_isDl)
+        {
+          // The UEs have data and free HARQ processes in every slot
+          NS_TEST_ASSERT_MSG_EQ (report.m_counters[NrMacSchedulerSlotStats::UE_CONSIDERED], ues,
+                                 "Each UE with data must be considered once");
+          dlSum += report;
+        }
+      else
+        {
+          ulSum += report;
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (dlTotal.m_numSlots, slots, "Wrong number of DL slots");
+  NS_TEST_ASSERT_MSG_EQ (ulTotal.m_numSlots, slots, "Wrong number of UL slots");
+  NS_TEST_ASSERT_MSG_EQ (dlTotal.m_counters[NrMacSchedulerSlotStats::DCI_EMITTED], dlDci,
+                         "The DL DCIs counted are not the ones returned to the MAC");
+  NS_TEST_ASSERT_MSG_EQ (ulTotal.m_counters[NrMacSchedulerSlotStats::DCI_EMITTED], ulDci,
+                         "The UL DCIs counted are not the ones returned to the MAC");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (dlTotal.m_counters[NrMacSchedulerSlotStats::TBS_COMPUTATIONS], dlDci,
+                               "The TBS of each DL DCI must be counted");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (ulTotal.m_counters[NrMacSchedulerSlotStats::TBS_COMPUTATIONS], ulDci,
+                               "The TBS of each UL DCI must be counted");
+
+  for (uint8_t c = 0; c < NrMacSchedulerSlotStats::NUM_COUNTERS; ++c)
+    {
+      NS_TEST_ASSERT_MSG_EQ (dlTotal.m_counters[c], dlSum.m_counters[c],
+                             "DL total of " << NrMacSchedulerSlotStats::GetCounterName (
+                               static_cast<NrMacSchedulerSlotStats::Counter> (c)) <<
+                             " is not the sum of the reports");
+      NS_TEST_ASSERT_MSG_EQ (ulTotal.m_counters[c], ulSum.m_counters[c],
+                             "UL total of " << NrMacSchedulerSlotStats::GetCounterName (
+                               static_cast<NrMacSchedulerSlotStats::Counter> (c)) <<
+                             " is not the sum of the reports");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the per-slot statistics of the scheduler
+ */
+class NrSlotStatsTestSuite : public TestSuite
+{
+public:
+  NrSlotStatsTestSuite ()
+    : TestSuite ("nr-test-sched-slot-stats", UNIT)
+  {
+    for (const auto & type : {NrMacSchedulerOfdmaRR::GetTypeId (), NrMacSchedulerTdmaRR::GetTypeId ()})
+      {
+        AddTestCase (new NrSlotStatsTestCase (type, false), TestCase::QUICK);
+        AddTestCase (new NrSlotStatsTestCase (type, true), TestCase::QUICK);
+      }
+  }
+};
+
+static NrSlotStatsTestSuite nrSlotStatsTestSuite; //!< Slot statistics test suite
+
+} // namespace ns3
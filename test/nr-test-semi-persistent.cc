@@ -0,0 +1,455 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/enum.h>
+#include <ns3/uinteger.h>
+#include <ns3/nr-helper.h>
+#include <ns3/nr-mac-scheduler-ofdma-rr.h>
+#include "nr-scheduler-test-driver.h"
+#include "nr-trace-comparison-scenario.h"
+
+/**
+ * \file nr-test-semi-persistent.cc
+ * \ingroup test
+ *
+ * \brief Test the periodic resources of the scheduler: the DL SPS and the UL
+ * configured grants of Type 1 and Type 2.
+ *
+ * The unit tests drive the scheduler directly, and check that the
+ * allocations are given only in the occasions, with the configured
+ * symbols and MCS, that a Type 2 grant is activated by the data and
+ * released after the configured number of empty occasions, and that
+ * nothing is given after the release of the configuration or of the UE.
+ *
+ * The system tests check that the UE sends the SR as usual when it has no
+ * active configured grant: with the attribute UlConfiguredGrant of the UE
+ * MAC enabled and no configured grant at the gNB the simulation is the same
+ * as with the attribute disabled, and the UL data arriving after the
+ * release of a Type 2 grant is still delivered.
+ */
+namespace ns3 {
+
+typedef NrMacSchedulerNs3::SemiPersistentConfig SemiPersistentConfig;
+
+/**
+ * \brief Create the factory of the scheduler of the unit tests
+ * \return the factory of a OFDMA RR scheduler with fixed MCS
+ */
+static ObjectFactory
+CreateSchedulerFactory ()
+{
+  ObjectFactory factory;
+  factory.SetTypeId (NrMacSchedulerOfdmaRR::GetTypeId ());
+  factory.Set ("FixedMcsDl", BooleanValue (true));
+  factory.Set ("FixedMcsUl", BooleanValue (true));
+  factory.Set ("StartingMcsDl", UintegerValue (10));
+  factory.Set ("StartingMcsUl", UintegerValue (10));
+  return factory;
+}
+
+/**
+ * \brief Check if a slot is an occasion
+ * \param sfn the slot
+ * \param periodicity the periodicity
+ * \param offset the offset
+ * \return true if the slot is an occasion
+ */
+static bool
+IsOccasion (const SfnSf &sfn, uint16_t periodicity, uint16_t offset)
+{
+  return sfn.Normalize () % periodicity == offset;
+}
+
+/**
+ * \brief Advance the driver until the next slot to schedule is an occasion
+ * \param driver the driver
+ * \param periodicity the periodicity
+ * \param offset the offset
+ */
+static void
+AdvanceToOccasion (NrSchedulerTestDriver *driver, uint16_t periodicity, uint16_t offset)
+{
+  SfnSf target = driver->GetCurrentSlot ();
+  target.Add (2);
+  while (! IsOccasion (target, periodicity, offset))
+    {
+      driver->DoSlot ();
+      target.Add (1);
+    }
+}
+
+/**
+ * \ingroup test
+ * \brief DL SPS: the data is sent only in the occasions, with the configured
+ * symbols and MCS
+ */
+class NrDlSpsTestCase : public TestCase
+{
+public:
+  NrDlSpsTestCase () : TestCase ("DL SPS occasions") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrDlSpsTestCase::DoRun ()
+{
+  const uint16_t periodicity = 4;
+  const uint16_t offset = 1;
+  const uint32_t slots = 40;
+
+  NrSchedulerTestDriver driver (CreateSchedulerFactory (), 52);
+  driver.AddUe (1);
+
+  SemiPersistentConfig config;
+  config.m_type = SemiPersistentConfig::DL_SPS;
+  config.m_periodicity = periodicity;
+  config.m_offset = offset;
+  config.m_numSym = 2;
+  config.m_mcs = 5;
+  driver.GetScheduler ()->SetSemiPersistentConfig (1, config);
+
+  driver.DlBuffer (1, 1000000);
+  uint32_t occasions = 0;
+  for (uint32_t i = 0; i < slots; ++i)
+    {
+      SfnSf target = driver.GetCurrentSlot ();
+      target.Add (2);
+      occasions += IsOccasion (target, periodicity, offset) ? 1 : 0;
+      driver.DoSlot ();
+    }
+
+  auto allocations = driver.GetAllocations (1, true);
+  NS_TEST_ASSERT_MSG_EQ (allocations.size (), occasions, "The UE must get exactly the occasions");
+  for (const auto & alloc : allocations)
+    {
+      NS_TEST_ASSERT_MSG_EQ (IsOccasion (alloc.m_sfnSf, periodicity, offset), true,
+                             "Allocation outside the occasions in slot " << alloc.m_sfnSf);
+      NS_TEST_ASSERT_MSG_EQ (+alloc.m_dci->m_numSym, +config.m_numSym, "Wrong number of symbols");
+      NS_TEST_ASSERT_MSG_EQ (+alloc.m_dci->m_mcs.at (0), +config.m_mcs, "Wrong MCS");
+      NS_TEST_ASSERT_MSG_EQ (alloc.m_dci->m_cgPeriodicity, 0, "A DL DCI is not a configured grant");
+    }
+
+  // After the release of the UE, nothing is scheduled anymore
+  driver.ReleaseUe (1);
+  size_t before = allocations.size ();
+  for (uint32_t i = 0; i < slots; ++i)
+    {
+      driver.DoSlot ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (driver.GetAllocations (1, true).size (), before,
+                         "SPS occasions after the release of the UE");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief UL configured grant Type 1: a grant at each occasion, without BSR
+ * or SR, until the release of the configuration. The configuration of a
+ * UE can also come from the attributes of the scheduler.
+ */
+class NrUlCgType1TestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param fromAttributes if true, configure the grant through the
+   * attributes of the scheduler, otherwise through SetSemiPersistentConfig
+   */
+  NrUlCgType1TestCase (bool fromAttributes)
+    : TestCase (std::string ("UL configured grant Type 1 configured by ") +
+                (fromAttributes ? "attributes" : "SetSemiPersistentConfig")),
+      m_fromAttributes (fromAttributes)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  bool m_fromAttributes {false}; //!< Configure through the attributes
+};
+
+void
+NrUlCgType1TestCase::DoRun ()
+{
+  const uint16_t rnti = 7;
+  const uint16_t periodicity = 5;
+  // The attributes give to each UE the offset RNTI % periodicity
+  const uint16_t offset = rnti % periodicity;
+  const uint8_t numSym = 3;
+  const uint8_t mcs = 8;
+  const uint32_t slots = 50;
+
+  ObjectFactory factory = CreateSchedulerFactory ();
+  if (m_fromAttributes)
+    {
+      factory.Set ("UlConfiguredGrantPeriodicity", UintegerValue (periodicity));
+      factory.Set ("UlConfiguredGrantType", EnumValue (SemiPersistentConfig::UL_TYPE1));
+      factory.Set ("SemiPersistentSymbols", UintegerValue (numSym));
+      factory.Set ("SemiPersistentMcs", UintegerValue (mcs));
+    }
+
+  NrSchedulerTestDriver driver (factory, 52);
+  driver.AddUe (rnti);
+  // A UE without configured grant, served dynamically
+  driver.AddUe (rnti + 1);
+
+  if (! m_fromAttributes)
+    {
+      SemiPersistentConfig config;
+      config.m_type = SemiPersistentConfig::UL_TYPE1;
+      config.m_periodicity = periodicity;
+      config.m_offset = offset;
+      config.m_numSym = numSym;
+      config.m_mcs = mcs;
+      driver.GetScheduler ()->SetSemiPersistentConfig (rnti, config);
+    }
+  else
+    {
+      // The other UE got its own configuration: remove it
+      driver.GetScheduler ()->ReleaseSemiPersistentConfig (rnti + 1, DciInfoElementTdma::UL);
+    }
+
+  driver.UlBsr (rnti + 1, 500);
+  uint32_t occasions = 0;
+  for (uint32_t i = 0; i < slots; ++i)
+    {
+      SfnSf target = driver.GetCurrentSlot ();
+      target.Add (2);
+      occasions += IsOccasion (target, periodicity, offset) ? 1 : 0;
+      driver.DoSlot ();
+    }
+
+  auto allocations = driver.GetAllocations (rnti, false);
+  NS_TEST_ASSERT_MSG_EQ (allocations.size (), occasions,
+                         "A Type 1 grant must be given at each occasion, even without data");
+  for (const auto & alloc : allocations)
+    {
+      NS_TEST_ASSERT_MSG_EQ (IsOccasion (alloc.m_sfnSf, periodicity, offset), true,
+                             "Grant outside the occasions in slot " << alloc.m_sfnSf);
+      NS_TEST_ASSERT_MSG_EQ (+alloc.m_dci->m_numSym, +numSym, "Wrong number of symbols");
+      NS_TEST_ASSERT_MSG_EQ (+alloc.m_dci->m_mcs.at (0), +mcs, "Wrong MCS");
+      NS_TEST_ASSERT_MSG_EQ (alloc.m_dci->m_cgPeriodicity, periodicity,
+                             "The DCI of an occasion must carry the periodicity of the grant");
+    }
+
+  auto dynamic = driver.GetAllocations (rnti + 1, false);
+  NS_TEST_ASSERT_MSG_GT (dynamic.size (), 0, "The UE without configured grant is not served");
+  for (const auto & alloc : dynamic)
+    {
+      NS_TEST_ASSERT_MSG_EQ (alloc.m_dci->m_cgPeriodicity, 0,
+                             "A dynamic grant must not look like a configured one");
+    }
+
+  // After the release, no grant is given without a BSR
+  driver.GetScheduler ()->ReleaseSemiPersistentConfig (rnti, DciInfoElementTdma::UL);
+  size_t before = allocations.size ();
+  for (uint32_t i = 0; i < slots; ++i)
+    {
+      driver.DoSlot ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (driver.GetAllocations (rnti, false).size (), before,
+                         "Grants after the release of the configured grant");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief UL configured grant Type 2: activated by a BSR, and released after
+ * the configured number of empty occasions
+ */
+class NrUlCgType2TestCase : public TestCase
+{
+public:
+  NrUlCgType2TestCase () : TestCase ("UL configured grant Type 2 activation and release") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrUlCgType2TestCase::DoRun ()
+{
+  const uint16_t periodicity = 2;
+  const uint16_t offset = 0;
+  const uint8_t releaseAfter = 3;
+
+  NrSchedulerTestDriver driver (CreateSchedulerFactory (), 52);
+  driver.AddUe (1);
+
+  SemiPersistentConfig config;
+  config.m_type = SemiPersistentConfig::UL_TYPE2;
+  config.m_periodicity = periodicity;
+  config.m_offset = offset;
+  config.m_numSym = 4;
+  config.m_mcs = 10;
+  config.m_releaseAfter = releaseAfter;
+  driver.GetScheduler ()->SetSemiPersistentConfig (1, config);
+
+  // Without data, the grant is not active
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      driver.DoSlot ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (driver.GetAllocations (1, false).size (), 0,
+                         "A Type 2 grant must wait for the data");
+
+  // The BSR activates the grant; the data fits in the first occasion, and
+  // the grant is released at the releaseAfter-th empty occasion. The BSR
+  // arrives just before an occasion, otherwise the inactive grant would
+  // leave the data to the dynamic scheduling
+  AdvanceToOccasion (&driver, periodicity, offset);
+  driver.UlBsr (1, 200);
+  for (uint32_t i = 0; i < 10 * periodicity; ++i)
+    {
+      driver.DoSlot ();
+    }
+
+  auto allocations = driver.GetAllocations (1, false);
+  NS_TEST_ASSERT_MSG_EQ (allocations.size (), releaseAfter,
+                         "Expected the activation and " << releaseAfter - 1 << " empty occasions");
+  for (size_t i = 0; i < allocations.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (IsOccasion (allocations.at (i).m_sfnSf, periodicity, offset), true,
+                             "Grant outside the occasions in slot " << allocations.at (i).m_sfnSf);
+      NS_TEST_ASSERT_MSG_EQ (allocations.at (i).m_dci->m_cgPeriodicity, periodicity,
+                             "The DCI of an occasion must carry the periodicity of the grant");
+      if (i > 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (allocations.at (i).m_sfnSf.Normalize () -
+                                 allocations.at (i - 1).m_sfnSf.Normalize (), periodicity,
+                                 "The occasions must be consecutive");
+        }
+    }
+
+  // New data activates the grant again
+  AdvanceToOccasion (&driver, periodicity, offset);
+  driver.UlBsr (1, 200);
+  for (uint32_t i = 0; i < 10 * periodicity; ++i)
+    {
+      driver.DoSlot ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (driver.GetAllocations (1, false).size (), 2 * releaseAfter,
+                         "The grant must be activated again by the new data");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief The attribute UlConfiguredGrant of the UE does not change anything
+ * without configured grants at the gNB
+ */
+class NrUeCgWithoutGrantTestCase : public TestCase
+{
+public:
+  NrUeCgWithoutGrantTestCase () : TestCase ("UE UlConfiguredGrant without configured grant at the gNB") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrUeCgWithoutGrantTestCase::DoRun ()
+{
+  NrTraceComparisonScenario scenario;
+  scenario.m_gnbNum = 1;
+
+  auto disabled = scenario.Run ([] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetUeMacAttribute ("UlConfiguredGrant", BooleanValue (false));
+  });
+  auto enabled = scenario.Run ([] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetUeMacAttribute ("UlConfiguredGrant", BooleanValue (true));
+  });
+
+  NS_TEST_ASSERT_MSG_GT (disabled.size (), 0, "Nothing happened in the simulation");
+  NS_TEST_ASSERT_MSG_EQ (NrTraceComparisonScenario::FirstDifference (disabled, enabled), "",
+                         "Without configured grants, the UE must send the SR as usual");
+}
+
+/**
+ * \ingroup test
+ * \brief The UL data that arrives after the release of a Type 2 grant is
+ * delivered: the UE sends a SR when the occasions stop
+ */
+class NrUeCgReleasedTestCase : public TestCase
+{
+public:
+  NrUeCgReleasedTestCase () : TestCase ("UE UlConfiguredGrant after the release of a Type 2 grant") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrUeCgReleasedTestCase::DoRun ()
+{
+  NrTraceComparisonScenario scenario;
+  scenario.m_gnbNum = 1;
+  scenario.m_isDownlink = false;
+  // Sparse packets: the grant is released between two of them
+  scenario.m_packetInterval = MilliSeconds (20);
+
+  auto countRx = [] (const std::vector<std::string> &events) {
+    return std::count_if (events.begin (), events.end (), [] (const std::string &e) {
+      return e.find (" rx ") != std::string::npos;
+    });
+  };
+
+  auto events = scenario.Run ([] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetUeMacAttribute ("UlConfiguredGrant", BooleanValue (true));
+    nrHelper->SetSchedulerAttribute ("UlConfiguredGrantPeriodicity", UintegerValue (4));
+    nrHelper->SetSchedulerAttribute ("UlConfiguredGrantType", EnumValue (SemiPersistentConfig::UL_TYPE2));
+    nrHelper->SetSchedulerAttribute ("UlConfiguredGrantReleaseAfter", UintegerValue (2));
+    nrHelper->SetSchedulerAttribute ("SemiPersistentSymbols", UintegerValue (2));
+  });
+
+  // The last packets of the flows are sent 20 ms before the end
+  int64_t expected = (scenario.m_simTime - scenario.m_appStart).GetMilliSeconds () /
+    scenario.m_packetInterval.GetMilliSeconds () * scenario.m_uesPerGnb;
+  NS_TEST_ASSERT_MSG_EQ (countRx (events), expected, "UL packets lost after the release of the grant");
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the SPS and the configured grants
+ */
+class NrSemiPersistentTestSuite : public TestSuite
+{
+public:
+  NrSemiPersistentTestSuite ()
+    : TestSuite ("nr-test-semi-persistent", UNIT)
+  {
+    AddTestCase (new NrDlSpsTestCase (), TestCase::QUICK);
+    AddTestCase (new NrUlCgType1TestCase (false), TestCase::QUICK);
+    AddTestCase (new NrUlCgType1TestCase (true), TestCase::QUICK);
+    AddTestCase (new NrUlCgType2TestCase (), TestCase::QUICK);
+    AddTestCase (new NrUeCgWithoutGrantTestCase (), TestCase::QUICK);
+    AddTestCase (new NrUeCgReleasedTestCase (), TestCase::QUICK);
+  }
+};
+
+static NrSemiPersistentTestSuite nrSemiPersistentTestSuite; //!< SPS and configured grant test suite
+
+} // namespace ns3
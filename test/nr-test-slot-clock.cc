@@ -0,0 +1,139 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/nr-helper.h>
+#include <ns3/nr-gnb-phy.h>
+#include <ns3/nr-slot-clock.h>
+#include "nr-trace-comparison-scenario.h"
+
+/**
+ * \file nr-test-slot-clock.cc
+ * \ingroup test
+ *
+ * \brief Check that the attribute UseSlotClock of NrHelper does not change
+ * the outcome of a simulation.
+ *
+ * Two gNBs serve two UEs each, with DL and UL traffic. The CTRL messages
+ * and the DCI received by the UEs, the scheduling of the gNBs and the
+ * packets received by the applications must be the same as in a run
+ * without the slot clock, at the same times, while the clock must run
+ * more than one slot boundary per event and the simulator must execute fewer
+ * events. The test is run with busy UEs, and with idle UEs that skip their
+ * empty slots (attribute IdleSlotSkipping of NrUePhy), which resume their
+ * slots through the clock, and with gNBs of numerology 0 and 1, whose slot
+ * boundaries happen at the same time but are scheduled at different times.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Compare a run with and without UseSlotClock
+ */
+class NrSlotClockTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create the test case
+   * \param idle if true, the UEs have a packet every 20 ms and skip their
+   * empty slots; otherwise, they have a packet every ms
+   * \param mixedNumerologies if true, the gNBs use numerology 0 and 1;
+   * otherwise, they both use numerology 1
+   */
+  NrSlotClockTestCase (bool idle, bool mixedNumerologies)
+    : TestCase (std::string ("Slot clock with ") + (idle ? "idle" : "busy") + " UEs" +
+                (mixedNumerologies ? " and mixed numerologies" : "")),
+      m_idle (idle),
+      m_mixedNumerologies (mixedNumerologies)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  bool m_idle {false};              //!< Idle UEs, skipping their empty slots
+  bool m_mixedNumerologies {false}; //!< gNBs with numerology 0 and 1
+};
+
+void
+NrSlotClockTestCase::DoRun ()
+{
+  NrTraceComparisonScenario scenario;
+  if (m_idle)
+    {
+      scenario.m_packetInterval = MilliSeconds (20);
+    }
+  if (m_mixedNumerologies)
+    {
+      scenario.m_gnbNumerologies = {0, 1};
+    }
+
+  // Number of events executed by the simulator, just before its end, and
+  // the slot clock of the run
+  uint64_t eventCount = 0;
+  Ptr<NrSlotClock> clock;
+  scenario.m_onInstalled = [&scenario, &eventCount, &clock] (const NetDeviceContainer &gnbDevs,
+                                                             const NetDeviceContainer &)
+    {
+      clock = NrHelper::GetGnbPhy (gnbDevs.Get (0), 0)->GetSlotClock ();
+      Simulator::Schedule (scenario.m_simTime - NanoSeconds (1),
+                           [&eventCount] () { eventCount = Simulator::GetEventCount (); });
+    };
+
+  const bool idle = m_idle;
+  auto perPhy = scenario.Run ([idle] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetUePhyAttribute ("IdleSlotSkipping", BooleanValue (idle));
+  });
+  const uint64_t perPhyEvents = eventCount;
+  NS_TEST_ASSERT_MSG_EQ (clock, nullptr, "Without UseSlotClock, the PHYs must not have a slot clock");
+
+  auto batched = scenario.Run ([idle] (const Ptr<NrHelper> &nrHelper) {
+    nrHelper->SetUePhyAttribute ("IdleSlotSkipping", BooleanValue (idle));
+    nrHelper->SetAttribute ("UseSlotClock", BooleanValue (true));
+  });
+  const uint64_t batchedEvents = eventCount;
+
+  NS_TEST_ASSERT_MSG_GT (perPhy.size (), 0, "Nothing happened in the simulation");
+  NS_TEST_ASSERT_MSG_EQ (NrTraceComparisonScenario::FirstDifference (perPhy, batched), "",
+                         "The slot clock changed the simulation");
+  NS_TEST_ASSERT_MSG_NE (clock, nullptr, "With UseSlotClock, the PHYs must have a slot clock");
+  NS_TEST_ASSERT_MSG_GT (clock->GetCalls (), clock->GetEvents (),
+                         "The slot clock must run more than one slot boundary per event");
+  NS_TEST_ASSERT_MSG_LT (batchedEvents, perPhyEvents, "The slot clock must save simulator events");
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the slot clock
+ */
+class NrSlotClockTestSuite : public TestSuite
+{
+public:
+  NrSlotClockTestSuite ()
+    : TestSuite ("nr-test-slot-clock", SYSTEM)
+  {
+    AddTestCase (new NrSlotClockTestCase (false, false), TestCase::QUICK);
+    AddTestCase (new NrSlotClockTestCase (true, false), TestCase::QUICK);
+    AddTestCase (new NrSlotClockTestCase (false, true), TestCase::QUICK);
+  }
+};
+
+static NrSlotClockTestSuite nrSlotClockTestSuite; //!< Slot clock test suite
+
+} // namespace ns3
@@ -0,0 +1,130 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-slot-rbg-grid.h>
+
+/**
+ * \file nr-test-slot-rbg-grid.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the symbol x RBG grid of the gNB PHY. Random
+ * allocations are stored in the grid, and the grid is compared with a
+ * per-symbol vector of RBG filled one by one. The grid is then reused for
+ * a second slot, to check that nothing of the first slot is left.
+ */
+namespace ns3 {
+
+class TestNrSlotRbgGridTestCase : public TestCase
+{
+public:
+  TestNrSlotRbgGridTestCase (uint32_t numRbg, uint32_t numAlloc, const std::string &name)
+    : TestCase (name),
+      m_numRbg (numRbg),
+      m_numAlloc (numAlloc)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Store random allocations in the grid and check it
+   * \param grid the grid
+   * \param seed the seed of the allocations
+   */
+  void FillAndCheck (NrSlotRbgGrid *grid, uint32_t seed);
+  uint32_t m_numRbg {0};   //!< Number of RBG
+  uint32_t m_numAlloc {0}; //!< Number of allocations in the slot
+};
+
+void
+TestNrSlotRbgGridTestCase::FillAndCheck (NrSlotRbgGrid *grid, uint32_t seed)
+{
+  std::vector<std::vector<uint8_t>> expected (NrSlotRbgGrid::MAX_SYMBOLS,
+                                              std::vector<uint8_t> (m_numRbg, 0));
+  grid->Clear (m_numRbg);
+  NS_TEST_ASSERT_MSG_EQ (grid->IsEmpty (), true, "The grid should be empty");
+
+  for (uint32_t a = 0; a < m_numAlloc; ++a)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint8_t symStart = (seed >> 16) % NrSlotRbgGrid::MAX_SYMBOLS;
+      seed = seed * 1103515245 + 12345;
+      uint8_t numSym = 1 + (seed >> 16) % (NrSlotRbgGrid::MAX_SYMBOLS - symStart);
+      NrRbMask mask (m_numRbg);
+      for (uint32_t rbg = 0; rbg < m_numRbg; ++rbg)
+        {
+          seed = seed * 1103515245 + 12345;
+          if ((seed >> 16) % 3 == 0)
+            {
+              mask.Set (rbg);
+              for (uint32_t sym = symStart; sym < static_cast<uint32_t> (symStart + numSym); ++sym)
+                {
+                  expected.at (sym).at (rbg) = 1;
+                }
+            }
+        }
+      grid->Store (symStart, numSym, mask);
+    }
+
+  uint32_t total = 0;
+  for (uint32_t sym = 0; sym < NrSlotRbgGrid::MAX_SYMBOLS; ++sym)
+    {
+      uint32_t count = 0;
+      for (uint32_t rbg = 0; rbg < m_numRbg; ++rbg)
+        {
+          NS_TEST_ASSERT_MSG_EQ (grid->IsUsed (sym, rbg), expected.at (sym).at (rbg) == 1,
+                                 "Wrong RBG " << rbg << " in symbol " << sym);
+          count += expected.at (sym).at (rbg);
+        }
+      NS_TEST_ASSERT_MSG_EQ (grid->CountRbg (sym), count, "Wrong count in symbol " << sym);
+      NS_TEST_ASSERT_MSG_EQ (grid->GetRow (sym).ToVector () == expected.at (sym), true,
+                             "Wrong row for symbol " << sym);
+      total += count;
+    }
+  NS_TEST_ASSERT_MSG_EQ (grid->CountRbg (), total, "Wrong count in the slot");
+
+  uint32_t sym = grid->FindNextUsedSymbol (0);
+  if (sym < NrSlotRbgGrid::MAX_SYMBOLS)
+    {
+      NS_TEST_ASSERT_MSG_EQ (grid->GetRbMask (sym, 4).Count (), 4 * grid->CountRbg (sym),
+                             "Wrong RB mask for symbol " << sym);
+    }
+}
+
+void
+TestNrSlotRbgGridTestCase::DoRun ()
+{
+  NrSlotRbgGrid grid;
+  FillAndCheck (&grid, m_numRbg * 31 + m_numAlloc);
+  FillAndCheck (&grid, m_numRbg * 17 + m_numAlloc * 5);
+}
+
+class TestNrSlotRbgGrid : public TestSuite
+{
+public:
+  TestNrSlotRbgGrid () : TestSuite ("nr-test-slot-rbg-grid", UNIT)
+  {
+    AddTestCase (new TestNrSlotRbgGridTestCase (17, 1, "17 RBG, 1 allocation"), QUICK);
+    AddTestCase (new TestNrSlotRbgGridTestCase (66, 4, "66 RBG, 4 allocations"), QUICK);
+    AddTestCase (new TestNrSlotRbgGridTestCase (275, 12, "275 RBG, 12 allocations"), QUICK);
+  }
+};
+
+static TestNrSlotRbgGrid testNrSlotRbgGrid; //!< Slot RBG grid test
+
+}  // namespace ns3
@@ -0,0 +1,101 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-slot-ring.h>
+
+/**
+ * \file nr-test-slot-ring.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the slot ring used by the PHY. A sliding set of
+ * slots is stored and removed as the PHY does (a few slots ahead of the
+ * current one), and then slots that collide in the window are stored to
+ * check that the window grows without losing any slot.
+ */
+namespace ns3 {
+
+class TestNrSlotRingTestCase : public TestCase
+{
+public:
+  TestNrSlotRingTestCase (uint32_t window, uint32_t lookAhead, const std::string &name)
+    : TestCase (name),
+      m_window (window),
+      m_lookAhead (lookAhead)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  uint32_t m_window {0};    //!< Initial window
+  uint32_t m_lookAhead {0}; //!< Number of slots stored ahead of the current one
+};
+
+void
+TestNrSlotRingTestCase::DoRun ()
+{
+  NrSlotRing<uint64_t> ring (m_window);
+  NS_TEST_ASSERT_MSG_EQ (ring.GetFirstSlot (), UINT64_MAX, "An empty ring has no first slot");
+
+  for (uint64_t slot = 0; slot < 100; ++slot)
+    {
+      ring.Insert (slot + m_lookAhead) = (slot + m_lookAhead) * 10;
+      NS_TEST_ASSERT_MSG_EQ (ring.GetFirstSlot (), slot < m_lookAhead ? m_lookAhead : slot,
+                             "Wrong first slot at " << slot);
+      if (slot >= m_lookAhead)
+        {
+          uint64_t *value = ring.Find (slot);
+          NS_TEST_ASSERT_MSG_NE (value, nullptr, "Slot " << slot << " not found");
+          NS_TEST_ASSERT_MSG_EQ (*value, slot * 10, "Wrong value for slot " << slot);
+          NS_TEST_ASSERT_MSG_EQ (ring.Erase (slot), true, "Slot " << slot << " not erased");
+          NS_TEST_ASSERT_MSG_EQ (ring.Erase (slot), false, "Slot " << slot << " erased twice");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.Size (), m_lookAhead, "Wrong number of slots stored");
+
+  // Store slots at a distance of one window: all of them fall in the same
+  // position, and the ring has to grow to keep them
+  ring.Clear ();
+  const uint64_t window = ring.GetWindow ();
+  for (uint64_t i = 0; i < 4; ++i)
+    {
+      ring.Insert (7 + i * window) = i;
+    }
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (ring.GetWindow (), 4 * window, "The window did not grow");
+  std::vector<uint64_t> slots = ring.GetSlots ();
+  NS_TEST_ASSERT_MSG_EQ (slots.size (), 4, "Wrong number of slots stored");
+  for (uint64_t i = 0; i < 4; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (slots.at (i), 7 + i * window, "Slots not in order");
+      NS_TEST_ASSERT_MSG_EQ (*ring.Find (slots.at (i)), i, "Value lost growing the window");
+    }
+}
+
+class TestNrSlotRing : public TestSuite
+{
+public:
+  TestNrSlotRing () : TestSuite ("nr-test-slot-ring", UNIT)
+  {
+    AddTestCase (new TestNrSlotRingTestCase (4, 2, "Window 4, 2 slots ahead"), QUICK);
+    AddTestCase (new TestNrSlotRingTestCase (5, 3, "Window 5 (8), 3 slots ahead"), QUICK);
+    AddTestCase (new TestNrSlotRingTestCase (16, 20, "Window 16, 20 slots ahead"), QUICK);
+  }
+};
+
+static TestNrSlotRing testNrSlotRing; //!< Slot ring test
+
+}  // namespace ns3
@@ -0,0 +1,356 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/nr-subband-cqi.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-spectrum-value-helper.h>
+#include <ns3/nr-mac-scheduler-cqi-management.h>
+#include <ns3/nr-mac-scheduler-ofdma-rr.h>
+#include "nr-scheduler-test-driver.h"
+
+/**
+ * \file nr-test-subband-cqi.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the subband CQI report. Random CQI differences
+ * are stored in a report, and read back quantized as in TS 38.214 Table
+ * 5.2.2.1-1. The sizes are chosen to have a smaller last subband and to
+ * cross the boundary of the internal words.
+ *
+ * The other tests follow the report through the chain: its creation from
+ * the SINR (NrAmc::CreateCqiFeedbackSbTdma, also with a subband size too
+ * small for the bandwidth), the MCS of each code computed by the scheduler
+ * (NrMacSchedulerCQIManagement::DlSBCQIReported) and the MCS of a set of
+ * RBG (NrMacSchedulerUeInfo::GetDlMcsOnRbg). Finally, an OFDMA scheduler
+ * must place the RBG of a UE on its best subbands
+ * (NrMacSchedulerOfdma::PlaceDlRbgOnSubbands), and use in the DCI the MCS
+ * of these subbands, with the TBS recomputed accordingly.
+ */
+namespace ns3 {
+
+class TestNrSubbandCqiTestCase : public TestCase
+{
+public:
+  TestNrSubbandCqiTestCase (uint32_t numRb, uint32_t rbPerSubband, const std::string &name)
+    : TestCase (name),
+      m_numRb (numRb),
+      m_rbPerSubband (rbPerSubband)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  uint32_t m_numRb {0};         //!< Number of RB
+  uint32_t m_rbPerSubband {0};  //!< RB per subband
+};
+
+void
+TestNrSubbandCqiTestCase::DoRun ()
+{
+  NrSubbandCqi sbCqi (m_numRb, m_rbPerSubband);
+  const uint32_t numSubbands = (m_numRb + m_rbPerSubband - 1) / m_rbPerSubband;
+  NS_TEST_ASSERT_MSG_EQ (sbCqi.GetNumSubbands (), numSubbands, "Wrong number of subbands");
+  NS_TEST_ASSERT_MSG_EQ (sbCqi.GetSubbandOfRb (m_numRb - 1), numSubbands - 1,
+                         "The last RB should be in the last subband");
+
+  std::vector<int8_t> expected (numSubbands, 0);
+  uint32_t seed = m_numRb * 31 + m_rbPerSubband;
+  for (uint32_t sb = 0; sb < numSubbands; ++sb)
+    {
+      seed = seed * 1103515245 + 12345;
+      int32_t diff = static_cast<int32_t> ((seed >> 16) % 9) - 4; // from -4 to 4
+      sbCqi.SetOffset (sb, diff);
+      expected.at (sb) = static_cast<int8_t> (std::max (-1, std::min (2, diff)));
+    }
+
+  for (uint32_t sb = 0; sb < numSubbands; ++sb)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+sbCqi.GetOffset (sb), +expected.at (sb),
+                             "Wrong offset for subband " << sb);
+      NS_TEST_ASSERT_MSG_EQ (+NrSubbandCqi::DecodeOffset (sbCqi.GetCode (sb)), +expected.at (sb),
+                             "Code and offset do not match for subband " << sb);
+    }
+
+  // Overwrite a subband: the neighbours must not change
+  sbCqi.SetOffset (0, 2);
+  NS_TEST_ASSERT_MSG_EQ (+sbCqi.GetOffset (0), 2, "Overwrite failed");
+  if (numSubbands > 1)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+sbCqi.GetOffset (1), +expected.at (1), "Overwrite changed subband 1");
+    }
+  expected.at (0) = 2;
+
+  // The range of the first two subbands gives the worst of the two
+  if (numSubbands > 1)
+    {
+      int8_t worst = std::min (expected.at (0), expected.at (1));
+      NS_TEST_ASSERT_MSG_EQ (+sbCqi.GetMinOffset (m_rbPerSubband - 1, 2), +worst,
+                             "Wrong minimum offset across two subbands");
+    }
+  NS_TEST_ASSERT_MSG_EQ (+sbCqi.GetMinOffset (0, 1), 2, "Wrong minimum offset of one RB");
+}
+
+/**
+ * \brief Create a SINR with two levels
+ * \param numRb number of RB
+ * \param isHigh function that tells if a RB has the high SINR
+ * \return the SINR, 100 (20 dB) in the high RB and 1 (0 dB) in the others
+ */
+static SpectrumValue
+CreateSinr (uint32_t numRb, const std::function<bool (uint32_t)> &isHigh)
+{
+  SpectrumValue sinr (NrSpectrumValueHelper::GetSpectrumModel (numRb, 3.5e9, 15e3));
+  for (uint32_t rb = 0; rb < numRb; ++rb)
+    {
+      sinr[rb] = isHigh (rb) ? 100.0 : 1.0;
+    }
+  return sinr;
+}
+
+/**
+ * \ingroup test
+ * \brief Creation of the subband CQI from the SINR, by NrAmc
+ */
+class TestNrSubbandCqiAmcTestCase : public TestCase
+{
+public:
+  TestNrSubbandCqiAmcTestCase () : TestCase ("Subband CQI created by NrAmc") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+TestNrSubbandCqiAmcTestCase::DoRun ()
+{
+  Ptr<NrAmc> amc = CreateObject<NrAmc> ();
+  const uint32_t numRb = 52;
+  const uint32_t rbPerSubband = 4;
+
+  // Same SINR everywhere: all the subbands are as the entire band
+  auto flat = amc->CreateCqiFeedbackSbTdma (CreateSinr (numRb, [] (uint32_t) { return true; }),
+                                            rbPerSubband, NrSubbandCqi ());
+  NS_TEST_ASSERT_MSG_EQ (flat.GetNumSubbands (), 13, "Wrong number of subbands");
+  NS_TEST_ASSERT_MSG_EQ (flat.GetRbPerSubband (), rbPerSubband, "Wrong subband size");
+  for (uint32_t sb = 0; sb < flat.GetNumSubbands (); ++sb)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+flat.GetOffset (sb), 0, "Subband " << sb << " of a flat SINR");
+    }
+
+  // First half at 20 dB, second half at 0 dB: the first subbands are better
+  // than the entire band, the last ones are worse
+  auto split = amc->CreateCqiFeedbackSbTdma (CreateSinr (numRb, [] (uint32_t rb) { return rb < 24; }),
+                                             rbPerSubband, NrSubbandCqi ());
+  for (uint32_t sb = 0; sb < split.GetNumSubbands (); ++sb)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+split.GetOffset (sb), sb < 6 ? NrSubbandCqi::MAX_OFFSET : NrSubbandCqi::MIN_OFFSET,
+                             "Wrong offset of subband " << sb);
+    }
+
+  // Without signal, the previous report is kept
+  SpectrumValue empty (NrSpectrumValueHelper::GetSpectrumModel (numRb, 3.5e9, 15e3));
+  auto kept = amc->CreateCqiFeedbackSbTdma (empty, rbPerSubband, split);
+  for (uint32_t sb = 0; sb < split.GetNumSubbands (); ++sb)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+kept.GetOffset (sb), +split.GetOffset (sb),
+                             "Subband " << sb << " without signal must keep the previous offset");
+    }
+
+  // 273 RB do not fit in MAX_SUBBANDS subbands of 1 RB: the subbands must be
+  // enlarged instead of aborting
+  const uint32_t wideRb = 273;
+  const uint32_t minSize = NrSubbandCqi::GetMinRbPerSubband (wideRb);
+  NS_TEST_ASSERT_MSG_EQ (minSize, 5, "Wrong minimum subband size");
+  NS_TEST_ASSERT_MSG_EQ (NrSubbandCqi::GetMinRbPerSubband (52), 1, "Wrong minimum subband size");
+  auto wide = amc->CreateCqiFeedbackSbTdma (CreateSinr (wideRb, [] (uint32_t) { return true; }),
+                                            1, NrSubbandCqi ());
+  NS_TEST_ASSERT_MSG_EQ (wide.GetRbPerSubband (), minSize, "The subband size must be clamped");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (wide.GetNumSubbands (), NrSubbandCqi::MAX_SUBBANDS, "Too many subbands");
+}
+
+/**
+ * \ingroup test
+ * \brief MCS of the subband CQI in the scheduler
+ */
+class TestNrSubbandCqiMcsTestCase : public TestCase
+{
+public:
+  TestNrSubbandCqiMcsTestCase () : TestCase ("MCS of the subband CQI in the scheduler") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+TestNrSubbandCqiMcsTestCase::DoRun ()
+{
+  Ptr<NrAmc> amc = CreateObject<NrAmc> ();
+  NrMacSchedulerCQIManagement cqiManagement;
+  cqiManagement.InstallGetNrAmcDlFn ([amc] () { return amc; });
+
+  // RBG of 2 RB, subbands of 4 RB: two RBG in each subband
+  auto ue = std::make_shared<NrMacSchedulerUeInfo> (1, BeamConfId (), [] () { return 2; });
+
+  const uint8_t wbCqi = 10;
+  const int8_t maxMcs = 28;
+  DlCqiInfo info;
+  info.m_rnti = 1;
+  info.m_ri = 1;
+  info.m_cqiType = DlCqiInfo::SB;
+  info.m_wbCqi = {wbCqi};
+  NrSubbandCqi sbCqi (52, 4);
+  sbCqi.SetOffset (0, 2);
+  sbCqi.SetOffset (1, 1);
+  sbCqi.SetOffset (2, -1);
+  info.m_sbCqi = {sbCqi};
+  cqiManagement.DlSBCQIReported (info, ue, 10, maxMcs);
+
+  NS_TEST_ASSERT_MSG_EQ (ue->m_dlCqi.m_cqiType, NrMacSchedulerUeInfo::DlCqiInfo::SB, "Expected a SB CQI");
+  NS_TEST_ASSERT_MSG_EQ (+ue->m_dlMcs.at (0), +amc->GetMcsFromCqi (wbCqi), "Wrong wideband MCS");
+  for (uint8_t code = 0; code < NrSubbandCqi::NUM_CODES; ++code)
+    {
+      uint8_t cqi = static_cast<uint8_t> (wbCqi + NrSubbandCqi::DecodeOffset (code));
+      NS_TEST_ASSERT_MSG_EQ (+ue->m_dlCqi.m_sbMcs.at (0).at (code), +amc->GetMcsFromCqi (cqi),
+                             "Wrong MCS of code " << +code);
+    }
+
+  // The RBG 0 and 1 are in the subband 0, 2 and 3 in the subband 1, 4 and 5
+  // in the subband 2, the others in subbands with offset 0
+  NS_TEST_ASSERT_MSG_EQ (+ue->GetDlSubbandOffset (1), 2, "Wrong offset of RBG 1");
+  NS_TEST_ASSERT_MSG_EQ (+ue->GetDlSubbandOffset (3), 1, "Wrong offset of RBG 3");
+  NS_TEST_ASSERT_MSG_EQ (+ue->GetDlSubbandOffset (4), -1, "Wrong offset of RBG 4");
+  NS_TEST_ASSERT_MSG_EQ (+ue->GetDlSubbandOffset (10), 0, "Wrong offset of RBG 10");
+
+  auto mcsOn = [&ue] (const std::vector<uint32_t> &rbgs)
+    {
+      NrRbMask mask (26);
+      for (uint32_t rbg : rbgs)
+        {
+          mask.Set (rbg);
+        }
+      return ue->GetDlMcsOnRbg (0, mask);
+    };
+  const auto & sbMcs = ue->m_dlCqi.m_sbMcs.at (0);
+  NS_TEST_ASSERT_MSG_EQ (+mcsOn ({0, 1}), +sbMcs.at (NrSubbandCqi::EncodeOffset (2)),
+                         "The RBG of the best subband must use its MCS");
+  NS_TEST_ASSERT_MSG_EQ (+mcsOn ({0, 3}), +sbMcs.at (NrSubbandCqi::EncodeOffset (1)),
+                         "The MCS must be the one of the worst subband used");
+  NS_TEST_ASSERT_MSG_EQ (+mcsOn ({0, 3, 5, 10}), +sbMcs.at (NrSubbandCqi::EncodeOffset (-1)),
+                         "The MCS must be the one of the worst subband used");
+  NS_TEST_ASSERT_MSG_EQ (+mcsOn ({10, 12}), +ue->m_dlMcs.at (0),
+                         "The subbands with offset 0 must use the wideband MCS");
+
+  // A wideband report disables the subbands
+  info.m_cqiType = DlCqiInfo::WB;
+  info.m_sbCqi.clear ();
+  cqiManagement.DlWBCQIReported (info, ue, 10, maxMcs);
+  NS_TEST_ASSERT_MSG_EQ (+ue->GetDlSubbandOffset (1), 0, "A WB report has no subband offsets");
+  NS_TEST_ASSERT_MSG_EQ (+mcsOn ({0, 1}), +ue->m_dlMcs.at (0), "A WB report uses the wideband MCS");
+}
+
+/**
+ * \ingroup test
+ * \brief An OFDMA scheduler places the RBG of a UE on its best subbands, and
+ * uses their MCS in the DCI
+ */
+class TestNrSubbandCqiSchedulingTestCase : public TestCase
+{
+public:
+  TestNrSubbandCqiSchedulingTestCase () : TestCase ("OFDMA scheduling on the subband CQI") {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+TestNrSubbandCqiSchedulingTestCase::DoRun ()
+{
+  const uint32_t numRb = 52;
+  const uint32_t rbPerSubband = 4;
+  const uint8_t wbCqi = 10;
+
+  ObjectFactory factory;
+  factory.SetTypeId (NrMacSchedulerOfdmaRR::GetTypeId ());
+  factory.Set ("FixedMcsDl", BooleanValue (false));
+  NrSchedulerTestDriver driver (factory, numRb);
+  driver.AddUe (1);
+
+  // The subbands 3, 7 and 11 are the best ones, the others the worst ones
+  auto isBest = [] (uint32_t sb) { return sb % 4 == 3; };
+  DlCqiInfo info;
+  info.m_rnti = 1;
+  info.m_ri = 1;
+  info.m_cqiType = DlCqiInfo::SB;
+  info.m_wbCqi = {wbCqi};
+  NrSubbandCqi sbCqi (numRb, rbPerSubband);
+  for (uint32_t sb = 0; sb < sbCqi.GetNumSubbands (); ++sb)
+    {
+      sbCqi.SetOffset (sb, isBest (sb) ? NrSubbandCqi::MAX_OFFSET : NrSubbandCqi::MIN_OFFSET);
+    }
+  info.m_sbCqi = {sbCqi};
+  driver.DlCqi (info);
+
+  // A buffer that fits in the best subbands
+  driver.DlBuffer (1, 200);
+  driver.DoSlot ();
+
+  auto allocations = driver.GetLastAllocations (true);
+  NS_TEST_ASSERT_MSG_EQ (allocations.size (), 1, "Expected one DL allocation");
+  const auto & dci = allocations.front ().m_dci;
+  NS_TEST_ASSERT_MSG_GT (dci->m_rbgBitmask.Count (), 0, "No RBG allocated");
+  for (uint32_t rbg : dci->m_rbgBitmask)
+    {
+      NS_TEST_ASSERT_MSG_EQ (isBest (sbCqi.GetSubbandOfRb (rbg)), true,
+                             "RBG " << rbg << " is not in one of the best subbands");
+    }
+
+  // The MCS is the one of the best subbands, and the TBS follows it
+  Ptr<NrAmc> amc = CreateObject<NrAmc> ();
+  const uint8_t mcs = amc->GetMcsFromCqi (wbCqi + NrSubbandCqi::MAX_OFFSET);
+  NS_TEST_ASSERT_MSG_EQ (+dci->m_mcs.at (0), +mcs, "The DCI must use the MCS of the subbands used");
+  NS_TEST_ASSERT_MSG_EQ (dci->m_tbSize.at (0),
+                         amc->CalculateTbSize (mcs, dci->m_rbgBitmask.Count () * dci->m_numSym),
+                         "The TBS must be recomputed with the MCS of the subbands used");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief Test suite for the subband CQI
+ */
+class TestNrSubbandCqi : public TestSuite
+{
+public:
+  TestNrSubbandCqi () : TestSuite ("nr-test-subband-cqi", UNIT)
+  {
+    AddTestCase (new TestNrSubbandCqiTestCase (52, 4, "52 RB, 4 RB per subband"), QUICK);
+    AddTestCase (new TestNrSubbandCqiTestCase (106, 8, "106 RB, 8 RB per subband"), QUICK);
+    AddTestCase (new TestNrSubbandCqiTestCase (273, 16, "273 RB, 16 RB per subband"), QUICK);
+    AddTestCase (new TestNrSubbandCqiTestCase (273, 5, "273 RB, 5 RB per subband"), QUICK);
+    AddTestCase (new TestNrSubbandCqiAmcTestCase (), QUICK);
+    AddTestCase (new TestNrSubbandCqiMcsTestCase (), QUICK);
+    AddTestCase (new TestNrSubbandCqiSchedulingTestCase (), QUICK);
+  }
+};
+
+static TestNrSubbandCqi testNrSubbandCqi; //!< Subband CQI test
+
+}  // namespace ns3
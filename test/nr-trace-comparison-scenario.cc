@@ -0,0 +1,328 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-trace-comparison-scenario.h"
+#include <ns3/packet.h>
+#include <ns3/simulator.h>
+#include <ns3/rng-seed-manager.h>
+#include <ns3/nr-module.h>
+#include <ns3/internet-module.h>
+#include <ns3/applications-module.h>
+#include <ns3/point-to-point-helper.h>
+#include <ns3/antenna-module.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <list>
+#include <sstream>
+
+namespace ns3 {
+
+/**
+ * \brief Where a trace sink records its events
+ */
+struct TraceComparisonSink
+{
+  std::vector<std::string> *m_events {nullptr}; //!< The events of the run
+  std::string m_name;                           //!< Name of the traced object
+};
+
+static std::ostringstream
+StartEvent (const TraceComparisonSink *sink)
+{
+  std::ostringstream ss;
+  ss << std::setw (12) << std::setfill ('0') << Simulator::Now ().GetNanoSeconds ()
+     << std::setfill (' ') << " " << sink->m_name;
+  return ss;
+}
+
+static void
+PrintSfnSf (std::ostringstream &ss, const SfnSf &sfn)
+{
+  ss << " " << sfn.GetFrame () << "/" << +sfn.GetSubframe () << "/" << sfn.GetSlot ();
+}
+
+static void
+SchedulingTrace (TraceComparisonSink *sink, NrSchedulingCallbackInfo info)
+{
+  std::ostringstream ss = StartEvent (sink);
+  ss << " " << info.m_frameNum << "/" << +info.m_subframeNum << "/" << info.m_slotNum
+     << " rnti " << info.m_rnti << " sym " << +info.m_symStart << "+" << +info.m_numSym
+     << " mcs " << +info.m_mcs << " tbs " << info.m_tbSize << " harq " << +info.m_harqId
+     << " ndi " << +info.m_ndi << " rv " << +info.m_rv;
+  sink->m_events->push_back (ss.str ());
+}
+
+static void
+RxedCtrlMsgsTrace (TraceComparisonSink *sink, SfnSf sfn, [[maybe_unused]] uint16_t nodeId,
+                   uint16_t rnti, [[maybe_unused]] uint8_t bwpId, Ptr<const NrControlMessage> msg)
+{
+  std::ostringstream ss = StartEvent (sink);
+  PrintSfnSf (ss, sfn);
+  ss << " rnti " << rnti << " ctrl " << msg->GetMessageType ();
+  sink->m_events->push_back (ss.str ());
+}
+
+static void
+RxedDlDciTrace (TraceComparisonSink *sink, SfnSf sfn, [[maybe_unused]] uint16_t nodeId,
+                uint16_t rnti, [[maybe_unused]] uint8_t bwpId, uint8_t harqId, uint32_t k1Delay)
+{
+  std::ostringstream ss = StartEvent (sink);
+  PrintSfnSf (ss, sfn);
+  ss << " rnti " << rnti << " dl dci harq " << +harqId << " k1 " << k1Delay;
+  sink->m_events->push_back (ss.str ());
+}
+
+static void
+RxPacketTrace (TraceComparisonSink *sink, Ptr<const Packet> pkt)
+{
+  std::ostringstream ss = StartEvent (sink);
+  ss << " rx " << pkt->GetSize ();
+  sink->m_events->push_back (ss.str ());
+}
+
+std::vector<std::string>
+NrTraceComparisonScenario::Run (const std::function<void (const Ptr<NrHelper> &)> &configure) const
+{
+  NS_ABORT_IF (!m_isUplink && !m_isDownlink);
+
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+
+  Config::SetDefault ("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue (999999999));
+  Config::SetDefault ("ns3::EpsBearer::Release", UintegerValue (15));
+  Config::SetDefault ("ns3::NrUePhy::EnableUplinkPowerControl", BooleanValue (false));
+  Config::SetDefault ("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue (MilliSeconds (0)));
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  gNbNodes.Create (m_gnbNum);
+  ueNodes.Create (m_gnbNum * m_uesPerGnb);
+
+  // The gNBs are far from each other, and each UE is close to its gNB
+  Ptr<ListPositionAllocator> gnbPositionAlloc = CreateObject<ListPositionAllocator> ();
+  Ptr<ListPositionAllocator> uePositionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint16_t gnb = 0; gnb < m_gnbNum; ++gnb)
+    {
+      double x = 200.0 * gnb;
+      gnbPositionAlloc->Add (Vector (x, 0.0, 10.0));
+      for (uint16_t ue = 0; ue < m_uesPerGnb; ++ue)
+        {
+          uePositionAlloc->Add (Vector (x + 5.0 + 2.0 * ue, 10.0 - 4.0 * ue, 1.5));
+        }
+    }
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (gnbPositionAlloc);
+  mobility.Install (gNbNodes);
+  mobility.SetPositionAllocator (uePositionAlloc);
+  mobility.Install (ueNodes);
+
+  Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper> ();
+  Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject<IdealBeamformingHelper> ();
+  idealBeamformingHelper->SetAttribute ("BeamformingMethod", TypeIdValue (DirectPathBeamforming::GetTypeId ()));
+
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  nrHelper->SetBeamformingHelper (idealBeamformingHelper);
+  nrHelper->SetEpcHelper (epcHelper);
+
+  nrHelper->SetUeAntennaAttribute ("NumRows", UintegerValue (2));
+  nrHelper->SetUeAntennaAttribute ("NumColumns", UintegerValue (2));
+  nrHelper->SetUeAntennaAttribute ("AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+  nrHelper->SetGnbAntennaAttribute ("NumRows", UintegerValue (4));
+  nrHelper->SetGnbAntennaAttribute ("NumColumns", UintegerValue (4));
+  nrHelper->SetGnbAntennaAttribute ("AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+
+  nrHelper->SetUePhyAttribute ("TxPower", DoubleValue (20.0));
+  nrHelper->SetGnbPhyAttribute ("TxPower", DoubleValue (40.0));
+  nrHelper->SetGnbPhyAttribute ("Numerology", UintegerValue (m_numerology));
+
+  // With a fixed (and low) MCS, and the UEs close to their gNB, the
+  // decoding never fails, whatever the channel realization
+  nrHelper->SetSchedulerTypeId (NrMacSchedulerOfdmaRR::GetTypeId ());
+  nrHelper->SetSchedulerAttribute ("FixedMcsDl", BooleanValue (true));
+  nrHelper->SetSchedulerAttribute ("FixedMcsUl", BooleanValue (true));
+  nrHelper->SetSchedulerAttribute ("StartingMcsDl", UintegerValue (10));
+  nrHelper->SetSchedulerAttribute ("StartingMcsUl", UintegerValue (10));
+  nrHelper->SetPathlossAttribute ("ShadowingEnabled", BooleanValue (false));
+
+  if (configure)
+    {
+      configure (nrHelper);
+    }
+
+  CcBwpCreator ccBwpCreator;
+  CcBwpCreator::SimpleOperationBandConf bandConf (28e9, 20e6, 1, BandwidthPartInfo::UMi_StreetCanyon_LoS);
+  OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc (bandConf);
+  nrHelper->InitializeOperationBand (&band);
+  BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps ({band});
+
+  NetDeviceContainer gNbNetDevs = nrHelper->InstallGnbDevice (gNbNodes, allBwps);
+  NetDeviceContainer ueNetDevs = nrHelper->InstallUeDevice (ueNodes, allBwps);
+
+  NS_ABORT_MSG_IF (! m_gnbNumerologies.empty () && m_gnbNumerologies.size () != m_gnbNum,
+                   "Specify the numerology of each gNB, or none");
+  for (uint32_t i = 0; i < m_gnbNumerologies.size (); ++i)
+    {
+      NrHelper::GetGnbPhy (gNbNetDevs.Get (i), 0)->SetAttribute ("Numerology",
+                                                                 UintegerValue (m_gnbNumerologies.at (i)));
+    }
+
+  int64_t randomStream = 1;
+  randomStream += nrHelper->AssignStreams (gNbNetDevs, randomStream);
+  randomStream += nrHelper->AssignStreams (ueNetDevs, randomStream);
+
+  for (auto it = gNbNetDevs.Begin (); it != gNbNetDevs.End (); ++it)
+    {
+      DynamicCast<NrGnbNetDevice> (*it)->UpdateConfig ();
+    }
+  for (auto it = ueNetDevs.Begin (); it != ueNetDevs.End (); ++it)
+    {
+      DynamicCast<NrUeNetDevice> (*it)->UpdateConfig ();
+    }
+
+  Ptr<Node> pgw = epcHelper->GetPgwNode ();
+  NodeContainer remoteHostContainer;
+  remoteHostContainer.Create (1);
+  Ptr<Node> remoteHost = remoteHostContainer.Get (0);
+  InternetStackHelper internet;
+  internet.Install (remoteHostContainer);
+  PointToPointHelper p2ph;
+  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+  p2ph.SetDeviceAttribute ("Mtu", UintegerValue (2500));
+  p2ph.SetChannelAttribute ("Delay", TimeValue (Seconds (0.000)));
+  NetDeviceContainer internetDevices = p2ph.Install (pgw, remoteHost);
+  Ipv4AddressHelper ipv4h;
+  ipv4h.SetBase ("1.0.0.0", "255.0.0.0");
+  Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign (internetDevices);
+  Ipv4Address remoteHostAddr = internetIpIfaces.GetAddress (1);
+
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> remoteHostStaticRouting = ipv4RoutingHelper.GetStaticRouting (remoteHost->GetObject<Ipv4> ());
+  remoteHostStaticRouting->AddNetworkRouteTo (Ipv4Address ("7.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+  internet.Install (ueNodes);
+  Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address (NetDeviceContainer (ueNetDevs));
+  for (uint32_t j = 0; j < ueNodes.GetN (); ++j)
+    {
+      Ptr<Ipv4StaticRouting> ueStaticRouting = ipv4RoutingHelper.GetStaticRouting (ueNodes.Get (j)->GetObject<Ipv4> ());
+      ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1);
+    }
+
+  nrHelper->AttachToClosestEnb (ueNetDevs, gNbNetDevs);
+
+  uint16_t dlPort = 1234;
+  uint16_t ulPort = 2000;
+  ApplicationContainer serverApps;
+  ApplicationContainer clientApps;
+  for (uint32_t j = 0; j < ueNodes.GetN (); ++j)
+    {
+      Ptr<EpcTft> tft = Create<EpcTft> ();
+      if (m_isDownlink)
+        {
+          serverApps.Add (UdpServerHelper (dlPort).Install (ueNodes.Get (j)));
+          UdpClientHelper dlClient (ueIpIface.GetAddress (j), dlPort);
+          dlClient.SetAttribute ("MaxPackets", UintegerValue (UINT32_MAX));
+          dlClient.SetAttribute ("PacketSize", UintegerValue (m_packetSize));
+          dlClient.SetAttribute ("Interval", TimeValue (m_packetInterval));
+          clientApps.Add (dlClient.Install (remoteHost));
+
+          EpcTft::PacketFilter dlpf;
+          dlpf.localPortStart = dlPort;
+          dlpf.localPortEnd = dlPort;
+          dlpf.direction = EpcTft::DOWNLINK;
+          tft->Add (dlpf);
+        }
+      if (m_isUplink)
+        {
+          serverApps.Add (UdpServerHelper (ulPort + j).Install (remoteHost));
+          UdpClientHelper ulClient (remoteHostAddr, ulPort + j);
+          ulClient.SetAttribute ("MaxPackets", UintegerValue (UINT32_MAX));
+          ulClient.SetAttribute ("PacketSize", UintegerValue (m_packetSize));
+          ulClient.SetAttribute ("Interval", TimeValue (m_packetInterval));
+          clientApps.Add (ulClient.Install (ueNodes.Get (j)));
+
+          EpcTft::PacketFilter ulpf;
+          ulpf.remotePortStart = ulPort + j;
+          ulpf.remotePortEnd = ulPort + j;
+          ulpf.direction = EpcTft::UPLINK;
+          tft->Add (ulpf);
+        }
+      nrHelper->ActivateDedicatedEpsBearer (ueNetDevs.Get (j), EpsBearer (EpsBearer::NGBR_LOW_LAT_EMBB), tft);
+    }
+  serverApps.Start (m_appStart);
+  clientApps.Start (m_appStart);
+
+  std::vector<std::string> events;
+  std::list<TraceComparisonSink> sinks;
+  auto newSink = [&] (const std::string &name) {
+    sinks.push_back (TraceComparisonSink {&events, name});
+    return &sinks.back ();
+  };
+
+  for (uint32_t i = 0; i < gNbNetDevs.GetN (); ++i)
+    {
+      Ptr<NrGnbMac> mac = NrHelper::GetGnbMac (gNbNetDevs.Get (i), 0);
+      std::string name = "gnb" + std::to_string (i);
+      mac->TraceConnectWithoutContext ("DlScheduling", MakeBoundCallback (&SchedulingTrace, newSink (name + " dl")));
+      mac->TraceConnectWithoutContext ("UlScheduling", MakeBoundCallback (&SchedulingTrace, newSink (name + " ul")));
+    }
+  for (uint32_t i = 0; i < ueNetDevs.GetN (); ++i)
+    {
+      Ptr<NrUePhy> phy = NrHelper::GetUePhy (ueNetDevs.Get (i), 0);
+      TraceComparisonSink *sink = newSink ("ue" + std::to_string (i));
+      phy->TraceConnectWithoutContext ("UePhyRxedCtrlMsgsTrace", MakeBoundCallback (&RxedCtrlMsgsTrace, sink));
+      phy->TraceConnectWithoutContext ("UePhyRxedDlDciTrace", MakeBoundCallback (&RxedDlDciTrace, sink));
+    }
+  for (uint32_t i = 0; i < serverApps.GetN (); ++i)
+    {
+      serverApps.Get (i)->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&RxPacketTrace, newSink ("app" + std::to_string (i))));
+    }
+
+  if (m_onInstalled)
+    {
+      m_onInstalled (gNbNetDevs, ueNetDevs);
+    }
+
+  Simulator::Stop (m_simTime);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::sort (events.begin (), events.end ());
+  return events;
+}
+
+std::string
+NrTraceComparisonScenario::FirstDifference (const std::vector<std::string> &a,
+                                            const std::vector<std::string> &b)
+{
+  auto mismatch = std::mismatch (a.begin (), a.end (), b.begin (), b.end ());
+  if (mismatch.first == a.end () && mismatch.second == b.end ())
+    {
+      return "";
+    }
+
+  std::ostringstream ss;
+  ss << "event " << std::distance (a.begin (), mismatch.first) << ": \""
+     << (mismatch.first == a.end () ? "<none>" : *mismatch.first) << "\" vs \""
+     << (mismatch.second == b.end () ? "<none>" : *mismatch.second) << "\"";
+  return ss.str ();
+}
+
+} // namespace ns3
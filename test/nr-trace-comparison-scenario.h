@@ -0,0 +1,95 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_TRACE_COMPARISON_SCENARIO_H
+#define NR_TRACE_COMPARISON_SCENARIO_H
+
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+#include <ns3/net-device-container.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class NrHelper;
+
+/**
+ * \file nr-trace-comparison-scenario.h
+ * \ingroup test
+ *
+ * \brief A small multi-cell scenario, used by the tests of the options that
+ * must not change the outcome of a simulation (e.g., the parallel
+ * scheduling). The test runs the scenario with and without the option,
+ * and compares the events traced in the two runs.
+ */
+
+/**
+ * \ingroup test
+ * \brief Multi-cell scenario with UDP traffic, that records the scheduling
+ * decisions, the CTRL messages and the DCI received by the UEs, and the
+ * packets received by the applications
+ *
+ * Each event is recorded as a line that starts with the simulation time;
+ * the lines are returned sorted, so that the comparison does not depend on
+ * the order of the events executed at the same time.
+ */
+class NrTraceComparisonScenario
+{
+public:
+  /**
+   * \brief Run the scenario
+   * \param configure function called with the NrHelper before installing the
+   * devices, to set the option under test (can be empty)
+   * \return the recorded events, sorted
+   */
+  std::vector<std::string> Run (const std::function<void (const Ptr<NrHelper> &)> &configure) const;
+
+  /**
+   * \brief Find the first difference between two runs
+   * \param a the events of the first run
+   * \param b the events of the second run
+   * \return an empty string if the runs are equal, a description of the
+   * first difference otherwise
+   */
+  static std::string FirstDifference (const std::vector<std::string> &a,
+                                      const std::vector<std::string> &b);
+
+  uint16_t m_gnbNum {2};                       //!< Number of gNBs
+  uint16_t m_uesPerGnb {2};                    //!< Number of UEs attached to each gNB
+  uint16_t m_numerology {1};                   //!< Numerology of the single BWP
+  std::vector<uint16_t> m_gnbNumerologies;     //!< Numerology of each gNB (if empty, all of them use m_numerology)
+  bool m_isDownlink {true};                    //!< Generate DL traffic
+  bool m_isUplink {true};                      //!< Generate UL traffic
+  uint32_t m_packetSize {100};                 //!< Size of the UDP packets
+  Time m_packetInterval {MilliSeconds (1)};    //!< Interval between the packets of a flow
+  Time m_appStart {MilliSeconds (400)};        //!< Start of the applications
+  Time m_simTime {MilliSeconds (600)};         //!< Duration of the simulation
+  /**
+   * Function called with the devices of the gNBs and of the UEs before
+   * starting the simulation, to connect other traces or to schedule events
+   * (can be empty)
+   */
+  std::function<void (const NetDeviceContainer &, const NetDeviceContainer &)> m_onInstalled;
+};
+
+} // namespace ns3
+
+#endif // NR_TRACE_COMPARISON_SCENARIO_H
@@ -609,10 +609,12 @@ GetNameMap (void)
     NrMacSchedulerTdmaRR::GetTypeId (),
     NrMacSchedulerTdmaPF::GetTypeId (),
     NrMacSchedulerTdmaMR::GetTypeId (),
+    NrMacSchedulerTdmaQos::GetTypeId (),
     NrMacSchedulerOfdma::GetTypeId (),
     NrMacSchedulerOfdmaRR::GetTypeId (),
     NrMacSchedulerOfdmaPF::GetTypeId (),
     NrMacSchedulerOfdmaMR::GetTypeId (),
+    NrMacSchedulerOfdmaQos::GetTypeId (),
     NrMacSchedulerNs3::GetTypeId (),
     NrInterference::GetTypeId (),
     NrHelper::GetTypeId (),